@@ -56,6 +56,12 @@ static int debug_port = -1;
 static const char* package_root = NULL;
 
 
+// Value of the --type-feedback option.
+// (This pointer points into an argv buffer and does not need to be
+// free'd.)
+static const char* type_feedback_filename = NULL;
+
+
 // Global flag that is used to indicate that we want to compile all the
 // dart functions and not run anything.
 static bool has_compile_all = false;
@@ -238,6 +244,16 @@ static bool ProcessGenScriptSnapshotOption(const char* filename) {
 }
 
 
+static bool ProcessTypeFeedbackOption(const char* filename) {
+  ASSERT(filename != NULL);
+  if (filename[0] == '\0') {
+    return false;
+  }
+  type_feedback_filename = filename;
+  return true;
+}
+
+
 static bool ProcessEnableVmServiceOption(const char* port) {
   ASSERT(port != NULL);
   vm_service_server_port = -1;
@@ -284,6 +300,7 @@ static struct {
   { "--compile_all", ProcessCompileAllOption },
   { "--debug", ProcessDebugOption },
   { "--snapshot=", ProcessGenScriptSnapshotOption },
+  { "--type-feedback=", ProcessTypeFeedbackOption },
   { "--print-script", ProcessPrintScriptOption },
   { "--enable-vm-service", ProcessEnableVmServiceOption },
   { "--trace-debug-protocol", ProcessTraceDebugProtocolOption },
@@ -632,6 +649,10 @@ static void PrintUsage() {
 "--snapshot=<file_name>\n"
 "  loads Dart script and generates a snapshot in the specified file\n"
 "\n"
+"--type-feedback=<file_name>\n"
+"  loads type feedback recorded by an earlier run of the same script from\n"
+"  the specified file, and records the type feedback of this run to it\n"
+"\n"
 "--print-script\n"
 "  generates Dart source code back and prints it after parsing a Dart script\n"
 "\n"
@@ -713,6 +734,46 @@ static int DartErrorExit(Dart_Handle error) {
 }
 
 
+static Dart_Handle LoadTypeFeedback(const char* filename) {
+  File* file = File::Open(filename, File::kRead);
+  if (file == NULL) {
+    // Nothing recorded yet, this run will record the feedback.
+    return Dart_Null();
+  }
+  intptr_t size = file->Length();
+  uint8_t* buffer = reinterpret_cast<uint8_t*>(malloc(size));
+  bool read = file->ReadFully(buffer, size);
+  delete file;
+  Dart_Handle result = read ?
+      Dart_LoadTypeFeedback(buffer, size) :
+      DartUtils::NewError("Unable to read type feedback from '%s'", filename);
+  free(buffer);
+  return result;
+}
+
+
+static Dart_Handle SaveTypeFeedback(const char* filename) {
+  uint8_t* buffer = NULL;
+  intptr_t size = 0;
+  Dart_Handle result = Dart_CreateTypeFeedback(&buffer, &size);
+  if (Dart_IsError(result)) {
+    return result;
+  }
+  File* file = File::Open(filename, File::kWriteTruncate);
+  if (file == NULL) {
+    return DartUtils::NewError("Unable to open file %s for writing the type"
+                               " feedback", filename);
+  }
+  bool written = file->WriteFully(buffer, size);
+  delete file;
+  if (!written) {
+    return DartUtils::NewError("Unable to write type feedback to '%s'",
+                               filename);
+  }
+  return result;
+}
+
+
 static void ShutdownIsolate(void* callback_data) {
   VmService::VmServiceShutdownCallback(callback_data);
   IsolateData* isolate_data = reinterpret_cast<IsolateData*>(callback_data);
@@ -910,6 +971,14 @@ int main(int argc, char** argv) {
         return DartErrorExit(result);
       }
     } else {
+      if (type_feedback_filename != NULL) {
+        // Stale feedback only costs warm up time, so keep running without it.
+        result = LoadTypeFeedback(type_feedback_filename);
+        if (Dart_IsError(result)) {
+          Log::PrintErr("Ignoring type feedback: %s\n", Dart_GetError(result));
+        }
+      }
+
       // The helper function _getMainClosure creates a closure for the main
       // entry point which is either explicitly or implictly exported from the
       // root library.
@@ -964,6 +1033,13 @@ int main(int argc, char** argv) {
       if (Dart_IsError(result)) {
         return DartErrorExit(result);
       }
+
+      if (type_feedback_filename != NULL) {
+        result = SaveTypeFeedback(type_feedback_filename);
+        if (Dart_IsError(result)) {
+          return DartErrorExit(result);
+        }
+      }
     }
   }
 
@@ -569,6 +569,24 @@ DART_EXPORT Dart_Handle Dart_AddGcEpilogueCallback(
 DART_EXPORT Dart_Handle Dart_RemoveGcEpilogueCallback(
     Dart_GcEpilogueCallback callback);
 
+/**
+ * Notifies the VM that the current isolate is about to become idle.
+ *
+ * The VM uses the idle time for work which would otherwise pause the
+ * isolate later: optimizing functions which became hot since the last
+ * notification (see --deferred_optimization), finishing the sweeping of
+ * old space, scavenging a populated new space, or collecting old space and
+ * unused code when they are due. Work is only started if it is expected
+ * to be done before the deadline.
+ *
+ * \param deadline_micros The number of microseconds from now after which
+ *   the isolate is expected to run again.
+ *
+ * \return Success if the idle time was used. Otherwise, returns an error
+ *   handle.
+ */
+DART_EXPORT Dart_Handle Dart_NotifyIdle(int64_t deadline_micros);
+
 
 /*
  * ==========================
@@ -905,6 +923,44 @@ DART_EXPORT Dart_Handle Dart_CreateSnapshot(uint8_t** buffer,
 DART_EXPORT Dart_Handle Dart_CreateScriptSnapshot(uint8_t** buffer,
                                                   intptr_t* size);
 
+/**
+ * Creates a snapshot of the type feedback gathered by the current isolate.
+ *
+ * Type feedback consists of the usage counters and inline cache contents of
+ * the functions run so far and the class ids guarded for instance fields.
+ * Loading it into a later run of the same application with
+ * Dart_LoadTypeFeedback lets that run optimize its hot functions right away
+ * instead of re-learning the feedback.
+ *
+ * Requires there to be a current isolate which already has loaded script.
+ *
+ * \param buffer Returns a pointer to a buffer containing
+ *   the snapshot. This buffer is scope allocated and is only valid
+ *   until the next call to Dart_ExitScope.
+ * \param size Returns the size of the buffer.
+ *
+ * \return A valid handle if no error occurs during the operation.
+ */
+DART_EXPORT Dart_Handle Dart_CreateTypeFeedback(uint8_t** buffer,
+                                                intptr_t* size);
+
+/**
+ * Loads type feedback created by Dart_CreateTypeFeedback into the current
+ * isolate. Must be called after the application script has been loaded and
+ * before it runs.
+ *
+ * The feedback is rejected as a whole, and nothing is loaded, if it was
+ * recorded against sources which differ from the ones loaded now.
+ *
+ * \param buffer A buffer created by Dart_CreateTypeFeedback.
+ * \param buffer_len Length of the buffer.
+ *
+ * \return A valid handle if the feedback was loaded. Otherwise, returns an
+ *   error handle describing why it was rejected.
+ */
+DART_EXPORT Dart_Handle Dart_LoadTypeFeedback(const uint8_t* buffer,
+                                              intptr_t buffer_len);
+
 /**
  * Schedules an interrupt for the specified isolate.
  *
@@ -478,6 +478,35 @@ ASSEMBLER_TEST_RUN(ForwardBranch, test) {
 }
 
 
+// Jumps through a table of branches indexed by the tagged Smi 2, like the
+// code of a JumpTable instruction.
+ASSEMBLER_TEST_GENERATE(JumpTable, assembler) {
+  const intptr_t kNumEntries = 4;
+  Label targets[kNumEntries];
+  Label done;
+  __ mov(R1, ShifterOperand(2 << kSmiTagShift));
+  __ add(PC, PC, ShifterOperand(R1, LSL, 1));
+  __ bkpt(0);
+  for (intptr_t i = 0; i < kNumEntries; i++) {
+    __ b(&targets[i]);
+  }
+  for (intptr_t i = 0; i < kNumEntries; i++) {
+    __ Bind(&targets[i]);
+    __ mov(R0, ShifterOperand(10 + i));
+    __ b(&done);
+  }
+  __ Bind(&done);
+  __ bx(LR);
+}
+
+
+ASSEMBLER_TEST_RUN(JumpTable, test) {
+  EXPECT(test != NULL);
+  typedef int (*JumpTable)();
+  EXPECT_EQ(12, EXECUTE_TEST_CODE_INT32(JumpTable, test->entry()));
+}
+
+
 ASSEMBLER_TEST_GENERATE(LoadStore, assembler) {
   __ mov(R1, ShifterOperand(123));
   __ Push(R1);
@@ -1868,6 +1868,20 @@ void Assembler::jmp(Label* label, bool near) {
 }
 
 
+void Assembler::JmpFixedSize(Label* label) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  if (label->IsBound()) {
+    intptr_t offset = label->Position() - buffer_.Size();
+    ASSERT(offset <= 0);
+    EmitUint8(0xE9);
+    EmitInt32(offset - kJmpFixedSize);
+  } else {
+    EmitUint8(0xE9);
+    EmitLabelLink(label);
+  }
+}
+
+
 void Assembler::jmp(const ExternalLabel* label) {
   AssemblerBuffer::EnsureCapacity ensured(&buffer_);
   EmitUint8(0xE9);
@@ -2051,12 +2065,16 @@ void Assembler::StoreIntoObject(Register object,
   } else {
     StoreIntoObjectFilterNoSmi(object, value, &done);
   }
-  // A store buffer update is required.
+  // A store buffer update is required. The stub also receives the address of
+  // the slot, so that stores into large arrays only dirty the slot's card.
+  leal(value, dest);
   if (value != EAX) pushl(EAX);  // Preserve EAX.
+  pushl(value);
   if (object != EAX) {
     movl(EAX, object);
   }
   call(&StubCode::UpdateStoreBufferLabel());
+  popl(value);
   if (value != EAX) popl(EAX);  // Restore EAX.
   Bind(&done);
 }
@@ -615,6 +615,10 @@ class Assembler : public ValueObject {
   void jmp(Register reg);
   void jmp(Label* label, bool near = kFarJump);
   void jmp(const ExternalLabel* label);
+  // Always encodes a 32-bit displacement, so that all entries of a jump table
+  // have the same size.
+  static const intptr_t kJmpFixedSize = 5;
+  void JmpFixedSize(Label* label);
 
   void lock();
   void cmpxchgl(const Address& address, Register reg);
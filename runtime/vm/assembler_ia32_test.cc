@@ -159,6 +159,38 @@ ASSEMBLER_TEST_RUN(NearJumpAroundCrash, test) {
 }
 
 
+// Jumps through a table of fixed-size jumps indexed by 2, like the code of a
+// JumpTable instruction. The call pushes the address of the table.
+ASSEMBLER_TEST_GENERATE(JumpTable, assembler) {
+  const intptr_t kNumEntries = 4;
+  Label targets[kNumEntries];
+  Label dispatch, done;
+  __ movl(ECX, Immediate(2));
+  ASSERT(Assembler::kJmpFixedSize == 5);
+  __ leal(ECX, Address(ECX, ECX, TIMES_4, 0));
+  __ call(&dispatch);
+  for (intptr_t i = 0; i < kNumEntries; i++) {
+    __ JmpFixedSize(&targets[i]);
+  }
+  __ Bind(&dispatch);
+  __ addl(Address(ESP, 0), ECX);
+  __ ret();
+  for (intptr_t i = 0; i < kNumEntries; i++) {
+    __ Bind(&targets[i]);
+    __ movl(EAX, Immediate(10 + i));
+    __ jmp(&done);
+  }
+  __ Bind(&done);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(JumpTable, test) {
+  typedef int (*JumpTableCode)();
+  EXPECT_EQ(12, reinterpret_cast<JumpTableCode>(test->entry())());
+}
+
+
 ASSEMBLER_TEST_GENERATE(SimpleLoop, assembler) {
   __ movl(EAX, Immediate(0));
   __ movl(ECX, Immediate(0));
@@ -1070,6 +1070,40 @@ ASSEMBLER_TEST_RUN(Jalr_delay, test) {
 }
 
 
+// Jumps through a table of branches indexed by the tagged Smi 2, like the
+// code of a JumpTable instruction. The table starts three instructions after
+// the address bal leaves in RA.
+ASSEMBLER_TEST_GENERATE(JumpTable, assembler) {
+  const intptr_t kNumEntries = 4;
+  Label targets[kNumEntries];
+  Label table_base, done;
+  __ mov(T2, RA);
+  __ LoadImmediate(T0, 2 << kSmiTagShift);
+  __ sll(T0, T0, 2);
+  __ AddImmediate(T0, 3 * Instr::kInstrSize);
+  __ bal(&table_base);
+  __ Bind(&table_base);
+  __ addu(T1, RA, T0);
+  __ jr(T1);
+  for (intptr_t i = 0; i < kNumEntries; i++) {
+    __ b(&targets[i]);
+  }
+  for (intptr_t i = 0; i < kNumEntries; i++) {
+    __ Bind(&targets[i]);
+    __ LoadImmediate(V0, 10 + i);
+    __ b(&done);
+  }
+  __ Bind(&done);
+  __ jr(T2);
+}
+
+
+ASSEMBLER_TEST_RUN(JumpTable, test) {
+  typedef int (*SimpleCode)();
+  EXPECT_EQ(12, EXECUTE_TEST_CODE_INT32(SimpleCode, test->entry()));
+}
+
+
 ASSEMBLER_TEST_GENERATE(AddOverflow_detect, assembler) {
   Register left = T0;
   Register right = T1;
@@ -479,6 +479,22 @@ void Assembler::leaq(Register dst, const Address& src) {
 }
 
 
+void Assembler::leaq(Register dst, Label* label) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(REX_PREFIX | REX_W | ((dst > 7) ? REX_R : REX_NONE));
+  EmitUint8(0x8D);
+  // Mod 0 and rm 5 encode a displacement from the next instruction.
+  EmitUint8(0x05 | ((dst & 7) << 3));
+  if (label->IsBound()) {
+    intptr_t offset = label->Position() - (buffer_.Size() + 4);
+    ASSERT(offset <= 0);
+    EmitInt32(offset);
+  } else {
+    EmitLabelLink(label);
+  }
+}
+
+
 void Assembler::cmovgeq(Register dst, Register src) {
   AssemblerBuffer::EnsureCapacity ensured(&buffer_);
   Operand operand(src);
@@ -2181,6 +2197,20 @@ void Assembler::jmp(Label* label, bool near) {
 }
 
 
+void Assembler::JmpFixedSize(Label* label) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  if (label->IsBound()) {
+    intptr_t offset = label->Position() - buffer_.Size();
+    ASSERT(offset <= 0);
+    EmitUint8(0xE9);
+    EmitInt32(offset - kJmpFixedSize);
+  } else {
+    EmitUint8(0xE9);
+    EmitLabelLink(label);
+  }
+}
+
+
 void Assembler::jmp(const ExternalLabel* label) {
   {  // Encode movq(TMP, Immediate(label->address())), but always as imm64.
     AssemblerBuffer::EnsureCapacity ensured(&buffer_);
@@ -2558,12 +2588,16 @@ void Assembler::StoreIntoObject(Register object,
   } else {
     StoreIntoObjectFilterNoSmi(object, value, &done);
   }
-  // A store buffer update is required.
+  // A store buffer update is required. The stub also receives the address of
+  // the slot, so that stores into large arrays only dirty the slot's card.
+  leaq(value, dest);
   if (value != RAX) pushq(RAX);
+  pushq(value);
   if (object != RAX) {
     movq(RAX, object);
   }
   Call(&StubCode::UpdateStoreBufferLabel(), PP);
+  popq(value);
   if (value != RAX) popq(RAX);
   Bind(&done);
 }
@@ -396,6 +396,8 @@ class Assembler : public ValueObject {
   void rep_movsb();
 
   void leaq(Register dst, const Address& src);
+  // Loads the address of the label relative to the instruction pointer.
+  void leaq(Register dst, Label* label);
 
   void cmovgeq(Register dst, Register src);
   void cmovlessq(Register dst, Register src);
@@ -625,6 +627,10 @@ class Assembler : public ValueObject {
   void jmp(Register reg);
   void jmp(Label* label, bool near = kFarJump);
   void jmp(const ExternalLabel* label);
+  // Always encodes a 32-bit displacement, so that all entries of a jump table
+  // have the same size.
+  static const intptr_t kJmpFixedSize = 5;
+  void JmpFixedSize(Label* label);
 
   void lock();
   void cmpxchgl(const Address& address, Register reg);
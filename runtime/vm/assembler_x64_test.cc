@@ -259,6 +259,38 @@ ASSEMBLER_TEST_RUN(JumpAroundCrash, test) {
 }
 
 
+// Jumps through a table of fixed-size jumps indexed by 2, like the code of a
+// JumpTable instruction.
+ASSEMBLER_TEST_GENERATE(JumpTable, assembler) {
+  const intptr_t kNumEntries = 4;
+  Label targets[kNumEntries];
+  Label table, done;
+  __ movq(RCX, Immediate(2));
+  ASSERT(Assembler::kJmpFixedSize == 5);
+  __ leaq(RCX, Address(RCX, RCX, TIMES_4, 0));
+  __ leaq(RDX, &table);
+  __ addq(RDX, RCX);
+  __ jmp(RDX);
+  __ Bind(&table);
+  for (intptr_t i = 0; i < kNumEntries; i++) {
+    __ JmpFixedSize(&targets[i]);
+  }
+  for (intptr_t i = 0; i < kNumEntries; i++) {
+    __ Bind(&targets[i]);
+    __ movq(RAX, Immediate(10 + i));
+    __ jmp(&done);
+  }
+  __ Bind(&done);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(JumpTable, test) {
+  typedef int (*JumpTableCode)();
+  EXPECT_EQ(12, reinterpret_cast<JumpTableCode>(test->entry())());
+}
+
+
 ASSEMBLER_TEST_GENERATE(SimpleLoop, assembler) {
   __ movq(RAX, Immediate(0));
   __ movq(RCX, Immediate(0));
@@ -0,0 +1,70 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_ATOMIC_WIN_H_
+#define VM_ATOMIC_WIN_H_
+
+#if !defined VM_ATOMIC_H_
+#error Do not include atomic_win.h directly. Use atomic.h instead.
+#endif
+
+#if !defined(TARGET_OS_WINDOWS)
+#error This file should only be included on Windows builds.
+#endif
+
+namespace dart {
+
+
+inline uword AtomicOperations::FetchAndIncrement(uword* p) {
+#if defined(TARGET_ARCH_X64)
+  return static_cast<uword>(
+      InterlockedIncrement64(reinterpret_cast<LONGLONG*>(p))) - 1;
+#elif defined(TARGET_ARCH_IA32)
+  return static_cast<uword>(
+      InterlockedIncrement(reinterpret_cast<LONG*>(p))) - 1;
+#else
+  UNIMPLEMENTED();
+  return 0;
+#endif
+}
+
+
+inline uword AtomicOperations::AddAndFetch(uword* p, uword value) {
+#if defined(TARGET_ARCH_X64)
+  return static_cast<uword>(
+      InterlockedExchangeAdd64(reinterpret_cast<LONGLONG*>(p),
+                               static_cast<LONGLONG>(value))) + value;
+#elif defined(TARGET_ARCH_IA32)
+  return static_cast<uword>(
+      InterlockedExchangeAdd(reinterpret_cast<LONG*>(p),
+                             static_cast<LONG>(value))) + value;
+#else
+  UNIMPLEMENTED();
+  return 0;
+#endif
+}
+
+
+inline uword AtomicOperations::CompareAndSwapWord(uword* ptr,
+                                                  uword old_value,
+                                                  uword new_value) {
+#if defined(TARGET_ARCH_X64)
+  return static_cast<uword>(
+      InterlockedCompareExchange64(reinterpret_cast<LONGLONG*>(ptr),
+                                   static_cast<LONGLONG>(new_value),
+                                   static_cast<LONGLONG>(old_value)));
+#elif defined(TARGET_ARCH_IA32)
+  return static_cast<uword>(
+      InterlockedCompareExchange(reinterpret_cast<LONG*>(ptr),
+                                 static_cast<LONG>(new_value),
+                                 static_cast<LONG>(old_value)));
+#else
+  UNIMPLEMENTED();
+  return 0;
+#endif
+}
+
+}  // namespace dart
+
+#endif  // VM_ATOMIC_WIN_H_
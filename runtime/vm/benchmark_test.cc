@@ -9,6 +9,7 @@
 
 #include "platform/assert.h"
 
+#include "vm/compiler_stats.h"
 #include "vm/dart_api_impl.h"
 #include "vm/stack_frame.h"
 #include "vm/unit_test.h"
@@ -393,6 +394,310 @@ BENCHMARK(FrameLookup) {
 }
 
 
+//
+// Measure stores of new objects into old objects, which need a store buffer
+// update on every iteration.
+//
+BENCHMARK(StoreBufferStores) {
+  const char* kScriptChars =
+      "class Holder {\n"
+      "  var value;\n"
+      "}\n"
+      "var holder;\n"
+      "var list;\n"
+      "void setup() {\n"
+      "  holder = new Holder();\n"
+      "  list = new List(1024);\n"
+      "}\n"
+      "void benchmark() {\n"
+      "  for (var i = 0; i < 1000000; i++) {\n"
+      "    var value = new Holder();\n"
+      "    holder.value = value;\n"
+      "    list[i & 1023] = value;\n"
+      "  }\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("setup"), 0, NULL));
+  // Promote the holder and the list, survivors of two scavenges.
+  Heap* heap = Isolate::Current()->heap();
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  Timer timer(true, "StoreBufferStores benchmark");
+  timer.Start();
+  EXPECT_VALID(Dart_Invoke(lib, NewString("benchmark"), 0, NULL));
+  timer.Stop();
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+
+// Times scavenges of a freshly built list with FLAG_scavenger_tasks set to
+// 'tasks', so that the scores of the benchmarks below show how the parallel
+// scavenger scales.
+static void RunScavengeBenchmark(Benchmark* benchmark, int tasks) {
+  const char* kScriptChars =
+      "class Node {\n"
+      "  var next;\n"
+      "  var value;\n"
+      "  Node(this.next, this.value);\n"
+      "}\n"
+      "var list;\n"
+      "void build() {\n"
+      "  list = null;\n"
+      "  for (var i = 0; i < 20000; i++) {\n"
+      "    list = new Node(list, new List(i % 4));\n"
+      "  }\n"
+      "}\n";
+  const intptr_t kNumIterations = 20;
+  const int saved_tasks = FLAG_scavenger_tasks;
+  FLAG_scavenger_tasks = tasks;
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Heap* heap = Isolate::Current()->heap();
+  Timer timer(true, "Scavenge benchmark");
+  for (intptr_t i = 0; i < kNumIterations; i++) {
+    // The list built since the previous scavenge is live in new space.
+    EXPECT_VALID(Dart_Invoke(lib, NewString("build"), 0, NULL));
+    timer.Start();
+    heap->CollectGarbage(Heap::kNew);
+    timer.Stop();
+  }
+  FLAG_scavenger_tasks = saved_tasks;
+  benchmark->set_score(timer.TotalElapsedTime());
+}
+
+
+//
+// Measure scavenges of a live list by one to eight scavenger tasks.
+//
+BENCHMARK(ScavengeTasks1) {
+  RunScavengeBenchmark(benchmark, 1);
+}
+
+
+BENCHMARK(ScavengeTasks2) {
+  RunScavengeBenchmark(benchmark, 2);
+}
+
+
+BENCHMARK(ScavengeTasks4) {
+  RunScavengeBenchmark(benchmark, 4);
+}
+
+
+BENCHMARK(ScavengeTasks8) {
+  RunScavengeBenchmark(benchmark, 8);
+}
+
+
+// Runs 'kernel' on typed data of a length that is not a multiple of four so
+// that both the vector loop and the scalar epilogue are exercised.
+static void RunTypedDataKernel(Benchmark* benchmark,
+                               const char* script,
+                               const char* name) {
+  Dart_Handle lib = TestCase::LoadTestScript(script, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("setup"), 0, NULL));
+  // Warm up so that the kernel is optimized before it is measured.
+  EXPECT_VALID(Dart_Invoke(lib, NewString("benchmark"), 0, NULL));
+  Timer timer(true, name);
+  timer.Start();
+  EXPECT_VALID(Dart_Invoke(lib, NewString("benchmark"), 0, NULL));
+  timer.Stop();
+  Dart_Handle result = Dart_Invoke(lib, NewString("check"), 0, NULL);
+  EXPECT_VALID(result);
+  EXPECT(Dart_IsBoolean(result));
+  bool ok = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &ok));
+  EXPECT(ok);
+  benchmark->set_score(timer.TotalElapsedTime());
+}
+
+
+//
+// Measure element-wise addition of Float32Lists.
+//
+BENCHMARK(Float32ListAdd) {
+  const char* kScriptChars =
+      "import 'dart:typed_data';\n"
+      "var a, b, c;\n"
+      "void setup() {\n"
+      "  a = new Float32List(1023);\n"
+      "  b = new Float32List(1023);\n"
+      "  c = new Float32List(1023);\n"
+      "  for (var i = 0; i < a.length; i++) {\n"
+      "    a[i] = i * 0.5;\n"
+      "    b[i] = 1.0 / (i + 1);\n"
+      "  }\n"
+      "}\n"
+      "void add(Float32List a, Float32List b, Float32List c) {\n"
+      "  for (var i = 0; i < c.length; i++) {\n"
+      "    c[i] = a[i] + b[i];\n"
+      "  }\n"
+      "}\n"
+      "void benchmark() {\n"
+      "  for (var j = 0; j < 10000; j++) add(a, b, c);\n"
+      "}\n"
+      "bool check() {\n"
+      "  var expected = new Float32List(1);\n"
+      "  for (var i = 0; i < c.length; i++) {\n"
+      "    expected[0] = a[i] + b[i];\n"
+      "    if (c[i] != expected[0]) return false;\n"
+      "  }\n"
+      "  return true;\n"
+      "}\n";
+  RunTypedDataKernel(benchmark, kScriptChars, "Float32ListAdd benchmark");
+}
+
+
+//
+// Measure scaling a Float32List by a constant.
+//
+BENCHMARK(Float32ListScale) {
+  const char* kScriptChars =
+      "import 'dart:typed_data';\n"
+      "var a, c;\n"
+      "void setup() {\n"
+      "  a = new Float32List(1023);\n"
+      "  c = new Float32List(1023);\n"
+      "  for (var i = 0; i < a.length; i++) a[i] = i / 3;\n"
+      "}\n"
+      "void scale(Float32List a, Float32List c) {\n"
+      "  for (var i = 0; i < c.length; i++) {\n"
+      "    c[i] = a[i] * 0.25;\n"
+      "  }\n"
+      "}\n"
+      "void benchmark() {\n"
+      "  for (var j = 0; j < 10000; j++) scale(a, c);\n"
+      "}\n"
+      "bool check() {\n"
+      "  for (var i = 0; i < c.length; i++) {\n"
+      "    if (c[i] != a[i] * 0.25) return false;\n"
+      "  }\n"
+      "  return true;\n"
+      "}\n";
+  RunTypedDataKernel(benchmark, kScriptChars, "Float32ListScale benchmark");
+}
+
+
+//
+// Measure element-wise addition of Int32Lists, which wraps around.
+//
+BENCHMARK(Int32ListAdd) {
+  const char* kScriptChars =
+      "import 'dart:typed_data';\n"
+      "var a, b, c;\n"
+      "void setup() {\n"
+      "  a = new Int32List(1023);\n"
+      "  b = new Int32List(1023);\n"
+      "  c = new Int32List(1023);\n"
+      "  for (var i = 0; i < a.length; i++) {\n"
+      "    a[i] = 0x7FFFFFF0 + i;\n"
+      "    b[i] = i * 7;\n"
+      "  }\n"
+      "}\n"
+      "void add(Int32List a, Int32List b, Int32List c) {\n"
+      "  for (var i = 0; i < c.length; i++) {\n"
+      "    c[i] = a[i] + b[i];\n"
+      "  }\n"
+      "}\n"
+      "void benchmark() {\n"
+      "  for (var j = 0; j < 10000; j++) add(a, b, c);\n"
+      "}\n"
+      "bool check() {\n"
+      "  for (var i = 0; i < c.length; i++) {\n"
+      "    var sum = (a[i] + b[i]) & 0xFFFFFFFF;\n"
+      "    if (sum >= 0x80000000) sum -= 0x100000000;\n"
+      "    if (c[i] != sum) return false;\n"
+      "  }\n"
+      "  return true;\n"
+      "}\n";
+  RunTypedDataKernel(benchmark, kScriptChars, "Int32ListAdd benchmark");
+}
+
+
+//
+// Count the moves from and to stack slots that the register allocator inserts
+// into the loops of optimized numeric kernels with values live across them.
+//
+BENCHMARK(NumericKernelStackMoves) {
+  const char* kScriptChars =
+      "import 'dart:typed_data';\n"
+      "matmul(Float64List a, Float64List b, Float64List c, int n) {\n"
+      "  for (var i = 0; i < n; i++) {\n"
+      "    for (var j = 0; j < n; j++) {\n"
+      "      var sum = 0.0;\n"
+      "      for (var k = 0; k < n; k++) sum += a[i * n + k] * b[k * n + j];\n"
+      "      c[i * n + j] = sum;\n"
+      "    }\n"
+      "  }\n"
+      "}\n"
+      "moments(Float64List a) {\n"
+      "  var s1 = 0.0, s2 = 0.0, s3 = 0.0, s4 = 0.0;\n"
+      "  var min = a[0], max = a[0];\n"
+      "  for (var i = 0; i < a.length; i++) {\n"
+      "    var x = a[i];\n"
+      "    s1 += x; s2 += x * x; s3 += x * x * x; s4 += x * x * x * x;\n"
+      "    if (x < min) min = x;\n"
+      "    if (x > max) max = x;\n"
+      "  }\n"
+      "  return s1 + s2 + s3 + s4 + min + max;\n"
+      "}\n"
+      "horner(Float64List coefficients, Float64List xs, Float64List ys) {\n"
+      "  var scale = coefficients.length * 0.5;\n"
+      "  var offset = xs.length * 0.25;\n"
+      "  for (var i = 0; i < xs.length; i++) {\n"
+      "    var y = 0.0;\n"
+      "    for (var j = coefficients.length - 1; j >= 0; j--) {\n"
+      "      y = y * xs[i] + coefficients[j];\n"
+      "    }\n"
+      "    ys[i] = y;\n"
+      "  }\n"
+      "  return scale + offset;\n"
+      "}\n"
+      "filter(Float64List xs, Float64List ys) {\n"
+      "  var lo = xs[0], hi = xs[1], mid = (lo + hi) * 0.5;\n"
+      "  var span = hi - lo, inv = 1.0 / (span + 1.0);\n"
+      "  for (var i = 0; i < xs.length; i++) {\n"
+      "    var x = xs[i];\n"
+      "    var x2 = x * x, x3 = x2 * x, x4 = x3 * x, x5 = x4 * x;\n"
+      "    var y = 1.0 + 0.5 * x + 0.25 * x2 + 0.125 * x3 + 0.0625 * x4;\n"
+      "    var z = x5 * 0.03125 - x4 * 0.0625 + x3 * 0.125 - x2 * 0.25;\n"
+      "    var w = (x + x2) * (x3 + x4) * (x5 + y) * (z + 1.0);\n"
+      "    ys[i] = y + z + w + x * x2 * x3 * x4 * x5;\n"
+      "  }\n"
+      "  return lo + hi + mid + span + inv;\n"
+      "}\n"
+      "benchmark() {\n"
+      "  var n = 16;\n"
+      "  var a = new Float64List(n * n);\n"
+      "  var b = new Float64List(n * n);\n"
+      "  var c = new Float64List(n * n);\n"
+      "  for (var i = 0; i < n * n; i++) {\n"
+      "    a[i] = i * 0.5;\n"
+      "    b[i] = 1.0 / (i + 1);\n"
+      "  }\n"
+      "  var coefficients = new Float64List(8);\n"
+      "  for (var i = 0; i < 8; i++) coefficients[i] = 1.0 / (i + 1);\n"
+      "  var ys = new Float64List(a.length);\n"
+      "  var result = 0.0;\n"
+      "  for (var k = 0; k < 200; k++) {\n"
+      "    matmul(a, b, c, n);\n"
+      "    result += moments(c);\n"
+      "    result += horner(coefficients, a, ys);\n"
+      "    result += filter(a, ys);\n"
+      "  }\n"
+      "  return result;\n"
+      "}\n";
+  const bool saved_compiler_stats = FLAG_compiler_stats;
+  FLAG_compiler_stats = true;
+  const intptr_t stack_moves_before = CompilerStats::num_loop_stack_moves;
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("benchmark"), 0, NULL));
+  benchmark->set_score(
+      CompilerStats::num_loop_stack_moves - stack_moves_before);
+  FLAG_compiler_stats = saved_compiler_stats;
+}
+
+
 static uint8_t* malloc_allocator(
     uint8_t* ptr, intptr_t old_size, intptr_t new_size) {
   return reinterpret_cast<uint8_t*>(realloc(ptr, new_size));
@@ -6,10 +6,15 @@
 
 #include "vm/allocation.h"
 #include "vm/code_patcher.h"
+#include "vm/flags.h"
 #include "vm/flow_graph.h"
 
 namespace dart {
 
+DEFINE_FLAG(bool, move_cold_blocks, true,
+    "Move blocks never executed by unoptimized code to the end of the "
+    "function.");
+
 // Compute the edge count at the deopt id of a TargetEntry or Goto.
 static intptr_t ComputeEdgeCount(const Code& unoptimized_code,
                                  intptr_t deopt_id) {
@@ -141,6 +146,58 @@ static void Union(GrowableArray<Chain*>* chains,
 }
 
 
+// A target block is cold if its edge was never taken while the other
+// successor of the same branch was.
+static bool IsColdTarget(TargetEntryInstr* target) {
+  if (target->edge_weight() != 0.0) return false;
+  BranchInstr* branch =
+      target->PredecessorAt(0)->last_instruction()->AsBranch();
+  if (branch == NULL) return false;
+  TargetEntryInstr* other = (branch->true_successor() == target)
+      ? branch->false_successor()
+      : branch->true_successor();
+  return other->edge_weight() > 0.0;
+}
+
+
+// Compute the set of blocks that were never executed by unoptimized code:
+// cold targets and blocks only reachable through cold blocks. Loop headers
+// are conservatively treated as hot because their back edges are not yet
+// visited.
+static void ComputeColdBlocks(FlowGraph* flow_graph,
+                              GrowableArray<bool>* is_cold) {
+  for (intptr_t i = 0; i < flow_graph->postorder().length(); ++i) {
+    is_cold->Add(false);
+  }
+  GrowableArray<bool> visited(flow_graph->postorder().length());
+  for (intptr_t i = 0; i < flow_graph->postorder().length(); ++i) {
+    visited.Add(false);
+  }
+
+  for (BlockIterator it = flow_graph->reverse_postorder_iterator();
+       !it.Done();
+       it.Advance()) {
+    BlockEntryInstr* block = it.Current();
+    bool cold = false;
+    if (block->IsTargetEntry() &&
+        (block != flow_graph->graph_entry()->normal_entry())) {
+      BlockEntryInstr* pred = block->PredecessorAt(0);
+      cold = (*is_cold)[pred->postorder_number()] ||
+          IsColdTarget(block->AsTargetEntry());
+    } else if (block->IsJoinEntry()) {
+      cold = true;
+      for (intptr_t i = 0; cold && (i < block->PredecessorCount()); ++i) {
+        BlockEntryInstr* pred = block->PredecessorAt(i);
+        cold = visited[pred->postorder_number()] &&
+            (*is_cold)[pred->postorder_number()];
+      }
+    }
+    (*is_cold)[block->postorder_number()] = cold;
+    visited[block->postorder_number()] = true;
+  }
+}
+
+
 void BlockScheduler::ReorderBlocks() const {
   // Add every block to a chain of length 1 and compute a list of edges
   // sorted by weight.
@@ -191,13 +248,39 @@ void BlockScheduler::ReorderBlocks() const {
     Union(&chains, source_chain, target_chain);
   }
 
+  // Chains consisting only of blocks that were never executed by the
+  // unoptimized code are emitted after all other chains, so that they do not
+  // separate the hot blocks.  Without profile information all blocks are
+  // considered hot.
+  GrowableArray<bool> is_cold(block_count);
+  if (FLAG_move_cold_blocks &&
+      (flow_graph()->graph_entry()->entry_count() > 0)) {
+    ComputeColdBlocks(flow_graph(), &is_cold);
+  } else {
+    for (intptr_t i = 0; i < block_count; ++i) is_cold.Add(false);
+  }
+  GrowableArray<bool> is_cold_chain(block_count);
+  for (intptr_t i = 0; i < block_count; ++i) {
+    bool cold = true;
+    for (Link* link = chains[i]->first;
+         cold && (link != NULL);
+         link = link->next) {
+      cold = is_cold[link->block->postorder_number()];
+    }
+    is_cold_chain.Add(cold);
+  }
+
   // Build a new block order.  Emit each chain when its first block occurs
   // in the original reverse postorder ordering (which gives a topological
-  // sort of the blocks).
-  for (intptr_t i = block_count - 1; i >= 0; --i) {
-    if (chains[i]->first->block == flow_graph()->postorder()[i]) {
-      for (Link* link = chains[i]->first; link != NULL; link = link->next) {
-        flow_graph()->CodegenBlockOrder(true)->Add(link->block);
+  // sort of the blocks).  Hot chains are emitted first.
+  for (intptr_t pass = 0; pass < 2; ++pass) {
+    const bool emit_cold = (pass == 1);
+    for (intptr_t i = block_count - 1; i >= 0; --i) {
+      if ((chains[i]->first->block == flow_graph()->postorder()[i]) &&
+          (is_cold_chain[i] == emit_cold)) {
+        for (Link* link = chains[i]->first; link != NULL; link = link->next) {
+          flow_graph()->CodegenBlockOrder(true)->Add(link->block);
+        }
       }
     }
   }
@@ -0,0 +1,107 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/block_scheduler.h"
+
+#include "platform/assert.h"
+#include "vm/dart_api_impl.h"
+#include "vm/flow_graph.h"
+#include "vm/flow_graph_builder.h"
+#include "vm/intermediate_language.h"
+#include "vm/parser.h"
+#include "vm/symbols.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+DECLARE_FLAG(bool, move_cold_blocks);
+
+// Builds the graph of the already executed function 'name' and lays out its
+// blocks using the edge counts of its unoptimized code.
+static FlowGraph* BuildReorderedGraph(Dart_Handle lib, const char* name) {
+  Library& library = Library::Handle();
+  library ^= Api::UnwrapHandle(lib);
+  const Function& function = Function::ZoneHandle(
+      library.LookupLocalFunction(String::Handle(Symbols::New(name))));
+  EXPECT(!function.IsNull());
+  EXPECT(function.HasCode());
+  ParsedFunction* parsed_function = new ParsedFunction(function);
+  Parser::ParseFunction(parsed_function);
+  parsed_function->AllocateVariables();
+  const Code& unoptimized_code = Code::Handle(function.unoptimized_code());
+  const Array& ic_data_array =
+      Array::Handle(unoptimized_code.ExtractTypeFeedbackArray());
+  // The deopt ids of the graph have to match the unoptimized code.
+  Isolate::Current()->set_deopt_id(0);
+  FlowGraphBuilder builder(parsed_function,
+                           ic_data_array,
+                           NULL,  // NULL = not inlining.
+                           Isolate::kNoDeoptId);
+  FlowGraph* flow_graph = builder.BuildGraph();
+  BlockScheduler block_scheduler(flow_graph);
+  block_scheduler.AssignEdgeWeights();
+  block_scheduler.ReorderBlocks();
+  return flow_graph;
+}
+
+
+// Position of the block ending in the return in the code generation order.
+static intptr_t ReturnPosition(FlowGraph* flow_graph) {
+  GrowableArray<BlockEntryInstr*>* order = flow_graph->CodegenBlockOrder(true);
+  for (intptr_t i = 0; i < order->length(); ++i) {
+    if ((*order)[i]->last_instruction()->IsReturn()) return i;
+  }
+  return -1;
+}
+
+
+// Position of the first branch target that was never executed in the code
+// generation order.
+static intptr_t ColdTargetPosition(FlowGraph* flow_graph) {
+  GrowableArray<BlockEntryInstr*>* order = flow_graph->CodegenBlockOrder(true);
+  for (intptr_t i = 0; i < order->length(); ++i) {
+    TargetEntryInstr* target = (*order)[i]->AsTargetEntry();
+    if ((target != NULL) && (target->edge_weight() == 0.0)) return i;
+  }
+  return -1;
+}
+
+
+TEST_CASE(BlockScheduler_MoveColdBlocks) {
+  const char* kScriptChars =
+      "foo(x) {\n"
+      "  var r = x;\n"
+      "  if (x < 0) {\n"
+      "    r = -x;\n"
+      "  }\n"
+      "  if (x.isEven) {\n"
+      "    r = r + 1;\n"
+      "  } else {\n"
+      "    r = r - 1;\n"
+      "  }\n"
+      "  return r;\n"
+      "}\n"
+      "main() {\n"
+      "  for (var i = 0; i < 10; i++) foo(i);\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("main"), 0, NULL));
+  const bool saved_move_cold_blocks = FLAG_move_cold_blocks;
+  // The never taken 'x < 0' branch ends up between the two halves of the
+  // 'x.isEven' diamond, which form separate chains.
+  FLAG_move_cold_blocks = false;
+  FlowGraph* flow_graph = BuildReorderedGraph(lib, "foo");
+  intptr_t cold = ColdTargetPosition(flow_graph);
+  EXPECT_LT(0, cold);
+  EXPECT_LT(cold, ReturnPosition(flow_graph));
+  // Moving cold blocks puts it after the return instead.
+  FLAG_move_cold_blocks = true;
+  flow_graph = BuildReorderedGraph(lib, "foo");
+  cold = ColdTargetPosition(flow_graph);
+  EXPECT_LT(ReturnPosition(flow_graph), cold);
+  EXPECT_EQ(flow_graph->CodegenBlockOrder(true)->length() - 1, cold);
+  FLAG_move_cold_blocks = saved_move_cold_blocks;
+}
+
+}  // namespace dart
@@ -6,6 +6,7 @@
 
 #include "vm/code_generator.h"
 #include "vm/flags.h"
+#include "vm/flow_graph_compiler.h"
 #include "vm/heap.h"
 #include "vm/isolate.h"
 #include "vm/longjump.h"
@@ -2076,6 +2077,12 @@ void ClassFinalizer::FinalizeClass(const Class& cls) {
   if (FLAG_use_cha) {
     RemoveOptimizedCode(added_subclass_to_cids);
   }
+  if (FlowGraphCompiler::SupportsMegamorphicDispatchTable() &&
+      !cls.is_abstract() && !cls.IsTopLevel() && !cls.IsSignatureClass()) {
+    // Inherited methods that are already compiled can be called on the new
+    // class from megamorphic call sites without missing first.
+    Isolate::Current()->megamorphic_cache_table()->InsertClassTargets(cls);
+  }
 }
 
 
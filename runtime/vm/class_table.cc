@@ -12,9 +12,16 @@
 namespace dart {
 
 DEFINE_FLAG(bool, print_class_table, false, "Print initial class table.");
+DEFINE_FLAG(bool, pretenure, false,
+    "Allocate instances of classes that mostly survive scavenges in old space "
+    "from optimized code.");
+DEFINE_FLAG(int, pretenure_survival_ratio, 80,
+    "Percentage of the new space allocation of a class that has to survive "
+    "scavenges for its instances to be pretenured.");
+DEFINE_FLAG(bool, trace_pretenuring, false, "Trace pretenuring decisions.");
 
 ClassTable::ClassTable()
-    : top_(kNumPredefinedCids), capacity_(0), table_(NULL) {
+    : top_(kNumPredefinedCids), capacity_(0), table_(NULL), feedback_(NULL) {
   if (Dart::vm_isolate() == NULL) {
     capacity_ = initial_capacity_;
     table_ = reinterpret_cast<RawClass**>(
@@ -32,11 +39,14 @@ ClassTable::ClassTable()
     table_[kDynamicCid] = vm_class_table->At(kDynamicCid);
     table_[kVoidCid] = vm_class_table->At(kVoidCid);
   }
+  feedback_ = reinterpret_cast<AllocationFeedback*>(
+      calloc(capacity_, sizeof(AllocationFeedback)));  // NOLINT
 }
 
 
 ClassTable::~ClassTable() {
   free(table_);
+  free(feedback_);
 }
 
 
@@ -65,8 +75,14 @@ void ClassTable::Register(const Class& cls) {
       for (intptr_t i = capacity_; i < new_capacity; i++) {
         new_table[i] = NULL;
       }
+      AllocationFeedback* new_feedback = reinterpret_cast<AllocationFeedback*>(
+          realloc(feedback_,
+                  new_capacity * sizeof(AllocationFeedback)));  // NOLINT
+      memset(&new_feedback[capacity_], 0,
+             (new_capacity - capacity_) * sizeof(AllocationFeedback));
       capacity_ = new_capacity;
       table_ = new_table;
+      feedback_ = new_feedback;
     }
     ASSERT(top_ < capacity_);
     cls.set_id(top_);
@@ -82,6 +98,54 @@ void ClassTable::VisitObjectPointers(ObjectPointerVisitor* visitor) {
 }
 
 
+bool ClassTable::UpdatePretenuring() {
+  bool withdrawn = false;
+  for (intptr_t i = 1; i < top_; i++) {
+    AllocationFeedback* feedback = &feedback_[i];
+    if (feedback->allocated_in_words < kPretenureSampleSizeInWords) {
+      continue;
+    }
+    const intptr_t survival_ratio =
+        (feedback->survived_in_words * 100) / feedback->allocated_in_words;
+    feedback->allocated_in_words = 0;
+    feedback->survived_in_words = 0;
+    // Withdraw a decision only once the survival rate dropped well below the
+    // threshold, so that classes do not flip between the two spaces.
+    if (!feedback->pretenure &&
+        (survival_ratio >= FLAG_pretenure_survival_ratio)) {
+      feedback->pretenure = true;
+    } else if (feedback->pretenure &&
+               (survival_ratio < (FLAG_pretenure_survival_ratio / 2))) {
+      feedback->pretenure = false;
+      feedback->withdrawn = true;
+      withdrawn = true;
+    } else {
+      continue;
+    }
+    if (FLAG_trace_pretenuring) {
+      OS::Print("%s pretenuring of class id %" Pd " (survival %" Pd "%%)\n",
+                feedback->pretenure ? "Starting" : "Stopping",
+                i, survival_ratio);
+    }
+  }
+  return withdrawn;
+}
+
+
+void ClassTable::DeoptimizeWithdrawnPretenuring() {
+  Class& cls = Class::Handle();
+  for (intptr_t i = 1; i < top_; i++) {
+    if (feedback_[i].withdrawn) {
+      feedback_[i].withdrawn = false;
+      if (HasValidClassAt(i)) {
+        cls = At(i);
+        cls.DeoptimizeDependentCode();
+      }
+    }
+  }
+}
+
+
 void ClassTable::Print() {
   Class& cls = Class::Handle();
   String& name = String::Handle();
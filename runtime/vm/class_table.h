@@ -40,6 +40,29 @@ class ClassTable {
 
   void VisitObjectPointers(ObjectPointerVisitor* visitor);
 
+  // Records an instance of class 'cid' allocated in new space since the
+  // previous scavenge, and whether it survived the current scavenge.
+  void RecordAllocation(intptr_t cid, intptr_t size, bool survived) {
+    ASSERT(IsValidIndex(cid));
+    AllocationFeedback* feedback = &feedback_[cid];
+    feedback->allocated_in_words += (size >> kWordSizeLog2);
+    if (survived) {
+      feedback->survived_in_words += (size >> kWordSizeLog2);
+    }
+  }
+
+  // Updates the pretenuring decisions from the recorded survival rates.
+  // Returns true if the decision was withdrawn for a class, in which case its
+  // dependent code needs to be deoptimized by DeoptimizeWithdrawnPretenuring.
+  bool UpdatePretenuring();
+  void DeoptimizeWithdrawnPretenuring();
+
+  // Whether instances of class 'cid' should be allocated in old space.
+  bool ShouldPretenure(intptr_t cid) const {
+    ASSERT(IsValidIndex(cid));
+    return feedback_[cid].pretenure;
+  }
+
   void Print();
 
   void PrintToJSONStream(JSONStream* stream);
@@ -52,10 +75,21 @@ class ClassTable {
   static const int initial_capacity_ = 512;
   static const int capacity_increment_ = 256;
 
+  // Minimum amount of allocation a survival rate is computed from.
+  static const intptr_t kPretenureSampleSizeInWords = 64 * KBInWords;
+
+  struct AllocationFeedback {
+    intptr_t allocated_in_words;
+    intptr_t survived_in_words;
+    bool pretenure;
+    bool withdrawn;
+  };
+
   intptr_t top_;
   intptr_t capacity_;
 
   RawClass** table_;
+  AllocationFeedback* feedback_;
 
   DISALLOW_COPY_AND_ASSIGN(ClassTable);
 };
@@ -14,6 +14,7 @@
 #include "vm/debugger.h"
 #include "vm/deopt_instructions.h"
 #include "vm/exceptions.h"
+#include "vm/flow_graph_compiler.h"
 #include "vm/intermediate_language.h"
 #include "vm/object_store.h"
 #include "vm/message.h"
@@ -27,6 +28,9 @@
 
 namespace dart {
 
+DEFINE_FLAG(int, baseline_optimization_counter_threshold, -1,
+    "Function's usage-counter value before it is compiled by the baseline "
+    "optimizing tier, -1 means never");
 DEFINE_FLAG(bool, deoptimize_alot, false,
     "Deoptimizes all live frames when we are about to return to Dart code from"
     " native entries.");
@@ -52,6 +56,7 @@ DEFINE_FLAG(bool, trace_optimized_ic_calls, false,
 DEFINE_FLAG(bool, trace_patching, false, "Trace patching of code.");
 DEFINE_FLAG(bool, trace_runtime_calls, false, "Trace runtime calls");
 
+DECLARE_FLAG(bool, deferred_optimization);
 DECLARE_FLAG(int, deoptimization_counter_threshold);
 DECLARE_FLAG(bool, enable_type_checks);
 DECLARE_FLAG(bool, report_usage_count);
@@ -145,6 +150,21 @@ DEFINE_RUNTIME_ENTRY(AllocateObject, 3) {
 }
 
 
+// Allocate a new object of a pretenured class in old space.
+// Arg0: class of the object that needs to be allocated.
+// Arg1: type arguments of the object, always null.
+// Arg2: kNoInstantiator.
+// Return value: newly allocated object.
+DEFINE_RUNTIME_ENTRY(AllocateObjectOld, 3) {
+  const Class& cls = Class::CheckedHandle(arguments.ArgAt(0));
+  // Only instances without type arguments are pretenured.
+  ASSERT(cls.NumTypeArguments() == 0);
+  const Instance& instance =
+      Instance::Handle(Instance::New(cls, Heap::kOld));
+  arguments.SetReturn(instance);
+}
+
+
 // Helper returning the token position of the Dart caller.
 static intptr_t GetCallerLocation() {
   DartFrameIterator iterator;
@@ -1032,6 +1052,11 @@ DEFINE_RUNTIME_ENTRY(MegamorphicCacheMissHandler, 3) {
   cache.EnsureCapacity();
   const Smi& class_id = Smi::Handle(Smi::New(cls.id()));
   cache.Insert(class_id, target);
+  if (FlowGraphCompiler::SupportsMegamorphicDispatchTable()) {
+    isolate->megamorphic_cache_table()->InsertDispatchTarget(cache,
+                                                             class_id,
+                                                             target);
+  }
   return;
 }
 
@@ -1313,6 +1338,9 @@ DEFINE_RUNTIME_ENTRY(StackOverflow, 0) {
     }
     isolate->heap()->CollectGarbage(Heap::kNew);
   }
+  if (interrupt_bits & Isolate::kPretenureInterrupt) {
+    isolate->class_table()->DeoptimizeWithdrawnPretenuring();
+  }
   if (interrupt_bits & Isolate::kMessageInterrupt) {
     isolate->message_handler()->HandleOOBMessages();
   }
@@ -1412,6 +1440,13 @@ DEFINE_RUNTIME_ENTRY(OptimizeInvokedFunction, 1) {
   ASSERT(function.HasCode());
 
   if (CanOptimizeFunction(function, isolate)) {
+    if (FLAG_deferred_optimization && Compiler::QueueOptimization(function)) {
+      // Keep running unoptimized code until idle time. If the function gets
+      // hot again before then, it is optimized at that invocation.
+      function.set_usage_counter(0);
+      arguments.SetReturn(Code::Handle(function.CurrentCode()));
+      return;
+    }
     const Error& error =
         Error::Handle(Compiler::CompileOptimizedFunction(function));
     if (!error.IsNull()) {
@@ -1419,8 +1454,11 @@ DEFINE_RUNTIME_ENTRY(OptimizeInvokedFunction, 1) {
     }
     const Code& optimized_code = Code::Handle(function.CurrentCode());
     ASSERT(!optimized_code.IsNull());
-    // Reset usage counter for reoptimization.
-    function.set_usage_counter(0);
+    // Baseline code keeps counting towards full optimization; everything else
+    // resets the usage counter for reoptimization.
+    if (!optimized_code.is_baseline()) {
+      function.set_usage_counter(0);
+    }
   }
   arguments.SetReturn(Code::Handle(function.CurrentCode()));
 }
@@ -1606,6 +1644,7 @@ DEFINE_LEAF_RUNTIME_ENTRY(intptr_t, DeoptimizeCopyFrame,
                        DeoptContext::kDestIsOriginalFrame,
                        fpu_registers, cpu_registers);
   isolate->set_deopt_context(deopt_context);
+  isolate->deopt_reason_counts()[deopt_context->deopt_reason()]++;
 
   // Stack size (FP - SP) in bytes.
   return deopt_context->DestStackAdjustment() * kWordSize;
@@ -50,11 +50,18 @@ DEFINE_FLAG(int, deoptimization_counter_threshold, 16,
     "How many times we allow deoptimization before we disallow optimization.");
 DEFINE_FLAG(int, deoptimization_counter_licm_threshold, 8,
     "How many times we allow deoptimization before we disable LICM.");
+DEFINE_FLAG(bool, loop_vectorization, true,
+    "Vectorize element-wise loops over typed data.");
 DEFINE_FLAG(bool, use_inlining, true, "Enable call-site inlining");
 DEFINE_FLAG(bool, range_analysis, true, "Enable range analysis");
 DEFINE_FLAG(bool, reorder_basic_blocks, true, "Enable basic-block reordering.");
+DEFINE_FLAG(bool, deferred_optimization, false,
+    "Queue hot functions and optimize them when the embedder reports idle "
+    "time instead of at the invocation that made them hot.");
 DEFINE_FLAG(bool, verify_compiler, false,
     "Enable compiler verification assertions");
+DECLARE_FLAG(int, baseline_optimization_counter_threshold);
+DECLARE_FLAG(int, optimization_counter_threshold);
 DECLARE_FLAG(bool, print_flow_graph);
 DECLARE_FLAG(bool, print_flow_graph_optimized);
 DECLARE_FLAG(bool, trace_failed_optimization_attempts);
@@ -258,10 +265,25 @@ static void InstallUnoptimizedCode(const Function& function) {
 }
 
 
+// Returns true if the function should be optimized by the baseline tier: it
+// is hot enough to leave unoptimized code but has not yet reached the full
+// optimization threshold. OSR always uses the full tier.
+static bool UseBaselineTier(const Function& function, intptr_t osr_id) {
+  return (FLAG_baseline_optimization_counter_threshold >= 0) &&
+         (osr_id == Isolate::kNoDeoptId) &&
+         !function.HasOptimizedCode() &&
+         (function.usage_counter() < FLAG_optimization_counter_threshold);
+}
+
+
 // Return false if bailed out.
+// Baseline compilation runs only the cheap optimization passes: no inlining,
+// CSE, LICM, vectorization, range analysis or allocation sinking.
 static bool CompileParsedFunctionHelper(ParsedFunction* parsed_function,
                                         bool optimized,
+                                        bool baseline,
                                         intptr_t osr_id) {
+  ASSERT(optimized || !baseline);
   const Function& function = parsed_function->function();
   if (optimized && !function.is_optimizable()) {
     return false;
@@ -312,6 +334,7 @@ static bool CompileParsedFunctionHelper(ParsedFunction* parsed_function,
                                  NULL,  // NULL = not inlining.
                                  osr_id);
         flow_graph = builder.BuildGraph();
+        flow_graph->set_is_baseline(baseline);
       }
 
       if (FLAG_print_flow_graph ||
@@ -362,7 +385,7 @@ static bool CompileParsedFunctionHelper(ParsedFunction* parsed_function,
         DEBUG_ASSERT(flow_graph->VerifyUseLists());
 
         // Inlining (mutates the flow graph)
-        if (FLAG_use_inlining) {
+        if (FLAG_use_inlining && !baseline) {
           TimerScope timer(FLAG_compiler_stats,
                            &CompilerStats::graphinliner_timer);
           // Propagate types to create more inlining opportunities.
@@ -425,12 +448,13 @@ static bool CompileParsedFunctionHelper(ParsedFunction* parsed_function,
         optimizer.SelectRepresentations();
         DEBUG_ASSERT(flow_graph->VerifyUseLists());
 
-        if (FLAG_common_subexpression_elimination ||
-            FLAG_loop_invariant_code_motion) {
+        if (!baseline &&
+            (FLAG_common_subexpression_elimination ||
+             FLAG_loop_invariant_code_motion)) {
           flow_graph->ComputeBlockEffects();
         }
 
-        if (FLAG_common_subexpression_elimination) {
+        if (FLAG_common_subexpression_elimination && !baseline) {
           if (DominatorBasedCSE::Optimize(flow_graph)) {
             DEBUG_ASSERT(flow_graph->VerifyUseLists());
             // Do another round of CSE to take secondary effects into account:
@@ -440,7 +464,7 @@ static bool CompileParsedFunctionHelper(ParsedFunction* parsed_function,
             DEBUG_ASSERT(flow_graph->VerifyUseLists());
           }
         }
-        if (FLAG_loop_invariant_code_motion &&
+        if (FLAG_loop_invariant_code_motion && !baseline &&
             (function.deoptimization_counter() <
              FLAG_deoptimization_counter_licm_threshold)) {
           LICM licm(flow_graph);
@@ -449,7 +473,15 @@ static bool CompileParsedFunctionHelper(ParsedFunction* parsed_function,
         }
         flow_graph->RemoveRedefinitions();
 
-        if (FLAG_range_analysis) {
+        if (FLAG_loop_vectorization && !baseline) {
+          // Runs after LICM so that array lengths and constant operands of
+          // the loop body are already hoisted into the pre-header.
+          LoopVectorizer vectorizer(flow_graph);
+          vectorizer.Optimize();
+          DEBUG_ASSERT(flow_graph->VerifyUseLists());
+        }
+
+        if (FLAG_range_analysis && !baseline) {
           // Propagate types after store-load-forwarding. Some phis may have
           // become smi phis that can be processed by range analysis.
           FlowGraphTypePropagator::Propagate(flow_graph);
@@ -462,7 +494,7 @@ static bool CompileParsedFunctionHelper(ParsedFunction* parsed_function,
           DEBUG_ASSERT(flow_graph->VerifyUseLists());
         }
 
-        if (FLAG_constant_propagation) {
+        if (FLAG_constant_propagation && !baseline) {
           // Constant propagation can use information from range analysis to
           // find unreachable branch targets.
           ConstantPropagator::OptimizeBranches(flow_graph);
@@ -485,13 +517,16 @@ static bool CompileParsedFunctionHelper(ParsedFunction* parsed_function,
         // Attempt to sink allocations of temporary non-escaping objects to
         // the deoptimization path.
         AllocationSinking* sinking = NULL;
-        if (FLAG_allocation_sinking &&
+        if (FLAG_allocation_sinking && !baseline &&
             (flow_graph->graph_entry()->SuccessorCount()  == 1)) {
           // TODO(fschneider): Support allocation sinking with try-catch.
           sinking = new AllocationSinking(flow_graph);
           sinking->Optimize();
         }
 
+        // Allocate the remaining objects of long-lived classes in old space.
+        optimizer.PretenureAllocations();
+
         // Ensure that all phis inserted by optimization passes have consistent
         // representations.
         optimizer.SelectRepresentations();
@@ -539,6 +574,7 @@ static bool CompileParsedFunctionHelper(ParsedFunction* parsed_function,
         const Code& code = Code::Handle(
             Code::FinalizeCode(function, &assembler, optimized));
         code.set_is_optimized(optimized);
+        code.set_is_baseline(baseline);
         graph_compiler.FinalizePcDescriptors(code);
         graph_compiler.FinalizeDeoptInfo(code);
         graph_compiler.FinalizeStackmaps(code);
@@ -563,6 +599,12 @@ static bool CompileParsedFunctionHelper(ParsedFunction* parsed_function,
             const Field* field = (*flow_graph->guarded_fields())[i];
             field->RegisterDependentCode(code);
           }
+          for (intptr_t i = 0;
+               i < flow_graph->pretenured_classes()->length();
+               i++) {
+            const Class* cls = (*flow_graph->pretenured_classes())[i];
+            cls->RegisterDependentCode(code);
+          }
         } else {
           function.set_unoptimized_code(code);
           function.SetCode(code);
@@ -752,10 +794,13 @@ static RawError* CompileFunctionHelper(const Function& function,
     per_compile_timer.Start();
     ParsedFunction* parsed_function =
         new ParsedFunction(Function::ZoneHandle(function.raw()));
+    const bool baseline = optimized && UseBaselineTier(function, osr_id);
     if (FLAG_trace_compiler) {
-      OS::Print("Compiling %s%sfunction: '%s' @ token %" Pd ", size %" Pd "\n",
+      OS::Print("Compiling %s%s%sfunction: '%s' @ token %" Pd
+                ", size %" Pd "\n",
                 (osr_id == Isolate::kNoDeoptId ? "" : "osr "),
                 (optimized ? "optimized " : ""),
+                (baseline ? "baseline " : ""),
                 function.ToFullyQualifiedCString(),
                 function.token_pos(),
                 (function.end_token_pos() - function.token_pos()));
@@ -767,7 +812,10 @@ static RawError* CompileFunctionHelper(const Function& function,
     }
 
     const bool success =
-        CompileParsedFunctionHelper(parsed_function, optimized, osr_id);
+        CompileParsedFunctionHelper(parsed_function,
+                                    optimized,
+                                    baseline,
+                                    osr_id);
     if (optimized && !success) {
       // Optimizer bailed out. Disable optimizations and to never try again.
       if (FLAG_trace_compiler) {
@@ -829,6 +877,74 @@ RawError* Compiler::CompileOptimizedFunction(const Function& function,
 }
 
 
+// Upper bound on the number of functions waiting for idle time. Beyond this
+// the mutator optimizes synchronously so that hot code is not starved when
+// the embedder rarely reports idle time.
+static const intptr_t kMaxQueuedFunctions = 64;
+
+
+bool Compiler::QueueOptimization(const Function& function) {
+  ASSERT(FLAG_deferred_optimization);
+  Isolate* isolate = Isolate::Current();
+  const GrowableObjectArray& queue = GrowableObjectArray::Handle(
+      isolate, isolate->object_store()->optimization_queue());
+  for (intptr_t i = 0; i < queue.Length(); i++) {
+    if (queue.At(i) == function.raw()) {
+      // Hot again before idle time came around: optimize it now. The last
+      // request takes its slot, so that only live requests count towards
+      // kMaxQueuedFunctions.
+      const Object& last = Object::Handle(isolate, queue.RemoveLast());
+      if (i < queue.Length()) {
+        queue.SetAt(i, last);
+      }
+      return false;
+    }
+  }
+  if (queue.Length() >= kMaxQueuedFunctions) {
+    return false;
+  }
+  if (FLAG_trace_compiler) {
+    OS::Print("--> queueing optimization of '%s'\n",
+              function.ToFullyQualifiedCString());
+  }
+  queue.Add(function);
+  return true;
+}
+
+
+void Compiler::OptimizeQueuedFunctions(int64_t deadline) {
+  Isolate* isolate = Isolate::Current();
+  const GrowableObjectArray& queue = GrowableObjectArray::Handle(
+      isolate, isolate->object_store()->optimization_queue());
+  Function& function = Function::Handle(isolate);
+  Error& error = Error::Handle(isolate);
+  while ((queue.Length() > 0) && (OS::GetCurrentTimeMicros() < deadline)) {
+    function ^= queue.RemoveLast();
+    if (!function.HasCode() ||
+        (function.HasOptimizedCode() &&
+            !Code::Handle(isolate, function.CurrentCode()).is_baseline()) ||
+        !function.is_optimizable() ||
+        (function.deoptimization_counter() >=
+            FLAG_deoptimization_counter_threshold)) {
+      continue;
+    }
+    error = CompileOptimizedFunction(function);
+    if (!error.IsNull()) {
+      if (FLAG_trace_compiler) {
+        OS::Print("--> deferred optimization of '%s' failed: %s\n",
+                  function.ToFullyQualifiedCString(), error.ToErrorCString());
+      }
+      continue;
+    }
+    // Reset usage counter for reoptimization unless baseline code was
+    // installed, which keeps counting towards full optimization.
+    if (!Code::Handle(isolate, function.CurrentCode()).is_baseline()) {
+      function.set_usage_counter(0);
+    }
+  }
+}
+
+
 RawError* Compiler::CompileParsedFunction(
     ParsedFunction* parsed_function) {
   Isolate* isolate = Isolate::Current();
@@ -837,7 +953,10 @@ RawError* Compiler::CompileParsedFunction(
   isolate->set_long_jump_base(&jump);
   if (setjmp(*jump.Set()) == 0) {
     // Non-optimized code generator.
-    CompileParsedFunctionHelper(parsed_function, false, Isolate::kNoDeoptId);
+    CompileParsedFunctionHelper(parsed_function,
+                                false,  // Not optimized.
+                                false,  // Not baseline.
+                                Isolate::kNoDeoptId);
     if (FLAG_disassemble) {
       DisassembleCode(parsed_function->function(), false);
     }
@@ -941,7 +1060,10 @@ RawObject* Compiler::ExecuteOnce(SequenceNode* fragment) {
     parsed_function->AllocateVariables();
 
     // Non-optimized code generator.
-    CompileParsedFunctionHelper(parsed_function, false, Isolate::kNoDeoptId);
+    CompileParsedFunctionHelper(parsed_function,
+                                false,  // Not optimized.
+                                false,  // Not baseline.
+                                Isolate::kNoDeoptId);
 
     const Object& result = Object::Handle(
         DartEntry::InvokeFunction(func, Object::empty_array()));
@@ -48,6 +48,17 @@ class Compiler : public AllStatic {
       const Function& function,
       intptr_t osr_id = Isolate::kNoDeoptId);
 
+  // Queues function for optimization at the next idle notification instead
+  // of optimizing it synchronously. Returns false if the caller should
+  // optimize the function now, either because the function became hot again
+  // while already queued or because the queue is full.
+  static bool QueueOptimization(const Function& function);
+
+  // Optimizes queued functions until the queue is empty or the current time
+  // (in microseconds) passes deadline. Requests made stale by the function
+  // having been optimized, deoptimized too often or disabled are dropped.
+  static void OptimizeQueuedFunctions(int64_t deadline);
+
   // Generates code for given parsed function (without parsing it again) and
   // sets its code field.
   //
@@ -61,6 +61,10 @@ intptr_t CompilerStats::num_token_checks = 0;
 intptr_t CompilerStats::num_tokens_rewind = 0;
 intptr_t CompilerStats::num_tokens_lookahead = 0;
 
+intptr_t CompilerStats::num_inliner_parse_cache_hits = 0;
+intptr_t CompilerStats::num_inliner_bailout_cache_hits = 0;
+intptr_t CompilerStats::num_loop_stack_moves = 0;
+
 void CompilerStats::Print() {
   if (!FLAG_compiler_stats) {
     return;
@@ -100,6 +104,10 @@ void CompilerStats::Print() {
       graphinliner_parse_timer.TotalElapsedTime();
   OS::Print("    Parsing:        %" Pd64 " msecs\n",
             graphinliner_parse_usecs / 1000);
+  OS::Print("      Cached:       %" Pd " parses\n",
+            num_inliner_parse_cache_hits);
+  OS::Print("      Bailouts:     %" Pd " cached\n",
+            num_inliner_bailout_cache_hits);
   int64_t graphinliner_build_usecs =
       graphinliner_build_timer.TotalElapsedTime();
   OS::Print("    Building:       %" Pd64 " msecs\n",
@@ -118,6 +126,7 @@ void CompilerStats::Print() {
   int64_t graphoptimizer_usecs = graphoptimizer_timer.TotalElapsedTime();
   OS::Print("  Graph optimizer:  %" Pd64 " msecs\n",
             (graphoptimizer_usecs - graphinliner_usecs) / 1000);
+  OS::Print("  Loop stack moves: %" Pd "\n", num_loop_stack_moves);
   int64_t graphcompiler_usecs = graphcompiler_timer.TotalElapsedTime();
   OS::Print("  Graph compiler:   %" Pd64 " msecs\n",
             graphcompiler_usecs / 1000);
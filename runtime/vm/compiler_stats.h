@@ -26,6 +26,10 @@ class CompilerStats : AllStatic {
   static intptr_t num_tokens_rewind;
   static intptr_t num_tokens_lookahead;
 
+  static intptr_t num_inliner_parse_cache_hits;    // Callee parses avoided.
+  static intptr_t num_inliner_bailout_cache_hits;  // Callee builds avoided.
+  static intptr_t num_loop_stack_moves;  // Allocator stack moves in loops.
+
   static intptr_t src_length;        // Total number of characters in source.
   static intptr_t code_allocated;    // Bytes allocated for generated code.
   static Timer parser_timer;         // Cumulative runtime of parser.
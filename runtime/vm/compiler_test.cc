@@ -4,7 +4,9 @@
 
 #include "platform/assert.h"
 #include "vm/class_finalizer.h"
+#include "vm/code_generator.h"
 #include "vm/compiler.h"
+#include "vm/compiler_stats.h"
 #include "vm/dart_api_impl.h"
 #include "vm/object.h"
 #include "vm/symbols.h"
@@ -12,6 +14,10 @@
 
 namespace dart {
 
+DECLARE_FLAG(int, baseline_optimization_counter_threshold);
+DECLARE_FLAG(bool, deferred_optimization);
+DECLARE_FLAG(bool, use_inlining);
+
 TEST_CASE(CompileScript) {
   const char* kScriptChars =
       "class A {\n"
@@ -97,4 +103,204 @@ TEST_CASE(EvalExpression) {
   EXPECT_STREQ("Herr Nilsson 100.", val.ToCString());
 }
 
+
+TEST_CASE(DeferredOptimization) {
+  const char* kScriptChars =
+      "foo(x) => x + 1;              \n"
+      "main() => foo(41);            \n";
+
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  Library& library = Library::Handle();
+  library ^= Api::UnwrapHandle(lib);
+  const Function& foo = Function::Handle(
+      library.LookupLocalFunction(String::Handle(Symbols::New("foo"))));
+  EXPECT(!foo.IsNull());
+  EXPECT(foo.HasCode());
+  EXPECT(!foo.HasOptimizedCode());
+
+  const bool saved_deferred_optimization = FLAG_deferred_optimization;
+  FLAG_deferred_optimization = true;
+  const GrowableObjectArray& queue = GrowableObjectArray::Handle(
+      Isolate::Current()->object_store()->optimization_queue());
+  EXPECT(Compiler::QueueOptimization(foo));
+  EXPECT_EQ(1, queue.Length());
+  // Requesting again before idle time means the caller optimizes right away,
+  // and the request no longer takes up room in the queue.
+  EXPECT(!Compiler::QueueOptimization(foo));
+  EXPECT_EQ(0, queue.Length());
+  EXPECT(Compiler::QueueOptimization(foo));
+  // A deadline in the past leaves the queue alone.
+  Compiler::OptimizeQueuedFunctions(0);
+  EXPECT(!foo.HasOptimizedCode());
+  Compiler::OptimizeQueuedFunctions(kMaxInt64);
+  EXPECT(foo.HasOptimizedCode());
+  FLAG_deferred_optimization = saved_deferred_optimization;
+
+  result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(42, value);
+}
+
+
+TEST_CASE(BaselineOptimization) {
+  const char* kScriptChars =
+      "foo(x) => x + 1;              \n"
+      "main() => foo(41);            \n";
+
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  Library& library = Library::Handle();
+  library ^= Api::UnwrapHandle(lib);
+  const Function& foo = Function::Handle(
+      library.LookupLocalFunction(String::Handle(Symbols::New("foo"))));
+  EXPECT(!foo.IsNull());
+  EXPECT(!foo.HasOptimizedCode());
+
+  const int saved_threshold = FLAG_baseline_optimization_counter_threshold;
+  FLAG_baseline_optimization_counter_threshold = 0;
+  Code& code = Code::Handle();
+  // The first optimizing compilation uses the baseline tier.
+  EXPECT(Error::Handle(Compiler::CompileOptimizedFunction(foo)).IsNull());
+  EXPECT(foo.HasOptimizedCode());
+  code = foo.CurrentCode();
+  EXPECT(code.is_baseline());
+
+  result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(42, value);
+
+  // Baseline code is replaced by fully optimized code.
+  EXPECT(Error::Handle(Compiler::CompileOptimizedFunction(foo)).IsNull());
+  code = foo.CurrentCode();
+  EXPECT(code.is_optimized());
+  EXPECT(!code.is_baseline());
+  FLAG_baseline_optimization_counter_threshold = saved_threshold;
+
+  result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(42, value);
+}
+
+
+// A callee whose graph building bails out is only built once per
+// compilation, the other call sites reuse the bailout.
+TEST_CASE(InlinerBailoutCache) {
+  const char* kScriptChars =
+      "guarded(x) {                  \n"
+      "  try {                       \n"
+      "    return x + 1;             \n"
+      "  } catch (e) {               \n"
+      "    return 0;                 \n"
+      "  }                           \n"
+      "}                             \n"
+      "foo(x) => guarded(x) + guarded(x + 1);\n"
+      "main() {                      \n"
+      "  var r;                      \n"
+      "  for (var i = 0; i < 10; i++) r = foo(i);\n"
+      "  return r;                   \n"
+      "}                             \n";
+
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  Library& library = Library::Handle();
+  library ^= Api::UnwrapHandle(lib);
+  const Function& foo = Function::Handle(
+      library.LookupLocalFunction(String::Handle(Symbols::New("foo"))));
+  EXPECT(!foo.IsNull());
+  EXPECT(!foo.HasOptimizedCode());
+  const Function& guarded = Function::Handle(
+      library.LookupLocalFunction(String::Handle(Symbols::New("guarded"))));
+  EXPECT(!guarded.IsNull());
+  // Compiling 'guarded' marked it as not inlinable. Clear the mark, so that
+  // only the bailout cache keeps the second call site from building it.
+  EXPECT(!guarded.IsInlineable());
+  guarded.set_is_inlinable(true);
+
+  const intptr_t hits_before = CompilerStats::num_inliner_bailout_cache_hits;
+  EXPECT(Error::Handle(Compiler::CompileOptimizedFunction(foo)).IsNull());
+  EXPECT(foo.HasOptimizedCode());
+  // The try-catch in 'guarded' stops inlining at the first call site, the
+  // second one is rejected without building the callee again.
+  EXPECT_EQ(hits_before + 1, CompilerStats::num_inliner_bailout_cache_hits);
+
+  result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(21, value);
+}
+
+
+
+// A deoptimization with a reason new at its call site does not count towards
+// giving up on the function, a repeated one does. The reoptimized code keeps
+// the generic call.
+TEST_CASE(DeoptReasonCounting) {
+  const char* kScriptChars =
+      "class A { f() => 1; }         \n"
+      "class B { f() => 2; }         \n"
+      "class C { f() => 3; }         \n"
+      "call(o, inner) {              \n"
+      "  if (inner != null) call(inner, null);\n"
+      "  return o.f();               \n"
+      "}                             \n"
+      "warmup() {                    \n"
+      "  var r;                      \n"
+      "  for (var i = 0; i < 10; i++) r = call(new A(), new A());\n"
+      "  return r;                   \n"
+      "}                             \n"
+      "deoptTwice() => call(new B(), new B());\n"
+      "other() => call(new C(), null);\n";
+
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("warmup"), 0, NULL));
+  Library& library = Library::Handle();
+  library ^= Api::UnwrapHandle(lib);
+  const Function& call = Function::Handle(
+      library.LookupLocalFunction(String::Handle(Symbols::New("call"))));
+  EXPECT(!call.IsNull());
+  EXPECT(!call.HasOptimizedCode());
+  // Keep the recursive call out of line, so that it deoptimizes on its own.
+  const bool saved_use_inlining = FLAG_use_inlining;
+  FLAG_use_inlining = false;
+  EXPECT(Error::Handle(Compiler::CompileOptimizedFunction(call)).IsNull());
+  EXPECT(call.HasOptimizedCode());
+
+  intptr_t* reason_counts = Isolate::Current()->deopt_reason_counts();
+  const intptr_t check_class_before = reason_counts[kDeoptCheckClass];
+  // The recursive call deoptimizes first, on a receiver class check that is
+  // new at 'o.f()'. The outer activation is still optimized and deoptimizes
+  // at the same site for the same, now repeated, reason.
+  Dart_Handle result = Dart_Invoke(lib, NewString("deoptTwice"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(2, value);
+  EXPECT(!call.HasOptimizedCode());
+  EXPECT_EQ(check_class_before + 2, reason_counts[kDeoptCheckClass]);
+  EXPECT_EQ(1, call.deoptimization_counter());
+
+  // The reoptimized code calls 'f' generically and runs on yet another class
+  // without deoptimizing.
+  EXPECT(Error::Handle(Compiler::CompileOptimizedFunction(call)).IsNull());
+  EXPECT(call.HasOptimizedCode());
+  result = Dart_Invoke(lib, NewString("other"), 0, NULL);
+  EXPECT_VALID(result);
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(3, value);
+  EXPECT(call.HasOptimizedCode());
+  EXPECT_EQ(check_class_before + 2, reason_counts[kDeoptCheckClass]);
+  EXPECT_EQ(1, call.deoptimization_counter());
+  FLAG_use_inlining = saved_use_inlining;
+}
+
 }  // namespace dart
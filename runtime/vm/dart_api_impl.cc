@@ -27,6 +27,7 @@
 #include "vm/port.h"
 #include "vm/resolver.h"
 #include "vm/reusable_handles.h"
+#include "vm/snapshot.h"
 #include "vm/stack_frame.h"
 #include "vm/symbols.h"
 #include "vm/timer.h"
@@ -721,6 +722,25 @@ DART_EXPORT Dart_Handle Dart_RemoveGcEpilogueCallback(
 }
 
 
+DART_EXPORT Dart_Handle Dart_NotifyIdle(int64_t deadline_micros) {
+  Isolate* isolate = Isolate::Current();
+  CHECK_ISOLATE(isolate);
+  if (deadline_micros < 0) {
+    return Api::NewError(
+        "%s expects argument 'deadline_micros' to be non-negative.",
+        CURRENT_FUNC);
+  }
+  int64_t deadline = OS::GetCurrentTimeMicros() + deadline_micros;
+  {
+    StackZone zone(isolate);
+    HANDLESCOPE(isolate);
+    Compiler::OptimizeQueuedFunctions(deadline);
+    isolate->heap()->NotifyIdle(deadline);
+  }
+  return Api::Success();
+}
+
+
 // --- Initialization and Globals ---
 
 DART_EXPORT const char* Dart_VersionString() {
@@ -944,6 +964,69 @@ DART_EXPORT Dart_Handle Dart_CreateScriptSnapshot(uint8_t** buffer,
 }
 
 
+DART_EXPORT Dart_Handle Dart_CreateTypeFeedback(uint8_t** buffer,
+                                                intptr_t* size) {
+  Isolate* isolate = Isolate::Current();
+  DARTSCOPE(isolate);
+  TIMERSCOPE(time_creating_snapshot);
+  if (buffer == NULL) {
+    RETURN_NULL_ERROR(buffer);
+  }
+  if (size == NULL) {
+    RETURN_NULL_ERROR(size);
+  }
+  Dart_Handle state = Api::CheckIsolateState(isolate);
+  if (::Dart_IsError(state)) {
+    return state;
+  }
+  TypeFeedbackWriter writer(buffer, ApiReallocate);
+  writer.WriteTypeFeedback();
+  *size = writer.BytesWritten();
+  return Api::Success();
+}
+
+
+DART_EXPORT Dart_Handle Dart_LoadTypeFeedback(const uint8_t* buffer,
+                                              intptr_t buffer_len) {
+  Isolate* isolate = Isolate::Current();
+  DARTSCOPE(isolate);
+  if (buffer == NULL) {
+    RETURN_NULL_ERROR(buffer);
+  }
+  const Snapshot* snapshot = Snapshot::SetupFromBuffer(buffer);
+  if ((buffer_len < Snapshot::kHeaderSize) ||
+      !snapshot->IsTypeFeedbackSnapshot()) {
+    return Api::NewError("%s expects parameter 'buffer' to be a type feedback"
+                         " snapshot.", CURRENT_FUNC);
+  }
+  if (snapshot->length() != buffer_len) {
+    return Api::NewError("%s: 'buffer_len' of %" Pd " is not equal to %d which"
+                         " is the expected length in the snapshot.",
+                         CURRENT_FUNC, buffer_len, snapshot->length());
+  }
+  Dart_Handle state = Api::CheckIsolateState(isolate);
+  if (::Dart_IsError(state)) {
+    return state;
+  }
+  const intptr_t content_len = snapshot->length() - Snapshot::kHeaderSize;
+  // Check the whole feedback against the loaded sources before applying any
+  // of it.
+  ApiError& error = ApiError::Handle(isolate);
+  {
+    TypeFeedbackReader reader(snapshot->content(), content_len, false);
+    error = reader.ReadTypeFeedback();
+  }
+  if (error.IsNull()) {
+    TypeFeedbackReader reader(snapshot->content(), content_len, true);
+    error = reader.ReadTypeFeedback();
+  }
+  if (!error.IsNull()) {
+    return Api::NewHandle(isolate, error.raw());
+  }
+  return Api::Success();
+}
+
+
 DART_EXPORT void Dart_InterruptIsolate(Dart_Isolate isolate) {
   TRACE_API_CALL(CURRENT_FUNC);
   if (isolate == NULL) {
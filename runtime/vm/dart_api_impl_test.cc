@@ -20,6 +20,7 @@
 namespace dart {
 
 DECLARE_FLAG(bool, enable_type_checks);
+DECLARE_FLAG(int, new_gen_target_pause_micros);
 
 TEST_CASE(ErrorHandleBasics) {
   const char* kScriptChars =
@@ -2693,6 +2694,41 @@ TEST_CASE(RemoveGarbageCollectionCallbacks) {
 }
 
 
+// Fills a quarter of new space with garbage, less than a semispace.
+static void FillNewSpace(Heap* heap) {
+  HANDLESCOPE(Isolate::Current());
+  while ((heap->UsedInWords(Heap::kNew) * 4) <
+         heap->CapacityInWords(Heap::kNew)) {
+    Array::New(64);
+  }
+}
+
+
+TEST_CASE(NotifyIdle) {
+  EXPECT(Dart_IsError(Dart_NotifyIdle(-1)));
+  Heap* heap = Isolate::Current()->heap();
+  // Idle time is only used for a scavenge once one has been measured.
+  heap->CollectGarbage(Heap::kNew);
+  const intptr_t full_capacity = heap->CapacityInWords(Heap::kNew);
+  FillNewSpace(heap);
+  intptr_t used_before = heap->UsedInWords(Heap::kNew);
+  EXPECT_VALID(Dart_NotifyIdle(10 * kMicrosecondsPerSecond));
+  // The idle time was used to scavenge the garbage and to return the unused
+  // new space memory.
+  EXPECT_LT(heap->UsedInWords(Heap::kNew), used_before);
+  const intptr_t shrunk_capacity = heap->CapacityInWords(Heap::kNew);
+  EXPECT_LT(shrunk_capacity, full_capacity);
+
+  // With a pause target the idle scavenge leaves the size to the target.
+  const int saved_target = FLAG_new_gen_target_pause_micros;
+  FLAG_new_gen_target_pause_micros = 1000000000;
+  FillNewSpace(heap);
+  EXPECT_VALID(Dart_NotifyIdle(10 * kMicrosecondsPerSecond));
+  EXPECT_GT(heap->CapacityInWords(Heap::kNew), shrunk_capacity);
+  FLAG_new_gen_target_pause_micros = saved_target;
+}
+
+
 TEST_CASE(SingleGarbageCollectionCallback) {
   // Add a prologue callback.
   EXPECT_VALID(Dart_AddGcPrologueCallback(&PrologueCallbackTimes2));
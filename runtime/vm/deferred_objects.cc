@@ -88,13 +88,17 @@ void DeferredObjectRef::Materialize() {
 
 RawInstance* DeferredObject::object() {
   if (object_ == NULL) {
-    Materialize();
+    Create();
   }
   return object_->raw();
 }
 
 
-void DeferredObject::Materialize() {
+void DeferredObject::Create() {
+  if (object_ != NULL) {
+    return;
+  }
+
   Class& cls = Class::Handle();
   cls ^= GetClass();
 
@@ -105,14 +109,19 @@ void DeferredObject::Materialize() {
                  field_count_);
   }
 
-  const Instance& obj = Instance::ZoneHandle(Instance::New(cls));
+  object_ = &Instance::ZoneHandle(Instance::New(cls));
+}
+
+
+void DeferredObject::Fill() {
+  Create();  // Ensure instance is created.
 
   Field& field = Field::Handle();
   Object& value = Object::Handle();
   for (intptr_t i = 0; i < field_count_; i++) {
     field ^= GetField(i);
     value = GetValue(i);
-    obj.SetField(field, value);
+    object_->SetField(field, value);
 
     if (FLAG_trace_deoptimization_verbose) {
       OS::PrintErr("    %s <- %s\n",
@@ -120,8 +129,6 @@ void DeferredObject::Materialize() {
                    value.ToCString());
     }
   }
-
-  object_ = &obj;
 }
 
 }  // namespace dart
@@ -139,6 +139,14 @@ class DeferredObject {
 
   RawInstance* object();
 
+  // Allocates the object.  Its fields are initialized by Fill once all
+  // deferred objects are allocated, because fields can refer to other
+  // deferred objects.
+  void Create();
+
+  // Initializes the fields of the object allocated by Create.
+  void Fill();
+
  private:
   enum {
     kClassIndex = 0,
@@ -151,11 +159,6 @@ class DeferredObject {
     kFieldEntrySize,
   };
 
-  // Materializes the object. Returns amount of values that were consumed
-  // and should be removed from the expression stack at the very end of
-  // deoptimization.
-  void Materialize();
-
   RawObject* GetClass() const {
     return args_[kClassIndex];
   }
@@ -15,6 +15,9 @@ namespace dart {
 
 DEFINE_FLAG(bool, compress_deopt_info, true,
             "Compress the size of the deoptimization info for optimized code.");
+DEFINE_FLAG(bool, count_new_deopt_reasons, false,
+            "Count deoptimizations with a reason not yet recorded at their "
+            "call site towards the deoptimization counter threshold.");
 DECLARE_FLAG(bool, trace_deoptimization);
 DECLARE_FLAG(bool, trace_deoptimization_verbose);
 
@@ -37,6 +40,7 @@ DeoptContext::DeoptContext(const StackFrame* frame,
       fpu_registers_(fpu_registers),
       num_args_(0),
       deopt_reason_(kDeoptUnknown),
+      deopt_reason_is_new_(false),
       isolate_(Isolate::Current()),
       deferred_boxes_(NULL),
       deferred_object_refs_(NULL),
@@ -263,6 +267,13 @@ void DeoptContext::FillDestFrame() {
   // frame. They will be used during materialization and removed from the stack
   // right before control switches to the unoptimized code.
   const intptr_t num_materializations = len - frame_size;
+  if (!objects_only) {
+    // Decide this before the frame instructions execute: the pc markers that
+    // update deoptimization counters run before the innermost return address
+    // records the reason.
+    deopt_reason_is_new_ =
+        IsNewDeoptReason(deopt_instructions, num_materializations);
+  }
   PrepareForDeferredMaterialization(num_materializations);
   for (intptr_t from_index = 0, to_index = kDartFrameFixedSize;
        from_index < num_materializations;
@@ -321,12 +332,18 @@ static void FillDeferredSlots(DeferredSlot** slot_list) {
 intptr_t DeoptContext::MaterializeDeferredObjects() {
   // First materialize all unboxed "primitive" values (doubles, mints, simd)
   // then materialize objects. The order is important: objects might be
-  // referencing boxes allocated on the first step. At the same time
-  // objects can't be referencing other deferred objects because storing
-  // an object into a field is always conservatively treated as escaping by
-  // allocation sinking and load forwarding.
+  // referencing boxes allocated on the first step. Objects can also be
+  // referencing other deferred objects (e.g. a closure stored into an
+  // eliminated allocation), so all objects are allocated before the
+  // references to them are written and before their fields are initialized.
   FillDeferredSlots(&deferred_boxes_);
+  for (intptr_t i = 0; i < DeferredObjectsCount(); i++) {
+    GetDeferredObject(i)->Create();
+  }
   FillDeferredSlots(&deferred_object_refs_);
+  for (intptr_t i = 0; i < DeferredObjectsCount(); i++) {
+    GetDeferredObject(i)->Fill();
+  }
 
   // Compute total number of artificial arguments used during deoptimization.
   intptr_t deopt_arg_count = 0;
@@ -474,6 +491,82 @@ class DeoptInt64StackSlotInstr : public DeoptInstr {
 };
 
 
+class DeoptUint32StackSlotInstr : public DeoptInstr {
+ public:
+  explicit DeoptUint32StackSlotInstr(intptr_t source_index)
+      : stack_slot_index_(source_index) {
+    ASSERT(stack_slot_index_ >= 0);
+  }
+
+  virtual intptr_t source_index() const { return stack_slot_index_; }
+  virtual DeoptInstr::Kind kind() const { return kUint32StackSlot; }
+
+  virtual const char* ToCString() const {
+    return Isolate::Current()->current_zone()->PrintToString(
+        "u32s%" Pd "", stack_slot_index_);
+  }
+
+  void Execute(DeoptContext* deopt_context, intptr_t* dest_addr) {
+    intptr_t source_index =
+       deopt_context->source_frame_size() - stack_slot_index_ - 1;
+    uint32_t* source_addr = reinterpret_cast<uint32_t*>(
+        deopt_context->GetSourceFrameAddressAt(source_index));
+    const int64_t value = static_cast<int64_t>(*source_addr);
+    *reinterpret_cast<RawSmi**>(dest_addr) = Smi::New(0);
+    if (Smi::IsValid64(value)) {
+      *dest_addr = reinterpret_cast<intptr_t>(
+          Smi::New(static_cast<intptr_t>(value)));
+    } else {
+      deopt_context->DeferMintMaterialization(
+          value, reinterpret_cast<RawMint**>(dest_addr));
+    }
+  }
+
+ private:
+  const intptr_t stack_slot_index_;  // First argument is 0, always >= 0.
+
+  DISALLOW_COPY_AND_ASSIGN(DeoptUint32StackSlotInstr);
+};
+
+
+class DeoptInt32StackSlotInstr : public DeoptInstr {
+ public:
+  explicit DeoptInt32StackSlotInstr(intptr_t source_index)
+      : stack_slot_index_(source_index) {
+    ASSERT(stack_slot_index_ >= 0);
+  }
+
+  virtual intptr_t source_index() const { return stack_slot_index_; }
+  virtual DeoptInstr::Kind kind() const { return kInt32StackSlot; }
+
+  virtual const char* ToCString() const {
+    return Isolate::Current()->current_zone()->PrintToString(
+        "i32s%" Pd "", stack_slot_index_);
+  }
+
+  void Execute(DeoptContext* deopt_context, intptr_t* dest_addr) {
+    intptr_t source_index =
+       deopt_context->source_frame_size() - stack_slot_index_ - 1;
+    int32_t* source_addr = reinterpret_cast<int32_t*>(
+        deopt_context->GetSourceFrameAddressAt(source_index));
+    const int64_t value = static_cast<int64_t>(*source_addr);
+    *reinterpret_cast<RawSmi**>(dest_addr) = Smi::New(0);
+    if (Smi::IsValid64(value)) {
+      *dest_addr = reinterpret_cast<intptr_t>(
+          Smi::New(static_cast<intptr_t>(value)));
+    } else {
+      deopt_context->DeferMintMaterialization(
+          value, reinterpret_cast<RawMint**>(dest_addr));
+    }
+  }
+
+ private:
+  const intptr_t stack_slot_index_;  // First argument is 0, always >= 0.
+
+  DISALLOW_COPY_AND_ASSIGN(DeoptInt32StackSlotInstr);
+};
+
+
 class DeoptFloat32x4StackSlotInstr : public DeoptInstr {
  public:
   explicit DeoptFloat32x4StackSlotInstr(intptr_t source_index)
@@ -538,6 +631,19 @@ class DeoptInt32x4StackSlotInstr : public DeoptInstr {
 };
 
 
+// Returns the IC data of the instance call at 'deopt_id' in the unoptimized
+// 'code', or null if there is no instance call at that deopt id.
+static RawICData* ICDataAtDeoptId(const Code& code, intptr_t deopt_id) {
+  const uword pc = code.GetPcForDeoptId(deopt_id, PcDescriptors::kIcCall);
+  if (pc == 0) {
+    return ICData::null();
+  }
+  ICData& ic_data = ICData::Handle();
+  CodePatcher::GetInstanceCallAt(pc, code, &ic_data);
+  return ic_data.raw();
+}
+
+
 // Deoptimization instruction creating return address using function and
 // deopt-id stored at 'object_table_index'.
 class DeoptRetAddressInstr : public DeoptInstr {
@@ -574,15 +680,12 @@ class DeoptRetAddressInstr : public DeoptInstr {
     ASSERT(continue_at_pc != 0);
     *dest_addr = continue_at_pc;
 
-    uword pc = code.GetPcForDeoptId(deopt_id_, PcDescriptors::kIcCall);
-    if (pc != 0) {
-      // If the deoptimization happened at an IC call, update the IC data
-      // to avoid repeated deoptimization at the same site next time around.
-      ICData& ic_data = ICData::Handle();
-      CodePatcher::GetInstanceCallAt(pc, code, &ic_data);
-      if (!ic_data.IsNull()) {
-        ic_data.set_deopt_reason(deopt_context->deopt_reason());
-      }
+    // If the deoptimization happened at an IC call, record the reason in the
+    // IC data to avoid repeated deoptimization at the same site next time
+    // around.
+    const ICData& ic_data = ICData::Handle(ICDataAtDeoptId(code, deopt_id_));
+    if (!ic_data.IsNull()) {
+      ic_data.AddDeoptReason(deopt_context->deopt_reason());
     }
   }
 
@@ -601,6 +704,26 @@ class DeoptRetAddressInstr : public DeoptInstr {
 };
 
 
+bool DeoptContext::IsNewDeoptReason(
+    const GrowableArray<DeoptInstr*>& instructions,
+    intptr_t frame_start) const {
+  // The first return address of the frame belongs to the innermost
+  // deoptimized function and carries the deopt id that failed.
+  for (intptr_t i = frame_start; i < instructions.length(); i++) {
+    if (instructions[i]->kind() == DeoptInstr::kRetAddress) {
+      DeoptRetAddressInstr* ret_address =
+          static_cast<DeoptRetAddressInstr*>(instructions[i]);
+      Code& code = Code::Handle(isolate());
+      code ^= ObjectAt(ret_address->object_table_index());
+      const ICData& ic_data = ICData::Handle(
+          isolate(), ICDataAtDeoptId(code, ret_address->deopt_id()));
+      return !ic_data.IsNull() && !ic_data.HasDeoptReason(deopt_reason_);
+    }
+  }
+  return false;
+}
+
+
 // Deoptimization instruction moving a constant stored at 'object_table_index'.
 class DeoptConstantInstr : public DeoptInstr {
  public:
@@ -654,6 +777,76 @@ class DeoptRegisterInstr: public DeoptInstr {
 };
 
 
+// Deoptimization instruction moving a CPU register holding an unboxed uint32
+// value.
+class DeoptUint32RegisterInstr: public DeoptInstr {
+ public:
+  explicit DeoptUint32RegisterInstr(intptr_t reg_as_int)
+      : reg_(static_cast<Register>(reg_as_int)) {}
+
+  virtual intptr_t source_index() const { return static_cast<intptr_t>(reg_); }
+  virtual DeoptInstr::Kind kind() const { return kUint32Register; }
+
+  virtual const char* ToCString() const {
+    return Isolate::Current()->current_zone()->PrintToString(
+        "%s(u32)", Assembler::RegisterName(reg_));
+  }
+
+  void Execute(DeoptContext* deopt_context, intptr_t* dest_addr) {
+    const int64_t value = static_cast<int64_t>(
+        static_cast<uint32_t>(deopt_context->RegisterValue(reg_)));
+    *reinterpret_cast<RawSmi**>(dest_addr) = Smi::New(0);
+    if (Smi::IsValid64(value)) {
+      *dest_addr = reinterpret_cast<intptr_t>(
+          Smi::New(static_cast<intptr_t>(value)));
+    } else {
+      deopt_context->DeferMintMaterialization(
+          value, reinterpret_cast<RawMint**>(dest_addr));
+    }
+  }
+
+ private:
+  const Register reg_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeoptUint32RegisterInstr);
+};
+
+
+// Deoptimization instruction moving a CPU register holding an unboxed int32
+// value.
+class DeoptInt32RegisterInstr: public DeoptInstr {
+ public:
+  explicit DeoptInt32RegisterInstr(intptr_t reg_as_int)
+      : reg_(static_cast<Register>(reg_as_int)) {}
+
+  virtual intptr_t source_index() const { return static_cast<intptr_t>(reg_); }
+  virtual DeoptInstr::Kind kind() const { return kInt32Register; }
+
+  virtual const char* ToCString() const {
+    return Isolate::Current()->current_zone()->PrintToString(
+        "%s(i32)", Assembler::RegisterName(reg_));
+  }
+
+  void Execute(DeoptContext* deopt_context, intptr_t* dest_addr) {
+    const int64_t value = static_cast<int64_t>(
+        static_cast<int32_t>(deopt_context->RegisterValue(reg_)));
+    *reinterpret_cast<RawSmi**>(dest_addr) = Smi::New(0);
+    if (Smi::IsValid64(value)) {
+      *dest_addr = reinterpret_cast<intptr_t>(
+          Smi::New(static_cast<intptr_t>(value)));
+    } else {
+      deopt_context->DeferMintMaterialization(
+          value, reinterpret_cast<RawMint**>(dest_addr));
+    }
+  }
+
+ private:
+  const Register reg_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeoptInt32RegisterInstr);
+};
+
+
 // Deoptimization instruction moving an XMM register.
 class DeoptFpuRegisterInstr: public DeoptInstr {
  public:
@@ -801,8 +994,14 @@ class DeoptPcMarkerInstr : public DeoptInstr {
         code.EntryPoint() + Assembler::kEntryPointToPcMarkerOffset;
     *dest_addr = pc_marker;
     // Increment the deoptimization counter. This effectively increments each
-    // function occurring in the optimized frame.
-    function.set_deoptimization_counter(function.deoptimization_counter() + 1);
+    // function occurring in the optimized frame. A reason that is new at its
+    // call site is not counted: the optimizer avoids recorded reasons, so only
+    // repeated deoptimizations bring the function closer to never being
+    // optimized again.
+    if (FLAG_count_new_deopt_reasons || !deopt_context->deopt_reason_is_new()) {
+      function.set_deoptimization_counter(
+          function.deoptimization_counter() + 1);
+    }
     if (FLAG_trace_deoptimization || FLAG_trace_deoptimization_verbose) {
       OS::PrintErr("Deoptimizing %s (count %d)\n",
           function.ToFullyQualifiedCString(),
@@ -1066,6 +1265,8 @@ DeoptInstr* DeoptInstr::Create(intptr_t kind_as_int, intptr_t source_index) {
     case kStackSlot: return new DeoptStackSlotInstr(source_index);
     case kDoubleStackSlot: return new DeoptDoubleStackSlotInstr(source_index);
     case kInt64StackSlot: return new DeoptInt64StackSlotInstr(source_index);
+    case kUint32StackSlot: return new DeoptUint32StackSlotInstr(source_index);
+    case kInt32StackSlot: return new DeoptInt32StackSlotInstr(source_index);
     case kFloat32x4StackSlot:
         return new DeoptFloat32x4StackSlotInstr(source_index);
     case kInt32x4StackSlot:
@@ -1073,6 +1274,8 @@ DeoptInstr* DeoptInstr::Create(intptr_t kind_as_int, intptr_t source_index) {
     case kRetAddress: return new DeoptRetAddressInstr(source_index);
     case kConstant: return new DeoptConstantInstr(source_index);
     case kRegister: return new DeoptRegisterInstr(source_index);
+    case kUint32Register: return new DeoptUint32RegisterInstr(source_index);
+    case kInt32Register: return new DeoptInt32RegisterInstr(source_index);
     case kFpuRegister: return new DeoptFpuRegisterInstr(source_index);
     case kInt64FpuRegister: return new DeoptInt64FpuRegisterInstr(source_index);
     case kFloat32x4FpuRegister:
@@ -1199,8 +1402,14 @@ void DeoptInfoBuilder::AddCopy(Value* value,
     intptr_t object_table_index = FindOrAddObjectInTable(source_loc.constant());
     deopt_instr = new DeoptConstantInstr(object_table_index);
   } else if (source_loc.IsRegister()) {
-    ASSERT(value->definition()->representation() == kTagged);
-    deopt_instr = new DeoptRegisterInstr(source_loc.reg());
+    if (value->definition()->representation() == kUnboxedUint32) {
+      deopt_instr = new DeoptUint32RegisterInstr(source_loc.reg());
+    } else if (value->definition()->representation() == kUnboxedInt32) {
+      deopt_instr = new DeoptInt32RegisterInstr(source_loc.reg());
+    } else {
+      ASSERT(value->definition()->representation() == kTagged);
+      deopt_instr = new DeoptRegisterInstr(source_loc.reg());
+    }
   } else if (source_loc.IsFpuRegister()) {
     if (value->definition()->representation() == kUnboxedDouble) {
       deopt_instr = new DeoptFpuRegisterInstr(source_loc.fpu_reg());
@@ -1213,9 +1422,15 @@ void DeoptInfoBuilder::AddCopy(Value* value,
       deopt_instr = new DeoptInt32x4FpuRegisterInstr(source_loc.fpu_reg());
     }
   } else if (source_loc.IsStackSlot()) {
-    ASSERT(value->definition()->representation() == kTagged);
     intptr_t source_index = CalculateStackIndex(source_loc);
-    deopt_instr = new DeoptStackSlotInstr(source_index);
+    if (value->definition()->representation() == kUnboxedUint32) {
+      deopt_instr = new DeoptUint32StackSlotInstr(source_index);
+    } else if (value->definition()->representation() == kUnboxedInt32) {
+      deopt_instr = new DeoptInt32StackSlotInstr(source_index);
+    } else {
+      ASSERT(value->definition()->representation() == kTagged);
+      deopt_instr = new DeoptStackSlotInstr(source_index);
+    }
   } else if (source_loc.IsDoubleStackSlot()) {
     intptr_t source_index = CalculateStackIndex(source_loc);
     if (value->definition()->representation() == kUnboxedDouble) {
@@ -14,6 +14,7 @@
 
 namespace dart {
 
+class DeoptInstr;
 class Location;
 class Value;
 class MaterializeObjectInstr;
@@ -91,6 +92,10 @@ class DeoptContext {
 
   DeoptReasonId deopt_reason() const { return deopt_reason_; }
 
+  // True if the deoptimization reason was not yet recorded at the deopt id
+  // of the innermost deoptimized function.
+  bool deopt_reason_is_new() const { return deopt_reason_is_new_; }
+
   RawDeoptInfo* deopt_info() const { return deopt_info_; }
 
   // Fills the destination frame but defers materialization of
@@ -160,6 +165,11 @@ class DeoptContext {
     }
   }
 
+  // Returns true if the deoptimization reason is not yet recorded in the IC
+  // data at the deopt id of the innermost frame described by 'instructions'.
+  bool IsNewDeoptReason(const GrowableArray<DeoptInstr*>& instructions,
+                        intptr_t frame_start) const;
+
   // Sets the materialized value for some deferred object.
   //
   // Claims ownership of the memory for 'object'.
@@ -184,6 +194,7 @@ class DeoptContext {
   fpu_register_t* fpu_registers_;
   intptr_t num_args_;
   DeoptReasonId deopt_reason_;
+  bool deopt_reason_is_new_;
   intptr_t caller_fp_;
   Isolate* isolate_;
 
@@ -207,6 +218,8 @@ class DeoptInstr : public ZoneAllocated {
     kRetAddress,
     kConstant,
     kRegister,
+    kUint32Register,
+    kInt32Register,
     kFpuRegister,
     kInt64FpuRegister,
     kFloat32x4FpuRegister,
@@ -214,6 +227,8 @@ class DeoptInstr : public ZoneAllocated {
     kStackSlot,
     kDoubleStackSlot,
     kInt64StackSlot,
+    kUint32StackSlot,
+    kInt32StackSlot,
     kFloat32x4StackSlot,
     kInt32x4StackSlot,
     kPcMarker,
@@ -38,10 +38,12 @@ FlowGraph::FlowGraph(const FlowGraphBuilder& builder,
     constant_dead_(NULL),
     block_effects_(NULL),
     licm_allowed_(true),
+    is_baseline_(false),
     use_far_branches_(false),
     loop_headers_(NULL),
     loop_invariant_loads_(NULL),
-    guarded_fields_(builder.guarded_fields()) {
+    guarded_fields_(builder.guarded_fields()),
+    pretenured_classes_(new ZoneGrowableArray<const Class*>()) {
   DiscoverBlocks();
 }
 
@@ -62,6 +64,16 @@ void FlowGraph::AddToGuardedFields(
 }
 
 
+void FlowGraph::AddToPretenuredClasses(const Class* cls) {
+  for (intptr_t i = 0; i < pretenured_classes_->length(); i++) {
+    if ((*pretenured_classes_)[i]->raw() == cls->raw()) {
+      return;
+    }
+  }
+  pretenured_classes_->Add(cls);
+}
+
+
 bool FlowGraph::ShouldReorderBlocks(const Function& function,
                                     bool is_optimized) {
   return is_optimized && FLAG_reorder_basic_blocks && !function.is_intrinsic();
@@ -177,6 +177,11 @@ class FlowGraph : public ZoneAllocated {
   // after this point.
   void disallow_licm() { licm_allowed_ = false; }
 
+  // Baseline graphs are compiled by the cheap optimizing tier and their code
+  // keeps counting invocations towards full optimization.
+  bool is_baseline() const { return is_baseline_; }
+  void set_is_baseline(bool value) { is_baseline_ = value; }
+
   bool use_far_branches() const { return use_far_branches_; }
   void set_use_far_branches(bool value) {
     use_far_branches_ = value;
@@ -209,10 +214,18 @@ class FlowGraph : public ZoneAllocated {
     return guarded_fields_;
   }
 
+  // Classes whose instances are allocated in old space by the graph. The code
+  // depends on their pretenuring decisions.
+  void AddToPretenuredClasses(const Class* cls);
+  ZoneGrowableArray<const Class*>* pretenured_classes() const {
+    return pretenured_classes_;
+  }
+
  private:
   friend class IfConverter;
   friend class BranchSimplifier;
   friend class ConstantPropagator;
+  friend class LoopVectorizer;
 
   // SSA transformation methods and fields.
   void ComputeDominators(GrowableArray<BitVector*>* dominance_frontier);
@@ -277,12 +290,14 @@ class FlowGraph : public ZoneAllocated {
 
   BlockEffects* block_effects_;
   bool licm_allowed_;
+  bool is_baseline_;
 
   bool use_far_branches_;
 
   ZoneGrowableArray<BlockEntryInstr*>* loop_headers_;
   ZoneGrowableArray<BitVector*>* loop_invariant_loads_;
   ZoneGrowableArray<const Field*>* guarded_fields_;
+  ZoneGrowableArray<const Class*>* pretenured_classes_;
 };
 
 
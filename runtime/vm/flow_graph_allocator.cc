@@ -5,6 +5,7 @@
 #include "vm/flow_graph_allocator.h"
 
 #include "vm/bit_vector.h"
+#include "vm/compiler_stats.h"
 #include "vm/intermediate_language.h"
 #include "vm/il_printer.h"
 #include "vm/flow_graph.h"
@@ -19,6 +20,9 @@ DEFINE_FLAG(bool, trace_ssa_allocator, false,
             "Trace register allocation over SSA.");
 DEFINE_FLAG(bool, print_ssa_liveranges, false,
             "Print live ranges after allocation.");
+DEFINE_FLAG(bool, loop_aware_splitting, true,
+            "Keep values without register uses in a loop spilled throughout "
+            "the loop and spill values defined in loops at loop exits.");
 
 #if defined(DEBUG)
 #define TRACE_ALLOC(statement)                                                 \
@@ -102,6 +106,22 @@ FlowGraphAllocator::FlowGraphAllocator(const FlowGraph& flow_graph)
 }
 
 
+// Adds the inputs of the given materialization to the live-in set. Objects
+// stored into the fields of the materialized object can be materialized
+// themselves, their inputs are live as well.
+static void AddMaterializationInputs(MaterializeObjectInstr* mat,
+                                     BitVector* live_in) {
+  for (intptr_t i = 0; i < mat->InputCount(); i++) {
+    Definition* defn = mat->InputAt(i)->definition();
+    if (defn->IsMaterializeObject()) {
+      AddMaterializationInputs(defn->AsMaterializeObject(), live_in);
+    } else if (!mat->InputAt(i)->BindsToConstant()) {
+      live_in->Add(defn->ssa_temp_index());
+    }
+  }
+}
+
+
 void SSALivenessAnalysis::ComputeInitialSets() {
   const intptr_t block_count = postorder_.length();
   for (intptr_t i = 0; i < block_count; i++) {
@@ -144,11 +164,7 @@ void SSALivenessAnalysis::ComputeInitialSets() {
           if (defn->IsMaterializeObject()) {
             // MaterializeObject instruction is not in the graph.
             // Treat its inputs as part of the environment.
-            for (intptr_t i = 0; i < defn->InputCount(); i++) {
-              if (!defn->InputAt(i)->BindsToConstant()) {
-                live_in->Add(defn->InputAt(i)->definition()->ssa_temp_index());
-              }
-            }
+            AddMaterializationInputs(defn->AsMaterializeObject(), live_in);
           } else if (!defn->IsPushArgument() && !defn->IsConstant()) {
             live_in->Add(defn->ssa_temp_index());
           }
@@ -830,6 +846,15 @@ void FlowGraphAllocator::ProcessMaterializationUses(
       continue;
     }
 
+    MaterializeObjectInstr* inner_mat = def->AsMaterializeObject();
+    if (inner_mat != NULL) {
+      // An object stored into a field of the materialized object which is
+      // materialized itself.
+      locations[i] = Location::NoLocation();
+      ProcessMaterializationUses(block, block_start_pos, use_pos, inner_mat);
+      continue;
+    }
+
     locations[i] = Location::Any();
 
     const intptr_t vreg = def->ssa_temp_index();
@@ -1889,9 +1914,26 @@ bool FlowGraphAllocator::AllocateFreeRegister(LiveRange* unallocated) {
 
   if (free_until != kMaxPosition) {
     // There was an intersection. Split unallocated.
-    TRACE_ALLOC(OS::Print("  splitting at %" Pd "\n", free_until));
-    LiveRange* tail = unallocated->SplitAt(free_until);
-    AddToUnallocated(tail);
+    BlockInfo* loop = FindLoopWithoutRegisterUses(unallocated, free_until);
+    if (loop != NULL) {
+      // The register is taken inside of a loop where the range is not used
+      // in registers. Instead of occupying the register in a part of the
+      // loop and spilling inside of the loop split the range at the loop
+      // entry and keep it in the spill slot until the loop exit.
+      const intptr_t loop_start = loop->entry()->start_pos();
+      const intptr_t loop_end = loop->last_block()->end_pos();
+      TRACE_ALLOC(OS::Print("  splitting at loop [%" Pd ", %" Pd ")\n",
+                            loop_start, loop_end));
+      LiveRange* tail = unallocated->SplitAt(loop_start);
+      if (tail->End() > loop_end) {
+        AddToUnallocated(tail->SplitAt(loop_end));
+      }
+      Spill(tail);
+    } else {
+      TRACE_ALLOC(OS::Print("  splitting at %" Pd "\n", free_until));
+      LiveRange* tail = unallocated->SplitAt(free_until);
+      AddToUnallocated(tail);
+    }
   }
 
   registers_[candidate].Add(unallocated);
@@ -1901,6 +1943,33 @@ bool FlowGraphAllocator::AllocateFreeRegister(LiveRange* unallocated) {
 }
 
 
+// Returns the outermost loop that contains the given position, starts after
+// the start of the given range and does not contain uses of the range that
+// require a register. Returns NULL if there is no such loop.
+BlockInfo* FlowGraphAllocator::FindLoopWithoutRegisterUses(LiveRange* range,
+                                                           intptr_t pos) {
+  if (!FLAG_loop_aware_splitting || (range->vreg() < 0)) return NULL;
+
+  BlockInfo* result = NULL;
+  for (BlockInfo* loop = BlockInfoAt(pos)->loop_header();
+       (loop != NULL) && (range->Start() < loop->entry()->start_pos());
+       loop = loop->loop()) {
+    const intptr_t loop_start = loop->entry()->start_pos();
+    const intptr_t loop_end = loop->last_block()->end_pos();
+    for (UsePosition* use = range->first_use();
+         (use != NULL) && (use->pos() < loop_end);
+         use = use->next()) {
+      if ((use->pos() >= loop_start) &&
+          !use->location_slot()->Equals(Location::Any())) {
+        return result;
+      }
+    }
+    result = loop;
+  }
+  return result;
+}
+
+
 bool FlowGraphAllocator::RangeHasOnlyUnconstrainedUsesInLoop(LiveRange* range,
                                                              intptr_t loop_id) {
   if (range->vreg() >= 0) {
@@ -2115,7 +2184,17 @@ bool FlowGraphAllocator::EvictIntersection(LiveRange* allocated,
         (spill_position < intersection) ? MinPosition(intersection, use->pos())
                                         : use->pos();
 
-    SpillBetween(allocated, spill_position, restore_position);
+    // A range spilled inside of a loop and restored after it would be
+    // reloaded on every back edge. Spill it at the loop entry instead.
+    intptr_t from = spill_position;
+    BlockInfo* loop = FindLoopWithoutRegisterUses(allocated, spill_position);
+    if ((loop != NULL) &&
+        (restore_position >= loop->last_block()->end_pos())) {
+      from = loop->entry()->start_pos();
+      TRACE_ALLOC(OS::Print("  moved spill position to loop header %" Pd "\n",
+                            from));
+    }
+    SpillBetween(allocated, from, restore_position);
   }
 
   return true;
@@ -2175,7 +2254,8 @@ void FlowGraphAllocator::ConvertAllUses(LiveRange* range) {
          safepoint = safepoint->next()) {
       if (!safepoint->locs()->always_calls()) {
         ASSERT(safepoint->locs()->can_call());
-        safepoint->locs()->live_registers()->Add(loc);
+        safepoint->locs()->live_registers()->Add(loc,
+                                                 range->representation());
       }
     }
   }
@@ -2347,6 +2427,9 @@ void FlowGraphAllocator::AllocateUnallocatedRanges() {
 
 bool FlowGraphAllocator::TargetLocationIsSpillSlot(LiveRange* range,
                                                    Location target) {
+  if (GetLiveRange(range->vreg())->is_spilled_at_split()) {
+    return false;
+  }
   if (target.IsStackSlot() ||
       target.IsDoubleStackSlot() ||
       target.IsConstant()) {
@@ -2431,7 +2514,73 @@ void FlowGraphAllocator::ConnectSplitSiblings(LiveRange* parent,
 }
 
 
+static bool IsStackLocation(Location loc) {
+  return loc.IsStackSlot() || loc.IsDoubleStackSlot() || loc.IsQuadStackSlot();
+}
+
+
+// Returns true if the value defined inside of a loop is in its spill slot only
+// outside of that loop. Such values are stored into the spill slot when they
+// are spilled instead of at the definition which is executed on every
+// iteration.
+bool FlowGraphAllocator::ShouldSpillAtSplit(LiveRange* range) {
+  if (!FLAG_loop_aware_splitting ||
+      !flow_graph_.graph_entry()->catch_entries().is_empty()) {
+    return false;
+  }
+
+  const Location spill_slot = range->spill_slot();
+  if (!IsStackLocation(spill_slot)) {
+    return false;
+  }
+
+  BlockInfo* loop = BlockInfoAt(range->Start())->loop_header();
+  if ((loop == NULL) || range->assigned_location().Equals(spill_slot)) {
+    return false;
+  }
+
+  const intptr_t loop_end = loop->last_block()->end_pos();
+  for (LiveRange* sibling = range->next_sibling();
+       sibling != NULL;
+       sibling = sibling->next_sibling()) {
+    if (sibling->assigned_location().Equals(spill_slot) &&
+        (sibling->Start() < loop_end)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+// The spill slot of a value spilled at splits contains the value only
+// while one of its spilled siblings is live.
+void FlowGraphAllocator::UnmarkObjectOutsideOfSpillSlot(LiveRange* range) {
+  const intptr_t stack_index = range->spill_slot().stack_index();
+  for (; range != NULL; range = range->next_sibling()) {
+    if (range->assigned_location().Equals(range->spill_slot())) continue;
+    for (SafepointPosition* safepoint = range->first_safepoint();
+         safepoint != NULL;
+         safepoint = safepoint->next()) {
+      safepoint->locs()->stack_bitmap()->Set(stack_index, false);
+    }
+  }
+}
+
+
 void FlowGraphAllocator::ResolveControlFlow() {
+  // Values that are only spilled outside of the loop containing their
+  // definition are stored into the spill slot when they are spilled.
+  for (intptr_t i = 0; i < spilled_.length(); i++) {
+    LiveRange* range = spilled_[i];
+    if (ShouldSpillAtSplit(range)) {
+      TRACE_ALLOC(OS::Print("v%" Pd " is spilled at splits\n", range->vreg()));
+      range->mark_spilled_at_split();
+      if (range->representation() == kTagged) {
+        UnmarkObjectOutsideOfSpillSlot(range);
+      }
+    }
+  }
+
   // Resolve linear control flow between touching split siblings
   // inside basic blocks.
   for (intptr_t vreg = 0; vreg < live_ranges_.length(); vreg++) {
@@ -2476,6 +2625,10 @@ void FlowGraphAllocator::ResolveControlFlow() {
   // this will cause spilling to occur on the fast path (at the definition).
   for (intptr_t i = 0; i < spilled_.length(); i++) {
     LiveRange* range = spilled_[i];
+    if (range->is_spilled_at_split()) {
+      // Stores were inserted when connecting split siblings.
+      continue;
+    }
     if (range->assigned_location().IsStackSlot() ||
         range->assigned_location().IsDoubleStackSlot() ||
         range->assigned_location().IsConstant()) {
@@ -2489,6 +2642,41 @@ void FlowGraphAllocator::ResolveControlFlow() {
 }
 
 
+static intptr_t CountStackMovesIn(ParallelMoveInstr* parallel_move) {
+  intptr_t count = 0;
+  for (intptr_t i = 0; i < parallel_move->NumMoves(); i++) {
+    MoveOperands* move = parallel_move->MoveOperandsAt(i);
+    if (move->src().Equals(move->dest())) continue;
+    if (IsStackLocation(move->src()) || IsStackLocation(move->dest())) {
+      count++;
+    }
+  }
+  return count;
+}
+
+
+intptr_t FlowGraphAllocator::CountLoopStackMoves() const {
+  intptr_t count = 0;
+  for (intptr_t i = 0; i < block_order_.length(); i++) {
+    BlockEntryInstr* block = block_order_[i];
+    BlockInfo* info = BlockInfoAt(block->lifetime_position());
+    if (!info->is_loop_header() && (info->loop() == NULL)) continue;
+    if (block->HasParallelMove()) {
+      count += CountStackMovesIn(block->parallel_move());
+    }
+    for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+      Instruction* instr = it.Current();
+      if (instr->IsParallelMove()) {
+        count += CountStackMovesIn(instr->AsParallelMove());
+      } else if (instr->IsGoto() && instr->AsGoto()->HasParallelMove()) {
+        count += CountStackMovesIn(instr->AsGoto()->parallel_move());
+      }
+    }
+  }
+  return count;
+}
+
+
 void FlowGraphAllocator::CollectRepresentations() {
   // Parameters.
   GraphEntryInstr* graph_entry = flow_graph_.graph_entry();
@@ -2585,6 +2773,10 @@ void FlowGraphAllocator::AllocateRegisters() {
 
   ResolveControlFlow();
 
+  if (FLAG_compiler_stats) {
+    CompilerStats::num_loop_stack_moves += CountLoopStackMoves();
+  }
+
   GraphEntryInstr* entry = block_order_[0]->AsGraphEntry();
   ASSERT(entry != NULL);
   intptr_t double_spill_slot_count = spill_slots_.length() * kDoubleSpillFactor;
@@ -149,6 +149,15 @@ class FlowGraphAllocator : public ValueObject {
   // Returns true if the target location is the spill slot for the given range.
   bool TargetLocationIsSpillSlot(LiveRange* range, Location target);
 
+  // Returns true if the value should be stored into its spill slot at the
+  // splits where it is spilled rather than at its definition.
+  bool ShouldSpillAtSplit(LiveRange* range);
+  void UnmarkObjectOutsideOfSpillSlot(LiveRange* range);
+
+  // Count moves from and to stack slots inside of loops for compiler
+  // statistics.
+  intptr_t CountLoopStackMoves() const;
+
   // Update location slot corresponding to the use with location allocated for
   // the use's live range.
   void ConvertUseTo(UsePosition* use, Location loc);
@@ -175,6 +184,10 @@ class FlowGraphAllocator : public ValueObject {
   // the given loop.
   bool RangeHasOnlyUnconstrainedUsesInLoop(LiveRange* range, intptr_t loop_id);
 
+  // Find the outermost loop around the given position where the given
+  // range can stay spilled because it has no register uses there.
+  BlockInfo* FindLoopWithoutRegisterUses(LiveRange* range, intptr_t pos);
+
   // Returns true if there is a register blocked by a range that
   // has only unconstrained uses in the loop. Such range is a good
   // eviction candidate when allocator tries to allocate loop phi.
@@ -529,6 +542,7 @@ class LiveRange : public ZoneAllocated {
       next_sibling_(NULL),
       has_only_any_uses_in_loops_(0),
       is_loop_phi_(false),
+      is_spilled_at_split_(false),
       finger_() {
   }
 
@@ -605,6 +619,13 @@ class LiveRange : public ZoneAllocated {
     is_loop_phi_ = true;
   }
 
+  // The spill slot is written when the value is spilled at a split instead
+  // of at the definition.
+  bool is_spilled_at_split() const { return is_spilled_at_split_; }
+  void mark_spilled_at_split() {
+    is_spilled_at_split_ = true;
+  }
+
  private:
   LiveRange(intptr_t vreg,
             Representation rep,
@@ -624,6 +645,7 @@ class LiveRange : public ZoneAllocated {
       next_sibling_(next_sibling),
       has_only_any_uses_in_loops_(0),
       is_loop_phi_(false),
+      is_spilled_at_split_(false),
       finger_() {
   }
 
@@ -643,6 +665,7 @@ class LiveRange : public ZoneAllocated {
 
   intptr_t has_only_any_uses_in_loops_;
   bool is_loop_phi_;
+  bool is_spilled_at_split_;
 
   AllocationFinger finger_;
 
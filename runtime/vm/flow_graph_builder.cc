@@ -39,9 +39,18 @@ DEFINE_FLAG(bool, print_flow_graph_optimized, false,
             "Print the IR flow graph when optimizing.");
 DEFINE_FLAG(bool, trace_type_check_elimination, false,
             "Trace type check elimination at compile time.");
+DEFINE_FLAG(int, switch_dispatch_threshold, 6,
+            "Minimum number of Smi case constants for dispatching a switch "
+            "by binary search instead of testing the cases one by one.");
+DEFINE_FLAG(bool, use_jump_tables, true,
+            "Dispatch dense ranges of Smi case constants through a jump "
+            "table.");
 DECLARE_FLAG(bool, enable_type_checks);
 
 
+class NestedSwitch;
+
+
 // Base class for a stack of enclosing statements of interest (e.g.,
 // blocks (breakable) and loops (continuable)).
 class NestedStatement : public ValueObject {
@@ -56,6 +65,8 @@ class NestedStatement : public ValueObject {
   virtual JoinEntryInstr* BreakTargetFor(SourceLabel* label);
   virtual JoinEntryInstr* ContinueTargetFor(SourceLabel* label);
 
+  virtual NestedSwitch* AsNestedSwitch() { return NULL; }
+
  protected:
   NestedStatement(FlowGraphBuilder* owner, const SourceLabel* label)
       : owner_(owner),
@@ -160,45 +171,140 @@ JoinEntryInstr* NestedLoop::ContinueTargetFor(SourceLabel* label) {
 
 
 // A nested switch which can be the target of a break if labeled, and whose
-// cases can be the targets of continues.
+// cases can be the targets of continues.  If all case expressions of the
+// switch compare against Smi constants, the constants are also collected
+// in sorted order so that the first case clause can dispatch Smi values by
+// binary search.
 class NestedSwitch : public NestedStatement {
  public:
   NestedSwitch(FlowGraphBuilder* owner, SwitchNode* node);
 
   virtual JoinEntryInstr* ContinueTargetFor(SourceLabel* label);
 
+  virtual NestedSwitch* AsNestedSwitch() { return this; }
+
+  SourceLabel* switch_label() const { return switch_label_; }
+
+  // Returns the join starting the statements of the given case clause.
+  JoinEntryInstr* CaseTargetFor(CaseNode* node);
+
+  // The case clause that emits the binary search dispatch, or NULL if the
+  // switch is tested case by case.
+  CaseNode* dispatch_case() const {
+    return dispatch_values_.is_empty() ? NULL : case_nodes_[0];
+  }
+  CaseNode* default_case() const { return default_case_; }
+
+  intptr_t dispatch_length() const { return dispatch_values_.length(); }
+  LiteralNode* DispatchValueAt(intptr_t i) const { return dispatch_values_[i]; }
+  CaseNode* DispatchCaseAt(intptr_t i) const {
+    return case_nodes_[dispatch_cases_[i]];
+  }
+
  private:
-  GrowableArray<SourceLabel*> case_labels_;
+  JoinEntryInstr* CaseTargetAt(intptr_t index);
+  void AddDispatchValue(LiteralNode* value, intptr_t case_index);
+
+  SourceLabel* switch_label_;
+  CaseNode* default_case_;
+  GrowableArray<CaseNode*> case_nodes_;
   GrowableArray<JoinEntryInstr*> case_targets_;
+  // Smi case constants sorted by value and the index of their case clause.
+  GrowableArray<LiteralNode*> dispatch_values_;
+  GrowableArray<intptr_t> dispatch_cases_;
 };
 
 
+// Returns the Smi constant of a case expression 'constant == switch_value'
+// as built by the parser, or NULL if the case expression has another shape.
+static LiteralNode* SmiCaseConstant(AstNode* case_expr,
+                                    const LocalVariable* switch_value) {
+  ComparisonNode* comparison = case_expr->AsComparisonNode();
+  if ((comparison == NULL) || (comparison->kind() != Token::kEQ)) return NULL;
+  LiteralNode* literal = comparison->left()->AsLiteralNode();
+  LoadLocalNode* load = comparison->right()->AsLoadLocalNode();
+  if ((literal == NULL) || !literal->literal().IsSmi()) return NULL;
+  if ((load == NULL) || (&load->local() != switch_value)) return NULL;
+  return literal;
+}
+
+
 NestedSwitch::NestedSwitch(FlowGraphBuilder* owner, SwitchNode* node)
     : NestedStatement(owner, node->label()),
-      case_labels_(node->body()->length()),
+      switch_label_(node->label()),
+      default_case_(NULL),
+      case_nodes_(node->body()->length()),
       case_targets_(node->body()->length()) {
   SequenceNode* body = node->body();
+  bool is_smi_switch = true;
   for (intptr_t i = 0; i < body->length(); ++i) {
     CaseNode* case_node = body->NodeAt(i)->AsCaseNode();
     if (case_node != NULL) {
-      case_labels_.Add(case_node->label());
+      case_nodes_.Add(case_node);
       case_targets_.Add(NULL);
+      if (case_node->contains_default()) default_case_ = case_node;
+      SequenceNode* case_expressions = case_node->case_expressions();
+      for (intptr_t j = 0; is_smi_switch && (j < case_expressions->length());
+           ++j) {
+        LiteralNode* value = SmiCaseConstant(case_expressions->NodeAt(j),
+                                             case_node->switch_expr_value());
+        if (value == NULL) {
+          is_smi_switch = false;
+        } else {
+          AddDispatchValue(value, case_nodes_.length() - 1);
+        }
+      }
     }
   }
+  if (!is_smi_switch ||
+      (dispatch_values_.length() < FLAG_switch_dispatch_threshold)) {
+    dispatch_values_.Clear();
+    dispatch_cases_.Clear();
+  }
+}
+
+
+void NestedSwitch::AddDispatchValue(LiteralNode* value, intptr_t case_index) {
+  const intptr_t smi_value = Smi::Cast(value->literal()).Value();
+  intptr_t position = 0;
+  while (position < dispatch_values_.length()) {
+    const intptr_t other =
+        Smi::Cast(dispatch_values_[position]->literal()).Value();
+    // A duplicate constant can never select its later case clause.
+    if (other == smi_value) return;
+    if (other > smi_value) break;
+    ++position;
+  }
+  dispatch_values_.InsertAt(position, value);
+  dispatch_cases_.InsertAt(position, case_index);
+}
+
+
+JoinEntryInstr* NestedSwitch::CaseTargetAt(intptr_t index) {
+  // Allocate a join for the case clause.  This block is not necessarily
+  // targeted by a continue, but we always use a join in the graph anyway.
+  if (case_targets_[index] == NULL) {
+    case_targets_[index] =
+        new JoinEntryInstr(owner()->AllocateBlockId(), owner()->try_index());
+  }
+  return case_targets_[index];
+}
+
+
+JoinEntryInstr* NestedSwitch::CaseTargetFor(CaseNode* node) {
+  for (intptr_t i = 0; i < case_nodes_.length(); ++i) {
+    if (node == case_nodes_[i]) return CaseTargetAt(i);
+  }
+  UNREACHABLE();
+  return NULL;
 }
 
 
 JoinEntryInstr* NestedSwitch::ContinueTargetFor(SourceLabel* label) {
-  // Allocate a join for a case clause that matches the label.  This block
-  // is not necessarily targeted by a continue, but we always use a join in
-  // the graph anyway.
-  for (intptr_t i = 0; i < case_labels_.length(); ++i) {
-    if (label != case_labels_[i]) continue;
-    if (case_targets_[i] == NULL) {
-      case_targets_[i] =
-          new JoinEntryInstr(owner()->AllocateBlockId(), owner()->try_index());
+  for (intptr_t i = 0; i < case_nodes_.length(); ++i) {
+    if ((label != NULL) && (label == case_nodes_[i]->label())) {
+      return CaseTargetAt(i);
     }
-    return case_targets_[i];
   }
   return NULL;
 }
@@ -1767,19 +1873,13 @@ void EffectGraphVisitor::VisitCaseNode(CaseNode* node) {
   const intptr_t len = node->case_expressions()->length();
   // Create case statements instructions.
   EffectGraphVisitor for_case_statements(owner());
-  // Compute the start of the statements fragment.
-  JoinEntryInstr* statement_start = NULL;
-  if (node->label() == NULL) {
-    statement_start = new JoinEntryInstr(owner()->AllocateBlockId(),
-                                         owner()->try_index());
-  } else {
-    // The case nodes are nested inside a SequenceNode that is the body of a
-    // SwitchNode.  The SwitchNode on the nesting stack contains the
-    // continue labels for all the case clauses.
-    statement_start =
-        owner()->nesting_stack()->outer()->ContinueTargetFor(node->label());
-  }
-  ASSERT(statement_start != NULL);
+  // Compute the start of the statements fragment.  The case nodes are nested
+  // inside a SequenceNode that is the body of a SwitchNode.  The SwitchNode on
+  // the nesting stack contains the targets for all the case clauses.
+  NestedSwitch* nested_switch =
+      owner()->nesting_stack()->outer()->AsNestedSwitch();
+  ASSERT(nested_switch != NULL);
+  JoinEntryInstr* statement_start = nested_switch->CaseTargetFor(node);
   node->statements()->Visit(&for_case_statements);
   Instruction* statement_exit =
       AppendFragment(statement_start, for_case_statements);
@@ -1791,6 +1891,11 @@ void EffectGraphVisitor::VisitCaseNode(CaseNode* node) {
     return;
   }
 
+  // Smi switch values skip the case expressions below.
+  if (nested_switch->dispatch_case() == node) {
+    BuildSwitchDispatch(nested_switch, node);
+  }
+
   // Generate instructions for all case expressions.
   TargetEntryInstr* next_target = NULL;
   for (intptr_t i = 0; i < len; i++) {
@@ -1843,6 +1948,201 @@ void EffectGraphVisitor::VisitCaseNode(CaseNode* node) {
 }
 
 
+// Dispatches Smi values of the switch expression by a binary search over the
+// sorted Smi case constants, which replaces the linear chain of case
+// expressions for switches with many cases.  All other values continue with
+// the case expressions, which implement the full '==' semantics:
+//   a) [ class-id(switch-value) === kSmiCid ] -> (search-target, exit-target)
+//   b) search-target
+//   c) [ binary search or jump table ] ->
+//          (case-statements-join-i ..., no-match-join)
+//   d) no-match-join -> (default-statements-join or break)
+//   e) exit-target
+void EffectGraphVisitor::BuildSwitchDispatch(NestedSwitch* nested_switch,
+                                             CaseNode* node) {
+  const intptr_t token_pos = node->token_pos();
+  Value* switch_value = Bind(BuildLoadLocal(*node->switch_expr_value()));
+  Value* class_id = Bind(new LoadClassIdInstr(switch_value));
+  Value* smi_cid =
+      Bind(new ConstantInstr(Smi::ZoneHandle(Smi::New(kSmiCid))));
+  BranchInstr* branch = new BranchInstr(
+      new StrictCompareInstr(token_pos,
+                             Token::kEQ_STRICT,
+                             class_id,
+                             smi_cid,
+                             false));  // No number check.
+  AddInstruction(branch);
+  CloseFragment();
+
+  TargetEntryInstr* search_target =
+      new TargetEntryInstr(owner()->AllocateBlockId(), owner()->try_index());
+  TargetEntryInstr* exit_target =
+      new TargetEntryInstr(owner()->AllocateBlockId(), owner()->try_index());
+  *branch->true_successor_address() = search_target;
+  *branch->false_successor_address() = exit_target;
+
+  JoinEntryInstr* no_match =
+      new JoinEntryInstr(owner()->AllocateBlockId(), owner()->try_index());
+  EffectGraphVisitor for_search(owner());
+  for_search.BuildSwitchSearch(nested_switch,
+                               node,
+                               0,
+                               nested_switch->dispatch_length(),
+                               no_match);
+  AppendFragment(search_target, for_search);
+
+  // Without a default clause, an unmatched value leaves the switch like a
+  // break, which also unchains a context allocated by the switch body.
+  EffectGraphVisitor for_no_match(owner());
+  if (nested_switch->default_case() != NULL) {
+    for_no_match.Goto(
+        nested_switch->CaseTargetFor(nested_switch->default_case()));
+  } else {
+    JumpNode* jump =
+        new JumpNode(token_pos, Token::kBREAK, nested_switch->switch_label());
+    jump->Visit(&for_no_match);
+  }
+  AppendFragment(no_match, for_no_match);
+
+  exit_ = exit_target;
+}
+
+
+static intptr_t DispatchSmiValueAt(NestedSwitch* nested_switch, intptr_t i) {
+  return Smi::Cast(nested_switch->DispatchValueAt(i)->literal()).Value();
+}
+
+
+// Whether the dispatch constants [from, to) are enough and fill at least half
+// of the range from the first to the last one, so that a jump table is both
+// cheaper than a search and small.  The binary search below tests the dense
+// parts of a sparse switch again.
+static bool IsDenseSwitchRange(NestedSwitch* nested_switch,
+                               intptr_t from,
+                               intptr_t to) {
+  const intptr_t kMinJumpTableLength = 4;
+  const intptr_t count = to - from;
+  if (count < kMinJumpTableLength) return false;
+  const intptr_t span = DispatchSmiValueAt(nested_switch, to - 1) -
+                        DispatchSmiValueAt(nested_switch, from) + 1;
+  return span <= (2 * count);
+}
+
+
+// Dispatches the Smi switch value through a table indexed by the value for
+// the dense dispatch constants [from, to).  Values without a constant in the
+// range go to 'no_match':
+//   a) [ jump table ] -> (case-target-i ..., no-match-target)
+//   b) case-target-i -> case-statements-join-i
+//   c) no-match-target -> no-match-join
+void EffectGraphVisitor::BuildSwitchJumpTable(NestedSwitch* nested_switch,
+                                              CaseNode* node,
+                                              intptr_t from,
+                                              intptr_t to,
+                                              JoinEntryInstr* no_match) {
+  const intptr_t lower_bound = DispatchSmiValueAt(nested_switch, from);
+  const intptr_t upper_bound = DispatchSmiValueAt(nested_switch, to - 1);
+  Value* switch_value = Bind(BuildLoadLocal(*node->switch_expr_value()));
+  JumpTableInstr* jump_table =
+      new JumpTableInstr(switch_value,
+                         lower_bound,
+                         upper_bound - lower_bound + 1);
+  AddInstruction(jump_table);
+  CloseFragment();
+
+  // Edges into joins have to leave from blocks with a single successor, so
+  // each distinct case clause is entered through its own target.
+  TargetEntryInstr* no_match_target =
+      new TargetEntryInstr(owner()->AllocateBlockId(), owner()->try_index());
+  no_match_target->Goto(no_match);
+  jump_table->set_default_target(no_match_target);
+  GrowableArray<JoinEntryInstr*> joins(to - from);
+  GrowableArray<TargetEntryInstr*> targets(to - from);
+  for (intptr_t i = from; i < to; i++) {
+    JoinEntryInstr* join =
+        nested_switch->CaseTargetFor(nested_switch->DispatchCaseAt(i));
+    TargetEntryInstr* target = NULL;
+    for (intptr_t j = 0; j < joins.length(); j++) {
+      if (joins[j] == join) target = targets[j];
+    }
+    if (target == NULL) {
+      target = new TargetEntryInstr(owner()->AllocateBlockId(),
+                                    owner()->try_index());
+      target->Goto(join);
+      joins.Add(join);
+      targets.Add(target);
+    }
+    jump_table->SetTargetAt(
+        DispatchSmiValueAt(nested_switch, i) - lower_bound, target);
+  }
+  for (intptr_t i = 0; i < jump_table->length(); i++) {
+    if (jump_table->TargetAt(i) == NULL) {
+      jump_table->SetTargetAt(i, no_match_target);
+    }
+  }
+}
+
+
+// Tests the Smi switch value against the dispatch constants [from, to) and
+// closes the fragment with jumps to the matching case clauses or to
+// 'no_match'.  Dense ranges are dispatched through a jump table instead.
+void EffectGraphVisitor::BuildSwitchSearch(NestedSwitch* nested_switch,
+                                           CaseNode* node,
+                                           intptr_t from,
+                                           intptr_t to,
+                                           JoinEntryInstr* no_match) {
+  // Ranges this short are cheaper to test value by value.
+  const intptr_t kMaxLinearSearchLength = 2;
+  ASSERT(from < to);
+  if (FLAG_use_jump_tables && IsDenseSwitchRange(nested_switch, from, to)) {
+    BuildSwitchJumpTable(nested_switch, node, from, to, no_match);
+    return;
+  }
+  const intptr_t token_pos = node->token_pos();
+  LocalVariable* switch_value = node->switch_expr_value();
+  if ((to - from) <= kMaxLinearSearchLength) {
+    BlockEntryInstr* next = NULL;
+    for (intptr_t i = from; i < to; i++) {
+      TestGraphVisitor for_test(owner(), token_pos);
+      ComparisonNode* comparison =
+          new ComparisonNode(token_pos,
+                             Token::kEQ_STRICT,
+                             new LoadLocalNode(token_pos, switch_value),
+                             nested_switch->DispatchValueAt(i));
+      comparison->Visit(&for_test);
+      if (next == NULL) {
+        Append(for_test);
+      } else {
+        AppendFragment(next, for_test);
+      }
+      for_test.IfTrueGoto(
+          nested_switch->CaseTargetFor(nested_switch->DispatchCaseAt(i)));
+      next = for_test.CreateFalseSuccessor();
+    }
+    next->Goto(no_match);
+    return;
+  }
+
+  const intptr_t middle = from + (to - from) / 2;
+  TestGraphVisitor for_test(owner(), token_pos);
+  ComparisonNode* comparison =
+      new ComparisonNode(token_pos,
+                         Token::kLT,
+                         new LoadLocalNode(token_pos, switch_value),
+                         nested_switch->DispatchValueAt(middle));
+  comparison->Visit(&for_test);
+  Append(for_test);
+
+  EffectGraphVisitor for_lower(owner());
+  for_lower.BuildSwitchSearch(nested_switch, node, from, middle, no_match);
+  AppendFragment(for_test.CreateTrueSuccessor(), for_lower);
+
+  EffectGraphVisitor for_upper(owner());
+  for_upper.BuildSwitchSearch(nested_switch, node, middle, to, no_match);
+  AppendFragment(for_test.CreateFalseSuccessor(), for_upper);
+}
+
+
 // <Statement> ::= While { label:     SourceLabel
 //                         condition: <Expression>
 //                         body:      <Sequence> }
@@ -2282,6 +2582,7 @@ void EffectGraphVisitor::VisitClosureNode(ClosureNode* node) {
             alloc->cls(),
             0));  // No token position.
     function_field.SetOffset(Closure::function_offset());
+    function_field.set_is_unboxing_candidate(false);
     const Field& context_field =
         Field::ZoneHandle(Field::New(
             Symbols::ClosureContextField(),
@@ -2291,6 +2592,7 @@ void EffectGraphVisitor::VisitClosureNode(ClosureNode* node) {
             alloc->cls(),
             0));  // No token position.
     context_field.SetOffset(Closure::context_offset());
+    context_field.set_is_unboxing_candidate(false);
     alloc->set_context_field(context_field);
 
     Value* closure_val = Bind(alloc);
@@ -26,6 +26,7 @@ class ParsedFunction;
 class String;
 
 class NestedStatement;
+class NestedSwitch;
 class TestGraphVisitor;
 
 // List of recognized list factories:
@@ -417,6 +418,19 @@ class EffectGraphVisitor : public AstNodeVisitor {
 
   void BuildLetTempExpressions(LetNode* node);
 
+  // Helpers for dispatching switches on Smi case constants.
+  void BuildSwitchDispatch(NestedSwitch* nested_switch, CaseNode* node);
+  void BuildSwitchSearch(NestedSwitch* nested_switch,
+                         CaseNode* node,
+                         intptr_t from,
+                         intptr_t to,
+                         JoinEntryInstr* no_match);
+  void BuildSwitchJumpTable(NestedSwitch* nested_switch,
+                            CaseNode* node,
+                            intptr_t from,
+                            intptr_t to,
+                            JoinEntryInstr* no_match);
+
  private:
   friend class TempLocalScope;  // For ReturnDefinition.
 
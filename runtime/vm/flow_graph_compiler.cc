@@ -22,10 +22,12 @@
 
 namespace dart {
 
+DECLARE_FLAG(int, baseline_optimization_counter_threshold);
 DECLARE_FLAG(bool, code_comments);
 DECLARE_FLAG(bool, enable_type_checks);
 DECLARE_FLAG(bool, intrinsify);
 DECLARE_FLAG(bool, propagate_ic_data);
+DECLARE_FLAG(int, reoptimization_counter_threshold);
 DECLARE_FLAG(bool, report_usage_count);
 DECLARE_FLAG(int, optimization_counter_threshold);
 DECLARE_FLAG(bool, use_cha);
@@ -49,6 +51,21 @@ void CompilerDeoptInfo::AllocateIncomingParametersRecursive(
 }
 
 
+// Materializations referenced from the fields of another materialization are
+// added first so that the reference can be resolved to their index.
+static void AddMaterializationRecursive(MaterializeObjectInstr* mat,
+                                        DeoptInfoBuilder* builder) {
+  for (intptr_t i = 0; i < mat->InputCount(); i++) {
+    MaterializeObjectInstr* inner_mat =
+        mat->InputAt(i)->definition()->AsMaterializeObject();
+    if (inner_mat != NULL) {
+      AddMaterializationRecursive(inner_mat, builder);
+    }
+  }
+  builder->AddMaterialization(mat);
+}
+
+
 void CompilerDeoptInfo::EmitMaterializations(Environment* env,
                                              DeoptInfoBuilder* builder) {
   for (Environment::DeepIterator it(env); !it.Done(); it.Advance()) {
@@ -56,7 +73,7 @@ void CompilerDeoptInfo::EmitMaterializations(Environment* env,
       MaterializeObjectInstr* mat =
           it.CurrentValue()->definition()->AsMaterializeObject();
       ASSERT(mat != NULL);
-      builder->AddMaterialization(mat);
+      AddMaterializationRecursive(mat, builder);
     }
   }
 }
@@ -166,6 +183,28 @@ bool FlowGraphCompiler::CanOSRFunction() const {
 }
 
 
+bool FlowGraphCompiler::CountsEntries() const {
+  return !is_optimizing() || flow_graph().is_baseline();
+}
+
+
+intptr_t FlowGraphCompiler::EntryCounterThreshold() const {
+  if (is_optimizing() && !flow_graph().is_baseline()) {
+    // Reoptimization of an optimized function is triggered by counting in
+    // IC stubs, but not at the entry of the function.
+    return FLAG_reoptimization_counter_threshold;
+  }
+  if (!is_optimizing() &&
+      (FLAG_baseline_optimization_counter_threshold >= 0) &&
+      (FLAG_baseline_optimization_counter_threshold <
+           FLAG_optimization_counter_threshold)) {
+    // Enter the baseline tier first.
+    return FLAG_baseline_optimization_counter_threshold;
+  }
+  return FLAG_optimization_counter_threshold;
+}
+
+
 static bool IsEmptyBlock(BlockEntryInstr* block) {
   return !block->HasParallelMove() &&
          block->next()->IsGoto() &&
@@ -448,8 +487,8 @@ void FlowGraphCompiler::RecordSafepoint(LocationSummary* locs) {
       // highest address (i.e., first in the stackmap).
       for (intptr_t i = 0; i < kNumberOfCpuRegisters; ++i) {
         Register reg = static_cast<Register>(i);
-        if (locs->live_registers()->ContainsRegister(reg)) {
-          bitmap->Set(bitmap->Length(), true);
+        if (regs->ContainsRegister(reg)) {
+          bitmap->Set(bitmap->Length(), regs->IsTagged(reg));
         }
       }
     }
@@ -637,8 +676,12 @@ void FlowGraphCompiler::TryIntrinsify() {
       ASSERT(return_node.value()->IsLoadInstanceFieldNode());
       const LoadInstanceFieldNode& load_node =
           *return_node.value()->AsLoadInstanceFieldNode();
-      GenerateInlinedGetter(load_node.field().Offset());
-      return;
+      // The inlined getter would return the box of an unboxed field instead
+      // of a copy of it.
+      if (!load_node.field().IsPotentialUnboxedField()) {
+        GenerateInlinedGetter(load_node.field().Offset());
+        return;
+      }
     }
     if (parsed_function().function().kind() == RawFunction::kImplicitSetter) {
       // An implicit setter must have a specific AST structure.
@@ -245,6 +245,9 @@ class FlowGraphCompiler : public ValueObject {
   ~FlowGraphCompiler();
 
   static bool SupportsUnboxedMints();
+  // Whether optimized megamorphic calls look their target up in the rows of
+  // the megamorphic dispatch table before probing the cache.
+  static bool SupportsMegamorphicDispatchTable();
 
   // Accessors.
   Assembler* assembler() const { return assembler_; }
@@ -267,6 +270,12 @@ class FlowGraphCompiler : public ValueObject {
   bool CanOSRFunction() const;
   bool is_optimizing() const { return is_optimizing_; }
 
+  // Unoptimized and baseline code increment the usage counter on entry;
+  // fully optimized code only checks it for reoptimization.
+  bool CountsEntries() const;
+  // Usage counter value at which the entry calls into the optimizer.
+  intptr_t EntryCounterThreshold() const;
+
   const GrowableArray<BlockInfo*>& block_info() const { return block_info_; }
   ParallelMoveResolver* parallel_move_resolver() {
     return &parallel_move_resolver_;
@@ -23,8 +23,6 @@ namespace dart {
 
 DEFINE_FLAG(bool, trap_on_deoptimization, false, "Trap on deoptimization.");
 DEFINE_FLAG(bool, unbox_mints, true, "Optimize 64-bit integer arithmetic.");
-DECLARE_FLAG(int, optimization_counter_threshold);
-DECLARE_FLAG(int, reoptimization_counter_threshold);
 DECLARE_FLAG(bool, enable_type_checks);
 DECLARE_FLAG(bool, eliminate_type_checks);
 DECLARE_FLAG(bool, throw_on_javascript_int_overflow);
@@ -46,6 +44,11 @@ bool FlowGraphCompiler::SupportsUnboxedMints() {
 }
 
 
+bool FlowGraphCompiler::SupportsMegamorphicDispatchTable() {
+  return true;
+}
+
+
 RawDeoptInfo* CompilerDeoptInfo::CreateDeoptInfo(FlowGraphCompiler* compiler,
                                                  DeoptInfoBuilder* builder,
                                                  const Array& deopt_table) {
@@ -1060,23 +1063,18 @@ void FlowGraphCompiler::EmitFrameEntry() {
   const Function& function = parsed_function().function();
   if (CanOptimizeFunction() &&
       function.is_optimizable() &&
-      (!is_optimizing() || may_reoptimize())) {
+      (CountsEntries() || may_reoptimize())) {
     const Register function_reg = EDI;
     __ LoadObject(function_reg, function);
     // Patch point is after the eventually inlined function object.
     AddCurrentDescriptor(PcDescriptors::kEntryPatch,
                          Isolate::kNoDeoptId,
                          0);  // No token position.
-    if (is_optimizing()) {
-      // Reoptimization of an optimized function is triggered by counting in
-      // IC stubs, but not at the entry of the function.
-      __ cmpl(FieldAddress(function_reg, Function::usage_counter_offset()),
-              Immediate(FLAG_reoptimization_counter_threshold));
-    } else {
+    if (CountsEntries()) {
       __ incl(FieldAddress(function_reg, Function::usage_counter_offset()));
-      __ cmpl(FieldAddress(function_reg, Function::usage_counter_offset()),
-              Immediate(FLAG_optimization_counter_threshold));
     }
+    __ cmpl(FieldAddress(function_reg, Function::usage_counter_offset()),
+            Immediate(EntryCounterThreshold()));
     ASSERT(function_reg == EDI);
     __ j(GREATER_EQUAL, &StubCode::OptimizeFunctionLabel());
   } else if (!flow_graph().IsCompiledForOsr()) {
@@ -1370,20 +1368,34 @@ void FlowGraphCompiler::EmitMegamorphicInstanceCall(
   // EAX: class ID of the receiver (smi).
   __ Bind(&load_cache);
   __ LoadObject(EBX, cache);
+  // Look the target up in the row of the cache in the dispatch table first.
+  __ movl(EDI, FieldAddress(EBX, MegamorphicCache::dispatch_table_offset()));
+  __ movl(ECX, FieldAddress(EBX, MegamorphicCache::row_offset_offset()));
+  __ addl(ECX, EAX);
+  // ECX: index of the dispatch table entry (smi).  Table entries are two
+  // words, so twice the index must be below the smi-tagged array length.
+  Label probe_cache, loop, update, call_target_function;
+  __ movl(EDX, ECX);
+  __ addl(EDX, EDX);
+  __ cmpl(EDX, FieldAddress(EDI, Array::length_offset()));
+  __ j(ABOVE_EQUAL, &probe_cache, Assembler::kNearJump);
+  const intptr_t base = Array::data_offset();
+  __ cmpl(EBX, FieldAddress(EDI, ECX, TIMES_4, base));
+  __ j(EQUAL, &call_target_function, Assembler::kNearJump);
+
+  // The class ID is not in the row of this cache, probe the cache itself.
+  __ Bind(&probe_cache);
   __ movl(EDI, FieldAddress(EBX, MegamorphicCache::buckets_offset()));
   __ movl(EBX, FieldAddress(EBX, MegamorphicCache::mask_offset()));
   // EDI: cache buckets array.
   // EBX: mask.
   __ movl(ECX, EAX);
-
-  Label loop, update, call_target_function;
   __ jmp(&loop);
 
   __ Bind(&update);
   __ addl(ECX, Immediate(Smi::RawValue(1)));
   __ Bind(&loop);
   __ andl(ECX, EBX);
-  const intptr_t base = Array::data_offset();
   // ECX is smi tagged, but table entries are two words, so TIMES_4.
   __ movl(EDX, FieldAddress(EDI, ECX, TIMES_4, base));
 
@@ -1394,10 +1406,10 @@ void FlowGraphCompiler::EmitMegamorphicInstanceCall(
   __ j(NOT_EQUAL, &update, Assembler::kNearJump);
 
   __ Bind(&call_target_function);
-  // Call the target found in the cache.  For a class id match, this is a
-  // proper target for the given name and arguments descriptor.  If the
-  // illegal class id was found, the target is a cache miss handler that can
-  // be invoked as a normal Dart function.
+  // Call the target found in the dispatch table or the cache.  For a class
+  // id match, this is a proper target for the given name and arguments
+  // descriptor.  If the illegal class id was found, the target is a cache
+  // miss handler that can be invoked as a normal Dart function.
   __ movl(EAX, FieldAddress(EDI, ECX, TIMES_4, base + kWordSize));
   __ movl(EBX, FieldAddress(EAX, Function::code_offset()));
   if (FLAG_collect_code) {
@@ -22,8 +22,6 @@
 namespace dart {
 
 DEFINE_FLAG(bool, trap_on_deoptimization, false, "Trap on deoptimization.");
-DECLARE_FLAG(int, optimization_counter_threshold);
-DECLARE_FLAG(int, reoptimization_counter_threshold);
 DECLARE_FLAG(bool, enable_type_checks);
 DECLARE_FLAG(bool, eliminate_type_checks);
 
@@ -42,6 +40,12 @@ bool FlowGraphCompiler::SupportsUnboxedMints() {
 }
 
 
+bool FlowGraphCompiler::SupportsMegamorphicDispatchTable() {
+  // Megamorphic calls only probe the cache, so the rows are not filled.
+  return false;
+}
+
+
 RawDeoptInfo* CompilerDeoptInfo::CreateDeoptInfo(FlowGraphCompiler* compiler,
                                                  DeoptInfoBuilder* builder,
                                                  const Array& deopt_table) {
@@ -1061,7 +1065,7 @@ void FlowGraphCompiler::EmitFrameEntry() {
   const Function& function = parsed_function().function();
   if (CanOptimizeFunction() &&
       function.is_optimizable() &&
-      (!is_optimizing() || may_reoptimize())) {
+      (CountsEntries() || may_reoptimize())) {
     const Register function_reg = T0;
 
     __ GetNextPC(T2, TMP);
@@ -1084,13 +1088,9 @@ void FlowGraphCompiler::EmitFrameEntry() {
     AddCurrentDescriptor(PcDescriptors::kEntryPatch,
                          Isolate::kNoDeoptId,
                          0);  // No token position.
-    intptr_t threshold = FLAG_optimization_counter_threshold;
+    const intptr_t threshold = EntryCounterThreshold();
     __ lw(T1, FieldAddress(function_reg, Function::usage_counter_offset()));
-    if (is_optimizing()) {
-      // Reoptimization of an optimized function is triggered by counting in
-      // IC stubs, but not at the entry of the function.
-      threshold = FLAG_reoptimization_counter_threshold;
-    } else {
+    if (CountsEntries()) {
       __ addiu(T1, T1, Immediate(1));
       __ sw(T1, FieldAddress(function_reg, Function::usage_counter_offset()));
     }
@@ -22,8 +22,6 @@
 namespace dart {
 
 DEFINE_FLAG(bool, trap_on_deoptimization, false, "Trap on deoptimization.");
-DECLARE_FLAG(int, optimization_counter_threshold);
-DECLARE_FLAG(int, reoptimization_counter_threshold);
 DECLARE_FLAG(bool, enable_type_checks);
 DECLARE_FLAG(bool, eliminate_type_checks);
 
@@ -43,6 +41,11 @@ bool FlowGraphCompiler::SupportsUnboxedMints() {
 }
 
 
+bool FlowGraphCompiler::SupportsMegamorphicDispatchTable() {
+  return true;
+}
+
+
 RawDeoptInfo* CompilerDeoptInfo::CreateDeoptInfo(FlowGraphCompiler* compiler,
                                                  DeoptInfoBuilder* builder,
                                                  const Array& deopt_table) {
@@ -1042,7 +1045,7 @@ void FlowGraphCompiler::EmitFrameEntry() {
   Register new_pc = kNoRegister;
   if (CanOptimizeFunction() &&
       function.is_optimizable() &&
-      (!is_optimizing() || may_reoptimize())) {
+      (CountsEntries() || may_reoptimize())) {
     const Register function_reg = RDI;
     new_pp = R13;
     new_pc = R12;
@@ -1072,20 +1075,13 @@ void FlowGraphCompiler::EmitFrameEntry() {
     AddCurrentDescriptor(PcDescriptors::kEntryPatch,
                          Isolate::kNoDeoptId,
                          0);  // No token position.
-    if (is_optimizing()) {
-      // Reoptimization of an optimized function is triggered by counting in
-      // IC stubs, but not at the entry of the function.
-      __ CompareImmediate(
-          FieldAddress(function_reg, Function::usage_counter_offset()),
-          Immediate(FLAG_reoptimization_counter_threshold),
-          new_pp);
-    } else {
+    if (CountsEntries()) {
       __ incq(FieldAddress(function_reg, Function::usage_counter_offset()));
-      __ CompareImmediate(
-          FieldAddress(function_reg, Function::usage_counter_offset()),
-          Immediate(FLAG_optimization_counter_threshold),
-          new_pp);
     }
+    __ CompareImmediate(
+        FieldAddress(function_reg, Function::usage_counter_offset()),
+        Immediate(EntryCounterThreshold()),
+        new_pp);
     ASSERT(function_reg == RDI);
     __ J(GREATER_EQUAL, &StubCode::OptimizeFunctionLabel(), R13);
   } else if (!flow_graph().IsCompiledForOsr()) {
@@ -1403,20 +1399,34 @@ void FlowGraphCompiler::EmitMegamorphicInstanceCall(
   // RAX: class ID of the receiver (smi).
   __ Bind(&load_cache);
   __ LoadObject(RBX, cache, PP);
+  // Look the target up in the row of the cache in the dispatch table first.
+  __ movq(RDI, FieldAddress(RBX, MegamorphicCache::dispatch_table_offset()));
+  __ movq(RCX, FieldAddress(RBX, MegamorphicCache::row_offset_offset()));
+  __ addq(RCX, RAX);
+  // RCX: index of the dispatch table entry (smi).  Table entries are two
+  // words, so twice the index must be below the smi-tagged array length.
+  Label probe_cache, loop, update, call_target_function;
+  __ movq(RDX, RCX);
+  __ addq(RDX, RDX);
+  __ cmpq(RDX, FieldAddress(RDI, Array::length_offset()));
+  __ j(ABOVE_EQUAL, &probe_cache, Assembler::kNearJump);
+  const intptr_t base = Array::data_offset();
+  __ cmpq(RBX, FieldAddress(RDI, RCX, TIMES_8, base));
+  __ j(EQUAL, &call_target_function, Assembler::kNearJump);
+
+  // The class ID is not in the row of this cache, probe the cache itself.
+  __ Bind(&probe_cache);
   __ movq(RDI, FieldAddress(RBX, MegamorphicCache::buckets_offset()));
   __ movq(RBX, FieldAddress(RBX, MegamorphicCache::mask_offset()));
   // RDI: cache buckets array.
   // RBX: mask.
   __ movq(RCX, RAX);
-
-  Label loop, update, call_target_function;
   __ jmp(&loop);
 
   __ Bind(&update);
   __ AddImmediate(RCX, Immediate(Smi::RawValue(1)), PP);
   __ Bind(&loop);
   __ andq(RCX, RBX);
-  const intptr_t base = Array::data_offset();
   // RCX is smi tagged, but table entries are two words, so TIMES_8.
   __ movq(RDX, FieldAddress(RDI, RCX, TIMES_8, base));
 
@@ -1427,10 +1437,10 @@ void FlowGraphCompiler::EmitMegamorphicInstanceCall(
   __ j(NOT_EQUAL, &update, Assembler::kNearJump);
 
   __ Bind(&call_target_function);
-  // Call the target found in the cache.  For a class id match, this is a
-  // proper target for the given name and arguments descriptor.  If the
-  // illegal class id was found, the target is a cache miss handler that can
-  // be invoked as a normal Dart function.
+  // Call the target found in the dispatch table or the cache.  For a class
+  // id match, this is a proper target for the given name and arguments
+  // descriptor.  If the illegal class id was found, the target is a cache
+  // miss handler that can be invoked as a normal Dart function.
   __ movq(RAX, FieldAddress(RDI, RCX, TIMES_8, base + kWordSize));
   __ movq(RBX, FieldAddress(RAX, Function::code_offset()));
   if (FLAG_collect_code) {
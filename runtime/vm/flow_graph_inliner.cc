@@ -352,7 +352,8 @@ class CallSiteInliner : public ValueObject {
         inlining_depth_(1),
         collected_call_sites_(NULL),
         inlining_call_sites_(NULL),
-        function_cache_() { }
+        function_cache_(),
+        bailout_cache_() { }
 
   FlowGraph* caller_graph() const { return caller_graph_; }
 
@@ -436,6 +437,16 @@ class CallSiteInliner : public ValueObject {
       return false;
     }
 
+    // Abort if building the graph of this function bailed out before. The
+    // reasons for such bailouts (e.g. try-catch or native bodies) do not
+    // depend on the call site. Checked before the inlinable bit, which the
+    // bailout may have cleared as well.
+    if (IsBailoutCached(function)) {
+      CompilerStats::num_inliner_bailout_cache_hits++;
+      TRACE_INLINING(OS::Print("     Bailout: cached bailout\n"));
+      return false;
+    }
+
     // Make a handle for the unoptimized code so that it is not disconnected
     // from the function while we are trying to inline it.
     const Code& unoptimized_code = Code::Handle(function.unoptimized_code());
@@ -496,6 +507,14 @@ class CallSiteInliner : public ValueObject {
         parsed_function = GetParsedFunction(function, &in_cache);
       }
 
+      // Add the function to the cache. It is reused at the other call sites
+      // of this function even if it is not inlined here.
+      if (in_cache) {
+        CompilerStats::num_inliner_parse_cache_hits++;
+      } else {
+        function_cache_.Add(parsed_function);
+      }
+
       // Load IC data for the callee.
       Array& ic_data_array = Array::Handle();
 
@@ -624,11 +643,6 @@ class CallSiteInliner : public ValueObject {
 
       collected_call_sites_->FindCallSites(callee_graph, inlining_depth_);
 
-      // Add the function to the cache.
-      if (!in_cache) {
-        function_cache_.Add(parsed_function);
-      }
-
       // Build succeeded so we restore the bailout jump.
       inlined_ = true;
       inlined_size_ += size;
@@ -657,6 +671,7 @@ class CallSiteInliner : public ValueObject {
       isolate->object_store()->clear_sticky_error();
       isolate->set_long_jump_base(base);
       isolate->set_deopt_id(prev_deopt_id);
+      bailout_cache_.Add(&Function::ZoneHandle(function.raw()));
       TRACE_INLINING(OS::Print("     Bailout: %s\n", error.ToErrorCString()));
       return false;
     }
@@ -760,6 +775,15 @@ class CallSiteInliner : public ValueObject {
     return parsed_function;
   }
 
+  bool IsBailoutCached(const Function& function) const {
+    for (intptr_t i = 0; i < bailout_cache_.length(); ++i) {
+      if (bailout_cache_[i]->raw() == function.raw()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   // Include special handling for List. factory: inlining it is not helpful
   // if the incoming argument is a non-constant value.
   // TODO(srdjan): Fix inlining of List. factory.
@@ -976,7 +1000,10 @@ class CallSiteInliner : public ValueObject {
   intptr_t inlining_depth_;
   CallSites* collected_call_sites_;
   CallSites* inlining_call_sites_;
+  // Functions parsed during this compilation, whether inlined or not.
   GrowableArray<ParsedFunction*> function_cache_;
+  // Functions whose graph building bailed out during this compilation.
+  GrowableArray<const Function*> bailout_cache_;
 
   DISALLOW_COPY_AND_ASSIGN(CallSiteInliner);
 };
@@ -23,6 +23,9 @@ namespace dart {
 
 DEFINE_FLAG(bool, array_bounds_check_elimination, true,
     "Eliminate redundant bounds checks.");
+DEFINE_FLAG(bool, hoist_bounds_checks, true,
+    "Speculatively replace bounds checks in loops with checks of the loop "
+    "bounds in the loop pre-header.");
 DEFINE_FLAG(bool, load_cse, true, "Use redundant load elimination.");
 DEFINE_FLAG(int, max_polymorphic_checks, 4,
     "Maximum number of polymorphic check, otherwise it is megamorphic.");
@@ -36,14 +39,23 @@ DEFINE_FLAG(bool, trace_optimization, false, "Print optimization details.");
 DEFINE_FLAG(bool, trace_range_analysis, false, "Trace range analysis progress");
 DEFINE_FLAG(bool, truncating_left_shift, true,
     "Optimize left shift to truncate if possible");
+DEFINE_FLAG(bool, unbox_int32, true,
+    "Use unboxed int32 arithmetic where range analysis proves that integer "
+    "values fit into 32 bits.");
+DEFINE_FLAG(bool, unbox_uint32, true,
+    "Use unboxed uint32 arithmetic where only the low 32 bits of an integer "
+    "result are observed.");
 DEFINE_FLAG(bool, use_cha, true, "Use class hierarchy analysis.");
 DEFINE_FLAG(bool, trace_load_optimization, false,
     "Print live sets for load optimization pass.");
 DEFINE_FLAG(bool, enable_simd_inline, true,
     "Enable inlining of SIMD related method calls.");
+DECLARE_FLAG(int, deoptimization_counter_licm_threshold);
 DECLARE_FLAG(bool, eliminate_type_checks);
+DECLARE_FLAG(bool, pretenure);
 DECLARE_FLAG(bool, enable_type_checks);
 DECLARE_FLAG(bool, trace_type_check_elimination);
+DECLARE_FLAG(bool, throw_on_javascript_int_overflow);
 
 
 static bool ShouldInlineSimd() {
@@ -160,7 +172,7 @@ static const ICData& SpecializeICData(const ICData& ic_data, intptr_t cid) {
       Object::empty_array(),  // Dummy argument descriptor.
       ic_data.deopt_id(),
       ic_data.num_args_tested()));
-  new_ic_data.set_deopt_reason(ic_data.deopt_reason());
+  new_ic_data.set_deopt_reasons(ic_data.deopt_reasons());
 
   const Function& function =
       Function::Handle(ic_data.GetTargetForReceiverClassId(cid));
@@ -494,6 +506,22 @@ void FlowGraphOptimizer::InsertConversion(Representation from,
     converted = new UnboxInt32x4Instr(use->CopyWithType(), deopt_id);
   } else if ((from == kUnboxedInt32x4) && (to == kTagged)) {
     converted = new BoxInt32x4Instr(use->CopyWithType());
+  } else if ((from == kTagged) && (to == kUnboxedUint32)) {
+    const intptr_t deopt_id = (deopt_target != NULL) ?
+        deopt_target->DeoptimizationTarget() : Isolate::kNoDeoptId;
+    converted = new UnboxUint32Instr(use->CopyWithType(), deopt_id);
+  } else if ((from == kUnboxedUint32) && (to == kTagged)) {
+    converted = new BoxUint32Instr(use->CopyWithType());
+  } else if ((from == kTagged) && (to == kUnboxedInt32)) {
+    const intptr_t deopt_id = (deopt_target != NULL) ?
+        deopt_target->DeoptimizationTarget() : Isolate::kNoDeoptId;
+    converted = new UnboxInt32Instr(use->CopyWithType(), deopt_id);
+  } else if ((from == kUnboxedInt32) && (to == kTagged)) {
+    converted = new BoxInt32Instr(use->CopyWithType());
+  } else if (((from == kUnboxedMint) && (to == kUnboxedUint32)) ||
+             ((from == kUnboxedUint32) && (to == kUnboxedMint)) ||
+             ((from == kUnboxedInt32) && (to == kUnboxedUint32))) {
+    converted = new UnboxedIntConverterInstr(from, to, use->CopyWithType());
   } else {
     // We have failed to find a suitable conversion instruction.
     // Insert two "dummy" conversion instructions with the correct
@@ -512,6 +540,10 @@ void FlowGraphOptimizer::InsertConversion(Representation from,
       boxed = new BoxFloat32x4Instr(use->CopyWithType());
     } else if (from == kUnboxedMint) {
       boxed = new BoxIntegerInstr(use->CopyWithType());
+    } else if (from == kUnboxedUint32) {
+      boxed = new BoxUint32Instr(use->CopyWithType());
+    } else if (from == kUnboxedInt32) {
+      boxed = new BoxInt32Instr(use->CopyWithType());
     } else {
       UNIMPLEMENTED();
     }
@@ -526,6 +558,10 @@ void FlowGraphOptimizer::InsertConversion(Representation from,
       converted = new UnboxFloat32x4Instr(to_value, deopt_id);
     } else if (to == kUnboxedMint) {
       converted = new UnboxIntegerInstr(to_value, deopt_id);
+    } else if (to == kUnboxedUint32) {
+      converted = new UnboxUint32Instr(to_value, deopt_id);
+    } else if (to == kUnboxedInt32) {
+      converted = new UnboxInt32Instr(to_value, deopt_id);
     } else {
       UNIMPLEMENTED();
     }
@@ -602,7 +638,651 @@ static bool UnboxPhi(PhiInstr* phi) {
 }
 
 
+// Returns the representation optimized code uses for the value of the given
+// field or kTagged if the field is not unboxed.
+static Representation UnboxedFieldRepresentation(const Field& field) {
+  if (!field.IsUnboxedField()) {
+    return kTagged;
+  }
+  switch (field.guarded_cid()) {
+    case kDoubleCid:
+      return kUnboxedDouble;
+    case kFloat32x4Cid:
+      return ShouldInlineSimd() ? kUnboxedFloat32x4 : kTagged;
+  }
+  return kTagged;
+}
+
+
+void FlowGraphOptimizer::SelectFieldRepresentations() {
+  for (intptr_t i = 0; i < block_order_.length(); ++i) {
+    BlockEntryInstr* entry = block_order_[i];
+    for (ForwardInstructionIterator it(entry); !it.Done(); it.Advance()) {
+      LoadFieldInstr* load = it.Current()->AsLoadField();
+      if ((load != NULL) &&
+          (load->field() != NULL) &&
+          !load->IsUnboxedLoad()) {
+        const Representation rep = UnboxedFieldRepresentation(*load->field());
+        if (rep != kTagged) {
+          load->set_representation(rep);
+          FlowGraph::AddToGuardedFields(flow_graph_->guarded_fields(),
+                                        load->field());
+        }
+        continue;
+      }
+
+      StoreInstanceFieldInstr* store = it.Current()->AsStoreInstanceField();
+      if ((store != NULL) && !store->IsUnboxedStore()) {
+        const Field& field = store->field();
+        // Unboxing conversions inserted in front of the store could not
+        // deoptimize: stores have no deoptimization target. Only unbox values
+        // that are statically known to satisfy the guard.
+        if (store->value()->Type()->ToCid() != field.guarded_cid()) {
+          continue;
+        }
+        const Representation rep = UnboxedFieldRepresentation(field);
+        if (rep != kTagged) {
+          store->set_value_representation(rep);
+          FlowGraph::AddToGuardedFields(flow_graph_->guarded_fields(), &field);
+        }
+      }
+    }
+  }
+}
+
+
+// Returns the token of an integer operation that can be performed on
+// unboxed uint32 values or Token::kILLEGAL.
+static Token::Kind Uint32OpKind(Definition* def) {
+  if (def->IsBinarySmiOp()) return def->AsBinarySmiOp()->op_kind();
+  if (def->IsBinaryMintOp()) return def->AsBinaryMintOp()->op_kind();
+  if (def->IsShiftMintOp()) return def->AsShiftMintOp()->op_kind();
+  if (def->IsBinaryUint32Op()) return def->AsBinaryUint32Op()->op_kind();
+  if (def->IsShiftUint32Op()) return def->AsShiftUint32Op()->op_kind();
+  return Token::kILLEGAL;
+}
+
+
+static bool IsUint32ShiftCount(Value* value) {
+  if (!value->BindsToConstant() || !value->BoundConstant().IsSmi()) {
+    return false;
+  }
+  const intptr_t count = Smi::Cast(value->BoundConstant()).Value();
+  return (0 <= count) && (count < 32);
+}
+
+
+static bool IsUint32Constant(Definition* def) {
+  ConstantInstr* constant = def->AsConstant();
+  if (constant == NULL) return false;
+  int64_t value = 0;
+  if (constant->value().IsSmi()) {
+    value = Smi::Cast(constant->value()).Value();
+  } else if (constant->value().IsMint()) {
+    value = Mint::Cast(constant->value()).value();
+  } else {
+    return false;
+  }
+  return (0 <= value) && (value <= kMaxUint32);
+}
+
+
+static bool IsUint32Range(Range* range) {
+  if (range == NULL) return false;
+#if defined(ARCH_IS_64_BIT)
+  return range->IsWithin(0, kMaxUint32);
+#else
+  return range->IsWithin(0, kMaxInt32);
+#endif
+}
+
+
+// Operations that only observe the low 32 bits of the given input.
+static bool IsTruncatingUse(Token::Kind op_kind, intptr_t use_index) {
+  switch (op_kind) {
+    case Token::kADD:
+    case Token::kSUB:
+    case Token::kMUL:
+    case Token::kBIT_AND:
+    case Token::kBIT_OR:
+    case Token::kBIT_XOR:
+      return true;
+    case Token::kSHL:
+      return use_index == 0;
+    default:
+      return false;
+  }
+}
+
+
+// Selects the unboxed uint32 representation for integer arithmetic whose
+// result is either observed only modulo 2^32 (e.g. hash computations that
+// are masked with a constant) or provably fits into 32 unsigned bits
+// according to constant masks and range analysis.
+//
+// A selected definition is "exact" if its mathematical value is in
+// [0, 2^32). Truncated (non-exact) definitions may only flow into other
+// selected operations that ignore the upper bits of their inputs. Everything
+// else - phis, environments, calls, comparisons, stores - requires an exact
+// value.
+class Uint32Selector : public ValueObject {
+ public:
+  explicit Uint32Selector(FlowGraph* flow_graph)
+      : flow_graph_(flow_graph),
+        candidates_(),
+        fixed_(new BitVector(flow_graph->max_virtual_register_number())),
+        selected_(new BitVector(flow_graph->max_virtual_register_number())),
+        exact_(new BitVector(flow_graph->max_virtual_register_number())) { }
+
+  // Returns the list of definitions that should be converted.
+  const GrowableArray<Definition*>& Select();
+
+ private:
+  bool IsSelected(Definition* def) const {
+    return def->HasSSATemp() && selected_->Contains(def->ssa_temp_index());
+  }
+
+  void AddCandidate(Definition* def, bool fixed);
+  void CollectCandidates();
+  bool IsPotentialUint32Definition(Definition* def) const;
+
+  bool IsExact(Definition* def) const;
+  bool ComputeExact(Definition* def) const;
+  bool IsConvertible(Value* value) const;
+  bool HasSelectedNeighbour(Definition* def) const;
+  bool CanBecomeUint32(Definition* def) const;
+
+  FlowGraph* flow_graph_;
+  GrowableArray<Definition*> candidates_;
+  GrowableArray<Definition*> result_;
+  BitVector* fixed_;
+  BitVector* selected_;
+  BitVector* exact_;
+};
+
+
+bool Uint32Selector::IsPotentialUint32Definition(Definition* def) const {
+  if (!def->HasSSATemp()) return false;
+  if (def->IsBinarySmiOp()) {
+    BinarySmiOpInstr* op = def->AsBinarySmiOp();
+    if ((op->op_kind() == Token::kSHL) || (op->op_kind() == Token::kSHR)) {
+      return IsUint32ShiftCount(op->right());
+    }
+    return BinaryUint32OpInstr::IsSupported(op->op_kind());
+  }
+  if (def->IsBinaryMintOp()) {
+    return BinaryUint32OpInstr::IsSupported(def->AsBinaryMintOp()->op_kind());
+  }
+  if (def->IsShiftMintOp()) {
+    return IsUint32ShiftCount(def->AsShiftMintOp()->right());
+  }
+  if (def->IsPhi()) {
+    PhiInstr* phi = def->AsPhi();
+    return phi->is_alive() &&
+        ((phi->representation() == kTagged) ||
+         (phi->representation() == kUnboxedMint));
+  }
+  return false;
+}
+
+
+void Uint32Selector::AddCandidate(Definition* def, bool fixed) {
+  candidates_.Add(def);
+  selected_->Add(def->ssa_temp_index());
+  exact_->Add(def->ssa_temp_index());
+  if (fixed) fixed_->Add(def->ssa_temp_index());
+}
+
+
+void Uint32Selector::CollectCandidates() {
+  const GrowableArray<BlockEntryInstr*>& block_order =
+      flow_graph_->reverse_postorder();
+  for (intptr_t i = 0; i < block_order.length(); ++i) {
+    BlockEntryInstr* block = block_order[i];
+    JoinEntryInstr* join = block->AsJoinEntry();
+    if (join != NULL) {
+      for (PhiIterator it(join); !it.Done(); it.Advance()) {
+        PhiInstr* phi = it.Current();
+        if (!phi->is_alive()) continue;
+        if (phi->representation() == kUnboxedUint32) {
+          AddCandidate(phi, true);
+        } else if (IsPotentialUint32Definition(phi)) {
+          AddCandidate(phi, false);
+        }
+      }
+    }
+    for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+      Definition* def = it.Current()->AsDefinition();
+      if ((def == NULL) || !def->HasSSATemp()) continue;
+      if (def->IsBinaryUint32Op() || def->IsShiftUint32Op()) {
+        // Selected by an earlier invocation.
+        AddCandidate(def, true);
+      } else if (IsPotentialUint32Definition(def)) {
+        AddCandidate(def, false);
+      }
+    }
+  }
+}
+
+
+bool Uint32Selector::IsExact(Definition* def) const {
+  if (IsSelected(def)) {
+    return exact_->Contains(def->ssa_temp_index());
+  }
+  if (IsUint32Constant(def) || def->IsBoxUint32()) {
+    return true;
+  }
+  if (def->IsUnboxUint32() || def->IsUnboxInteger()) {
+    Definition* boxed = def->InputAt(0)->definition();
+    return IsUint32Constant(boxed) || IsUint32Range(boxed->range());
+  }
+  return (def->Type()->ToCid() == kSmiCid) && IsUint32Range(def->range());
+}
+
+
+bool Uint32Selector::ComputeExact(Definition* def) const {
+  PhiInstr* phi = def->AsPhi();
+  if (phi != NULL) {
+    for (intptr_t i = 0; i < phi->InputCount(); i++) {
+      if (!IsExact(phi->InputAt(i)->definition())) return false;
+    }
+    return true;
+  }
+
+  if (IsUint32Range(def->range())) {
+    return true;
+  }
+
+  Definition* left = def->InputAt(0)->definition();
+  Definition* right = def->InputAt(1)->definition();
+  switch (Uint32OpKind(def)) {
+    case Token::kBIT_AND:
+      return IsExact(left) || IsExact(right);
+    case Token::kBIT_OR:
+    case Token::kBIT_XOR:
+      return IsExact(left) && IsExact(right);
+    case Token::kSHR:
+      return IsExact(left);
+    default:
+      return false;
+  }
+}
+
+
+// Returns true if the given input can be converted to uint32 without
+// deoptimization.
+bool Uint32Selector::IsConvertible(Value* value) const {
+  Definition* def = value->definition();
+  if (IsSelected(def)) return true;
+  switch (def->representation()) {
+    case kUnboxedUint32:
+      return true;
+    case kUnboxedInt32:
+      // The low 32 bits of an int32 value are its uint32 bit pattern.
+      return true;
+    case kUnboxedMint:
+      return true;
+    case kTagged:
+      return (value->Type()->ToCid() == kSmiCid) ||
+             (value->Type()->ToCid() == kMintCid);
+    default:
+      return false;
+  }
+}
+
+
+// Converting an operation that neither consumes nor produces other uint32
+// values would only surround it with conversions.
+bool Uint32Selector::HasSelectedNeighbour(Definition* def) const {
+  for (intptr_t i = 0; i < def->InputCount(); i++) {
+    Definition* input = def->InputAt(i)->definition();
+    if (IsSelected(input) || (input->representation() == kUnboxedUint32)) {
+      return true;
+    }
+  }
+  for (Value::Iterator it(def->input_use_list()); !it.Done(); it.Advance()) {
+    Definition* user = it.Current()->instruction()->AsDefinition();
+    if ((user != NULL) && IsSelected(user)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+bool Uint32Selector::CanBecomeUint32(Definition* def) const {
+  const bool is_exact = exact_->Contains(def->ssa_temp_index());
+
+  // Truncated values can't be observed by the environment.
+  if ((def->env_use_list() != NULL) && !is_exact) {
+    return false;
+  }
+
+  for (Value::Iterator it(def->input_use_list()); !it.Done(); it.Advance()) {
+    Value* use = it.Current();
+    Definition* user = use->instruction()->AsDefinition();
+    const bool is_truncating = (user != NULL) &&
+        IsSelected(user) &&
+        !user->IsPhi() &&
+        IsTruncatingUse(Uint32OpKind(user), use->use_index());
+    if (!is_truncating && !is_exact) {
+      return false;
+    }
+  }
+
+  if (def->IsPhi()) {
+    // Conversions for phi inputs are inserted in predecessors and can't
+    // deoptimize: each input has to be an exact uint32 value already.
+    for (intptr_t i = 0; i < def->InputCount(); i++) {
+      Value* input = def->InputAt(i);
+      if (!IsExact(input->definition()) || !IsConvertible(input)) {
+        return false;
+      }
+    }
+  } else {
+    // The shift count of a uint32 shift stays a tagged constant.
+    const Token::Kind op_kind = Uint32OpKind(def);
+    const intptr_t count =
+        ((op_kind == Token::kSHL) || (op_kind == Token::kSHR)) ?
+            1 : def->InputCount();
+    for (intptr_t i = 0; i < count; i++) {
+      if (!IsConvertible(def->InputAt(i))) return false;
+    }
+  }
+
+  return HasSelectedNeighbour(def);
+}
+
+
+const GrowableArray<Definition*>& Uint32Selector::Select() {
+  CollectCandidates();
+
+  // Optimistically all candidates are selected and exact. Shrink both sets
+  // until they are consistent.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (intptr_t i = 0; i < candidates_.length(); i++) {
+      Definition* def = candidates_[i];
+      const intptr_t index = def->ssa_temp_index();
+      if (!selected_->Contains(index)) continue;
+      if (exact_->Contains(index) && !ComputeExact(def)) {
+        exact_->Remove(index);
+        changed = true;
+      }
+      if (!fixed_->Contains(index) && !CanBecomeUint32(def)) {
+        selected_->Remove(index);
+        exact_->Remove(index);
+        changed = true;
+      }
+    }
+  }
+
+  for (intptr_t i = 0; i < candidates_.length(); i++) {
+    Definition* def = candidates_[i];
+    const intptr_t index = def->ssa_temp_index();
+    if (selected_->Contains(index) && !fixed_->Contains(index)) {
+      result_.Add(def);
+    }
+  }
+  return result_;
+}
+
+
+void FlowGraphOptimizer::SelectUint32Representations() {
+  if (!FLAG_unbox_uint32) {
+    return;
+  }
+  // Truncated intermediate values can't be checked against the JavaScript
+  // integer range.
+  if (FLAG_throw_on_javascript_int_overflow) {
+    return;
+  }
+  // Values flowing into catch entries are expected to be tagged.
+  if (flow_graph_->graph_entry()->SuccessorCount() > 1) {
+    return;
+  }
+
+  Uint32Selector selector(flow_graph_);
+  const GrowableArray<Definition*>& selected = selector.Select();
+  for (intptr_t i = 0; i < selected.length(); i++) {
+    Definition* def = selected[i];
+    if (FLAG_trace_optimization) {
+      OS::Print("Selecting uint32 representation for v%" Pd "\n",
+                def->ssa_temp_index());
+    }
+    if (def->IsPhi()) {
+      def->AsPhi()->set_representation(kUnboxedUint32);
+      continue;
+    }
+    const Token::Kind op_kind = Uint32OpKind(def);
+    Definition* replacement = NULL;
+    if ((op_kind == Token::kSHL) || (op_kind == Token::kSHR)) {
+      replacement = new ShiftUint32OpInstr(op_kind,
+                                           def->InputAt(0)->CopyWithType(),
+                                           def->InputAt(1)->CopyWithType(),
+                                           def->GetDeoptId());
+    } else {
+      replacement = new BinaryUint32OpInstr(op_kind,
+                                            def->InputAt(0)->CopyWithType(),
+                                            def->InputAt(1)->CopyWithType(),
+                                            def->GetDeoptId());
+    }
+    def->ReplaceWith(replacement, NULL);
+  }
+}
+
+
+// Selects the unboxed int32 representation for Smi arithmetic and Smi phis
+// that range analysis proved to stay within 32 bits. Unlike uint32 values,
+// int32 values are never truncated: every selected definition holds the exact
+// value of the Smi it replaces and can be used anywhere after boxing.
+class Int32Selector : public ValueObject {
+ public:
+  explicit Int32Selector(FlowGraph* flow_graph)
+      : flow_graph_(flow_graph),
+        candidates_(),
+        selected_(new BitVector(flow_graph->max_virtual_register_number())) { }
+
+  // Returns the list of definitions that should be converted.
+  const GrowableArray<Definition*>& Select();
+
+ private:
+  bool IsSelected(Definition* def) const {
+    return def->HasSSATemp() && selected_->Contains(def->ssa_temp_index());
+  }
+
+  void CollectCandidates();
+  bool IsPotentialInt32Definition(Definition* def) const;
+
+  bool IsInt32Value(Value* value) const;
+  bool HasUnboxedNeighbour(Definition* def) const;
+  bool CanBecomeInt32(Definition* def) const;
+
+  FlowGraph* flow_graph_;
+  GrowableArray<Definition*> candidates_;
+  GrowableArray<Definition*> result_;
+  BitVector* selected_;
+};
+
+
+bool Int32Selector::IsPotentialInt32Definition(Definition* def) const {
+  // Selection is driven by range analysis: definitions are only considered
+  // once their range has been inferred.
+  if (!def->HasSSATemp() || (def->range() == NULL)) return false;
+  if (def->IsBinarySmiOp()) {
+    BinarySmiOpInstr* op = def->AsBinarySmiOp();
+    return BinaryInt32OpInstr::IsSupported(op->op_kind()) &&
+        !op->CanDeoptimize();
+  }
+  if (def->IsPhi()) {
+    PhiInstr* phi = def->AsPhi();
+    return phi->is_alive() &&
+        (phi->representation() == kTagged) &&
+        (phi->Type()->ToCid() == kSmiCid);
+  }
+  return false;
+}
+
+
+void Int32Selector::CollectCandidates() {
+  const GrowableArray<BlockEntryInstr*>& block_order =
+      flow_graph_->reverse_postorder();
+  for (intptr_t i = 0; i < block_order.length(); ++i) {
+    BlockEntryInstr* block = block_order[i];
+    JoinEntryInstr* join = block->AsJoinEntry();
+    if (join != NULL) {
+      for (PhiIterator it(join); !it.Done(); it.Advance()) {
+        PhiInstr* phi = it.Current();
+        if (IsPotentialInt32Definition(phi)) {
+          candidates_.Add(phi);
+          selected_->Add(phi->ssa_temp_index());
+        }
+      }
+    }
+    for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+      Definition* def = it.Current()->AsDefinition();
+      if ((def != NULL) && IsPotentialInt32Definition(def)) {
+        candidates_.Add(def);
+        selected_->Add(def->ssa_temp_index());
+      }
+    }
+  }
+}
+
+
+// Returns true if the given input can be converted to int32 without
+// deoptimization.
+bool Int32Selector::IsInt32Value(Value* value) const {
+  Definition* def = value->definition();
+  if (IsSelected(def)) return true;
+  switch (def->representation()) {
+    case kUnboxedInt32:
+      return true;
+    case kTagged:
+      return UnboxInt32Instr::IsSmiInInt32Range(value);
+    default:
+      return false;
+  }
+}
+
+
+// Converting a definition that neither consumes nor produces other unboxed
+// 32-bit values would only surround it with conversions.
+bool Int32Selector::HasUnboxedNeighbour(Definition* def) const {
+  for (intptr_t i = 0; i < def->InputCount(); i++) {
+    Definition* input = def->InputAt(i)->definition();
+    if (IsSelected(input) ||
+        (input->representation() == kUnboxedInt32) ||
+        (input->representation() == kUnboxedUint32)) {
+      return true;
+    }
+  }
+  for (Value::Iterator it(def->input_use_list()); !it.Done(); it.Advance()) {
+    Value* use = it.Current();
+    Instruction* user = use->instruction();
+    if ((user->AsDefinition() != NULL) && IsSelected(user->AsDefinition())) {
+      return true;
+    }
+    const Representation rep =
+        user->RequiredInputRepresentation(use->use_index());
+    if ((rep == kUnboxedInt32) || (rep == kUnboxedUint32)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+bool Int32Selector::CanBecomeInt32(Definition* def) const {
+  // Conversions for phi inputs are inserted in predecessors and can't
+  // deoptimize. Operations lost their deoptimization environment if range
+  // analysis proved that they can't overflow. Either way the inputs have to
+  // be int32 values already.
+  for (intptr_t i = 0; i < def->InputCount(); i++) {
+    if (!IsInt32Value(def->InputAt(i))) return false;
+  }
+
+  if (!def->IsPhi()) {
+    // Bitwise operations of int32 values produce int32 values. Sums and
+    // differences fit if every Smi does or if their range says so.
+    const Token::Kind op_kind = def->AsBinarySmiOp()->op_kind();
+    if ((op_kind == Token::kADD) || (op_kind == Token::kSUB)) {
+      if ((kSmiBits >= 32) && !def->range()->IsWithin(kMinInt32, kMaxInt32)) {
+        return false;
+      }
+    }
+  }
+
+  return HasUnboxedNeighbour(def);
+}
+
+
+const GrowableArray<Definition*>& Int32Selector::Select() {
+  CollectCandidates();
+
+  // Optimistically all candidates are selected. Shrink the set until it is
+  // consistent.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (intptr_t i = 0; i < candidates_.length(); i++) {
+      Definition* def = candidates_[i];
+      const intptr_t index = def->ssa_temp_index();
+      if (selected_->Contains(index) && !CanBecomeInt32(def)) {
+        selected_->Remove(index);
+        changed = true;
+      }
+    }
+  }
+
+  for (intptr_t i = 0; i < candidates_.length(); i++) {
+    Definition* def = candidates_[i];
+    if (selected_->Contains(def->ssa_temp_index())) {
+      result_.Add(def);
+    }
+  }
+  return result_;
+}
+
+
+void FlowGraphOptimizer::SelectInt32Representations() {
+  if (!FLAG_unbox_int32) {
+    return;
+  }
+  // Values flowing into catch entries are expected to be tagged.
+  if (flow_graph_->graph_entry()->SuccessorCount() > 1) {
+    return;
+  }
+
+  Int32Selector selector(flow_graph_);
+  const GrowableArray<Definition*>& selected = selector.Select();
+  for (intptr_t i = 0; i < selected.length(); i++) {
+    Definition* def = selected[i];
+    if (FLAG_trace_optimization) {
+      OS::Print("Selecting int32 representation for v%" Pd "\n",
+                def->ssa_temp_index());
+    }
+    if (def->IsPhi()) {
+      def->AsPhi()->set_representation(kUnboxedInt32);
+      continue;
+    }
+    BinarySmiOpInstr* op = def->AsBinarySmiOp();
+    BinaryInt32OpInstr* replacement =
+        new BinaryInt32OpInstr(op->op_kind(),
+                               op->left()->CopyWithType(),
+                               op->right()->CopyWithType(),
+                               op->GetDeoptId());
+    def->ReplaceWith(replacement, NULL);
+  }
+}
+
+
 void FlowGraphOptimizer::SelectRepresentations() {
+  SelectFieldRepresentations();
+  SelectUint32Representations();
+  SelectInt32Representations();
+
   // Convervatively unbox all phis that were proven to be of Double,
   // Float32x4, or Int32x4 type.
   for (intptr_t i = 0; i < block_order_.length(); ++i) {
@@ -1317,7 +1997,7 @@ bool FlowGraphOptimizer::InlineGetIndexed(MethodRecognizer::Kind kind,
       (array_cid == kTypedDataUint32ArrayCid)) {
     // Set deopt_id if we can optimistically assume that the result is Smi.
     // Assume mixed Mint/Smi if this instruction caused deoptimization once.
-    deopt_id = (ic_data.deopt_reason() == kDeoptUnknown) ?
+    deopt_id = !ic_data.HasDeoptReasons() ?
         call->deopt_id() : Isolate::kNoDeoptId;
   }
 
@@ -1548,14 +2228,14 @@ bool FlowGraphOptimizer::TryReplaceWithBinaryOp(InstanceCallInstr* call,
       if (HasOnlyTwoOf(ic_data, kSmiCid)) {
         // Don't generate smi code if the IC data is marked because
         // of an overflow.
-        operands_type = (ic_data.deopt_reason() == kDeoptBinarySmiOp)
+        operands_type = ic_data.HasDeoptReason(kDeoptBinarySmiOp)
             ? kMintCid
             : kSmiCid;
       } else if (HasTwoMintOrSmi(ic_data) &&
                  FlowGraphCompiler::SupportsUnboxedMints()) {
         // Don't generate mint code if the IC data is marked because of an
         // overflow.
-        if (ic_data.deopt_reason() == kDeoptBinaryMintOp) return false;
+        if (ic_data.HasDeoptReason(kDeoptBinaryMintOp)) return false;
         operands_type = kMintCid;
       } else if (ShouldSpecializeForDouble(ic_data)) {
         operands_type = kDoubleCid;
@@ -1572,7 +2252,7 @@ bool FlowGraphOptimizer::TryReplaceWithBinaryOp(InstanceCallInstr* call,
         // Don't generate smi code if the IC data is marked because of an
         // overflow.
         // TODO(fschneider): Add unboxed mint multiplication.
-        if (ic_data.deopt_reason() == kDeoptBinarySmiOp) return false;
+        if (ic_data.HasDeoptReason(kDeoptBinarySmiOp)) return false;
         operands_type = kSmiCid;
       } else if (ShouldSpecializeForDouble(ic_data)) {
         operands_type = kDoubleCid;
@@ -1611,10 +2291,10 @@ bool FlowGraphOptimizer::TryReplaceWithBinaryOp(InstanceCallInstr* call,
         // Left shift may overflow from smi into mint or big ints.
         // Don't generate smi code if the IC data is marked because
         // of an overflow.
-        if (ic_data.deopt_reason() == kDeoptShiftMintOp) {
+        if (ic_data.HasDeoptReason(kDeoptShiftMintOp)) {
           return false;
         }
-        operands_type = (ic_data.deopt_reason() == kDeoptBinarySmiOp)
+        operands_type = ic_data.HasDeoptReason(kDeoptBinarySmiOp)
             ? kMintCid
             : kSmiCid;
       } else if (HasTwoMintOrSmi(ic_data) &&
@@ -1622,7 +2302,7 @@ bool FlowGraphOptimizer::TryReplaceWithBinaryOp(InstanceCallInstr* call,
                      ic_data.AsUnaryClassChecksForArgNr(1)))) {
         // Don't generate mint code if the IC data is marked because of an
         // overflow.
-        if (ic_data.deopt_reason() == kDeoptShiftMintOp) {
+        if (ic_data.HasDeoptReason(kDeoptShiftMintOp)) {
           return false;
         }
         // Check for smi/mint << smi or smi/mint >> smi.
@@ -1634,7 +2314,7 @@ bool FlowGraphOptimizer::TryReplaceWithBinaryOp(InstanceCallInstr* call,
     case Token::kMOD:
     case Token::kTRUNCDIV:
       if (HasOnlyTwoOf(ic_data, kSmiCid)) {
-        if (ic_data.deopt_reason() == kDeoptBinarySmiOp) {
+        if (ic_data.HasDeoptReason(kDeoptBinarySmiOp)) {
           return false;
         }
         operands_type = kSmiCid;
@@ -2296,7 +2976,7 @@ bool FlowGraphOptimizer::TryInlineInstanceMethod(InstanceCallInstr* call) {
         const ICData& ic_data = *call->ic_data();
         Definition* input = call->ArgumentAt(0);
         Definition* d2i_instr = NULL;
-        if (ic_data.deopt_reason() == kDeoptDoubleToSmi) {
+        if (ic_data.HasDeoptReason(kDeoptDoubleToSmi)) {
           // Do not repeatedly deoptimize because result didn't fit into Smi.
           d2i_instr = new DoubleToIntegerInstr(new Value(input), call);
         } else {
@@ -2405,7 +3085,7 @@ bool FlowGraphOptimizer::TryInlineInstanceMethod(InstanceCallInstr* call) {
     Definition* count = call->ArgumentAt(1);
     Definition* int32_mask = call->ArgumentAt(2);
     if (HasOnlyTwoOf(ic_data, kSmiCid)) {
-      if (ic_data.deopt_reason() == kDeoptShiftMintOp) {
+      if (ic_data.HasDeoptReason(kDeoptShiftMintOp)) {
         return false;
       }
       // We cannot overflow. The input value must be a Smi
@@ -2442,7 +3122,7 @@ bool FlowGraphOptimizer::TryInlineInstanceMethod(InstanceCallInstr* call) {
     if (HasTwoMintOrSmi(ic_data) &&
         HasOnlyOneSmi(ICData::Handle(ic_data.AsUnaryClassChecksForArgNr(1)))) {
       if (!FlowGraphCompiler::SupportsUnboxedMints() ||
-          (ic_data.deopt_reason() == kDeoptShiftMintOp)) {
+          ic_data.HasDeoptReason(kDeoptShiftMintOp)) {
         return false;
       }
       ShiftMintOpInstr* left_shift =
@@ -2771,7 +3451,7 @@ bool FlowGraphOptimizer::InlineByteArrayViewLoad(Instruction* call,
       (array_cid == kTypedDataUint32ArrayCid)) {
     // Set deopt_id if we can optimistically assume that the result is Smi.
     // Assume mixed Mint/Smi if this instruction caused deoptimization once.
-    deopt_id = (ic_data.deopt_reason() == kDeoptUnknown) ?
+    deopt_id = !ic_data.HasDeoptReasons() ?
         call->deopt_id() : Isolate::kNoDeoptId;
   }
 
@@ -2959,7 +3639,7 @@ bool FlowGraphOptimizer::BuildByteArrayViewStore(InstanceCallInstr* call,
       // We don't have ICData for the value stored, so we optimistically assume
       // smis first. If we ever deoptimized here, we require to unbox the value
       // before storing to handle the mint case, too.
-      if (call->ic_data()->deopt_reason() == kDeoptUnknown) {
+      if (!call->ic_data()->HasDeoptReasons()) {
         value_check = ICData::New(flow_graph_->parsed_function().function(),
                                   call->function_name(),
                                   Object::empty_array(),  // Dummy args. descr.
@@ -3325,6 +4005,14 @@ void FlowGraphOptimizer::VisitInstanceCall(InstanceCallInstr* instr) {
     }
   }
 
+  if (unary_checks.HasDeoptReason(kDeoptCheckClass) ||
+      unary_checks.HasDeoptReason(kDeoptPolymorphicInstanceCallTestFail)) {
+    // Receiver class checks failed at this call site before. Keep the
+    // generic instance call instead of deoptimizing on the next new class.
+    instr->set_ic_data(&unary_checks);
+    return;
+  }
+
   if (unary_checks.NumberOfChecks() <= FLAG_max_polymorphic_checks) {
     bool call_with_checks;
     if (has_one_target) {
@@ -3502,11 +4190,27 @@ bool FlowGraphOptimizer::TryInlineInstanceSetter(InstanceCallInstr* instr,
 
 
 // Range analysis for smi values.
+static BlockEntryInstr* FindPreHeader(BlockEntryInstr* header) {
+  for (intptr_t j = 0; j < header->PredecessorCount(); ++j) {
+    BlockEntryInstr* candidate = header->PredecessorAt(j);
+    if (header->dominator() == candidate) {
+      return candidate;
+    }
+  }
+  return NULL;
+}
+
+
 class RangeAnalysis : public ValueObject {
  public:
   explicit RangeAnalysis(FlowGraph* flow_graph)
       : flow_graph_(flow_graph),
-        marked_defns_(NULL) { }
+        marked_defns_(NULL),
+        hoist_bounds_checks_(
+            FLAG_hoist_bounds_checks &&
+            flow_graph->is_licm_allowed() &&
+            (flow_graph->parsed_function().function().deoptimization_counter()
+                < FLAG_deoptimization_counter_licm_threshold)) { }
 
   // Infer ranges for all values and remove overflow checks from binary smi
   // operations when proven redundant.
@@ -3575,6 +4279,22 @@ class RangeAnalysis : public ValueObject {
     }
   }
 
+  // Speculatively replace a bounds check inside a loop with checks of the
+  // bounds of its index range in the loop pre-header, e.g. a single check of
+  // end <= a.length for a[i] in for (i = start; i < end; i++). Returns false
+  // if the range is not expressed in terms of loop invariant values.
+  // Deoptimization restarts the loop in unoptimized code, which performs the
+  // checks on every iteration.
+  bool TryHoistBoundsCheck(CheckArrayBoundInstr* check);
+
+  BlockEntryInstr* FindInnermostLoop(BlockEntryInstr* block);
+
+  // Returns a definition computing bound + extra in front of the pre-header
+  // exit.
+  Definition* MaterializeBoundary(const RangeBoundary& bound,
+                                  intptr_t extra,
+                                  GotoInstr* pre_header_exit);
+
   // Remove artificial Constraint instructions and replace them with actual
   // unconstrained definitions.
   void RemoveConstraints();
@@ -3595,6 +4315,8 @@ class RangeAnalysis : public ValueObject {
   GrowableArray<Definition*> worklist_;
   BitVector* marked_defns_;
 
+  const bool hoist_bounds_checks_;
+
   DISALLOW_COPY_AND_ASSIGN(RangeAnalysis);
 };
 
@@ -4031,7 +4753,8 @@ void RangeAnalysis::InferRangesRecursive(BlockEntryInstr* block) {
       CheckArrayBoundInstr* check = current->AsCheckArrayBound();
       RangeBoundary array_length =
           RangeBoundary::FromDefinition(check->length()->definition());
-      if (check->IsRedundant(array_length)) {
+      if (check->IsRedundant(array_length) ||
+          (hoist_bounds_checks_ && TryHoistBoundsCheck(check))) {
         it.RemoveCurrentFromGraph();
       }
     }
@@ -4072,6 +4795,124 @@ void RangeAnalysis::InferRanges() {
 }
 
 
+BlockEntryInstr* RangeAnalysis::FindInnermostLoop(BlockEntryInstr* block) {
+  const ZoneGrowableArray<BlockEntryInstr*>& loop_headers =
+      flow_graph_->loop_headers();
+  BlockEntryInstr* innermost = NULL;
+  for (intptr_t i = 0; i < loop_headers.length(); ++i) {
+    BlockEntryInstr* header = loop_headers[i];
+    if (header->loop_info()->Contains(block->preorder_number()) &&
+        ((innermost == NULL) || innermost->Dominates(header))) {
+      innermost = header;
+    }
+  }
+  return innermost;
+}
+
+
+// Returns true if bound + extra can be computed in the pre-header of the
+// loop with the given header.
+static bool IsHoistableBoundary(const RangeBoundary& bound,
+                                intptr_t extra,
+                                BlockEntryInstr* header,
+                                BlockEntryInstr* pre_header) {
+  if (bound.IsConstant()) {
+    return Smi::IsValid64(static_cast<int64_t>(bound.value()) + extra);
+  }
+  if (!bound.IsSymbol() || !Smi::IsValid(bound.offset() + extra)) {
+    return false;
+  }
+  BlockEntryInstr* block = bound.symbol()->GetBlock();
+  return !header->loop_info()->Contains(block->preorder_number()) &&
+      block->Dominates(pre_header);
+}
+
+
+Definition* RangeAnalysis::MaterializeBoundary(const RangeBoundary& bound,
+                                               intptr_t extra,
+                                               GotoInstr* pre_header_exit) {
+  if (bound.IsConstant()) {
+    return flow_graph_->GetConstant(
+        Smi::ZoneHandle(Smi::New(bound.value() + extra)));
+  }
+  const intptr_t offset = bound.offset() + extra;
+  if (offset == 0) return bound.symbol();
+  BinarySmiOpInstr* add = new BinarySmiOpInstr(
+      Token::kADD,
+      new Value(bound.symbol()),
+      new Value(flow_graph_->GetConstant(Smi::ZoneHandle(Smi::New(offset)))),
+      pre_header_exit->GetDeoptId());
+  flow_graph_->InsertBefore(pre_header_exit,
+                            add,
+                            pre_header_exit->env(),
+                            Definition::kValue);
+  return add;
+}
+
+
+bool RangeAnalysis::TryHoistBoundsCheck(CheckArrayBoundInstr* check) {
+  Range* index_range = check->index()->definition()->range();
+  if (index_range == NULL) return false;
+
+  BlockEntryInstr* header = FindInnermostLoop(check->GetBlock());
+  if (header == NULL) return false;
+  BlockEntryInstr* pre_header = FindPreHeader(header);
+  if (pre_header == NULL) return false;
+  GotoInstr* pre_header_exit = pre_header->last_instruction()->AsGoto();
+  if ((pre_header_exit == NULL) || (pre_header_exit->env() == NULL)) {
+    return false;
+  }
+
+  // The index stays within [min, max] on every iteration, so the check
+  // always succeeds if 0 <= min and max + 1 <= length. Both conditions are
+  // tested in the form 0 <= x <= length, which also holds for loops that do
+  // not execute at all, e.g. start == end == length.
+  const RangeBoundary length =
+      RangeBoundary::FromDefinition(check->length()->definition());
+  const RangeBoundary& min = index_range->min();
+  const RangeBoundary& max = index_range->max();
+  const bool needs_lower_check =
+      (Range::ConstantMin(index_range).value() < 0);
+  if (!IsHoistableBoundary(length, 1, header, pre_header) ||
+      !IsHoistableBoundary(max, 1, header, pre_header) ||
+      (needs_lower_check &&
+       (!min.IsSymbol() ||
+        !IsHoistableBoundary(min, 0, header, pre_header)))) {
+    return false;
+  }
+
+  if (FLAG_trace_range_analysis) {
+    OS::Print("hoisting bounds check %" Pd " to B%" Pd "\n",
+              check->GetDeoptId(),
+              pre_header->block_id());
+  }
+
+  // For fields with a guarded list length the length is a constant.
+  Definition* limit = MaterializeBoundary(length, 1, pre_header_exit);
+  Definition* upper = MaterializeBoundary(max, 1, pre_header_exit);
+  CheckArrayBoundInstr* upper_check =
+      new CheckArrayBoundInstr(new Value(limit),
+                               new Value(upper),
+                               pre_header_exit->GetDeoptId());
+  flow_graph_->InsertBefore(pre_header_exit,
+                            upper_check,
+                            pre_header_exit->env(),
+                            Definition::kEffect);
+  if (needs_lower_check) {
+    Definition* lower = MaterializeBoundary(min, 0, pre_header_exit);
+    CheckArrayBoundInstr* lower_check =
+        new CheckArrayBoundInstr(new Value(limit),
+                                 new Value(lower),
+                                 pre_header_exit->GetDeoptId());
+    flow_graph_->InsertBefore(pre_header_exit,
+                              lower_check,
+                              pre_header_exit->env(),
+                              Definition::kEffect);
+  }
+  return true;
+}
+
+
 void RangeAnalysis::RemoveConstraints() {
   for (intptr_t i = 0; i < constraints_.length(); i++) {
     Definition* def = constraints_[i]->value()->definition();
@@ -4158,17 +4999,6 @@ void TryCatchAnalyzer::Optimize(FlowGraph* flow_graph) {
 }
 
 
-static BlockEntryInstr* FindPreHeader(BlockEntryInstr* header) {
-  for (intptr_t j = 0; j < header->PredecessorCount(); ++j) {
-    BlockEntryInstr* candidate = header->PredecessorAt(j);
-    if (header->dominator() == candidate) {
-      return candidate;
-    }
-  }
-  return NULL;
-}
-
-
 LICM::LICM(FlowGraph* flow_graph) : flow_graph_(flow_graph) {
   ASSERT(flow_graph->is_licm_allowed());
 }
@@ -4263,55 +5093,459 @@ static bool IsLoopInvariantLoad(ZoneGrowableArray<BitVector*>* sets,
 }
 
 
-void LICM::Optimize() {
-  const ZoneGrowableArray<BlockEntryInstr*>& loop_headers =
-      flow_graph()->loop_headers();
+void LICM::Optimize() {
+  const ZoneGrowableArray<BlockEntryInstr*>& loop_headers =
+      flow_graph()->loop_headers();
+
+  ZoneGrowableArray<BitVector*>* loop_invariant_loads =
+      flow_graph()->loop_invariant_loads();
+
+  BlockEffects* block_effects = flow_graph()->block_effects();
+
+  for (intptr_t i = 0; i < loop_headers.length(); ++i) {
+    BlockEntryInstr* header = loop_headers[i];
+    // Skip loop that don't have a pre-header block.
+    BlockEntryInstr* pre_header = FindPreHeader(header);
+    if (pre_header == NULL) continue;
+
+    for (BitVector::Iterator loop_it(header->loop_info());
+         !loop_it.Done();
+         loop_it.Advance()) {
+      BlockEntryInstr* block = flow_graph()->preorder()[loop_it.Current()];
+      for (ForwardInstructionIterator it(block);
+           !it.Done();
+           it.Advance()) {
+        Instruction* current = it.Current();
+        if ((current->AllowsCSE() &&
+             block_effects->CanBeMovedTo(current, pre_header)) ||
+            IsLoopInvariantLoad(loop_invariant_loads, i, current)) {
+          bool inputs_loop_invariant = true;
+          for (int i = 0; i < current->InputCount(); ++i) {
+            Definition* input_def = current->InputAt(i)->definition();
+            if (!input_def->GetBlock()->Dominates(pre_header)) {
+              inputs_loop_invariant = false;
+              break;
+            }
+          }
+          if (inputs_loop_invariant &&
+              !current->IsAssertAssignable() &&
+              !current->IsAssertBoolean()) {
+            // TODO(fschneider): Enable hoisting of Assert-instructions
+            // if it safe to do.
+            Hoist(&it, pre_header, current);
+          } else if (current->IsCheckSmi() &&
+                     current->InputAt(0)->definition()->IsPhi()) {
+            TryHoistCheckSmiThroughPhi(
+                &it, header, pre_header, current->AsCheckSmi());
+          }
+        }
+      }
+    }
+  }
+}
+
+
+LoopVectorizer::LoopVectorizer(FlowGraph* flow_graph)
+    : flow_graph_(flow_graph) {
+}
+
+
+void LoopVectorizer::Optimize() {
+  // The vector induction variable is incremented without an overflow check.
+  if (!ShouldInlineSimd() || FLAG_throw_on_javascript_int_overflow) return;
+
+  const ZoneGrowableArray<BlockEntryInstr*>& loop_headers =
+      flow_graph()->loop_headers();
+
+  bool changed = false;
+  for (intptr_t i = 0; i < loop_headers.length(); ++i) {
+    JoinEntryInstr* header = loop_headers[i]->AsJoinEntry();
+    if ((header != NULL) && TryVectorize(header)) {
+      changed = true;
+    }
+  }
+
+  if (changed) {
+    // Vector loops were inserted in front of the original loops.
+    flow_graph()->DiscoverBlocks();
+    GrowableArray<BitVector*> dominance_frontier;
+    flow_graph()->ComputeDominators(&dominance_frontier);
+    // Loop information is indexed by preorder number, which has changed.
+    // Range analysis reads it from the blocks, so recompute it eagerly.
+    for (BlockIterator it = flow_graph()->reverse_postorder_iterator();
+         !it.Done();
+         it.Advance()) {
+      it.Current()->set_loop_info(NULL);
+    }
+    flow_graph()->loop_headers();
+  }
+}
+
+
+static bool IsInLoop(BitVector* loop_info, Definition* defn) {
+  return loop_info->Contains(defn->GetBlock()->preorder_number());
+}
+
+
+static bool IsSmiConstant(Value* value, intptr_t expected) {
+  return value->BindsToConstant() &&
+      value->BoundConstant().IsSmi() &&
+      (Smi::Cast(value->BoundConstant()).Value() == expected);
+}
+
+
+// Returns true if the unboxed double defn is a constant that is exactly
+// representable in single precision. Splatting such a constant does not
+// change the result of a single precision operation.
+static bool IsFloat32Constant(Definition* defn) {
+  UnboxDoubleInstr* unbox = defn->AsUnboxDouble();
+  if ((unbox == NULL) || !unbox->value()->BindsToConstant()) return false;
+  const Object& constant = unbox->value()->BoundConstant();
+  double value;
+  if (constant.IsSmi()) {
+    value = static_cast<double>(Smi::Cast(constant).Value());
+  } else if (constant.IsDouble()) {
+    value = Double::Cast(constant).value();
+  } else {
+    return false;
+  }
+  return static_cast<double>(static_cast<float>(value)) == value;
+}
+
+
+// A single +, -, * or / of two single precision values rounds to the same
+// result whether it is computed in single precision or in double precision
+// and then narrowed, which is what the scalar loop does. NEON flushes
+// denormals to zero and only estimates division, so on ARM the vector loop
+// would not match the scalar loop.
+static bool IsVectorizableFloat32Op(Token::Kind op_kind) {
+#if defined(TARGET_ARCH_ARM)
+  return false;
+#else
+  switch (op_kind) {
+    case Token::kADD:
+    case Token::kSUB:
+    case Token::kMUL:
+    case Token::kDIV:
+      return true;
+    default:
+      return false;
+  }
+#endif
+}
+
+
+// Storing into an Int32List truncates to 32 bits, so these operations give
+// the same stored value when they wrap around in 32-bit lanes.
+static bool IsVectorizableInt32Op(Token::Kind op_kind) {
+  switch (op_kind) {
+    case Token::kADD:
+    case Token::kSUB:
+    case Token::kBIT_AND:
+    case Token::kBIT_OR:
+    case Token::kBIT_XOR:
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+static void AddUnique(GrowableArray<Definition*>* list, Definition* defn) {
+  for (intptr_t i = 0; i < list->length(); ++i) {
+    if ((*list)[i] == defn) return;
+  }
+  list->Add(defn);
+}
 
-  ZoneGrowableArray<BitVector*>* loop_invariant_loads =
-      flow_graph()->loop_invariant_loads();
 
-  BlockEffects* block_effects = flow_graph()->block_effects();
+bool LoopVectorizer::TryVectorize(JoinEntryInstr* header) {
+  // The loop must consist of the header and a single body block which
+  // jumps back to the header.
+  if (header->PredecessorCount() != 2) return false;
+  BlockEntryInstr* pre_header = FindPreHeader(header);
+  if ((pre_header == NULL) || !pre_header->last_instruction()->IsGoto()) {
+    return false;
+  }
+  const intptr_t entry_index = header->IndexOfPredecessor(pre_header);
+  TargetEntryInstr* body =
+      header->PredecessorAt(1 - entry_index)->AsTargetEntry();
+  if ((body == NULL) || (body->PredecessorAt(0) != header)) return false;
 
-  for (intptr_t i = 0; i < loop_headers.length(); ++i) {
-    BlockEntryInstr* header = loop_headers[i];
-    // Skip loop that don't have a pre-header block.
-    BlockEntryInstr* pre_header = FindPreHeader(header);
-    if (pre_header == NULL) continue;
+  BitVector* loop_info = header->loop_info();
+  intptr_t block_count = 0;
+  for (BitVector::Iterator it(loop_info); !it.Done(); it.Advance()) {
+    ++block_count;
+  }
+  if (block_count != 2) return false;
 
-    for (BitVector::Iterator loop_it(header->loop_info());
-         !loop_it.Done();
-         loop_it.Advance()) {
-      BlockEntryInstr* block = flow_graph()->preorder()[loop_it.Current()];
-      for (ForwardInstructionIterator it(block);
-           !it.Done();
-           it.Advance()) {
-        Instruction* current = it.Current();
-        if ((current->AllowsCSE() &&
-             block_effects->CanBeMovedTo(current, pre_header)) ||
-            IsLoopInvariantLoad(loop_invariant_loads, i, current)) {
-          bool inputs_loop_invariant = true;
-          for (int i = 0; i < current->InputCount(); ++i) {
-            Definition* input_def = current->InputAt(i)->definition();
-            if (!input_def->GetBlock()->Dominates(pre_header)) {
-              inputs_loop_invariant = false;
-              break;
-            }
-          }
-          if (inputs_loop_invariant &&
-              !current->IsAssertAssignable() &&
-              !current->IsAssertBoolean()) {
-            // TODO(fschneider): Enable hoisting of Assert-instructions
-            // if it safe to do.
-            Hoist(&it, pre_header, current);
-          } else if (current->IsCheckSmi() &&
-                     current->InputAt(0)->definition()->IsPhi()) {
-            TryHoistCheckSmiThroughPhi(
-                &it, header, pre_header, current->AsCheckSmi());
-          }
-        }
+  // The header only tests i < n, where n is loop invariant.
+  BranchInstr* branch = header->last_instruction()->AsBranch();
+  if ((branch == NULL) || (branch->true_successor() != body)) return false;
+  for (ForwardInstructionIterator it(header); !it.Done(); it.Advance()) {
+    if ((it.Current() != branch) && !it.Current()->IsCheckStackOverflow()) {
+      return false;
+    }
+  }
+  RelationalOpInstr* compare = branch->comparison()->AsRelationalOp();
+  if ((compare == NULL) ||
+      (compare->kind() != Token::kLT) ||
+      (compare->operation_cid() != kSmiCid)) {
+    return false;
+  }
+  PhiInstr* index = compare->left()->definition()->AsPhi();
+  Definition* limit = compare->right()->definition();
+  if ((index == NULL) ||
+      (index->block() != header) ||
+      IsInLoop(loop_info, limit)) {
+    return false;
+  }
+
+  // The index is the only value carried around the loop. It starts at zero
+  // and is incremented by one.
+  for (PhiIterator it(header); !it.Done(); it.Advance()) {
+    if (it.Current()->is_alive() && (it.Current() != index)) return false;
+  }
+  if (!IsSmiConstant(index->InputAt(entry_index), 0)) return false;
+  BinarySmiOpInstr* increment =
+      index->InputAt(1 - entry_index)->definition()->AsBinarySmiOp();
+  if ((increment == NULL) ||
+      (increment->op_kind() != Token::kADD) ||
+      (increment->left()->definition() != index) ||
+      !IsSmiConstant(increment->right(), 1)) {
+    return false;
+  }
+
+  // The body stores the result of a single operation on elements at the
+  // index. Bounds checks are allowed; their lengths bound the vector loop.
+  StoreIndexedInstr* store = NULL;
+  Definition* op = NULL;
+  GrowableArray<LoadIndexedInstr*> loads;
+  GrowableArray<Definition*> arrays;
+  GrowableArray<Definition*> lengths;
+  for (ForwardInstructionIterator it(body); !it.Done(); it.Advance()) {
+    Instruction* current = it.Current();
+    if ((current == increment) || (current == body->last_instruction())) {
+      continue;
+    }
+    if (current->IsCheckArrayBound()) {
+      CheckArrayBoundInstr* check = current->AsCheckArrayBound();
+      Definition* length = check->length()->definition();
+      if ((check->index()->definition() != index) ||
+          IsInLoop(loop_info, length)) {
+        return false;
       }
+      AddUnique(&lengths, length);
+    } else if (current->IsLoadIndexed()) {
+      LoadIndexedInstr* load = current->AsLoadIndexed();
+      if ((load->index()->definition() != index) ||
+          IsInLoop(loop_info, load->array()->definition()) ||
+          load->IsExternal()) {
+        return false;
+      }
+      loads.Add(load);
+      AddUnique(&arrays, load->array()->definition());
+    } else if (current->IsStoreIndexed() && (store == NULL)) {
+      store = current->AsStoreIndexed();
+      if ((store->index()->definition() != index) ||
+          IsInLoop(loop_info, store->array()->definition()) ||
+          (store->array()->definition()->representation() != kTagged)) {
+        return false;
+      }
+      AddUnique(&arrays, store->array()->definition());
+    } else if ((current->IsBinaryDoubleOp() || current->IsBinarySmiOp()) &&
+               (op == NULL)) {
+      op = current->AsDefinition();
+    } else {
+      return false;
+    }
+  }
+  if ((store == NULL) || (op == NULL) ||
+      (store->value()->definition() != op) ||
+      !body->last_instruction()->IsGoto()) {
+    return false;
+  }
+
+  const intptr_t scalar_cid = store->class_id();
+  intptr_t vector_cid = kIllegalCid;
+  Token::Kind op_kind = Token::kILLEGAL;
+  if ((scalar_cid == kTypedDataFloat32ArrayCid) && op->IsBinaryDoubleOp()) {
+    op_kind = op->AsBinaryDoubleOp()->op_kind();
+    if (!IsVectorizableFloat32Op(op_kind)) return false;
+    vector_cid = kTypedDataFloat32x4ArrayCid;
+  } else if ((scalar_cid == kTypedDataInt32ArrayCid) && op->IsBinarySmiOp()) {
+    op_kind = op->AsBinarySmiOp()->op_kind();
+    if (!IsVectorizableInt32Op(op_kind)) return false;
+    vector_cid = kTypedDataInt32x4ArrayCid;
+  } else {
+    return false;
+  }
+
+  // Every load reads an element of the stored type only for the operation.
+  for (intptr_t i = 0; i < loads.length(); ++i) {
+    if (loads[i]->class_id() != scalar_cid) return false;
+    for (Value* use = loads[i]->input_use_list();
+         use != NULL;
+         use = use->next_use()) {
+      if (use->instruction() != op) return false;
+    }
+  }
+  // The other operands must be float constants that can be splatted.
+  for (intptr_t i = 0; i < op->InputCount(); ++i) {
+    Definition* operand = op->InputAt(i)->definition();
+    if (operand->IsLoadIndexed() && (operand->GetBlock() == body)) continue;
+    if ((vector_cid != kTypedDataFloat32x4ArrayCid) ||
+        IsInLoop(loop_info, operand) ||
+        !IsFloat32Constant(operand)) {
+      return false;
     }
   }
+
+  if (FLAG_trace_optimization) {
+    OS::Print("Vectorizing loop B%" Pd "\n", header->block_id());
+  }
+
+  // Number of elements processed by the vector loop: the loop limit clamped
+  // to every accessed length and rounded down to a multiple of four.
+  GotoInstr* entry_goto = pre_header->last_instruction()->AsGoto();
+  Definition* initial_index = index->InputAt(entry_index)->definition();
+  Definition* vector_limit = limit;
+  for (intptr_t i = 0; i < arrays.length(); ++i) {
+    LoadFieldInstr* length =
+        new LoadFieldInstr(new Value(arrays[i]),
+                           CheckArrayBoundInstr::LengthOffsetFor(scalar_cid),
+                           Type::ZoneHandle(Type::SmiType()),
+                           true);  // Immutable.
+    length->set_result_cid(kSmiCid);
+    length->set_recognized_kind(
+        LoadFieldInstr::RecognizedKindFromArrayCid(scalar_cid));
+    flow_graph()->InsertBefore(entry_goto, length, NULL, Definition::kValue);
+    AddUnique(&lengths, length);
+  }
+  for (intptr_t i = 0; i < lengths.length(); ++i) {
+    if (lengths[i] == limit) continue;
+    MathMinMaxInstr* min = new MathMinMaxInstr(MethodRecognizer::kMathMin,
+                                               new Value(vector_limit),
+                                               new Value(lengths[i]),
+                                               Isolate::kNoDeoptId,
+                                               kSmiCid);
+    flow_graph()->InsertBefore(entry_goto, min, NULL, Definition::kValue);
+    vector_limit = min;
+  }
+  BinarySmiOpInstr* rounded_limit = new BinarySmiOpInstr(
+      Token::kBIT_AND,
+      new Value(vector_limit),
+      new Value(flow_graph()->GetConstant(Smi::ZoneHandle(Smi::New(-4)))),
+      Isolate::kNoDeoptId);
+  flow_graph()->InsertBefore(
+      entry_goto, rounded_limit, NULL, Definition::kValue);
+
+  const intptr_t try_index = header->try_index();
+  JoinEntryInstr* vector_header =
+      new JoinEntryInstr(flow_graph()->allocate_block_id(), try_index);
+  TargetEntryInstr* vector_body =
+      new TargetEntryInstr(flow_graph()->allocate_block_id(), try_index);
+  TargetEntryInstr* vector_exit =
+      new TargetEntryInstr(flow_graph()->allocate_block_id(), try_index);
+
+  // The vector exit takes the place of the pre-header as the entry of the
+  // scalar loop, which continues from the first unprocessed element.
+  pre_header->ReplaceAsPredecessorWith(vector_exit);
+  GotoInstr* vector_entry_goto = new GotoInstr(vector_header);
+  entry_goto->previous()->LinkTo(vector_entry_goto);
+  pre_header->set_last_instruction(vector_entry_goto);
+  vector_exit->LinkTo(entry_goto);
+
+  // The vector header's predecessors are the pre-header and the vector body,
+  // in block id order.
+  PhiInstr* vector_index = new PhiInstr(vector_header, 2);
+  vector_index->set_ssa_temp_index(flow_graph()->alloc_ssa_temp_index());
+  vector_index->mark_alive();
+  vector_header->InsertPhi(vector_index);
+  Value* initial_value = new Value(initial_index);
+  vector_index->SetInputAt(0, initial_value);
+  initial_index->AddInputUse(initial_value);
+
+  RelationalOpInstr* vector_compare =
+      new RelationalOpInstr(compare->token_pos(),
+                            Token::kLT,
+                            new Value(vector_index),
+                            new Value(rounded_limit),
+                            kSmiCid,
+                            Isolate::kNoDeoptId);
+  BranchInstr* vector_branch = new BranchInstr(vector_compare);
+  *vector_branch->true_successor_address() = vector_body;
+  *vector_branch->false_successor_address() = vector_exit;
+  vector_header->AppendInstruction(vector_branch);
+  vector_header->set_last_instruction(vector_branch);
+
+  Instruction* cursor = vector_body;
+  Definition* vector_operands[2];
+  for (intptr_t i = 0; i < op->InputCount(); ++i) {
+    Definition* operand = op->InputAt(i)->definition();
+    LoadIndexedInstr* load = operand->AsLoadIndexed();
+    if ((load != NULL) && (load->GetBlock() == body)) {
+      vector_operands[i] =
+          new LoadIndexedInstr(new Value(load->array()->definition()),
+                               new Value(vector_index),
+                               load->index_scale(),
+                               vector_cid,
+                               Isolate::kNoDeoptId);
+    } else {
+      vector_operands[i] =
+          new Float32x4SplatInstr(new Value(operand), Isolate::kNoDeoptId);
+    }
+    cursor = flow_graph()->AppendTo(
+        cursor, vector_operands[i], NULL, Definition::kValue);
+  }
+  Definition* vector_op = NULL;
+  if (vector_cid == kTypedDataFloat32x4ArrayCid) {
+    vector_op = new BinaryFloat32x4OpInstr(op_kind,
+                                           new Value(vector_operands[0]),
+                                           new Value(vector_operands[1]),
+                                           Isolate::kNoDeoptId);
+  } else {
+    vector_op = new BinaryInt32x4OpInstr(op_kind,
+                                         new Value(vector_operands[0]),
+                                         new Value(vector_operands[1]),
+                                         Isolate::kNoDeoptId);
+  }
+  cursor = flow_graph()->AppendTo(cursor, vector_op, NULL, Definition::kValue);
+  StoreIndexedInstr* vector_store =
+      new StoreIndexedInstr(new Value(store->array()->definition()),
+                            new Value(vector_index),
+                            new Value(vector_op),
+                            kNoStoreBarrier,
+                            store->index_scale(),
+                            vector_cid,
+                            Isolate::kNoDeoptId);
+  cursor = flow_graph()->AppendTo(
+      cursor, vector_store, NULL, Definition::kEffect);
+  // The index stays below the rounded limit, so it cannot overflow.
+  BinarySmiOpInstr* vector_increment = new BinarySmiOpInstr(
+      Token::kADD,
+      new Value(vector_index),
+      new Value(flow_graph()->GetConstant(Smi::ZoneHandle(Smi::New(4)))),
+      Isolate::kNoDeoptId);
+  vector_increment->set_overflow(false);
+  cursor = flow_graph()->AppendTo(
+      cursor, vector_increment, NULL, Definition::kValue);
+  GotoInstr* vector_back_edge = new GotoInstr(vector_header);
+  cursor->LinkTo(vector_back_edge);
+  vector_body->set_last_instruction(vector_back_edge);
+
+  Value* next_value = new Value(vector_increment);
+  vector_index->SetInputAt(1, next_value);
+  vector_increment->AddInputUse(next_value);
+
+  // The scalar loop starts where the vector loop stopped.
+  Value* scalar_start =
+      index->InputAt(header->IndexOfPredecessor(vector_exit));
+  scalar_start->RemoveFromUseList();
+  scalar_start->set_definition(vector_index);
+  vector_index->AddInputUse(scalar_start);
+
+  return true;
 }
 
 
@@ -6231,6 +7465,16 @@ void ConstantPropagator::VisitBranch(BranchInstr* instr) {
 }
 
 
+void ConstantPropagator::VisitJumpTable(JumpTableInstr* instr) {
+  // Any successor may be reachable, but only if this instruction is.
+  if (reachable_->Contains(instr->GetBlock()->preorder_number())) {
+    for (intptr_t i = 0; i < instr->SuccessorCount(); ++i) {
+      SetReachable(instr->SuccessorAt(i));
+    }
+  }
+}
+
+
 // --------------------------------------------------------------------------
 // Analysis of non-definition instructions.  They do not have values so they
 // cannot have constant values.
@@ -6855,6 +8099,49 @@ void ConstantPropagator::VisitUnaryMintOp(
 }
 
 
+void ConstantPropagator::VisitBoxUint32(BoxUint32Instr* instr) {
+  SetValue(instr, non_constant_);
+}
+
+
+void ConstantPropagator::VisitUnboxUint32(UnboxUint32Instr* instr) {
+  SetValue(instr, non_constant_);
+}
+
+
+void ConstantPropagator::VisitUnboxedIntConverter(
+    UnboxedIntConverterInstr* instr) {
+  SetValue(instr, non_constant_);
+}
+
+
+void ConstantPropagator::VisitBinaryUint32Op(BinaryUint32OpInstr* instr) {
+  // Truncating uint32 arithmetic is introduced after constant propagation
+  // has run. Don't fold it with the untruncated HandleBinaryOp.
+  SetValue(instr, non_constant_);
+}
+
+
+void ConstantPropagator::VisitShiftUint32Op(ShiftUint32OpInstr* instr) {
+  SetValue(instr, non_constant_);
+}
+
+
+void ConstantPropagator::VisitBoxInt32(BoxInt32Instr* instr) {
+  SetValue(instr, non_constant_);
+}
+
+
+void ConstantPropagator::VisitUnboxInt32(UnboxInt32Instr* instr) {
+  SetValue(instr, non_constant_);
+}
+
+
+void ConstantPropagator::VisitBinaryInt32Op(BinaryInt32OpInstr* instr) {
+  SetValue(instr, non_constant_);
+}
+
+
 void ConstantPropagator::VisitUnarySmiOp(UnarySmiOpInstr* instr) {
   const Object& value = instr->value()->definition()->constant_value();
   if (IsNonConstant(value)) {
@@ -7216,6 +8503,10 @@ void ConstantPropagator::VisitBranches() {
         SetReachable(branch->true_successor());
         SetReachable(branch->false_successor());
       }
+    } else if (last->IsJumpTable()) {
+      for (intptr_t i = 0; i < last->SuccessorCount(); ++i) {
+        SetReachable(last->SuccessorAt(i));
+      }
     }
   }
 }
@@ -7655,7 +8946,8 @@ void IfConverter::Simplify(FlowGraph* flow_graph) {
 
       if (IsTrivialBlock(pred1, v1->definition()) &&
           IsTrivialBlock(pred2, v2->definition()) &&
-          (pred1->PredecessorAt(0) == pred2->PredecessorAt(0))) {
+          (pred1->PredecessorAt(0) == pred2->PredecessorAt(0)) &&
+          pred1->PredecessorAt(0)->last_instruction()->IsBranch()) {
         BlockEntryInstr* pred = pred1->PredecessorAt(0);
         BranchInstr* branch = pred->last_instruction()->AsBranch();
         ComparisonInstr* comparison = branch->comparison();
@@ -7736,20 +9028,115 @@ void FlowGraphOptimizer::EliminateEnvironments() {
 }
 
 
+void FlowGraphOptimizer::PretenureAllocations() {
+  if (!FLAG_pretenure) return;
+  ClassTable* class_table = Isolate::Current()->class_table();
+  for (intptr_t i = 0; i < block_order_.length(); ++i) {
+    BlockEntryInstr* block = block_order_[i];
+    for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+      AllocateObjectInstr* alloc = it.Current()->AsAllocateObject();
+      // The stores initializing type arguments do not use a write barrier,
+      // so only instances without type arguments can be pretenured.
+      if ((alloc != NULL) &&
+          (alloc->cls().NumTypeArguments() == 0) &&
+          class_table->ShouldPretenure(alloc->cls().id())) {
+        if (FLAG_trace_optimization) {
+          OS::Print("Pretenuring allocation of %s\n",
+                    alloc->cls().ToCString());
+        }
+        alloc->set_space(Heap::kOld);
+        flow_graph_->AddToPretenuredClasses(&alloc->cls());
+      }
+    }
+  }
+}
+
+
+// Returns the allocation this allocation is stored into or NULL if it is
+// only used in stores into its own fields.
+static AllocateObjectInstr* OuterAllocation(AllocateObjectInstr* alloc) {
+  for (Value* use = alloc->input_use_list();
+       use != NULL;
+       use = use->next_use()) {
+    if (use->use_index() == 1) {
+      return use->instruction()->InputAt(0)->definition()->AsAllocateObject();
+    }
+  }
+  return NULL;
+}
+
+
+// Returns true if the given store of an allocation into a field of another
+// allocation can be described by nested materializations: the outer object
+// is allocated earlier in the same block, the store is in that block and it
+// is the only store into this field of the outer object. Under these
+// conditions the field of the outer object contains either null or the
+// stored object at every deoptimization exit, which is why load forwarding
+// never has to merge it with other values.
+static bool IsNestedSinkingStore(AllocateObjectInstr* alloc,
+                                 StoreInstanceFieldInstr* store) {
+  AllocateObjectInstr* outer =
+      store->instance()->definition()->AsAllocateObject();
+  if ((outer == NULL) ||
+      (outer == alloc) ||
+      (outer->GetBlock() != alloc->GetBlock()) ||
+      (store->GetBlock() != alloc->GetBlock())) {
+    return false;
+  }
+
+  // The outer object must be allocated before the inner one. This excludes
+  // cycles between sinking candidates.
+  for (Instruction* instr = alloc->previous();
+       instr != outer;
+       instr = instr->previous()) {
+    if (instr->IsBlockEntry()) return false;
+  }
+
+  for (Value* use = outer->input_use_list();
+       use != NULL;
+       use = use->next_use()) {
+    StoreInstanceFieldInstr* other = use->instruction()->AsStoreInstanceField();
+    if ((other != NULL) &&
+        (other != store) &&
+        (use->use_index() == 0) &&
+        (other->field().raw() == store->field().raw())) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
 // Right now we are attempting to sink allocation only into
 // deoptimization exit. So candidate should only be used in StoreInstanceField
-// instructions that write into fields of the allocated object.
+// instructions that write into fields of the allocated object, plus at most
+// one store of the object itself into a field of another candidate (see
+// IsNestedSinkingStore). This allows, for example, to eliminate closures
+// stored into objects that are themselves eliminated.
 // We do not support materialization of the object that has type arguments.
 static bool IsAllocationSinkingCandidate(AllocateObjectInstr* alloc) {
   if (!HasSimpleTypeArguments(alloc)) return false;
 
+  bool is_stored = false;
   for (Value* use = alloc->input_use_list();
        use != NULL;
        use = use->next_use()) {
-    if (!(use->instruction()->IsStoreInstanceField() &&
-          (use->use_index() == 0))) {
+    StoreInstanceFieldInstr* store = use->instruction()->AsStoreInstanceField();
+    if (store == NULL) {
+      return false;
+    }
+    // Load forwarding can't connect the tagged loads inserted for
+    // materializations with unboxed stores.
+    if (store->IsUnboxedStore()) {
       return false;
     }
+    if (use->use_index() != 0) {
+      if (is_stored || !IsNestedSinkingStore(alloc, store)) {
+        return false;
+      }
+      is_stored = true;
+    }
   }
 
   return true;
@@ -7759,18 +9146,17 @@ static bool IsAllocationSinkingCandidate(AllocateObjectInstr* alloc) {
 // Remove the given allocation from the graph. It is not observable.
 // If deoptimization occurs the object will be materialized.
 static void EliminateAllocation(AllocateObjectInstr* alloc) {
-  ASSERT(IsAllocationSinkingCandidate(alloc));
-
   if (FLAG_trace_optimization) {
     OS::Print("removing allocation from the graph: v%" Pd "\n",
               alloc->ssa_temp_index());
   }
 
   // As an allocation sinking candidate it is only used in stores to its own
-  // fields. Remove these stores.
+  // fields and in stores into other sinking candidates. Remove these stores.
   for (Value* use = alloc->input_use_list();
        use != NULL;
        use = alloc->input_use_list()) {
+    ASSERT(use->instruction()->IsStoreInstanceField());
     use->instruction()->RemoveFromGraph();
   }
 
@@ -7788,29 +9174,121 @@ static void EliminateAllocation(AllocateObjectInstr* alloc) {
 }
 
 
-void AllocationSinking::Optimize() {
-  GrowableArray<AllocateObjectInstr*> candidates(5);
+static bool IsCandidate(const GrowableArray<AllocateObjectInstr*>& candidates,
+                        AllocateObjectInstr* alloc) {
+  for (intptr_t i = 0; i < candidates.length(); i++) {
+    if (candidates[i] == alloc) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+// Add given instruction to the list of the instructions if it is not yet
+// present there.
+static void AddInstruction(ZoneGrowableArray<Instruction*>* exits,
+                           Instruction* exit) {
+  ASSERT(!exit->IsGraphEntry());
+  for (intptr_t i = 0; i < exits->length(); i++) {
+    if ((*exits)[i] == exit) {
+      return;
+    }
+  }
+  exits->Add(exit);
+}
+
 
-  // Collect sinking candidates.
-  const GrowableArray<BlockEntryInstr*>& postorder = flow_graph_->postorder();
-  for (BlockIterator block_it(postorder);
+// Returns true if the given instruction follows the given store: either in
+// the same block or in a block dominated by the store's block.
+static bool IsAfter(Instruction* instr, Instruction* store) {
+  BlockEntryInstr* block = store->GetBlock();
+  if (instr->GetBlock() != block) {
+    return block->Dominates(instr->GetBlock());
+  }
+  for (Instruction* it = store->next(); it != NULL; it = it->next()) {
+    if (it == instr) return true;
+  }
+  return false;
+}
+
+
+void AllocationSinking::Optimize() {
+  GrowableArray<AllocateObjectInstr*> discovered(5);
+
+  // Collect sinking candidates. Blocks are visited in reverse postorder so
+  // that an allocation is always discovered after the allocations it can be
+  // stored into.
+  const GrowableArray<BlockEntryInstr*>& reverse_postorder =
+      flow_graph_->reverse_postorder();
+  for (BlockIterator block_it(reverse_postorder);
        !block_it.Done();
        block_it.Advance()) {
     BlockEntryInstr* block = block_it.Current();
     for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
       AllocateObjectInstr* alloc = it.Current()->AsAllocateObject();
       if ((alloc != NULL) && IsAllocationSinkingCandidate(alloc)) {
-        if (FLAG_trace_optimization) {
-          OS::Print("discovered allocation sinking candidate: v%" Pd "\n",
-                    alloc->ssa_temp_index());
-        }
+        discovered.Add(alloc);
+      }
+    }
+  }
+
+  // An allocation stored into another object can only be eliminated together
+  // with that object. Outer objects are discovered before inner ones, so a
+  // single pass drops all allocations stored into non-candidates.
+  GrowableArray<AllocateObjectInstr*> candidates(5);
+  for (intptr_t i = 0; i < discovered.length(); i++) {
+    AllocateObjectInstr* outer = OuterAllocation(discovered[i]);
+    if ((outer == NULL) || IsCandidate(candidates, outer)) {
+      candidates.Add(discovered[i]);
+    }
+  }
 
-        // All sinking candidate are known to be not aliased.
-        alloc->set_identity(AllocateObjectInstr::kNotAliased);
+  for (intptr_t i = 0; i < candidates.length(); i++) {
+    AllocateObjectInstr* alloc = candidates[i];
+    if (FLAG_trace_optimization) {
+      OS::Print("discovered allocation sinking candidate: v%" Pd "\n",
+                alloc->ssa_temp_index());
+    }
+
+    // All sinking candidate are known to be not aliased.
+    alloc->set_identity(AllocateObjectInstr::kNotAliased);
+  }
 
-        candidates.Add(alloc);
+  // Collect all instructions that mention each candidate in the environment.
+  // An object stored into another candidate must also be materialized
+  // wherever the outer object is materialized after the store. Outer objects
+  // precede inner ones in the candidates list.
+  GrowableArray<ZoneGrowableArray<Instruction*>*> exits(candidates.length());
+  for (intptr_t i = 0; i < candidates.length(); i++) {
+    AllocateObjectInstr* alloc = candidates[i];
+    ZoneGrowableArray<Instruction*>* alloc_exits =
+        new ZoneGrowableArray<Instruction*>(10);
+    for (Value* use = alloc->env_use_list();
+         use != NULL;
+         use = use->next_use()) {
+      AddInstruction(alloc_exits, use->instruction());
+    }
+
+    AllocateObjectInstr* outer = OuterAllocation(alloc);
+    if (outer != NULL) {
+      Instruction* store = NULL;
+      for (Value* use = alloc->input_use_list();
+           use != NULL;
+           use = use->next_use()) {
+        if (use->use_index() == 1) store = use->instruction();
+      }
+      for (intptr_t k = 0; k < i; k++) {
+        if (candidates[k] != outer) continue;
+        for (intptr_t e = 0; e < exits[k]->length(); e++) {
+          Instruction* exit = (*exits[k])[e];
+          if (IsAfter(exit, store)) {
+            AddInstruction(alloc_exits, exit);
+          }
+        }
       }
     }
+    exits.Add(alloc_exits);
   }
 
   // Insert MaterializeObject instructions that will describe the state of the
@@ -7820,8 +9298,10 @@ void AllocationSinking::Optimize() {
   //           ...
   //   v_N     <- LoadField(v_0, field_N)
   //   v_{N+1} <- MaterializeObject(field_1 = v_1, ..., field_N = v_{N})
-  for (intptr_t i = 0; i < candidates.length(); i++) {
-    InsertMaterializations(candidates[i]);
+  // Inner objects are processed first so that their materializations precede
+  // materializations of the objects they are stored into.
+  for (intptr_t i = candidates.length() - 1; i >= 0; i--) {
+    InsertMaterializations(candidates[i], *exits[i]);
   }
 
   // Run load forwarding to eliminate LoadField instructions inserted above.
@@ -7832,6 +9312,19 @@ void AllocationSinking::Optimize() {
   //      external effects from calls.
   LoadOptimizer::OptimizeGraph(flow_graph_);
 
+  // Loads from the outer objects were forwarded to the inner allocations.
+  // Replace them with the inner materializations inserted at the same exit.
+  for (intptr_t i = 0; i < materializations_.length(); i++) {
+    MaterializeObjectInstr* mat = materializations_[i];
+    for (intptr_t j = 0; j < mat->InputCount(); j++) {
+      AllocateObjectInstr* alloc =
+          mat->InputAt(j)->definition()->AsAllocateObject();
+      if ((alloc != NULL) && IsCandidate(candidates, alloc)) {
+        mat->InputAt(j)->BindTo(FindMaterialization(mat, alloc));
+      }
+    }
+  }
+
   if (FLAG_trace_optimization) {
     FlowGraphPrinter::PrintGraph("Sinking", flow_graph_);
   }
@@ -7859,11 +9352,37 @@ void AllocationSinking::Optimize() {
 }
 
 
+// Find the materialization of the given allocation inserted for the same
+// exit as the given materialization of the outer object.
+MaterializeObjectInstr* AllocationSinking::FindMaterialization(
+    MaterializeObjectInstr* outer,
+    AllocateObjectInstr* alloc) {
+  for (Instruction* instr = outer->previous();
+       !instr->IsBlockEntry();
+       instr = instr->previous()) {
+    MaterializeObjectInstr* mat = instr->AsMaterializeObject();
+    if ((mat != NULL) && (mat->allocation() == alloc)) {
+      return mat;
+    }
+  }
+  UNREACHABLE();
+  return NULL;
+}
+
+
 // Remove materializations from the graph. Register allocator will treat them
 // as part of the environment not as a real instruction.
 void AllocationSinking::DetachMaterializations() {
   for (intptr_t i = 0; i < materializations_.length(); i++) {
-    ASSERT(materializations_[i]->input_use_list() == NULL);
+#if defined(DEBUG)
+    // Materializations can only be referenced by the environment and by
+    // materializations of the objects they are stored into.
+    for (Value* use = materializations_[i]->input_use_list();
+         use != NULL;
+         use = use->next_use()) {
+      ASSERT(use->instruction()->IsMaterializeObject());
+    }
+#endif
     materializations_[i]->previous()->LinkTo(materializations_[i]->next());
   }
 }
@@ -7881,20 +9400,6 @@ static void AddField(ZoneGrowableArray<const Field*>* fields,
 }
 
 
-// Add given instruction to the list of the instructions if it is not yet
-// present there.
-static void AddInstruction(GrowableArray<Instruction*>* exits,
-                           Instruction* exit) {
-  ASSERT(!exit->IsGraphEntry());
-  for (intptr_t i = 0; i < exits->length(); i++) {
-    if ((*exits)[i] == exit) {
-      return;
-    }
-  }
-  exits->Add(exit);
-}
-
-
 // Insert MaterializeObject instruction for the given allocation before
 // the given instruction that can deoptimize.
 void AllocationSinking::CreateMaterializationAt(
@@ -7917,7 +9422,8 @@ void AllocationSinking::CreateMaterializationAt(
     values->Add(new Value(load));
   }
 
-  MaterializeObjectInstr* mat = new MaterializeObjectInstr(cls, fields, values);
+  MaterializeObjectInstr* mat =
+      new MaterializeObjectInstr(alloc, cls, fields, values);
   flow_graph_->InsertBefore(exit, mat, NULL, Definition::kValue);
 
   // Replace all mentions of this allocation with a newly inserted
@@ -7940,7 +9446,9 @@ void AllocationSinking::CreateMaterializationAt(
 }
 
 
-void AllocationSinking::InsertMaterializations(AllocateObjectInstr* alloc) {
+void AllocationSinking::InsertMaterializations(
+    AllocateObjectInstr* alloc,
+    const ZoneGrowableArray<Instruction*>& exits) {
   // Collect all fields that are written for this instance.
   ZoneGrowableArray<const Field*>* fields =
       new ZoneGrowableArray<const Field*>(5);
@@ -7949,7 +9457,10 @@ void AllocationSinking::InsertMaterializations(AllocateObjectInstr* alloc) {
        use != NULL;
        use = use->next_use()) {
     ASSERT(use->instruction()->IsStoreInstanceField());
-    AddField(fields, use->instruction()->AsStoreInstanceField()->field());
+    // Skip the store of this object into a field of an outer object.
+    if (use->use_index() == 0) {
+      AddField(fields, use->instruction()->AsStoreInstanceField()->field());
+    }
   }
 
   if (alloc->ArgumentCount() > 0) {
@@ -7964,17 +9475,10 @@ void AllocationSinking::InsertMaterializations(AllocateObjectInstr* alloc) {
             alloc->cls(),
             0));  // No token position.
     type_args_field.SetOffset(alloc->cls().type_arguments_field_offset());
+    type_args_field.set_is_unboxing_candidate(false);
     AddField(fields, type_args_field);
   }
 
-  // Collect all instructions that mention this object in the environment.
-  GrowableArray<Instruction*> exits(10);
-  for (Value* use = alloc->env_use_list();
-       use != NULL;
-       use = use->next_use()) {
-    AddInstruction(&exits, use->instruction());
-  }
-
   // Insert materializations at environment uses.
   for (intptr_t i = 0; i < exits.length(); i++) {
     CreateMaterializationAt(exits[i], alloc, alloc->cls(), *fields);
@@ -57,6 +57,10 @@ class FlowGraphOptimizer : public FlowGraphVisitor {
   // Remove environments from the instructions which do not deoptimize.
   void EliminateEnvironments();
 
+  // Allocate the instances of classes whose instances mostly survive
+  // scavenges directly in old space.
+  void PretenureAllocations();
+
   virtual void VisitStaticCall(StaticCallInstr* instr);
   virtual void VisitInstanceCall(InstanceCallInstr* instr);
 
@@ -71,6 +75,17 @@ class FlowGraphOptimizer : public FlowGraphVisitor {
   // Attempt to build ICData for call using propagated class-ids.
   bool TryCreateICData(InstanceCallInstr* call);
 
+  // Switch loads and stores of unboxed fields to unboxed representations.
+  void SelectFieldRepresentations();
+
+  // Switch integer arithmetic that is observed only modulo 2^32 to unboxed
+  // uint32 representation.
+  void SelectUint32Representations();
+
+  // Switch Smi arithmetic that range analysis proved to fit into 32 bits to
+  // unboxed int32 representation.
+  void SelectInt32Representations();
+
   void SpecializePolymorphicInstanceCall(PolymorphicInstanceCallInstr* call);
 
   bool TryReplaceWithStoreIndexed(InstanceCallInstr* call);
@@ -235,6 +250,30 @@ class LICM : public ValueObject {
 };
 
 
+// Rewrites counted loops that apply a single element-wise operation to
+// Float32List or Int32List arrays
+//
+//   for (var i = 0; i < n; i++) c[i] = a[i] op b[i];
+//
+// into a loop that processes four elements per iteration with Float32x4 or
+// Int32x4 operations, followed by the original loop for the remaining
+// elements. The vector loop never runs past the length of any array it
+// accesses, so it needs no bounds checks.
+class LoopVectorizer : public ValueObject {
+ public:
+  explicit LoopVectorizer(FlowGraph* flow_graph);
+
+  void Optimize();
+
+ private:
+  FlowGraph* flow_graph() const { return flow_graph_; }
+
+  bool TryVectorize(JoinEntryInstr* header);
+
+  FlowGraph* const flow_graph_;
+};
+
+
 // A simple common subexpression elimination based
 // on the dominator tree.
 class DominatorBasedCSE : public AllStatic {
@@ -366,7 +405,8 @@ class AllocationSinking : public ZoneAllocated {
   void DetachMaterializations();
 
  private:
-  void InsertMaterializations(AllocateObjectInstr* alloc);
+  void InsertMaterializations(AllocateObjectInstr* alloc,
+                              const ZoneGrowableArray<Instruction*>& exits);
 
   void CreateMaterializationAt(
       Instruction* exit,
@@ -374,6 +414,9 @@ class AllocationSinking : public ZoneAllocated {
       const Class& cls,
       const ZoneGrowableArray<const Field*>& fields);
 
+  MaterializeObjectInstr* FindMaterialization(MaterializeObjectInstr* outer,
+                                              AllocateObjectInstr* alloc);
+
   FlowGraph* flow_graph_;
 
   GrowableArray<MaterializeObjectInstr*> materializations_;
@@ -1035,6 +1035,46 @@ CompileType UnboxIntegerInstr::ComputeType() const {
 }
 
 
+CompileType BoxUint32Instr::ComputeType() const {
+  return (kSmiBits >= 32) ? CompileType::FromCid(kSmiCid) : CompileType::Int();
+}
+
+
+CompileType UnboxUint32Instr::ComputeType() const {
+  return CompileType::Int();
+}
+
+
+CompileType UnboxedIntConverterInstr::ComputeType() const {
+  return CompileType::Int();
+}
+
+
+CompileType BinaryUint32OpInstr::ComputeType() const {
+  return CompileType::Int();
+}
+
+
+CompileType ShiftUint32OpInstr::ComputeType() const {
+  return CompileType::Int();
+}
+
+
+CompileType BoxInt32Instr::ComputeType() const {
+  return (kSmiBits >= 32) ? CompileType::FromCid(kSmiCid) : CompileType::Int();
+}
+
+
+CompileType UnboxInt32Instr::ComputeType() const {
+  return CompileType::FromCid(kSmiCid);
+}
+
+
+CompileType BinaryInt32OpInstr::ComputeType() const {
+  return CompileType::Int();
+}
+
+
 CompileType DoubleToIntegerInstr::ComputeType() const {
   return CompileType::Int();
 }
@@ -103,6 +103,26 @@ void FreeList::Reset() {
 }
 
 
+void FreeList::MergeFrom(FreeList* other) {
+  for (int i = 0; i < (kNumLists + 1); i++) {
+    FreeListElement* head = other->free_lists_[i];
+    if (head == NULL) {
+      continue;
+    }
+    FreeListElement* tail = head;
+    while (tail->next() != NULL) {
+      tail = tail->next();
+    }
+    if ((free_lists_[i] == NULL) && (i != kNumLists)) {
+      free_map_.Set(i, true);
+    }
+    tail->set_next(free_lists_[i]);
+    free_lists_[i] = head;
+  }
+  other->Reset();
+}
+
+
 intptr_t FreeList::IndexForSize(intptr_t size) {
   ASSERT(size >= kObjectAlignment);
   ASSERT(Utils::IsAligned(size, kObjectAlignment));
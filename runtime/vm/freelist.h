@@ -80,6 +80,9 @@ class FreeList {
 
   void Reset();
 
+  // Moves all elements of 'other' to this free list, leaving 'other' empty.
+  void MergeFrom(FreeList* other);
+
   intptr_t Length(int index) const;
 
   void Print() const;
@@ -50,4 +50,32 @@ TEST_CASE(FreeList) {
   delete free_list;
 }
 
+
+TEST_CASE(FreeListMerge) {
+  FreeList* free_list = new FreeList();
+  FreeList* other = new FreeList();
+  intptr_t kBlobSize = 64 * KB;
+  intptr_t kSmallObjectSize = 4 * kWordSize;
+  uword blob = reinterpret_cast<uword>(malloc(kBlobSize));
+  uword blob2 = reinterpret_cast<uword>(malloc(kBlobSize));
+  free_list->Free(blob, kSmallObjectSize);
+  other->Free(blob + kSmallObjectSize, kSmallObjectSize);
+  other->Free(blob2, kBlobSize);
+  free_list->MergeFrom(other);
+  // The other free list has been emptied.
+  EXPECT_EQ(0U, other->TryAllocate(kSmallObjectSize));
+  // Both small elements are available, followed by the large one.
+  uword small_object = free_list->TryAllocate(kSmallObjectSize);
+  uword small_object2 = free_list->TryAllocate(kSmallObjectSize);
+  EXPECT_EQ(blob, Utils::Minimum(small_object, small_object2));
+  EXPECT_EQ(blob + kSmallObjectSize, Utils::Maximum(small_object,
+                                                    small_object2));
+  EXPECT_EQ(blob2, free_list->TryAllocate(kSmallObjectSize));
+  // Delete the memory associated with the test.
+  free(reinterpret_cast<void*>(blob));
+  free(reinterpret_cast<void*>(blob2));
+  delete other;
+  delete free_list;
+}
+
 }  // namespace dart
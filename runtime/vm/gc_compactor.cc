@@ -0,0 +1,232 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/gc_compactor.h"
+
+#include "vm/dart_api_state.h"
+#include "vm/heap.h"
+#include "vm/isolate.h"
+#include "vm/object_id_ring.h"
+#include "vm/pages.h"
+#include "vm/raw_object.h"
+#include "vm/stack_frame.h"
+#include "vm/store_buffer.h"
+#include "vm/visitor.h"
+#include "vm/weak_table.h"
+
+namespace dart {
+
+// Evacuated objects are forwarded the same way the scavenger forwards new
+// objects: the header of the original is replaced by the address of the copy
+// with the mark bit set.
+enum {
+  kForwardingMask = 1 << RawObject::kMarkBit,
+  kForwarded = kForwardingMask
+};
+
+
+class CompactorUpdateVisitor : public ObjectPointerVisitor {
+ public:
+  CompactorUpdateVisitor(Isolate* isolate, const GCCompactor* compactor)
+      : ObjectPointerVisitor(isolate), compactor_(compactor) { }
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      compactor_->UpdatePointer(current);
+    }
+  }
+
+ private:
+  const GCCompactor* compactor_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompactorUpdateVisitor);
+};
+
+
+class CompactorWeakVisitor : public HandleVisitor {
+ public:
+  explicit CompactorWeakVisitor(const GCCompactor* compactor)
+      : compactor_(compactor) { }
+
+  void VisitHandle(uword addr) {
+    FinalizablePersistentHandle* handle =
+        reinterpret_cast<FinalizablePersistentHandle*>(addr);
+    compactor_->UpdatePointer(handle->raw_addr());
+  }
+
+ private:
+  const GCCompactor* compactor_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompactorWeakVisitor);
+};
+
+
+static int CompareHeapPages(HeapPage* const* a, HeapPage* const* b) {
+  uword a_addr = reinterpret_cast<uword>(*a);
+  uword b_addr = reinterpret_cast<uword>(*b);
+  if (a_addr < b_addr) {
+    return -1;
+  }
+  return (a_addr > b_addr) ? 1 : 0;
+}
+
+
+intptr_t GCCompactor::MarkedSize(HeapPage* page) {
+  intptr_t marked = 0;
+  uword current = page->object_start();
+  uword end = page->object_end();
+  while (current < end) {
+    RawObject* raw_obj = RawObject::FromAddr(current);
+    intptr_t obj_size = raw_obj->Size();
+    if (raw_obj->IsMarked()) {
+      marked += obj_size;
+    }
+    current += obj_size;
+  }
+  return marked;
+}
+
+
+bool GCCompactor::IsEvacuated(uword addr) const {
+  if ((addr < evacuated_start_) || (addr >= evacuated_end_)) {
+    return false;
+  }
+  intptr_t low = 0;
+  intptr_t high = pages_.length() - 1;
+  while (low <= high) {
+    intptr_t mid = low + ((high - low) >> 1);
+    HeapPage* page = pages_[mid];
+    if (addr < page->object_start()) {
+      high = mid - 1;
+    } else if (addr >= page->object_end()) {
+      low = mid + 1;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void GCCompactor::UpdatePointer(RawObject** p) const {
+  RawObject* raw_obj = *p;
+  if (!raw_obj->IsHeapObject() || raw_obj->IsNewObject()) {
+    return;
+  }
+  uword raw_addr = RawObject::ToAddr(raw_obj);
+  if (!IsEvacuated(raw_addr)) {
+    return;
+  }
+  // Only marked objects are reachable and all of them have been copied.
+  uword header = *reinterpret_cast<uword*>(raw_addr);
+  ASSERT((header & kForwardingMask) == kForwarded);
+  *p = RawObject::FromAddr(header & ~kForwardingMask);
+}
+
+
+intptr_t GCCompactor::EvacuatePage(HeapPage* page) {
+  intptr_t evacuated = 0;
+  uword current = page->object_start();
+  uword end = page->object_end();
+  while (current < end) {
+    RawObject* raw_obj = RawObject::FromAddr(current);
+    intptr_t obj_size = raw_obj->Size();
+    if (raw_obj->IsMarked()) {
+      uword new_addr = page_space_->TryAllocate(obj_size,
+                                                HeapPage::kData,
+                                                PageSpace::kForceGrowth);
+      if (new_addr == 0) {
+        FATAL("Out of memory during compaction.\n");
+      }
+      memmove(reinterpret_cast<void*>(new_addr),
+              reinterpret_cast<void*>(current),
+              obj_size);
+      RawObject::FromAddr(new_addr)->ClearMarkBit();
+      *reinterpret_cast<uword*>(current) = new_addr | kForwarded;
+      evacuated += obj_size;
+    }
+    current += obj_size;
+  }
+  return evacuated;
+}
+
+
+void GCCompactor::UpdateWeakTables() {
+  for (int sel = 0;
+       sel < Heap::kNumWeakSelectors;
+       sel++) {
+    WeakTable* table = heap_->GetWeakTable(
+        Heap::kOld, static_cast<Heap::WeakSelector>(sel));
+    heap_->SetWeakTable(Heap::kOld,
+                        static_cast<Heap::WeakSelector>(sel),
+                        WeakTable::NewFrom(table));
+    intptr_t size = table->size();
+    for (intptr_t i = 0; i < size; i++) {
+      if (table->IsValidEntryAt(i)) {
+        RawObject* raw_obj = table->ObjectAt(i);
+        UpdatePointer(&raw_obj);
+        heap_->SetWeakEntry(raw_obj,
+                            static_cast<Heap::WeakSelector>(sel),
+                            table->ValueAt(i));
+      }
+    }
+    // Remove the old table as it has been replaced with the newly allocated
+    // table above.
+    delete table;
+  }
+}
+
+
+void GCCompactor::UpdateStoreBuffer(Isolate* isolate) {
+  StoreBuffer* buffer = isolate->store_buffer();
+  StoreBufferBlock* blocks = buffer->Blocks();
+  while (blocks != NULL) {
+    StoreBufferBlock* next = blocks->next();
+    intptr_t count = blocks->Count();
+    for (intptr_t i = 0; i < count; i++) {
+      RawObject* raw_obj = blocks->At(i);
+      UpdatePointer(&raw_obj);
+      buffer->AddObjectGC(raw_obj);
+    }
+    delete blocks;
+    blocks = next;
+  }
+}
+
+
+intptr_t GCCompactor::EvacuatePages(Isolate* isolate,
+                                    const GrowableArray<HeapPage*>& pages) {
+  ASSERT(pages.length() > 0);
+  for (intptr_t i = 0; i < pages.length(); i++) {
+    pages_.Add(pages[i]);
+  }
+  pages_.Sort(CompareHeapPages);
+  evacuated_start_ = pages_[0]->object_start();
+  evacuated_end_ = pages_.Last()->object_end();
+
+  intptr_t evacuated = 0;
+  for (intptr_t i = 0; i < pages_.length(); i++) {
+    evacuated += EvacuatePage(pages_[i]);
+  }
+
+  // Update the references to the copies. The evacuated pages are no longer
+  // part of the page space, so they are not visited.
+  CompactorUpdateVisitor visitor(isolate, this);
+  isolate->VisitObjectPointers(&visitor,
+                               false,
+                               StackFrameIterator::kDontValidateFrames);
+  CompactorWeakVisitor weak_visitor(this);
+  isolate->VisitWeakPersistentHandles(&weak_visitor, true);
+  ObjectIdRing* ring = isolate->object_id_ring();
+  if (ring != NULL) {
+    ring->VisitPointers(&visitor);
+  }
+  heap_->IterateNewPointers(&visitor);
+  heap_->IterateOldPointers(&visitor);
+  UpdateWeakTables();
+  UpdateStoreBuffer(isolate);
+  return evacuated;
+}
+
+}  // namespace dart
@@ -0,0 +1,64 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_GC_COMPACTOR_H_
+#define VM_GC_COMPACTOR_H_
+
+#include "vm/allocation.h"
+#include "vm/growable_array.h"
+
+namespace dart {
+
+// Forward declarations.
+class Heap;
+class HeapPage;
+class Isolate;
+class PageSpace;
+class RawObject;
+
+// The class GCCompactor is used to evacuate the marked objects of sparsely
+// used old generation data pages after marking, so that the pages can be
+// released. The evacuated pages must have been removed from the page list of
+// the page space, which must have been swept, before calling EvacuatePages.
+class GCCompactor : public ValueObject {
+ public:
+  GCCompactor(Heap* heap, PageSpace* page_space)
+      : heap_(heap),
+        page_space_(page_space),
+        pages_(),
+        evacuated_start_(0),
+        evacuated_end_(0) { }
+  ~GCCompactor() { }
+
+  // Returns the size of memory used by the marked objects of the page.
+  static intptr_t MarkedSize(HeapPage* page);
+
+  // Copy the marked objects of the pages into the remaining pages of the page
+  // space and update all references to them. Returns the size of the copied
+  // objects.
+  intptr_t EvacuatePages(Isolate* isolate,
+                         const GrowableArray<HeapPage*>& pages);
+
+  // Replaces a reference to an evacuated object with a reference to its copy.
+  void UpdatePointer(RawObject** p) const;
+
+ private:
+  intptr_t EvacuatePage(HeapPage* page);
+  bool IsEvacuated(uword addr) const;
+  void UpdateWeakTables();
+  void UpdateStoreBuffer(Isolate* isolate);
+
+  Heap* heap_;
+  PageSpace* page_space_;
+  // The evacuated pages, sorted by address.
+  GrowableArray<HeapPage*> pages_;
+  uword evacuated_start_;
+  uword evacuated_end_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(GCCompactor);
+};
+
+}  // namespace dart
+
+#endif  // VM_GC_COMPACTOR_H_
@@ -8,16 +8,26 @@
 #include <utility>
 
 #include "vm/allocation.h"
+#include "vm/atomic.h"
+#include "vm/dart.h"
 #include "vm/dart_api_state.h"
 #include "vm/isolate.h"
 #include "vm/pages.h"
 #include "vm/raw_object.h"
 #include "vm/stack_frame.h"
+#include "vm/store_buffer.h"
+#include "vm/thread_pool.h"
 #include "vm/visitor.h"
 #include "vm/object_id_ring.h"
 
 namespace dart {
 
+DEFINE_FLAG(int, marker_tasks, 1,
+            "Number of tasks used to mark old space. Values larger than 1 "
+            "mark objects in parallel using the VM thread pool.");
+
+class ParallelMarking;
+
 // A simple chunked marking stack.
 class MarkingStack : public ValueObject {
  public:
@@ -79,6 +89,24 @@ class MarkingStack : public ValueObject {
     return marking_stack_[top_];
   }
 
+  // All chunks but the head chunk are full.
+  bool HasFullChunk() const {
+    return head_->next() != NULL;
+  }
+
+  // Moves a full chunk from this stack to 'other'. Returns false if this
+  // stack has no full chunk to give away.
+  bool TransferChunk(MarkingStack* other) {
+    MarkingStackChunk* chunk = head_->next();
+    if (chunk == NULL) {
+      return false;
+    }
+    head_->set_next(chunk->next());
+    chunk->set_next(other->head_->next());
+    other->head_->set_next(chunk);
+    return true;
+  }
+
  private:
   class MarkingStackChunk {
    public:
@@ -118,20 +146,169 @@ class MarkingStack : public ValueObject {
 };
 
 
+// Shared state of a parallel marking phase: the chunks of marking stack
+// handed out to idle tasks, termination detection and the results handed
+// back by the tasks. The mutator thread participates as one of the tasks.
+// Helper tasks run with the isolate set as their current isolate, so locking
+// uses the platform scopes which, unlike MonitorLocker, do not register as
+// stack resources of the isolate.
+class ParallelMarking : public ValueObject {
+ public:
+  ParallelMarking(Isolate* isolate,
+                  Heap* heap,
+                  PageSpace* page_space,
+                  bool visit_function_code)
+      : isolate_(isolate),
+        heap_(heap),
+        page_space_(page_space),
+        visit_function_code_(visit_function_code),
+        running_tasks_(1),
+        idle_tasks_(0),
+        pending_tasks_(0),
+        done_(false),
+        remembered_(NULL),
+        deferred_(NULL),
+        marked_bytes_(0),
+        helper_marked_bytes_(0) { }
+
+  ~ParallelMarking() {
+    ASSERT(pending_tasks_ == 0);
+  }
+
+  Isolate* isolate() const { return isolate_; }
+  Heap* heap() const { return heap_; }
+  PageSpace* page_space() const { return page_space_; }
+  bool visit_function_code() const { return visit_function_code_; }
+
+  // Called by a helper task before it starts working. Returns false if the
+  // marking has already completed without it.
+  bool EnterTask() {
+    ScopedMonitor ml(&monitor_);
+    if (done_) {
+      return false;
+    }
+    running_tasks_++;
+    return true;
+  }
+
+  // Called by every task, including the mutator, once it has run out of work.
+  void ExitTask(MarkingVisitor* visitor, bool is_helper);
+
+  void StartHelpers(intptr_t num_helpers) {
+    {
+      ScopedMonitor ml(&monitor_);
+      pending_tasks_ += num_helpers;
+    }
+    for (intptr_t i = 0; i < num_helpers; i++) {
+      Dart::thread_pool()->Run(new ParallelMarkingTask(this));
+    }
+  }
+
+  // Waits until all helper tasks have handed back their results.
+  void WaitForHelpers() {
+    ScopedMonitor ml(&monitor_);
+    while (pending_tasks_ > 0) {
+      ml.Wait();
+    }
+  }
+
+  // Hands a full chunk of the local marking stack to the idle tasks.
+  void ShareWork(MarkingStack* local) {
+    ScopedMonitor ml(&monitor_);
+    if (local->TransferChunk(&shared_) && (idle_tasks_ > 0)) {
+      ml.Notify();
+    }
+  }
+
+  // Moves a shared chunk onto the local marking stack, waiting for other
+  // tasks to share one if necessary. Returns false once all tasks are idle
+  // and no work is left.
+  bool TakeWork(MarkingStack* local) {
+    ScopedMonitor ml(&monitor_);
+    while (true) {
+      if (shared_.TransferChunk(local)) {
+        return true;
+      }
+      if (done_) {
+        return false;
+      }
+      idle_tasks_++;
+      if (idle_tasks_ == running_tasks_) {
+        done_ = true;
+        ml.NotifyAll();
+        return false;
+      }
+      ml.Wait();
+      idle_tasks_--;
+    }
+  }
+
+  // Racy by design: only used as a hint whether sharing local work pays off.
+  bool HasIdleTasks() const { return idle_tasks_ > 0; }
+
+  StoreBufferBlock* remembered() const { return remembered_; }
+  StoreBufferBlock* deferred() const { return deferred_; }
+  intptr_t marked_bytes() const { return marked_bytes_; }
+  intptr_t helper_marked_bytes() const { return helper_marked_bytes_; }
+
+ private:
+  class ParallelMarkingTask : public ThreadPool::Task {
+   public:
+    explicit ParallelMarkingTask(ParallelMarking* marking)
+        : marking_(marking) { }
+
+    virtual void Run();
+
+   private:
+    ParallelMarking* marking_;
+
+    DISALLOW_COPY_AND_ASSIGN(ParallelMarkingTask);
+  };
+
+  static void AppendBlocks(StoreBufferBlock** list, StoreBufferBlock* blocks);
+
+  Isolate* isolate_;
+  Heap* heap_;
+  PageSpace* page_space_;
+  const bool visit_function_code_;
+
+  Monitor monitor_;
+  // Only ever holds full chunks after its empty head chunk.
+  MarkingStack shared_;
+  intptr_t running_tasks_;
+  volatile intptr_t idle_tasks_;
+  intptr_t pending_tasks_;
+  bool done_;
+
+  // Results merged from the tasks.
+  StoreBufferBlock* remembered_;
+  StoreBufferBlock* deferred_;
+  intptr_t marked_bytes_;
+  intptr_t helper_marked_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelMarking);
+};
+
+
 class MarkingVisitor : public ObjectPointerVisitor {
  public:
   MarkingVisitor(Isolate* isolate,
                  Heap* heap,
                  PageSpace* page_space,
                  MarkingStack* marking_stack,
-                 bool visit_function_code)
+                 bool visit_function_code,
+                 ParallelMarking* parallel_marking)
       : ObjectPointerVisitor(isolate),
         heap_(heap),
         vm_heap_(Dart::vm_isolate()->heap()),
         page_space_(page_space),
         marking_stack_(marking_stack),
+        parallel_marking_(parallel_marking),
         visiting_old_object_(NULL),
-        visit_function_code_(visit_function_code) {
+        visit_function_code_(visit_function_code),
+        marked_bytes_(0),
+        remembered_(NULL),
+        deferred_(NULL) {
     ASSERT(heap_ != vm_heap_);
   }
 
@@ -145,6 +322,10 @@ class MarkingVisitor : public ObjectPointerVisitor {
 
   bool visit_function_code() const { return visit_function_code_; }
 
+  // Size of the marked objects whose pointers have been visited.
+  intptr_t marked_bytes() const { return marked_bytes_; }
+  void AddMarkedBytes(intptr_t size) { marked_bytes_ += size; }
+
   GrowableArray<RawFunction*>* skipped_code_functions() {
     return &skipped_code_functions_;
   }
@@ -176,7 +357,68 @@ class MarkingVisitor : public ObjectPointerVisitor {
     visiting_old_object_ = obj;
   }
 
+  // Drains the local marking stack and the chunks shared by other tasks until
+  // the parallel marking terminates.
+  void ProcessWork() {
+    ASSERT(parallel_marking_ != NULL);
+    do {
+      while (!marking_stack_->IsEmpty()) {
+        ScanObject(marking_stack_->Pop());
+        if (marking_stack_->HasFullChunk() &&
+            parallel_marking_->HasIdleTasks()) {
+          parallel_marking_->ShareWork(marking_stack_);
+        }
+      }
+    } while (parallel_marking_->TakeWork(marking_stack_));
+  }
+
+  StoreBufferBlock* remembered() const { return remembered_; }
+  StoreBufferBlock* deferred() const { return deferred_; }
+
  private:
+  static void AddToBlocks(StoreBufferBlock** blocks, RawObject* raw_obj) {
+    if ((*blocks == NULL) || (*blocks)->IsFull()) {
+      *blocks = new StoreBufferBlock(*blocks);
+    }
+    (*blocks)->Add(raw_obj);
+  }
+
+  // Visits the pointers of a marked object during parallel marking.
+  void ScanObject(RawObject* raw_obj) {
+    intptr_t class_id = raw_obj->GetClassId();
+    if ((class_id == kWeakPropertyCid) ||
+        ((class_id == kFunctionCid) && !visit_function_code_)) {
+      // Weak properties depend on the reachability of their keys and
+      // functions may record skipped code in a zone allocated array. Both are
+      // left for the serial marking which follows.
+      AddToBlocks(&deferred_, raw_obj);
+      return;
+    }
+    VisitingOldObject(raw_obj);
+    marked_bytes_ += raw_obj->VisitPointers(this);
+    VisitingOldObject(NULL);
+  }
+
+  // Sets the mark bit with a compare-and-swap so that exactly one task pushes
+  // the object. Returns false if another task marked the object first.
+  static bool TryMark(RawObject* raw_obj) {
+    uword* tags_addr = reinterpret_cast<uword*>(RawObject::ToAddr(raw_obj));
+    uword tags = *tags_addr;
+    while (!RawObject::MarkBit::decode(tags)) {
+      // Keys are only watched by the serial marking of weak properties.
+      ASSERT(!RawObject::WatchedBit::decode(tags));
+      uword new_tags = RawObject::RememberedBit::update(
+          false, RawObject::MarkBit::update(true, tags));
+      uword old_tags =
+          AtomicOperations::CompareAndSwapWord(tags_addr, tags, new_tags);
+      if (old_tags == tags) {
+        return true;
+      }
+      tags = old_tags;
+    }
+    return false;
+  }
+
   void MarkAndPush(RawObject* raw_obj) {
     ASSERT(raw_obj->IsHeapObject());
     ASSERT((FLAG_verify_before_gc || FLAG_verify_before_gc) ?
@@ -184,19 +426,25 @@ class MarkingVisitor : public ObjectPointerVisitor {
            true);
 
     // Mark the object and push it on the marking stack.
-    ASSERT(!raw_obj->IsMarked());
     RawClass* raw_class = isolate()->class_table()->At(raw_obj->GetClassId());
-    raw_obj->SetMarkBit();
-    raw_obj->ClearRememberedBit();
-    if (raw_obj->IsWatched()) {
-      std::pair<DelaySet::iterator, DelaySet::iterator> ret;
-      // Visit all elements with a key equal to raw_obj.
-      ret = delay_set_.equal_range(raw_obj);
-      for (DelaySet::iterator it = ret.first; it != ret.second; ++it) {
-        it->second->VisitPointers(this);
+    if (parallel_marking_ != NULL) {
+      if (!TryMark(raw_obj)) {
+        return;
+      }
+    } else {
+      ASSERT(!raw_obj->IsMarked());
+      raw_obj->SetMarkBit();
+      raw_obj->ClearRememberedBit();
+      if (raw_obj->IsWatched()) {
+        std::pair<DelaySet::iterator, DelaySet::iterator> ret;
+        // Visit all elements with a key equal to raw_obj.
+        ret = delay_set_.equal_range(raw_obj);
+        for (DelaySet::iterator it = ret.first; it != ret.second; ++it) {
+          it->second->VisitPointers(this);
+        }
+        delay_set_.erase(ret.first, ret.second);
+        raw_obj->ClearWatchedBit();
       }
-      delay_set_.erase(ret.first, ret.second);
-      raw_obj->ClearWatchedBit();
     }
     marking_stack_->Push(raw_obj);
 
@@ -219,10 +467,23 @@ class MarkingVisitor : public ObjectPointerVisitor {
     if (raw_obj->IsNewObject()) {
       // TODO(iposva): Add consistency check.
       if ((visiting_old_object_ != NULL) &&
-          !visiting_old_object_->IsRemembered()) {
+          visiting_old_object_->IsCardRemembered()) {
+        ASSERT(p != NULL);
+        // Each old object is scanned by one task only, so its cards can be
+        // dirtied without synchronization.
+        HeapPage::OfCardRemembered(visiting_old_object_)->RememberCard(
+            reinterpret_cast<uword>(p));
+      } else if ((visiting_old_object_ != NULL) &&
+                 !visiting_old_object_->IsRemembered()) {
         ASSERT(p != NULL);
         visiting_old_object_->SetRememberedBit();
-        isolate()->store_buffer()->AddObjectGC(visiting_old_object_);
+        if (parallel_marking_ != NULL) {
+          // Each old object is scanned by one task only, so its remembered
+          // bit can be updated without synchronization.
+          AddToBlocks(&remembered_, visiting_old_object_);
+        } else {
+          isolate()->store_buffer()->AddObjectGC(visiting_old_object_);
+        }
       }
       return;
     }
@@ -259,16 +520,72 @@ class MarkingVisitor : public ObjectPointerVisitor {
   Heap* vm_heap_;
   PageSpace* page_space_;
   MarkingStack* marking_stack_;
+  ParallelMarking* parallel_marking_;
   RawObject* visiting_old_object_;
   typedef std::multimap<RawObject*, RawWeakProperty*> DelaySet;
   DelaySet delay_set_;
   const bool visit_function_code_;
   GrowableArray<RawFunction*> skipped_code_functions_;
+  intptr_t marked_bytes_;
+
+  // Used by parallel marking only.
+  // Old objects which need to be added to the store buffer.
+  StoreBufferBlock* remembered_;
+  // Marked objects whose pointers are visited by the serial marking.
+  StoreBufferBlock* deferred_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(MarkingVisitor);
 };
 
 
+void ParallelMarking::ParallelMarkingTask::Run() {
+  Isolate::SetCurrentHelper(marking_->isolate());
+  MarkingStack marking_stack;
+  MarkingVisitor visitor(marking_->isolate(),
+                         marking_->heap(),
+                         marking_->page_space(),
+                         &marking_stack,
+                         marking_->visit_function_code(),
+                         marking_);
+  if (marking_->EnterTask()) {
+    visitor.ProcessWork();
+  }
+  marking_->ExitTask(&visitor, true);
+  // The marking may be gone at this point, do not touch it anymore.
+  Isolate::SetCurrentHelper(NULL);
+}
+
+
+void ParallelMarking::AppendBlocks(StoreBufferBlock** list,
+                                   StoreBufferBlock* blocks) {
+  while (blocks != NULL) {
+    StoreBufferBlock* next = blocks->next();
+    intptr_t count = blocks->Count();
+    for (intptr_t i = 0; i < count; i++) {
+      if ((*list == NULL) || (*list)->IsFull()) {
+        *list = new StoreBufferBlock(*list);
+      }
+      (*list)->Add(blocks->At(i));
+    }
+    delete blocks;
+    blocks = next;
+  }
+}
+
+
+void ParallelMarking::ExitTask(MarkingVisitor* visitor, bool is_helper) {
+  ScopedMonitor ml(&monitor_);
+  AppendBlocks(&remembered_, visitor->remembered());
+  AppendBlocks(&deferred_, visitor->deferred());
+  marked_bytes_ += visitor->marked_bytes();
+  if (is_helper) {
+    helper_marked_bytes_ += visitor->marked_bytes();
+    pending_tasks_--;
+    ml.NotifyAll();
+  }
+}
+
+
 bool IsUnreachable(const RawObject* raw_obj) {
   if (!raw_obj->IsHeapObject()) {
     return false;
@@ -328,6 +645,59 @@ void GCMarker::IterateRoots(Isolate* isolate,
 }
 
 
+void GCMarker::ParallelIterateRoots(
+    Isolate* isolate,
+    PageSpace* page_space,
+    MarkingStack* marking_stack,
+    bool visit_function_code,
+    bool visit_prologue_weak_persistent_handles) {
+  ParallelMarking marking(isolate, heap_, page_space, visit_function_code);
+  intptr_t num_helpers = FLAG_marker_tasks - 1;
+  marking.StartHelpers(num_helpers);
+
+  // The helpers pick up chunks of the marking stack as the mutator fills it
+  // from the roots.
+  MarkingStack local_stack;
+  MarkingVisitor visitor(isolate,
+                         heap_,
+                         page_space,
+                         &local_stack,
+                         visit_function_code,
+                         &marking);
+  IterateRoots(isolate, &visitor, visit_prologue_weak_persistent_handles);
+  visitor.ProcessWork();
+  marking.ExitTask(&visitor, false);
+  marking.WaitForHelpers();
+
+  // Add the old objects which still refer to new space to the store buffer.
+  StoreBuffer* buffer = isolate->store_buffer();
+  StoreBufferBlock* remembered = marking.remembered();
+  while (remembered != NULL) {
+    StoreBufferBlock* next = remembered->next();
+    intptr_t count = remembered->Count();
+    for (intptr_t i = 0; i < count; i++) {
+      buffer->AddObjectGC(remembered->At(i));
+    }
+    delete remembered;
+    remembered = next;
+  }
+  // The deferred objects are already marked; the serial marking visits them
+  // when draining the marking stack.
+  StoreBufferBlock* deferred = marking.deferred();
+  while (deferred != NULL) {
+    StoreBufferBlock* next = deferred->next();
+    intptr_t count = deferred->Count();
+    for (intptr_t i = 0; i < count; i++) {
+      marking_stack->Push(deferred->At(i));
+    }
+    delete deferred;
+    deferred = next;
+  }
+  marked_bytes_ += marking.marked_bytes();
+  helper_marked_bytes_ += marking.helper_marked_bytes();
+}
+
+
 void GCMarker::IterateWeakRoots(Isolate* isolate,
                                 HandleVisitor* visitor,
                                 bool visit_prologue_weak_persistent_handles) {
@@ -396,9 +766,10 @@ void GCMarker::DrainMarkingStack(Isolate* isolate,
     RawObject* raw_obj = visitor->marking_stack()->Pop();
     visitor->VisitingOldObject(raw_obj);
     if (raw_obj->GetClassId() != kWeakPropertyCid) {
-      raw_obj->VisitPointers(visitor);
+      visitor->AddMarkedBytes(raw_obj->VisitPointers(visitor));
     } else {
       RawWeakProperty* raw_weak = reinterpret_cast<RawWeakProperty*>(raw_obj);
+      visitor->AddMarkedBytes(raw_weak->Size());
       ProcessWeakProperty(raw_weak, visitor);
     }
   }
@@ -476,9 +847,19 @@ void GCMarker::MarkObjects(Isolate* isolate,
   const bool visit_function_code = !collect_code;
   MarkingStack marking_stack;
   Prologue(isolate, invoke_api_callbacks);
+  // Like the store buffer, the cards are rebuilt as part of marking.
+  page_space->ClearCards();
   MarkingVisitor mark(
-      isolate, heap_, page_space, &marking_stack, visit_function_code);
-  IterateRoots(isolate, &mark, !invoke_api_callbacks);
+      isolate, heap_, page_space, &marking_stack, visit_function_code, NULL);
+  if (FLAG_marker_tasks > 1) {
+    ParallelIterateRoots(isolate,
+                         page_space,
+                         &marking_stack,
+                         visit_function_code,
+                         !invoke_api_callbacks);
+  } else {
+    IterateRoots(isolate, &mark, !invoke_api_callbacks);
+  }
   DrainMarkingStack(isolate, &mark);
   IterateWeakReferences(isolate, &mark);
   MarkingWeakVisitor mark_weak;
@@ -486,6 +867,7 @@ void GCMarker::MarkObjects(Isolate* isolate,
   mark.Finalize();
   ProcessWeakTables(page_space);
   ProcessObjectIdTable(isolate);
+  marked_bytes_ += mark.marked_bytes();
 
   Epilogue(isolate, invoke_api_callbacks);
 }
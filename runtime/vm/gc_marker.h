@@ -13,6 +13,7 @@ namespace dart {
 class HandleVisitor;
 class Heap;
 class Isolate;
+class MarkingStack;
 class MarkingVisitor;
 class ObjectPointerVisitor;
 class PageSpace;
@@ -22,7 +23,8 @@ class RawWeakProperty;
 // of the mark-sweep collection. The marking bit used is defined in RawObject.
 class GCMarker : public ValueObject {
  public:
-  explicit GCMarker(Heap* heap) : heap_(heap) { }
+  explicit GCMarker(Heap* heap)
+      : heap_(heap), marked_bytes_(0), helper_marked_bytes_(0) { }
   ~GCMarker() { }
 
   void MarkObjects(Isolate* isolate,
@@ -30,12 +32,26 @@ class GCMarker : public ValueObject {
                    bool invoke_api_callbacks,
                    bool collect_code);
 
+  // Size of all old generation objects marked by MarkObjects.
+  intptr_t marked_words() const { return marked_bytes_ >> kWordSizeLog2; }
+  // The part of it marked by the helper tasks of parallel marking.
+  intptr_t helper_marked_words() const {
+    return helper_marked_bytes_ >> kWordSizeLog2;
+  }
+
  private:
   void Prologue(Isolate* isolate, bool invoke_api_callbacks);
   void Epilogue(Isolate* isolate, bool invoke_api_callbacks);
   void IterateRoots(Isolate* isolate,
                     ObjectPointerVisitor* visitor,
                     bool visit_prologue_weak_persistent_handles);
+  // Marks everything reachable from the roots with --marker_tasks tasks.
+  // Objects which need the serial marking are left on 'marking_stack'.
+  void ParallelIterateRoots(Isolate* isolate,
+                            PageSpace* page_space,
+                            MarkingStack* marking_stack,
+                            bool visit_function_code,
+                            bool visit_prologue_weak_persistent_handles);
   void IterateWeakRoots(Isolate* isolate,
                         HandleVisitor* visitor,
                         bool visit_prologue_weak_persistent_handles);
@@ -47,6 +63,8 @@ class GCMarker : public ValueObject {
 
 
   Heap* heap_;
+  intptr_t marked_bytes_;
+  intptr_t helper_marked_bytes_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(GCMarker);
 };
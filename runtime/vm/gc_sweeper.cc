@@ -4,13 +4,130 @@
 
 #include "vm/gc_sweeper.h"
 
+#include "vm/atomic.h"
+#include "vm/dart.h"
 #include "vm/freelist.h"
 #include "vm/globals.h"
 #include "vm/heap.h"
+#include "vm/isolate.h"
 #include "vm/pages.h"
+#include "vm/thread_pool.h"
 
 namespace dart {
 
+// Shared state of a parallel sweep. Pages are claimed one at a time by
+// atomically incrementing the index of the next page. The mutator thread
+// participates as one of the tasks.
+class ParallelSweep : public ValueObject {
+ public:
+  ParallelSweep(Isolate* isolate,
+                GCSweeper* sweeper,
+                HeapPage** pages,
+                intptr_t* in_use,
+                intptr_t num_pages,
+                FreeList* freelists)
+      : isolate_(isolate),
+        sweeper_(sweeper),
+        pages_(pages),
+        in_use_(in_use),
+        num_pages_(num_pages),
+        freelists_(freelists),
+        next_page_(0),
+        pending_tasks_(0),
+        swept_pages_(0),
+        helper_swept_pages_(0) { }
+
+  ~ParallelSweep() {
+    ASSERT(pending_tasks_ == 0);
+  }
+
+  void StartHelpers(intptr_t num_helpers) {
+    {
+      ScopedMonitor ml(&monitor_);
+      pending_tasks_ += num_helpers;
+    }
+    for (intptr_t i = 0; i < num_helpers; i++) {
+      Dart::thread_pool()->Run(new ParallelSweepTask(this));
+    }
+  }
+
+  // Waits until all helper tasks have merged their free lists.
+  void WaitForHelpers() {
+    ScopedMonitor ml(&monitor_);
+    while (pending_tasks_ > 0) {
+      ml.Wait();
+    }
+  }
+
+  // Sweeps pages until all of them have been claimed.
+  void SweepPages(bool is_helper);
+
+  intptr_t swept_pages() const { return swept_pages_; }
+  intptr_t helper_swept_pages() const { return helper_swept_pages_; }
+
+ private:
+  class ParallelSweepTask : public ThreadPool::Task {
+   public:
+    explicit ParallelSweepTask(ParallelSweep* sweep) : sweep_(sweep) { }
+
+    virtual void Run() {
+      Isolate::SetCurrentHelper(sweep_->isolate_);
+      sweep_->SweepPages(true);
+      // The sweep may be gone at this point, do not touch it anymore.
+      Isolate::SetCurrentHelper(NULL);
+    }
+
+   private:
+    ParallelSweep* sweep_;
+
+    DISALLOW_COPY_AND_ASSIGN(ParallelSweepTask);
+  };
+
+  Isolate* isolate_;
+  GCSweeper* sweeper_;
+  HeapPage** pages_;
+  intptr_t* in_use_;
+  const intptr_t num_pages_;
+  FreeList* freelists_;
+
+  uword next_page_;
+
+  // Protects the merging into freelists_, pending_tasks_ and the counts of
+  // swept pages.
+  Monitor monitor_;
+  intptr_t pending_tasks_;
+  intptr_t swept_pages_;
+  intptr_t helper_swept_pages_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelSweep);
+};
+
+
+void ParallelSweep::SweepPages(bool is_helper) {
+  FreeList freelists[HeapPage::kNumPageTypes];
+  intptr_t swept_pages = 0;
+  while (true) {
+    intptr_t i = AtomicOperations::FetchAndIncrement(&next_page_);
+    if (i >= num_pages_) {
+      break;
+    }
+    HeapPage* page = pages_[i];
+    in_use_[i] = sweeper_->SweepPage(page, &freelists[page->type()]);
+    swept_pages++;
+  }
+  ScopedMonitor ml(&monitor_);
+  for (intptr_t type = 0; type < HeapPage::kNumPageTypes; type++) {
+    freelists_[type].MergeFrom(&freelists[type]);
+  }
+  swept_pages_ += swept_pages;
+  if (is_helper) {
+    helper_swept_pages_ += swept_pages;
+    pending_tasks_--;
+    ml.NotifyAll();
+  }
+}
+
+
 intptr_t GCSweeper::SweepPage(HeapPage* page, FreeList* freelist) {
   // Keep track of the discovered live object sizes to be able to finish
   // sweeping early. Reset the per page in_use count for the next marking phase.
@@ -57,6 +174,22 @@ intptr_t GCSweeper::SweepPage(HeapPage* page, FreeList* freelist) {
 }
 
 
+intptr_t GCSweeper::SweepPages(Isolate* isolate,
+                               HeapPage** pages,
+                               intptr_t* in_use,
+                               intptr_t num_pages,
+                               FreeList* freelists,
+                               intptr_t num_tasks) {
+  ParallelSweep sweep(isolate, this, pages, in_use, num_pages, freelists);
+  sweep.StartHelpers(num_tasks - 1);
+  sweep.SweepPages(false);
+  sweep.WaitForHelpers();
+  // Each page was claimed by exactly one task.
+  ASSERT(sweep.swept_pages() == num_pages);
+  return sweep.helper_swept_pages();
+}
+
+
 intptr_t GCSweeper::SweepLargePage(HeapPage* page) {
   RawObject* raw_obj = RawObject::FromAddr(page->object_start());
   if (!raw_obj->IsMarked()) {
@@ -13,6 +13,7 @@ namespace dart {
 class FreeList;
 class Heap;
 class HeapPage;
+class Isolate;
 
 // The class GCSweeper is used to visit the heap after marking to reclaim unused
 // memory.
@@ -28,6 +29,18 @@ class GCSweeper {
 
   intptr_t SweepLargePage(HeapPage* page);
 
+  // Sweep 'num_pages' pages using 'num_tasks' tasks. Each task adds the
+  // unmarked objects to free lists of its own, which are merged into
+  // 'freelists' (indexed by page type) once the task is done.
+  // Stores the size of memory used by the marked objects of pages[i] in
+  // in_use[i]. Returns how many of the pages the helper tasks swept.
+  intptr_t SweepPages(Isolate* isolate,
+                  HeapPage** pages,
+                  intptr_t* in_use,
+                  intptr_t num_pages,
+                  FreeList* freelists,
+                  intptr_t num_tasks);
+
  private:
   Heap* heap_;
 
@@ -269,4 +269,60 @@ TEST_CASE(GuardFieldConstructor2Test) {
   EXPECT_EQ(false, f3.is_nullable());
 }
 
+
+TEST_CASE(GuardFieldUnboxedDoubleTest) {
+  const char* script_chars =
+      "class A {\n"
+      "  var x = 1.0;\n"
+      "  var y = 0.0;\n"
+      "  step() {\n"
+      "    x = x + 1.0;\n"
+      "  }\n"
+      "}\n"
+      "\n"
+      "runLoop() {\n"
+      "  var a = new A();\n"
+      "  var sum = 0.0;\n"
+      "  for (int i = 0; i < 2000; i++) {\n"
+      "    var old = a.x;\n"
+      "    a.step();\n"
+      "    a.y = old;\n"
+      "    sum += a.x - a.y;\n"
+      "  }\n"
+      "  return sum;\n"
+      "}\n"
+      "\n"
+      "runNull() {\n"
+      "  var a = new A();\n"
+      "  a.x = null;\n"
+      "  return a.x == null;\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(script_chars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("runLoop"), 0, NULL);
+  EXPECT_VALID(result);
+  double sum = 0.0;
+  EXPECT_VALID(Dart_DoubleValue(result, &sum));
+  // Values read from the field must not change with later stores.
+  EXPECT_FLOAT_EQ(2000.0, sum, 0.0);
+  Field& x = Field::ZoneHandle(LookupField(lib, "A", "x"));
+  EXPECT_EQ(kDoubleCid, x.guarded_cid());
+  EXPECT_EQ(false, x.is_nullable());
+#if defined(TARGET_ARCH_X64)
+  EXPECT(x.IsUnboxedField());
+#endif
+
+  // Storing null invalidates the guard and the field stops being unboxed.
+  result = Dart_Invoke(lib, NewString("runNull"), 0, NULL);
+  EXPECT_VALID(result);
+  bool is_null = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &is_null));
+  EXPECT(is_null);
+  EXPECT(!x.IsUnboxedField());
+
+  result = Dart_Invoke(lib, NewString("runLoop"), 0, NULL);
+  EXPECT_VALID(result);
+  EXPECT_VALID(Dart_DoubleValue(result, &sum));
+  EXPECT_FLOAT_EQ(2000.0, sum, 0.0);
+}
+
 }  // namespace dart
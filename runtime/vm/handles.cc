@@ -109,18 +109,33 @@ HandleScope::~HandleScope() {
 
 
 #if defined(DEBUG)
-NoHandleScope::NoHandleScope(BaseIsolate* isolate) : StackResource(isolate) {
-  isolate->IncrementNoHandleScopeDepth();
+// Helper threads of a parallel collection may not push resources on the stack
+// of the mutator. Their scopes are not checked.
+static BaseIsolate* CheckedIsolate(BaseIsolate* isolate) {
+  return Isolate::IsCurrentHelper() ? NULL : isolate;
 }
 
 
-NoHandleScope::NoHandleScope() : StackResource(Isolate::Current()) {
-  isolate()->IncrementNoHandleScopeDepth();
+NoHandleScope::NoHandleScope(BaseIsolate* isolate)
+    : StackResource(CheckedIsolate(isolate)) {
+  if (this->isolate() != NULL) {
+    this->isolate()->IncrementNoHandleScopeDepth();
+  }
+}
+
+
+NoHandleScope::NoHandleScope()
+    : StackResource(CheckedIsolate(Isolate::Current())) {
+  if (isolate() != NULL) {
+    isolate()->IncrementNoHandleScopeDepth();
+  }
 }
 
 
 NoHandleScope::~NoHandleScope() {
-  isolate()->DecrementNoHandleScopeDepth();
+  if (isolate() != NULL) {
+    isolate()->DecrementNoHandleScopeDepth();
+  }
 }
 #endif  // defined(DEBUG)
 
@@ -36,7 +36,13 @@ DEFINE_FLAG(int, old_gen_heap_size, Heap::kHeapSizeInMB,
             "old gen heap size in MB,"
             "e.g: --old_gen_heap_size=1024 allocates a 1024MB old gen heap");
 
-Heap::Heap() : read_only_(false), gc_in_progress_(false) {
+DECLARE_FLAG(int, new_gen_target_pause_micros);
+
+Heap::Heap()
+    : last_scavenge_micros_(kNotMeasured),
+      last_mark_sweep_micros_(kNotMeasured),
+      read_only_(false),
+      gc_in_progress_(false) {
   for (int sel = 0;
        sel < kNumWeakSelectors;
        sel++) {
@@ -146,6 +152,11 @@ void Heap::IterateOldObjects(ObjectVisitor* visitor) {
 }
 
 
+void Heap::IterateCardRememberedObjects(ObjectVisitor* visitor) {
+  old_space_->VisitCardRememberedObjects(visitor);
+}
+
+
 RawInstructions* Heap::FindObjectInCodeSpace(FindObjectVisitor* visitor) {
   // Only executable pages can have RawInstructions objects.
   RawObject* raw_obj = old_space_->FindObject(visitor, HeapPage::kExecutable);
@@ -233,6 +244,54 @@ void Heap::WriteProtect(bool read_only) {
 }
 
 
+void Heap::ShrinkNewSpace() {
+  new_space_->Shrink();
+}
+
+
+// Without a measured duration a collection is not predicted to fit.
+static bool FitsBeforeDeadline(int64_t last_micros, int64_t deadline) {
+  return (last_micros >= 0) &&
+         ((OS::GetCurrentTimeMicros() + last_micros) <= deadline);
+}
+
+
+void Heap::NotifyIdle(int64_t deadline) {
+  // Lazy sweeping proceeds page by page, so it can use any idle time.
+  if (!old_space_->SweepUntil(deadline)) {
+    return;
+  }
+  intptr_t new_used = new_space_->UsedInWords();
+  if ((new_used * 100 >= new_space_->CapacityInWords() * kIdleScavengeUsedRatio)
+      && FitsBeforeDeadline(last_scavenge_micros_, deadline)) {
+    RecordBeforeGC(kNew, kIdle);
+    new_space_->Scavenge(kIgnoreApiCallbacks);
+    RecordAfterGC();
+    PrintStats();
+    if (new_space_->HadPromotionFailure()) {
+      CollectGarbage(kOld, kInvokeApiCallbacks);
+      return;
+    }
+    // The survivors fit into less memory until the mutator runs again. With
+    // a pause target the scavenge has already sized new space for it.
+    if (FLAG_new_gen_target_pause_micros <= 0) {
+      new_space_->Shrink();
+    }
+  }
+  // Collect old space if it can not grow any more without a collection, or
+  // if unused code is due to be collected.
+  if ((old_space_->NeedsGarbageCollection() ||
+       (FLAG_collect_code && old_space_->ShouldCollectCode())) &&
+      FitsBeforeDeadline(last_mark_sweep_micros_, deadline)) {
+    RecordBeforeGC(kOld, kIdle);
+    old_space_->MarkSweep(kInvokeApiCallbacks);
+    RecordAfterGC();
+    PrintStats();
+    UpdateObjectHistogram();
+  }
+}
+
+
 uword Heap::TopAddress() {
   return reinterpret_cast<uword>(new_space_->TopAddress());
 }
@@ -243,6 +302,16 @@ uword Heap::EndAddress() {
 }
 
 
+uword Heap::OldTopAddress() {
+  return reinterpret_cast<uword>(old_space_->TopAddress());
+}
+
+
+uword Heap::OldEndAddress() {
+  return reinterpret_cast<uword>(old_space_->EndAddress());
+}
+
+
 void Heap::Init(Isolate* isolate) {
   ASSERT(isolate->heap() == NULL);
   Heap* heap = new Heap();
@@ -369,6 +438,8 @@ const char* Heap::GCReasonToString(GCReason gc_reason) {
       return "debugging";
     case kGCTestCase:
       return "test case";
+    case kIdle:
+      return "idle";
     default:
       UNREACHABLE();
       return "";
@@ -417,14 +488,12 @@ void Heap::RecordBeforeGC(Space space, GCReason reason) {
   stats_.before_.new_capacity_in_words_ = new_space_->CapacityInWords();
   stats_.before_.old_used_in_words_ = old_space_->UsedInWords();
   stats_.before_.old_capacity_in_words_ = old_space_->CapacityInWords();
-  stats_.times_[0] = 0;
-  stats_.times_[1] = 0;
-  stats_.times_[2] = 0;
-  stats_.times_[3] = 0;
-  stats_.data_[0] = 0;
-  stats_.data_[1] = 0;
-  stats_.data_[2] = 0;
-  stats_.data_[3] = 0;
+  for (intptr_t i = 0; i < GCStats::kTimeEntries; i++) {
+    stats_.times_[i] = 0;
+  }
+  for (intptr_t i = 0; i < GCStats::kDataEntries; i++) {
+    stats_.data_[i] = 0;
+  }
 }
 
 
@@ -434,6 +503,12 @@ void Heap::RecordAfterGC() {
   stats_.after_.new_capacity_in_words_ = new_space_->CapacityInWords();
   stats_.after_.old_used_in_words_ = old_space_->UsedInWords();
   stats_.after_.old_capacity_in_words_ = old_space_->CapacityInWords();
+  int64_t micros = stats_.after_.micros_ - stats_.before_.micros_;
+  if (stats_.space_ == kNew) {
+    last_scavenge_micros_ = micros;
+  } else {
+    last_mark_sweep_micros_ = micros;
+  }
   ASSERT(gc_in_progress_);
   gc_in_progress_ = false;
 }
@@ -462,7 +537,7 @@ void Heap::PrintStats() {
     "%" Pd ", %" Pd ", "  // old gen: in use before/after
     "%" Pd ", %" Pd ", "  // old gen: capacity before/after
     "%.3f, %.3f, %.3f, %.3f, "  // times
-    "%" Pd ", %" Pd ", %" Pd ", %" Pd ", "  // data
+    "%" Pd ", %" Pd ", %" Pd ", %" Pd ", %" Pd ", "  // data
     "]\n",  // End with a comma to make it easier to import in spreadsheets.
     isolate->main_port(), space_str, GCReasonToString(stats_.reason_),
     stats_.num_,
@@ -484,7 +559,8 @@ void Heap::PrintStats() {
     stats_.data_[0],
     stats_.data_[1],
     stats_.data_[2],
-    stats_.data_[3]);
+    stats_.data_[3],
+    stats_.data_[4]);
 }
 
 
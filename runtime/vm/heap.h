@@ -52,6 +52,7 @@ class Heap {
     kFull,
     kGCAtAlloc,
     kGCTestCase,
+    kIdle,
   };
 
   // Default allocation sizes in MB for the old gen and code heaps.
@@ -123,6 +124,10 @@ class Heap {
   void IterateNewObjects(ObjectVisitor* visitor);
   void IterateOldObjects(ObjectVisitor* visitor);
 
+  // Visit the large arrays in old space which are remembered by their cards
+  // and not by the store buffer.
+  void IterateCardRememberedObjects(ObjectVisitor* visitor);
+
   // Find an object by visiting all pointers in the specified heap space,
   // the 'visitor' is used to determine if an object is found or not.
   // The 'visitor' function should be set up to return true if the
@@ -147,10 +152,25 @@ class Heap {
   // Protect access to the heap.
   void WriteProtect(bool read_only);
 
+  // Return the new space memory not needed by the current objects to the OS.
+  void ShrinkNewSpace();
+
+  // Uses the time until 'deadline' (as returned by OS::GetCurrentTimeMicros)
+  // for collection work which would otherwise pause the mutator later. Only
+  // work which the duration of its last run predicts to finish in time is
+  // started.
+  void NotifyIdle(int64_t deadline);
+
   // Accessors for inlined allocation in generated code.
   uword TopAddress();
   uword EndAddress();
+  uword OldTopAddress();
+  uword OldEndAddress();
   static intptr_t new_space_offset() { return OFFSET_OF(Heap, new_space_); }
+  static intptr_t old_space_offset() { return OFFSET_OF(Heap, old_space_); }
+
+  Scavenger* new_space() const { return new_space_; }
+  PageSpace* old_space() const { return old_space_; }
 
   // Initialize the heap and register it with the isolate.
   static void Init(Isolate* isolate);
@@ -217,7 +237,7 @@ class Heap {
 
   // Stats collection.
   void RecordTime(int id, int64_t micros) {
-    ASSERT((id >= 0) && (id < GCStats::kDataEntries));
+    ASSERT((id >= 0) && (id < GCStats::kTimeEntries));
     stats_.times_[id] = micros;
   }
 
@@ -253,12 +273,13 @@ class Heap {
     };
 
     enum {
-      kDataEntries = 4
+      kTimeEntries = 4,
+      kDataEntries = 5
     };
 
     Data before_;
     Data after_;
-    int64_t times_[kDataEntries];
+    int64_t times_[kTimeEntries];
     intptr_t data_[kDataEntries];
 
    private:
@@ -267,6 +288,12 @@ class Heap {
 
   static const intptr_t kNewAllocatableSize = 256 * KB;
 
+  // Idle time is only used for a scavenge once new space is used to at least
+  // this percentage of its capacity.
+  static const intptr_t kIdleScavengeUsedRatio = 25;
+
+  static const int64_t kNotMeasured = -1;
+
   Heap();
 
   uword AllocateNew(intptr_t size);
@@ -288,6 +315,12 @@ class Heap {
   // GC stats collection.
   GCStats stats_;
 
+  // Duration of the last collection of each space, used to predict whether
+  // a collection fits into idle time. kNotMeasured until the space has been
+  // collected once.
+  int64_t last_scavenge_micros_;
+  int64_t last_mark_sweep_micros_;
+
   // This heap is in read-only mode: No allocation is allowed.
   bool read_only_;
 
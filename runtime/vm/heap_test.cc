@@ -5,10 +5,15 @@
 #include "platform/assert.h"
 #include "vm/globals.h"
 #include "vm/heap.h"
+#include "vm/symbols.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
+DECLARE_FLAG(int, new_gen_target_pause_micros);
+DECLARE_FLAG(bool, pretenure);
+DECLARE_FLAG(bool, card_marking);
+
 TEST_CASE(OldGC) {
   const char* kScriptChars =
   "main() {\n"
@@ -46,4 +51,326 @@ TEST_CASE(LargeSweep) {
   Dart_ExitScope();
   heap->CollectGarbage(Heap::kOld);
 }
+
+
+// Builds a list in old space with garbage hanging off every node, so that
+// the live and dead objects are interleaved on the pages once the garbage is
+// dropped. Returns by how many words collecting the fragmented old space
+// again reduced its capacity.
+static intptr_t RunNodeListTest() {
+  const char* kScriptChars =
+  "class Node {\n"
+  "  var next;\n"
+  "  var value;\n"
+  "  var garbage;\n"
+  "  Node(this.next, this.value);\n"
+  "}\n"
+  "var list;\n"
+  "build() {\n"
+  "  list = null;\n"
+  "  for (var i = 0; i < 100000; i++) {\n"
+  "    list = new Node(list, new List(i % 8));\n"
+  "    list.garbage = new List(32);\n"
+  "  }\n"
+  "}\n"
+  "drop() {\n"
+  "  for (var n = list; n != null; n = n.next) {\n"
+  "    n.garbage = null;\n"
+  "  }\n"
+  "}\n"
+  "check() {\n"
+  "  var count = 0;\n"
+  "  for (var n = list; n != null; n = n.next) {\n"
+  "    if (n.value.length != (99999 - count) % 8) return -1;\n"
+  "    count++;\n"
+  "  }\n"
+  "  return count;\n"
+  "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("build"), 0, NULL));
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  // The first scavenge copies the list, the second one promotes it.
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("drop"), 0, NULL));
+  // The first collection leaves the pages fragmented, the second one may
+  // evacuate them.
+  heap->CollectGarbage(Heap::kOld);
+  intptr_t fragmented_capacity = heap->CapacityInWords(Heap::kOld);
+  heap->CollectGarbage(Heap::kOld);
+  intptr_t shrink = fragmented_capacity - heap->CapacityInWords(Heap::kOld);
+  // Reuse the swept memory and collect again.
+  EXPECT_VALID(Dart_Invoke(lib, NewString("build"), 0, NULL));
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kOld);
+  Dart_Handle result = Dart_Invoke(lib, NewString("check"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t count = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &count));
+  EXPECT_EQ(100000, count);
+  return shrink;
+}
+
+
+class CountingObjectVisitor : public ObjectVisitor {
+ public:
+  explicit CountingObjectVisitor(Isolate* isolate)
+      : ObjectVisitor(isolate), count_(0) { }
+
+  void VisitObject(RawObject* obj) {
+    if (!obj->IsFreeListElement()) {
+      count_++;
+    }
+  }
+
+  intptr_t count() const { return count_; }
+
+ private:
+  intptr_t count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingObjectVisitor);
+};
+
+
+TEST_CASE(ParallelScavenge) {
+  const int saved_tasks = FLAG_scavenger_tasks;
+  FLAG_scavenger_tasks = 4;
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  Scavenger* new_space = heap->new_space();
+  RunNodeListTest();
+  // The helper tasks took a share of the copying, but not all of it.
+  EXPECT_LT(0, new_space->parallel_helper_copied_count());
+  EXPECT_LT(new_space->parallel_helper_copied_count(),
+            new_space->parallel_copied_count());
+  // Every survivor of a scavenge is still live at the next one and is claimed
+  // by exactly one task.
+  heap->CollectGarbage(Heap::kNew);
+  CountingObjectVisitor visitor(isolate);
+  heap->IterateNewObjects(&visitor);
+  const intptr_t copied_before = new_space->parallel_copied_count();
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT_EQ(visitor.count(),
+            new_space->parallel_copied_count() - copied_before);
+  FLAG_scavenger_tasks = saved_tasks;
+}
+
+
+TEST_CASE(ParallelMark) {
+  const int saved_tasks = FLAG_marker_tasks;
+  FLAG_marker_tasks = 4;
+  Heap* heap = Isolate::Current()->heap();
+  PageSpace* old_space = heap->old_space();
+  RunNodeListTest();
+  // The helper tasks took a share of the marking, but not all of it.
+  const intptr_t helper_before = old_space->helper_marked_in_words();
+  heap->CollectGarbage(Heap::kOld);
+  const intptr_t helper_marked =
+      old_space->helper_marked_in_words() - helper_before;
+  EXPECT_LT(0, helper_marked);
+  EXPECT_LT(helper_marked, old_space->marked_in_words());
+  FLAG_marker_tasks = saved_tasks;
+}
+
+
+TEST_CASE(ParallelSweep) {
+  const int saved_tasks = FLAG_sweeper_tasks;
+  FLAG_sweeper_tasks = 4;
+  Heap* heap = Isolate::Current()->heap();
+  PageSpace* old_space = heap->old_space();
+  RunNodeListTest();
+  // The helper tasks swept some of the pages.
+  const intptr_t helper_before = old_space->helper_swept_pages();
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT_LT(helper_before, old_space->helper_swept_pages());
+  FLAG_sweeper_tasks = saved_tasks;
+}
+
+
+TEST_CASE(CompactOldSpace) {
+  const bool saved_compact = FLAG_compact_old_space;
+  FLAG_compact_old_space = true;
+  EXPECT_LT(0, RunNodeListTest());
+  FLAG_compact_old_space = saved_compact;
+}
+
+
+TEST_CASE(LazySweep) {
+  const bool saved_lazy_sweep = FLAG_lazy_sweep;
+  FLAG_lazy_sweep = true;
+  Heap* heap = Isolate::Current()->heap();
+  PageSpace* old_space = heap->old_space();
+  RunNodeListTest();
+  // Collecting leaves the pages to the allocator.
+  heap->CollectGarbage(Heap::kOld);
+  const intptr_t unswept = old_space->unswept_pages();
+  EXPECT_LT(0, unswept);
+  // Allocation sweeps only until it finds room.
+  Array::Handle(Array::New(8, Heap::kOld));
+  EXPECT_LT(old_space->unswept_pages(), unswept);
+  EXPECT_LT(0, old_space->unswept_pages());
+  old_space->CompleteSweep();
+  EXPECT_EQ(0, old_space->unswept_pages());
+  FLAG_lazy_sweep = saved_lazy_sweep;
+}
+
+
+TEST_CASE(OldSpaceBumpAllocation) {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  const Array& first = Array::Handle(Array::New(4, Heap::kOld));
+  intptr_t used_before = heap->UsedInWords(Heap::kOld);
+  const Array& second = Array::Handle(Array::New(4, Heap::kOld));
+  intptr_t size = second.raw()->Size();
+  // Only the object itself is accounted for, not the rest of the area.
+  EXPECT_EQ(size >> kWordSizeLog2,
+            heap->UsedInWords(Heap::kOld) - used_before);
+  // Small data objects are allocated from the bump allocation area.
+  uword top = *reinterpret_cast<uword*>(heap->OldTopAddress());
+  EXPECT_EQ(RawObject::ToAddr(second.raw()) + size, top);
+  EXPECT(top <= *reinterpret_cast<uword*>(heap->OldEndAddress()));
+  // The old space stays iterable.
+  EXPECT(heap->Verify());
+  EXPECT_EQ(4, first.Length());
+}
+
+
+TEST_CASE(PretenureFeedback) {
+  const char* kScriptChars =
+  "class Entry {\n"
+  "  var next;\n"
+  "  Entry(this.next);\n"
+  "}\n"
+  "class Temp {\n"
+  "  var value;\n"
+  "  Temp(this.value);\n"
+  "}\n"
+  "var cache;\n"
+  "fill() {\n"
+  "  for (var i = 0; i < 100000; i++) {\n"
+  "    cache = new Entry(cache);\n"
+  "    new Temp(i);\n"
+  "  }\n"
+  "}\n";
+  const bool saved_pretenure = FLAG_pretenure;
+  FLAG_pretenure = true;
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  // Start with an empty new space, so that only the loop is sampled.
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("fill"), 0, NULL));
+  heap->CollectGarbage(Heap::kNew);
+  const Library& library = Library::Handle(Library::LookupLibrary(
+      String::Handle(String::New(TestCase::url()))));
+  EXPECT(!library.IsNull());
+  const Class& entry = Class::Handle(
+      library.LookupClass(String::Handle(Symbols::New("Entry"))));
+  const Class& temp = Class::Handle(
+      library.LookupClass(String::Handle(Symbols::New("Temp"))));
+  EXPECT(!entry.IsNull());
+  EXPECT(!temp.IsNull());
+  // All the entries are kept alive by the cache, the temporaries die young.
+  ClassTable* class_table = isolate->class_table();
+  EXPECT(class_table->ShouldPretenure(entry.id()));
+  EXPECT(!class_table->ShouldPretenure(temp.id()));
+  FLAG_pretenure = saved_pretenure;
+}
+
+
+static void AllocateGarbage(intptr_t count) {
+  for (intptr_t i = 0; i < count; i++) {
+    Array::New(8);
+  }
+}
+
+
+TEST_CASE(NewSpaceResizing) {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  heap->CollectGarbage(Heap::kNew);
+  const intptr_t full_capacity = heap->CapacityInWords(Heap::kNew);
+  heap->ShrinkNewSpace();
+  EXPECT_LT(heap->CapacityInWords(Heap::kNew), full_capacity);
+  AllocateGarbage(1000);
+  // Without a pause target the next scavenge restores the full size.
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT_EQ(full_capacity, heap->CapacityInWords(Heap::kNew));
+
+  // With a generous pause target new space grows while little survives.
+  const int saved_target = FLAG_new_gen_target_pause_micros;
+  FLAG_new_gen_target_pause_micros = 1000000000;
+  heap->ShrinkNewSpace();
+  const intptr_t shrunk_capacity = heap->CapacityInWords(Heap::kNew);
+  AllocateGarbage(50000);
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT_GT(heap->CapacityInWords(Heap::kNew), shrunk_capacity);
+  EXPECT_LE(heap->CapacityInWords(Heap::kNew), full_capacity);
+  FLAG_new_gen_target_pause_micros = saved_target;
+}
+
+
+static intptr_t CardIndexOf(intptr_t index) {
+  return (Array::data_offset() + index * kWordSize) >> HeapPage::kCardSizeLog2;
+}
+
+
+TEST_CASE(CardMarking) {
+  if (!FLAG_card_marking) {
+    return;
+  }
+  Heap* heap = Isolate::Current()->heap();
+  const intptr_t kLength = 64 * KB;
+  const intptr_t kIndex = 40000;
+  const Array& array = Array::Handle(Array::New(kLength, Heap::kOld));
+  EXPECT(array.raw()->IsCardRemembered());
+  HeapPage* page = HeapPage::OfCardRemembered(array.raw());
+  EXPECT(!page->IsCardDirty(CardIndexOf(kIndex)));
+  array.SetAt(kIndex, String::Handle(String::New("young")));
+  // Only the card of the stored slot is dirty, the store buffer is unused.
+  EXPECT(!array.raw()->IsRemembered());
+  EXPECT(page->IsCardDirty(CardIndexOf(kIndex)));
+  EXPECT(!page->IsCardDirty(CardIndexOf(0)));
+  EXPECT(!page->IsCardDirty(CardIndexOf(kLength - 1)));
+  // The copied string is still in new space and keeps its card dirty.
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(array.At(kIndex)->IsNewObject());
+  EXPECT(page->IsCardDirty(CardIndexOf(kIndex)));
+  // Once promoted, the string no longer needs its card.
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(array.At(kIndex)->IsOldObject());
+  EXPECT(!page->IsCardDirty(CardIndexOf(kIndex)));
+  String& str = String::Handle();
+  str ^= array.At(kIndex);
+  EXPECT(str.Equals("young"));
+  // Marking rebuilds the cards.
+  array.SetAt(kIndex, String::Handle(String::New("young again")));
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT(page->IsCardDirty(CardIndexOf(kIndex)));
+}
+
+
+TEST_CASE(StoreBufferDeduplication) {
+  Isolate* isolate = Isolate::Current();
+  isolate->heap()->CollectGarbage(Heap::kNew);
+  StoreBuffer* buffer = isolate->store_buffer();
+  const Array& array = Array::Handle(Array::New(8, Heap::kOld));
+  const String& str = String::Handle(String::New("young"));
+  intptr_t count_before = buffer->Count();
+  // Repeated stores record the array only once.
+  for (intptr_t i = 0; i < 100; i++) {
+    array.SetAt(i % 8, str);
+  }
+  EXPECT(array.raw()->IsRemembered());
+  EXPECT_EQ(count_before + 1, buffer->Count());
+  // A clone is recorded on its own, even though it copies the header tags.
+  const Array& clone = Array::Handle(
+      Array::RawCast(Object::Clone(array, Heap::kOld)));
+  EXPECT(clone.raw()->IsRemembered());
+  EXPECT(buffer->Contains(clone.raw()));
+  EXPECT_EQ(count_before + 2, buffer->Count());
 }
+
+}  // namespace dart
@@ -476,6 +476,9 @@ void AllocateObjectInstr::PrintOperandsTo(BufferFormatter* f) const {
     f->Print(", ");
     PushArgumentAt(i)->value()->PrintTo(f);
   }
+  if (space() == Heap::kOld) {
+    f->Print(", old");
+  }
 }
 
 
@@ -793,6 +796,49 @@ void ShiftMintOpInstr::PrintOperandsTo(BufferFormatter* f) const {
 }
 
 
+static const char* IntRepresentationToCString(Representation rep) {
+  switch (rep) {
+    case kUnboxedMint: return "mint";
+    case kUnboxedUint32: return "uint32";
+    case kUnboxedInt32: return "int32";
+    default: UNREACHABLE();
+  }
+  return NULL;
+}
+
+
+void UnboxedIntConverterInstr::PrintOperandsTo(BufferFormatter* f) const {
+  f->Print("%s->%s, ",
+           IntRepresentationToCString(from()),
+           IntRepresentationToCString(to()));
+  value()->PrintTo(f);
+}
+
+
+void BinaryUint32OpInstr::PrintOperandsTo(BufferFormatter* f) const {
+  f->Print("%s, ", Token::Str(op_kind()));
+  left()->PrintTo(f);
+  f->Print(", ");
+  right()->PrintTo(f);
+}
+
+
+void ShiftUint32OpInstr::PrintOperandsTo(BufferFormatter* f) const {
+  f->Print("%s, ", Token::Str(op_kind()));
+  left()->PrintTo(f);
+  f->Print(", ");
+  right()->PrintTo(f);
+}
+
+
+void BinaryInt32OpInstr::PrintOperandsTo(BufferFormatter* f) const {
+  f->Print("%s, ", Token::Str(op_kind()));
+  left()->PrintTo(f);
+  f->Print(", ");
+  right()->PrintTo(f);
+}
+
+
 void UnaryMintOpInstr::PrintOperandsTo(BufferFormatter* f) const {
   f->Print("%s, ", Token::Str(op_kind()));
   value()->PrintTo(f);
@@ -966,6 +1012,17 @@ void BranchInstr::PrintTo(BufferFormatter* f) const {
 }
 
 
+void JumpTableInstr::PrintTo(BufferFormatter* f) const {
+  Instruction::PrintTo(f);
+  f->Print(" from %" Pd " goto (", lower_bound());
+  for (intptr_t i = 0; i < length(); i++) {
+    if (i != 0) f->Print(", ");
+    f->Print("%" Pd "", TargetAt(i)->block_id());
+  }
+  f->Print(") else %" Pd "", default_target()->block_id());
+}
+
+
 void ParallelMoveInstr::PrintTo(BufferFormatter* f) const {
   f->Print("%s ", DebugName());
   for (intptr_t i = 0; i < moves_.length(); i++) {
@@ -1073,6 +1073,38 @@ BlockEntryInstr* BranchInstr::SuccessorAt(intptr_t index) const {
 }
 
 
+void JumpTableInstr::AddSuccessor(TargetEntryInstr* target) {
+  for (intptr_t i = 0; i < successors_.length(); ++i) {
+    if (successors_[i] == target) return;
+  }
+  successors_.Add(target);
+}
+
+
+void JumpTableInstr::SetTargetAt(intptr_t index, TargetEntryInstr* target) {
+  ASSERT(table_[index] == NULL);
+  table_[index] = target;
+  AddSuccessor(target);
+}
+
+
+void JumpTableInstr::set_default_target(TargetEntryInstr* target) {
+  ASSERT(default_target_ == NULL);
+  default_target_ = target;
+  AddSuccessor(target);
+}
+
+
+intptr_t JumpTableInstr::SuccessorCount() const {
+  return successors_.length();
+}
+
+
+BlockEntryInstr* JumpTableInstr::SuccessorAt(intptr_t index) const {
+  return successors_[index];
+}
+
+
 intptr_t GotoInstr::SuccessorCount() const {
   return 1;
 }
@@ -1449,6 +1481,57 @@ Definition* UnboxDoubleInstr::Canonicalize(FlowGraph* flow_graph) {
 }
 
 
+Definition* BoxUint32Instr::Canonicalize(FlowGraph* flow_graph) {
+  if (input_use_list() == NULL) {
+    // Environments can accomodate any representation. No need to box.
+    return value()->definition();
+  }
+  return this;
+}
+
+
+Definition* UnboxUint32Instr::Canonicalize(FlowGraph* flow_graph) {
+  // Fold away UnboxUint32(BoxUint32(v)). The opposite direction truncates
+  // and can't be folded.
+  BoxUint32Instr* defn = value()->definition()->AsBoxUint32();
+  return (defn != NULL) ? defn->value()->definition() : this;
+}
+
+
+Definition* BoxInt32Instr::Canonicalize(FlowGraph* flow_graph) {
+  if (input_use_list() == NULL) {
+    // Environments can accomodate any representation. No need to box.
+    return value()->definition();
+  }
+  return this;
+}
+
+
+Definition* UnboxInt32Instr::Canonicalize(FlowGraph* flow_graph) {
+  // Fold away UnboxInt32(BoxInt32(v)).
+  BoxInt32Instr* defn = value()->definition()->AsBoxInt32();
+  return (defn != NULL) ? defn->value()->definition() : this;
+}
+
+
+bool UnboxInt32Instr::IsSmiInInt32Range(Value* value) {
+  if (value->BindsToConstant()) {
+    const Object& constant = value->BoundConstant();
+    return constant.IsSmi() &&
+        Utils::IsInt(32, static_cast<int64_t>(Smi::Cast(constant).Value()));
+  }
+  if (value->Type()->ToCid() != kSmiCid) {
+    return false;
+  }
+  if (kSmiBits < 32) {
+    // Every Smi fits.
+    return true;
+  }
+  Range* range = value->definition()->range();
+  return (range != NULL) && range->IsWithin(kMinInt32, kMaxInt32);
+}
+
+
 Definition* BoxFloat32x4Instr::Canonicalize(FlowGraph* flow_graph) {
   if (input_use_list() == NULL) {
     // Environments can accomodate any representation. No need to box.
@@ -2669,7 +2752,12 @@ void BinarySmiOpInstr::InferRange() {
   }
 
   ASSERT(!min.IsUnknown() && !max.IsUnknown());
-  set_overflow(min.LowerBound().Overflowed() || max.UpperBound().Overflowed());
+  // Operations created without an overflow check (e.g. the induction variable
+  // of a vectorized loop) have no deoptimization environment to fall back on.
+  if (overflow_) {
+    set_overflow(min.LowerBound().Overflowed() ||
+                 max.UpperBound().Overflowed());
+  }
 
   if (min.IsConstant()) min.Clamp();
   if (max.IsConstant()) max.Clamp();
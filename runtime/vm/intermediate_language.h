@@ -604,6 +604,7 @@ class EmbeddedArray<T, 0> {
   M(ReThrow)                                                                   \
   M(Goto)                                                                      \
   M(Branch)                                                                    \
+  M(JumpTable)                                                                 \
   M(AssertAssignable)                                                          \
   M(AssertBoolean)                                                             \
   M(CurrentContext)                                                            \
@@ -667,6 +668,14 @@ class EmbeddedArray<T, 0> {
   M(BinaryMintOp)                                                              \
   M(ShiftMintOp)                                                               \
   M(UnaryMintOp)                                                               \
+  M(BoxUint32)                                                                 \
+  M(UnboxUint32)                                                               \
+  M(UnboxedIntConverter)                                                       \
+  M(BinaryUint32Op)                                                            \
+  M(ShiftUint32Op)                                                             \
+  M(BoxInt32)                                                                  \
+  M(UnboxInt32)                                                                \
+  M(BinaryInt32Op)                                                             \
   M(CheckArrayBound)                                                           \
   M(Constraint)                                                                \
   M(StringFromCharCode)                                                        \
@@ -988,6 +997,11 @@ FOR_EACH_INSTRUCTION(INSTRUCTION_TYPE_CHECK)
   friend class UnaryDoubleOpInstr;
   friend class ShiftMintOpInstr;
   friend class UnaryMintOpInstr;
+  friend class UnboxUint32Instr;
+  friend class BinaryUint32OpInstr;
+  friend class ShiftUint32OpInstr;
+  friend class UnboxInt32Instr;
+  friend class BinaryInt32OpInstr;
   friend class MathUnaryInstr;
   friend class MathMinMaxInstr;
   friend class CheckClassInstr;
@@ -996,6 +1010,7 @@ FOR_EACH_INSTRUCTION(INSTRUCTION_TYPE_CHECK)
   friend class CheckArrayBoundInstr;
   friend class CheckEitherNonSmiInstr;
   friend class LICM;
+  friend class RangeAnalysis;
   friend class DoubleToSmiInstr;
   friend class DoubleToDoubleInstr;
   friend class InvokeMathCFunctionInstr;
@@ -2335,6 +2350,61 @@ class BranchInstr : public Instruction {
 };
 
 
+// Jumps to the target in the table entry for its Smi input minus the lower
+// bound of the table, or to the default target if the input is outside of
+// the table.  The targets are distinct blocks, entries that go to the same
+// block share its target.
+class JumpTableInstr : public TemplateInstruction<1> {
+ public:
+  JumpTableInstr(Value* value, intptr_t lower_bound, intptr_t length)
+      : lower_bound_(lower_bound),
+        table_(length),
+        default_target_(NULL),
+        successors_(length + 1) {
+    SetInputAt(0, value);
+    for (intptr_t i = 0; i < length; ++i) {
+      table_.Add(NULL);
+    }
+  }
+
+  DECLARE_INSTRUCTION(JumpTable)
+
+  Value* value() const { return inputs_[0]; }
+
+  virtual intptr_t ArgumentCount() const { return 0; }
+
+  intptr_t lower_bound() const { return lower_bound_; }
+  intptr_t length() const { return table_.length(); }
+
+  TargetEntryInstr* TargetAt(intptr_t index) const { return table_[index]; }
+  void SetTargetAt(intptr_t index, TargetEntryInstr* target);
+
+  TargetEntryInstr* default_target() const { return default_target_; }
+  void set_default_target(TargetEntryInstr* target);
+
+  virtual intptr_t SuccessorCount() const;
+  virtual BlockEntryInstr* SuccessorAt(intptr_t index) const;
+
+  virtual bool CanDeoptimize() const { return false; }
+
+  virtual EffectSet Effects() const { return EffectSet::None(); }
+
+  virtual void PrintTo(BufferFormatter* f) const;
+
+  virtual bool MayThrow() const { return false; }
+
+ private:
+  void AddSuccessor(TargetEntryInstr* target);
+
+  const intptr_t lower_bound_;
+  GrowableArray<TargetEntryInstr*> table_;
+  TargetEntryInstr* default_target_;
+  GrowableArray<TargetEntryInstr*> successors_;
+
+  DISALLOW_COPY_AND_ASSIGN(JumpTableInstr);
+};
+
+
 class StoreContextInstr : public TemplateInstruction<1> {
  public:
   explicit StoreContextInstr(Value* value) {
@@ -3469,7 +3539,8 @@ class StoreInstanceFieldInstr : public TemplateDefinition<2> {
                           Value* value,
                           StoreBarrierType emit_store_barrier)
       : field_(field),
-        emit_store_barrier_(emit_store_barrier) {
+        emit_store_barrier_(emit_store_barrier),
+        value_representation_(kTagged) {
     SetInputAt(kInstancePos, instance);
     SetInputAt(kValuePos, value);
   }
@@ -3493,6 +3564,31 @@ class StoreInstanceFieldInstr : public TemplateDefinition<2> {
         && (emit_store_barrier_ == kEmitStoreBarrier);
   }
 
+  // An unboxed store writes an unboxed value into the box owned by the
+  // instance (see Field::IsUnboxedField). Only the optimizer creates unboxed
+  // stores, the resulting code depends on the guard of the field.
+  bool IsUnboxedStore() const { return value_representation_ != kTagged; }
+  void set_value_representation(Representation rep) {
+    value_representation_ = rep;
+  }
+
+  // A tagged store into a field that is unboxed or might become unboxed.
+  // The generated code checks the state of the field at run time.
+  bool IsPotentialUnboxedStore() const {
+    return !IsUnboxedStore() && field().IsPotentialUnboxedField();
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT((idx == kInstancePos) || (idx == kValuePos));
+    return (idx == kValuePos) ? value_representation_ : kTagged;
+  }
+
+  // Unboxed stores only take values that are known to match the guard, so
+  // the conversions in front of them never deoptimize.
+  virtual intptr_t DeoptimizationTarget() const {
+    return Isolate::kNoDeoptId;
+  }
+
   virtual void PrintOperandsTo(BufferFormatter* f) const;
 
   virtual bool CanDeoptimize() const { return false; }
@@ -3514,6 +3610,7 @@ class StoreInstanceFieldInstr : public TemplateDefinition<2> {
 
   const Field& field_;
   const StoreBarrierType emit_store_barrier_;
+  Representation value_representation_;
 
   DISALLOW_COPY_AND_ASSIGN(StoreInstanceFieldInstr);
 };
@@ -3897,6 +3994,7 @@ class AllocateObjectInstr : public TemplateDefinition<0> {
         cls_(cls),
         arguments_(arguments),
         identity_(kUnknown),
+        space_(Heap::kNew),
         closure_function_(Function::ZoneHandle()),
         context_field_(Field::ZoneHandle()) {
     // Either no arguments or one type-argument and one instantiator.
@@ -3944,11 +4042,16 @@ class AllocateObjectInstr : public TemplateDefinition<0> {
   Identity identity() const { return identity_; }
   void set_identity(Identity identity) { identity_ = identity; }
 
+  // Space the instance is allocated in, old space if the class is pretenured.
+  Heap::Space space() const { return space_; }
+  void set_space(Heap::Space space) { space_ = space; }
+
  private:
   const intptr_t token_pos_;
   const Class& cls_;
   ZoneGrowableArray<PushArgumentInstr*>* const arguments_;
   Identity identity_;
+  Heap::Space space_;
   Function& closure_function_;
   Field& context_field_;
 
@@ -3961,10 +4064,15 @@ class AllocateObjectInstr : public TemplateDefinition<0> {
 // It does not produce any real code only deoptimization information.
 class MaterializeObjectInstr : public Definition {
  public:
-  MaterializeObjectInstr(const Class& cls,
+  MaterializeObjectInstr(AllocateObjectInstr* allocation,
+                         const Class& cls,
                          const ZoneGrowableArray<const Field*>& fields,
                          ZoneGrowableArray<Value*>* values)
-      : cls_(cls), fields_(fields), values_(values), locations_(NULL) {
+      : allocation_(allocation),
+        cls_(cls),
+        fields_(fields),
+        values_(values),
+        locations_(NULL) {
     ASSERT(fields_.length() == values_->length());
     for (intptr_t i = 0; i < InputCount(); i++) {
       InputAt(i)->set_instruction(this);
@@ -3972,6 +4080,8 @@ class MaterializeObjectInstr : public Definition {
     }
   }
 
+  // The eliminated allocation described by this materialization.
+  AllocateObjectInstr* allocation() const { return allocation_; }
   const Class& cls() const { return cls_; }
   const Field& FieldAt(intptr_t i) const {
     return *fields_[i];
@@ -4009,6 +4119,7 @@ class MaterializeObjectInstr : public Definition {
     (*values_)[i] = value;
   }
 
+  AllocateObjectInstr* allocation_;
   const Class& cls_;
   const ZoneGrowableArray<const Field*>& fields_;
   ZoneGrowableArray<Value*>* values_;
@@ -4199,7 +4310,8 @@ class LoadFieldInstr : public TemplateDefinition<1> {
         result_cid_(kDynamicCid),
         immutable_(immutable),
         recognized_kind_(MethodRecognizer::kUnknown),
-        field_(NULL) {
+        field_(NULL),
+        representation_(kTagged) {
     ASSERT(offset_in_bytes >= 0);
     ASSERT(type.IsZoneHandle());  // May be null if field is not an instance.
     SetInputAt(0, instance);
@@ -4214,6 +4326,21 @@ class LoadFieldInstr : public TemplateDefinition<1> {
   const Field* field() const { return field_; }
   void set_field(const Field* field) { field_ = field; }
 
+  // An unboxed load reads the payload of the box owned by the instance
+  // (see Field::IsUnboxedField). Only the optimizer creates unboxed loads,
+  // the resulting code depends on the guard of the field.
+  bool IsUnboxedLoad() const { return representation_ != kTagged; }
+  void set_representation(Representation rep) { representation_ = rep; }
+  virtual Representation representation() const { return representation_; }
+
+  // A tagged load of a field that is unboxed or might become unboxed. The
+  // generated code checks the state of the field at run time and returns a
+  // copy of the box if the field is unboxed.
+  bool IsPotentialUnboxedLoad() const {
+    return !IsUnboxedLoad() &&
+        (field_ != NULL) && field_->IsPotentialUnboxedField();
+  }
+
   void set_recognized_kind(MethodRecognizer::Kind kind) {
     recognized_kind_ = kind;
   }
@@ -4255,6 +4382,7 @@ class LoadFieldInstr : public TemplateDefinition<1> {
   MethodRecognizer::Kind recognized_kind_;
 
   const Field* field_;
+  Representation representation_;
 
   DISALLOW_COPY_AND_ASSIGN(LoadFieldInstr);
 };
@@ -6260,6 +6388,432 @@ class UnaryMintOpInstr : public TemplateDefinition<1> {
 };
 
 
+// Boxes an unboxed uint32 value into a Smi, or into a Mint on platforms where
+// it does not fit into a Smi.
+class BoxUint32Instr : public TemplateDefinition<1> {
+ public:
+  explicit BoxUint32Instr(Value* value) {
+    SetInputAt(0, value);
+  }
+
+  Value* value() const { return inputs_[0]; }
+
+  virtual bool CanDeoptimize() const { return false; }
+
+  virtual intptr_t DeoptimizationTarget() const {
+    return Isolate::kNoDeoptId;
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT(idx == 0);
+    return kUnboxedUint32;
+  }
+
+  DECLARE_INSTRUCTION(BoxUint32)
+  virtual CompileType ComputeType() const;
+
+  virtual bool AllowsCSE() const { return true; }
+  virtual EffectSet Effects() const { return EffectSet::None(); }
+  virtual EffectSet Dependencies() const { return EffectSet::None(); }
+  virtual bool AttributesEqual(Instruction* other) const { return true; }
+
+  virtual bool MayThrow() const { return false; }
+
+  Definition* Canonicalize(FlowGraph* flow_graph);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BoxUint32Instr);
+};
+
+
+// Unboxes a Smi or a Mint into an unboxed uint32 value keeping only the
+// low 32 bits of the integer.
+class UnboxUint32Instr : public TemplateDefinition<1> {
+ public:
+  UnboxUint32Instr(Value* value, intptr_t deopt_id) {
+    SetInputAt(0, value);
+    deopt_id_ = deopt_id;
+  }
+
+  Value* value() const { return inputs_[0]; }
+
+  virtual bool CanDeoptimize() const {
+    return (value()->Type()->ToCid() != kSmiCid)
+        && (value()->Type()->ToCid() != kMintCid);
+  }
+
+  virtual Representation representation() const {
+    return kUnboxedUint32;
+  }
+
+  DECLARE_INSTRUCTION(UnboxUint32)
+  virtual CompileType ComputeType() const;
+
+  virtual bool AllowsCSE() const { return true; }
+  virtual EffectSet Effects() const { return EffectSet::None(); }
+  virtual EffectSet Dependencies() const { return EffectSet::None(); }
+  virtual bool AttributesEqual(Instruction* other) const { return true; }
+
+  virtual bool MayThrow() const { return false; }
+
+  Definition* Canonicalize(FlowGraph* flow_graph);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(UnboxUint32Instr);
+};
+
+
+// Converts between unboxed mint, uint32 and int32 representations without
+// going through a box. Conversion to uint32 truncates. Only int32 to uint32
+// is supported for int32 values.
+class UnboxedIntConverterInstr : public TemplateDefinition<1> {
+ public:
+  UnboxedIntConverterInstr(Representation from,
+                           Representation to,
+                           Value* value)
+      : from_representation_(from),
+        to_representation_(to) {
+    ASSERT(from != to);
+    ASSERT((from == kUnboxedMint) ||
+           (from == kUnboxedUint32) ||
+           (from == kUnboxedInt32));
+    ASSERT((to == kUnboxedMint) || (to == kUnboxedUint32));
+    ASSERT((from != kUnboxedInt32) || (to == kUnboxedUint32));
+    SetInputAt(0, value);
+  }
+
+  Value* value() const { return inputs_[0]; }
+
+  Representation from() const { return from_representation_; }
+  Representation to() const { return to_representation_; }
+
+  virtual bool CanDeoptimize() const { return false; }
+
+  virtual Representation representation() const {
+    return to();
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT(idx == 0);
+    return from();
+  }
+
+  virtual void PrintOperandsTo(BufferFormatter* f) const;
+
+  DECLARE_INSTRUCTION(UnboxedIntConverter)
+  virtual CompileType ComputeType() const;
+
+  virtual bool AllowsCSE() const { return true; }
+  virtual EffectSet Effects() const { return EffectSet::None(); }
+  virtual EffectSet Dependencies() const { return EffectSet::None(); }
+  virtual bool AttributesEqual(Instruction* other) const {
+    ASSERT(other->IsUnboxedIntConverter());
+    UnboxedIntConverterInstr* converter = other->AsUnboxedIntConverter();
+    return (converter->from() == from()) && (converter->to() == to());
+  }
+
+  virtual bool MayThrow() const { return false; }
+
+ private:
+  const Representation from_representation_;
+  const Representation to_representation_;
+
+  DISALLOW_COPY_AND_ASSIGN(UnboxedIntConverterInstr);
+};
+
+
+// Arithmetic on unboxed uint32 values. The result is truncated to 32 bits:
+// the instruction is only used where the program observes the low 32 bits of
+// the result (see Uint32Selector).
+class BinaryUint32OpInstr : public TemplateDefinition<2> {
+ public:
+  BinaryUint32OpInstr(Token::Kind op_kind,
+                      Value* left,
+                      Value* right,
+                      intptr_t deopt_id)
+      : op_kind_(op_kind) {
+    ASSERT(IsSupported(op_kind));
+    SetInputAt(0, left);
+    SetInputAt(1, right);
+    // Override generated deopt-id.
+    deopt_id_ = deopt_id;
+  }
+
+  static bool IsSupported(Token::Kind op_kind) {
+    switch (op_kind) {
+      case Token::kADD:
+      case Token::kSUB:
+      case Token::kMUL:
+      case Token::kBIT_AND:
+      case Token::kBIT_OR:
+      case Token::kBIT_XOR:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  Value* left() const { return inputs_[0]; }
+  Value* right() const { return inputs_[1]; }
+
+  Token::Kind op_kind() const { return op_kind_; }
+
+  virtual void PrintOperandsTo(BufferFormatter* f) const;
+
+  virtual bool CanDeoptimize() const { return false; }
+
+  virtual Representation representation() const {
+    return kUnboxedUint32;
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT((idx == 0) || (idx == 1));
+    return kUnboxedUint32;
+  }
+
+  virtual intptr_t DeoptimizationTarget() const {
+    // Direct access since this instruction cannot deoptimize, and the deopt-id
+    // was inherited from another instruction that could deoptimize.
+    return deopt_id_;
+  }
+
+  DECLARE_INSTRUCTION(BinaryUint32Op)
+  virtual CompileType ComputeType() const;
+
+  virtual bool AllowsCSE() const { return true; }
+  virtual EffectSet Effects() const { return EffectSet::None(); }
+  virtual EffectSet Dependencies() const { return EffectSet::None(); }
+  virtual bool AttributesEqual(Instruction* other) const {
+    ASSERT(other->IsBinaryUint32Op());
+    return op_kind() == other->AsBinaryUint32Op()->op_kind();
+  }
+
+  virtual bool MayThrow() const { return false; }
+
+ private:
+  const Token::Kind op_kind_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryUint32OpInstr);
+};
+
+
+// Shift of an unboxed uint32 value by a constant Smi count in [0, 31].
+// Shift-left is truncated to 32 bits.
+class ShiftUint32OpInstr : public TemplateDefinition<2> {
+ public:
+  ShiftUint32OpInstr(Token::Kind op_kind,
+                     Value* left,
+                     Value* right,
+                     intptr_t deopt_id)
+      : op_kind_(op_kind) {
+    ASSERT((op_kind == Token::kSHR) || (op_kind == Token::kSHL));
+    ASSERT(right->BindsToConstant() && right->BoundConstant().IsSmi());
+    SetInputAt(0, left);
+    SetInputAt(1, right);
+    // Override generated deopt-id.
+    deopt_id_ = deopt_id;
+  }
+
+  Value* left() const { return inputs_[0]; }
+  Value* right() const { return inputs_[1]; }
+
+  Token::Kind op_kind() const { return op_kind_; }
+
+  intptr_t shift_count() const {
+    return Smi::Cast(right()->BoundConstant()).Value();
+  }
+
+  virtual void PrintOperandsTo(BufferFormatter* f) const;
+
+  virtual bool CanDeoptimize() const { return false; }
+
+  virtual Representation representation() const {
+    return kUnboxedUint32;
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT((idx == 0) || (idx == 1));
+    return (idx == 0) ? kUnboxedUint32 : kTagged;
+  }
+
+  virtual intptr_t DeoptimizationTarget() const {
+    // Direct access since this instruction cannot deoptimize, and the deopt-id
+    // was inherited from another instruction that could deoptimize.
+    return deopt_id_;
+  }
+
+  DECLARE_INSTRUCTION(ShiftUint32Op)
+  virtual CompileType ComputeType() const;
+
+  virtual bool AllowsCSE() const { return true; }
+  virtual EffectSet Effects() const { return EffectSet::None(); }
+  virtual EffectSet Dependencies() const { return EffectSet::None(); }
+  virtual bool AttributesEqual(Instruction* other) const {
+    ASSERT(other->IsShiftUint32Op());
+    return op_kind() == other->AsShiftUint32Op()->op_kind();
+  }
+
+  virtual bool MayThrow() const { return false; }
+
+ private:
+  const Token::Kind op_kind_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShiftUint32OpInstr);
+};
+
+
+// Boxes an unboxed int32 value into a Smi, or into a Mint on platforms where
+// it does not fit into a Smi.
+class BoxInt32Instr : public TemplateDefinition<1> {
+ public:
+  explicit BoxInt32Instr(Value* value) {
+    SetInputAt(0, value);
+  }
+
+  Value* value() const { return inputs_[0]; }
+
+  virtual bool CanDeoptimize() const { return false; }
+
+  virtual intptr_t DeoptimizationTarget() const {
+    return Isolate::kNoDeoptId;
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT(idx == 0);
+    return kUnboxedInt32;
+  }
+
+  DECLARE_INSTRUCTION(BoxInt32)
+  virtual CompileType ComputeType() const;
+
+  virtual bool AllowsCSE() const { return true; }
+  virtual EffectSet Effects() const { return EffectSet::None(); }
+  virtual EffectSet Dependencies() const { return EffectSet::None(); }
+  virtual bool AttributesEqual(Instruction* other) const { return true; }
+
+  virtual bool MayThrow() const { return false; }
+
+  Definition* Canonicalize(FlowGraph* flow_graph);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BoxInt32Instr);
+};
+
+
+// Unboxes a Smi into an unboxed int32 value. Deoptimizes if the value is not
+// a Smi or does not fit into 32 bits.
+class UnboxInt32Instr : public TemplateDefinition<1> {
+ public:
+  UnboxInt32Instr(Value* value, intptr_t deopt_id) {
+    SetInputAt(0, value);
+    deopt_id_ = deopt_id;
+  }
+
+  Value* value() const { return inputs_[0]; }
+
+  // Returns true if the given tagged value is known to be a Smi that fits
+  // into 32 bits, i.e. unboxing it can't deoptimize.
+  static bool IsSmiInInt32Range(Value* value);
+
+  virtual bool CanDeoptimize() const {
+    return !IsSmiInInt32Range(value());
+  }
+
+  virtual Representation representation() const {
+    return kUnboxedInt32;
+  }
+
+  DECLARE_INSTRUCTION(UnboxInt32)
+  virtual CompileType ComputeType() const;
+
+  virtual bool AllowsCSE() const { return true; }
+  virtual EffectSet Effects() const { return EffectSet::None(); }
+  virtual EffectSet Dependencies() const { return EffectSet::None(); }
+  virtual bool AttributesEqual(Instruction* other) const { return true; }
+
+  virtual bool MayThrow() const { return false; }
+
+  Definition* Canonicalize(FlowGraph* flow_graph);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(UnboxInt32Instr);
+};
+
+
+// Arithmetic on unboxed int32 values. Only used where range analysis proved
+// that the result fits into 32 bits (see Int32Selector), so the operation
+// never overflows.
+class BinaryInt32OpInstr : public TemplateDefinition<2> {
+ public:
+  BinaryInt32OpInstr(Token::Kind op_kind,
+                     Value* left,
+                     Value* right,
+                     intptr_t deopt_id)
+      : op_kind_(op_kind) {
+    ASSERT(IsSupported(op_kind));
+    SetInputAt(0, left);
+    SetInputAt(1, right);
+    // Override generated deopt-id.
+    deopt_id_ = deopt_id;
+  }
+
+  static bool IsSupported(Token::Kind op_kind) {
+    switch (op_kind) {
+      case Token::kADD:
+      case Token::kSUB:
+      case Token::kBIT_AND:
+      case Token::kBIT_OR:
+      case Token::kBIT_XOR:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  Value* left() const { return inputs_[0]; }
+  Value* right() const { return inputs_[1]; }
+
+  Token::Kind op_kind() const { return op_kind_; }
+
+  virtual void PrintOperandsTo(BufferFormatter* f) const;
+
+  virtual bool CanDeoptimize() const { return false; }
+
+  virtual Representation representation() const {
+    return kUnboxedInt32;
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT((idx == 0) || (idx == 1));
+    return kUnboxedInt32;
+  }
+
+  virtual intptr_t DeoptimizationTarget() const {
+    // Direct access since this instruction cannot deoptimize, and the deopt-id
+    // was inherited from another instruction that could deoptimize.
+    return deopt_id_;
+  }
+
+  DECLARE_INSTRUCTION(BinaryInt32Op)
+  virtual CompileType ComputeType() const;
+
+  virtual bool AllowsCSE() const { return true; }
+  virtual EffectSet Effects() const { return EffectSet::None(); }
+  virtual EffectSet Dependencies() const { return EffectSet::None(); }
+  virtual bool AttributesEqual(Instruction* other) const {
+    ASSERT(other->IsBinaryInt32Op());
+    return op_kind() == other->AsBinaryInt32Op()->op_kind();
+  }
+
+  virtual bool MayThrow() const { return false; }
+
+ private:
+  const Token::Kind op_kind_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryInt32OpInstr);
+};
+
+
 class BinarySmiOpInstr : public TemplateDefinition<2> {
  public:
   BinarySmiOpInstr(Token::Kind op_kind,
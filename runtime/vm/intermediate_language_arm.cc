@@ -4196,6 +4196,67 @@ void BranchInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 }
 
 
+LocationSummary* JumpTableInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 1;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_temp(0, Location::RequiresRegister());
+  return summary;
+}
+
+
+// Emits a binary search for the Smi value over the table entries [from, to).
+static void EmitJumpTableSearch(FlowGraphCompiler* compiler,
+                                JumpTableInstr* jump_table,
+                                Register value,
+                                intptr_t from,
+                                intptr_t to) {
+  const intptr_t kMaxLinearSearchLength = 2;
+  if ((to - from) <= kMaxLinearSearchLength) {
+    for (intptr_t i = from; i < to; i++) {
+      __ CompareImmediate(value,
+                          Smi::RawValue(jump_table->lower_bound() + i));
+      __ b(compiler->GetJumpLabel(jump_table->TargetAt(i)), EQ);
+    }
+    __ b(compiler->GetJumpLabel(jump_table->default_target()));
+    return;
+  }
+  const intptr_t middle = from + (to - from) / 2;
+  Label upper;
+  __ CompareImmediate(value,
+                      Smi::RawValue(jump_table->lower_bound() + middle));
+  __ b(&upper, GE);
+  EmitJumpTableSearch(compiler, jump_table, value, from, middle);
+  __ Bind(&upper);
+  EmitJumpTableSearch(compiler, jump_table, value, middle, to);
+}
+
+
+void JumpTableInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  Register value = locs()->in(0).reg();
+  if (compiler->assembler()->use_far_branches()) {
+    // Far branches vary in size, so the table entries could not be indexed.
+    EmitJumpTableSearch(compiler, this, value, 0, length());
+    return;
+  }
+  Register index = locs()->temp(0).reg();
+  // The Smi value minus the lower bound is a tagged index, which is too large
+  // as unsigned if the value is below the lower bound.
+  __ AddImmediate(index, value, -Smi::RawValue(lower_bound()));
+  __ CompareImmediate(index, Smi::RawValue(length()));
+  __ b(compiler->GetJumpLabel(default_target()), CS);
+  // The entries are single branches, twice the size of the tagged index. The
+  // pc reads as the address of the add plus 8, where the table starts.
+  __ add(PC, PC, ShifterOperand(index, LSL, 1));
+  __ bkpt(0);
+  for (intptr_t i = 0; i < length(); i++) {
+    __ b(compiler->GetJumpLabel(TargetAt(i)));
+  }
+}
+
+
 LocationSummary* CheckClassInstr::MakeLocationSummary() const {
   const intptr_t kNumInputs = 1;
   const intptr_t kNumTemps = 0;
@@ -4377,6 +4438,279 @@ void UnaryMintOpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 }
 
 
+LocationSummary* BoxUint32Instr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs,
+                          kNumTemps,
+                          LocationSummary::kCallOnSlowPath);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+// Allocates the Mint box of an unboxed uint32 or int32 value that does not
+// fit into a Smi.
+class BoxMintSlowPath : public SlowPathCode {
+ public:
+  explicit BoxMintSlowPath(Definition* instruction)
+      : instruction_(instruction) { }
+
+  virtual void EmitNativeCode(FlowGraphCompiler* compiler) {
+    __ Comment("BoxMintSlowPath");
+    __ Bind(entry_label());
+    const Class& mint_class =
+        Class::ZoneHandle(Isolate::Current()->object_store()->mint_class());
+    const Code& stub =
+        Code::Handle(StubCode::GetAllocationStubForClass(mint_class));
+    const ExternalLabel label(mint_class.ToCString(), stub.EntryPoint());
+
+    LocationSummary* locs = instruction_->locs();
+    locs->live_registers()->Remove(locs->out());
+
+    compiler->SaveLiveRegisters(locs);
+    compiler->GenerateCall(Scanner::kDummyTokenIndex,  // No token position.
+                           &label,
+                           PcDescriptors::kOther,
+                           locs);
+    __ MoveRegister(locs->out().reg(), R0);
+    compiler->RestoreLiveRegisters(locs);
+
+    __ b(exit_label());
+  }
+
+ private:
+  Definition* instruction_;
+};
+
+
+void BoxUint32Instr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  BoxMintSlowPath* slow_path = new BoxMintSlowPath(this);
+  compiler->AddSlowPathCode(slow_path);
+
+  const Register value = locs()->in(0).reg();
+  const Register out = locs()->out().reg();
+
+  Label done;
+  __ Lsl(out, value, kSmiTagSize);
+  // The value fits into a Smi if its two upper bits are clear.
+  __ tst(value, ShifterOperand(1, 3));  // 0xC0000000.
+  __ b(&done, EQ);
+  __ TryAllocate(
+      Class::ZoneHandle(Isolate::Current()->object_store()->mint_class()),
+      slow_path->entry_label(),
+      out);
+  __ Bind(slow_path->exit_label());
+  __ StoreToOffset(kWord, value, out, Mint::value_offset() - kHeapObjectTag);
+  __ LoadImmediate(IP, 0);
+  __ StoreToOffset(kWord, IP, out,
+                   Mint::value_offset() - kHeapObjectTag + kWordSize);
+  __ Bind(&done);
+}
+
+
+LocationSummary* UnboxUint32Instr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t value_cid = value()->Type()->ToCid();
+  const bool needs_temp = ((value_cid != kSmiCid) && (value_cid != kMintCid));
+  const intptr_t kNumTemps = needs_temp ? 1 : 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  if (needs_temp) summary->set_temp(0, Location::RequiresRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+void UnboxUint32Instr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const intptr_t value_cid = value()->Type()->ToCid();
+  const Register value = locs()->in(0).reg();
+  const Register out = locs()->out().reg();
+
+  if (value_cid == kSmiCid) {
+    __ Asr(out, value, kSmiTagSize);
+  } else if (value_cid == kMintCid) {
+    __ LoadFromOffset(kWord, out, value,
+                      Mint::value_offset() - kHeapObjectTag);
+  } else {
+    Register temp = locs()->temp(0).reg();
+    Label* deopt = compiler->AddDeoptStub(deopt_id_, kDeoptUnboxInteger);
+    Label done;
+    __ Asr(out, value, kSmiTagSize);
+    __ tst(value, ShifterOperand(kSmiTagMask));
+    __ b(&done, EQ);
+    __ CompareClassId(value, kMintCid, temp);
+    __ b(deopt, NE);
+    __ LoadFromOffset(kWord, out, value,
+                      Mint::value_offset() - kHeapObjectTag);
+    __ Bind(&done);
+  }
+}
+
+
+LocationSummary* UnboxedIntConverterInstr::MakeLocationSummary() const {
+  // There are no unboxed mints on ARM.
+  ASSERT((from() == kUnboxedInt32) && (to() == kUnboxedUint32));
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_out(Location::SameAsFirstInput());
+  return summary;
+}
+
+
+void UnboxedIntConverterInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  // The int32 value already is the uint32 bit pattern.
+  ASSERT(locs()->out().reg() == locs()->in(0).reg());
+}
+
+
+LocationSummary* BinaryUint32OpInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 2;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_in(1, Location::RequiresRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+void BinaryUint32OpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register left = locs()->in(0).reg();
+  const Register right = locs()->in(1).reg();
+  const Register out = locs()->out().reg();
+  switch (op_kind()) {
+    case Token::kADD: __ add(out, left, ShifterOperand(right)); break;
+    case Token::kSUB: __ sub(out, left, ShifterOperand(right)); break;
+    case Token::kMUL: __ mul(out, left, right); break;
+    case Token::kBIT_AND: __ and_(out, left, ShifterOperand(right)); break;
+    case Token::kBIT_OR: __ orr(out, left, ShifterOperand(right)); break;
+    case Token::kBIT_XOR: __ eor(out, left, ShifterOperand(right)); break;
+    default: UNREACHABLE();
+  }
+}
+
+
+LocationSummary* ShiftUint32OpInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 2;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_in(1, Location::Constant(right()->BoundConstant()));
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+void ShiftUint32OpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register left = locs()->in(0).reg();
+  const Register out = locs()->out().reg();
+  if (op_kind() == Token::kSHL) {
+    __ Lsl(out, left, shift_count());
+  } else {
+    ASSERT(op_kind() == Token::kSHR);
+    __ Lsr(out, left, shift_count());
+  }
+}
+
+
+LocationSummary* BoxInt32Instr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs,
+                          kNumTemps,
+                          LocationSummary::kCallOnSlowPath);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+void BoxInt32Instr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  BoxMintSlowPath* slow_path = new BoxMintSlowPath(this);
+  compiler->AddSlowPathCode(slow_path);
+
+  const Register value = locs()->in(0).reg();
+  const Register out = locs()->out().reg();
+
+  Label done;
+  __ Lsl(out, value, kSmiTagSize);
+  // The value fits into a Smi if tagging does not change its sign.
+  __ cmp(value, ShifterOperand(out, ASR, kSmiTagSize));
+  __ b(&done, EQ);
+  __ TryAllocate(
+      Class::ZoneHandle(Isolate::Current()->object_store()->mint_class()),
+      slow_path->entry_label(),
+      out);
+  __ Bind(slow_path->exit_label());
+  __ StoreToOffset(kWord, value, out, Mint::value_offset() - kHeapObjectTag);
+  __ Asr(IP, value, 31);  // Sign extend into the upper half.
+  __ StoreToOffset(kWord, IP, out,
+                   Mint::value_offset() - kHeapObjectTag + kWordSize);
+  __ Bind(&done);
+}
+
+
+LocationSummary* UnboxInt32Instr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+void UnboxInt32Instr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register value = locs()->in(0).reg();
+  const Register out = locs()->out().reg();
+  // Every Smi fits into 32 bits.
+  if (CanDeoptimize()) {
+    Label* deopt = compiler->AddDeoptStub(deopt_id_, kDeoptUnboxInteger);
+    __ tst(value, ShifterOperand(kSmiTagMask));
+    __ b(deopt, NE);
+  }
+  __ Asr(out, value, kSmiTagSize);
+}
+
+
+LocationSummary* BinaryInt32OpInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 2;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_in(1, Location::RequiresRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+void BinaryInt32OpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register left = locs()->in(0).reg();
+  const Register right = locs()->in(1).reg();
+  const Register out = locs()->out().reg();
+  switch (op_kind()) {
+    case Token::kADD: __ add(out, left, ShifterOperand(right)); break;
+    case Token::kSUB: __ sub(out, left, ShifterOperand(right)); break;
+    case Token::kBIT_AND: __ and_(out, left, ShifterOperand(right)); break;
+    case Token::kBIT_OR: __ orr(out, left, ShifterOperand(right)); break;
+    case Token::kBIT_XOR: __ eor(out, left, ShifterOperand(right)); break;
+    default: UNREACHABLE();
+  }
+}
+
+
 LocationSummary* ThrowInstr::MakeLocationSummary() const {
   return new LocationSummary(0, 0, LocationSummary::kCall);
 }
@@ -4596,7 +4930,8 @@ LocationSummary* AllocateObjectInstr::MakeLocationSummary() const {
 
 
 void AllocateObjectInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
-  const Code& stub = Code::Handle(StubCode::GetAllocationStubForClass(cls()));
+  const Code& stub = Code::Handle(
+      StubCode::GetAllocationStubForClass(cls(), space()));
   const ExternalLabel label(cls().ToCString(), stub.EntryPoint());
   compiler->GenerateCall(token_pos(),
                          &label,
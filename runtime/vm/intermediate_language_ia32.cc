@@ -4129,6 +4129,43 @@ void BranchInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 }
 
 
+LocationSummary* JumpTableInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 1;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_temp(0, Location::RequiresRegister());
+  return summary;
+}
+
+
+void JumpTableInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  Register value = locs()->in(0).reg();
+  Register index = locs()->temp(0).reg();
+  // The Smi value minus the lower bound is a tagged index, which is too large
+  // as unsigned if the value is below the lower bound.
+  __ movl(index, value);
+  __ subl(index, Immediate(Smi::RawValue(lower_bound())));
+  __ cmpl(index, Immediate(Smi::RawValue(length())));
+  __ j(ABOVE_EQUAL, compiler->GetJumpLabel(default_target()));
+  __ SmiUntag(index);
+  ASSERT(Assembler::kJmpFixedSize == 5);
+  __ leal(index, Address(index, index, TIMES_4, 0));
+  // Without instruction pointer relative addressing, the call pushes the
+  // address of the table as its return address, which is advanced to the
+  // entry before returning to it.
+  Label dispatch;
+  __ call(&dispatch);
+  for (intptr_t i = 0; i < length(); i++) {
+    __ JmpFixedSize(compiler->GetJumpLabel(TargetAt(i)));
+  }
+  __ Bind(&dispatch);
+  __ addl(Address(ESP, 0), index);
+  __ ret();
+}
+
+
 LocationSummary* CheckClassInstr::MakeLocationSummary() const {
   const intptr_t kNumInputs = 1;
   const intptr_t kNumTemps = 0;
@@ -4594,6 +4631,298 @@ void UnaryMintOpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 }
 
 
+LocationSummary* BoxUint32Instr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs,
+                          kNumTemps,
+                          LocationSummary::kCallOnSlowPath);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+// Allocates the Mint box of an unboxed uint32 or int32 value that does not
+// fit into a Smi.
+class BoxMintSlowPath : public SlowPathCode {
+ public:
+  explicit BoxMintSlowPath(Definition* instruction)
+      : instruction_(instruction) { }
+
+  virtual void EmitNativeCode(FlowGraphCompiler* compiler) {
+    __ Comment("BoxMintSlowPath");
+    __ Bind(entry_label());
+    const Class& mint_class =
+        Class::ZoneHandle(Isolate::Current()->object_store()->mint_class());
+    const Code& stub =
+        Code::Handle(StubCode::GetAllocationStubForClass(mint_class));
+    const ExternalLabel label(mint_class.ToCString(), stub.EntryPoint());
+
+    LocationSummary* locs = instruction_->locs();
+    locs->live_registers()->Remove(locs->out());
+
+    compiler->SaveLiveRegisters(locs);
+    compiler->GenerateCall(Scanner::kDummyTokenIndex,  // No token position.
+                           &label,
+                           PcDescriptors::kOther,
+                           locs);
+    __ MoveRegister(locs->out().reg(), EAX);
+    compiler->RestoreLiveRegisters(locs);
+
+    __ jmp(exit_label());
+  }
+
+ private:
+  Definition* instruction_;
+};
+
+
+void BoxUint32Instr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  BoxMintSlowPath* slow_path = new BoxMintSlowPath(this);
+  compiler->AddSlowPathCode(slow_path);
+
+  const Register value = locs()->in(0).reg();
+  const Register out = locs()->out().reg();
+
+  Label done;
+  __ movl(out, value);
+  __ SmiTag(out);
+  // The value fits into a Smi if its two upper bits are clear.
+  __ testl(value, Immediate(0xC0000000));
+  __ j(ZERO, &done);
+  __ TryAllocate(
+      Class::ZoneHandle(Isolate::Current()->object_store()->mint_class()),
+      slow_path->entry_label(),
+      Assembler::kFarJump,
+      out);
+  __ Bind(slow_path->exit_label());
+  __ movl(FieldAddress(out, Mint::value_offset()), value);
+  __ movl(FieldAddress(out, Mint::value_offset() + kWordSize), Immediate(0));
+  __ Bind(&done);
+}
+
+
+LocationSummary* UnboxUint32Instr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t value_cid = value()->Type()->ToCid();
+  const bool needs_temp = ((value_cid != kSmiCid) && (value_cid != kMintCid));
+  const intptr_t kNumTemps = needs_temp ? 1 : 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  if (needs_temp) summary->set_temp(0, Location::RequiresRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+void UnboxUint32Instr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const intptr_t value_cid = value()->Type()->ToCid();
+  const Register value = locs()->in(0).reg();
+  const Register out = locs()->out().reg();
+
+  if (value_cid == kSmiCid) {
+    __ movl(out, value);
+    __ SmiUntag(out);
+  } else if (value_cid == kMintCid) {
+    __ movl(out, FieldAddress(value, Mint::value_offset()));
+  } else {
+    Register temp = locs()->temp(0).reg();
+    Label* deopt = compiler->AddDeoptStub(deopt_id_, kDeoptUnboxInteger);
+    Label is_smi, done;
+    __ testl(value, Immediate(kSmiTagMask));
+    __ j(ZERO, &is_smi, Assembler::kNearJump);
+    __ CompareClassId(value, kMintCid, temp);
+    __ j(NOT_EQUAL, deopt);
+    __ movl(out, FieldAddress(value, Mint::value_offset()));
+    __ jmp(&done, Assembler::kNearJump);
+    __ Bind(&is_smi);
+    __ movl(out, value);
+    __ SmiUntag(out);
+    __ Bind(&done);
+  }
+}
+
+
+LocationSummary* UnboxedIntConverterInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  if (from() == kUnboxedInt32) {
+    summary->set_in(0, Location::RequiresRegister());
+    summary->set_out(Location::SameAsFirstInput());
+  } else if (from() == kUnboxedMint) {
+    summary->set_in(0, Location::RequiresFpuRegister());
+    summary->set_out(Location::RequiresRegister());
+  } else {
+    summary->set_in(0, Location::RequiresRegister());
+    summary->set_out(Location::RequiresFpuRegister());
+  }
+  return summary;
+}
+
+
+void UnboxedIntConverterInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  if (from() == kUnboxedInt32) {
+    // The int32 value already is the uint32 bit pattern.
+    ASSERT(locs()->out().reg() == locs()->in(0).reg());
+  } else if (from() == kUnboxedMint) {
+    // Truncate to the low 32 bits.
+    __ movd(locs()->out().reg(), locs()->in(0).fpu_reg());
+  } else {
+    // movd zero extends into the upper half of the XMM register.
+    __ movd(locs()->out().fpu_reg(), locs()->in(0).reg());
+  }
+}
+
+
+LocationSummary* BinaryUint32OpInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 2;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_in(1, Location::RequiresRegister());
+  summary->set_out(Location::SameAsFirstInput());
+  return summary;
+}
+
+
+void BinaryUint32OpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register left = locs()->in(0).reg();
+  const Register right = locs()->in(1).reg();
+  ASSERT(locs()->out().reg() == left);
+  switch (op_kind()) {
+    case Token::kADD: __ addl(left, right); break;
+    case Token::kSUB: __ subl(left, right); break;
+    case Token::kMUL: __ imull(left, right); break;
+    case Token::kBIT_AND: __ andl(left, right); break;
+    case Token::kBIT_OR: __ orl(left, right); break;
+    case Token::kBIT_XOR: __ xorl(left, right); break;
+    default: UNREACHABLE();
+  }
+}
+
+
+LocationSummary* ShiftUint32OpInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 2;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_in(1, Location::Constant(right()->BoundConstant()));
+  summary->set_out(Location::SameAsFirstInput());
+  return summary;
+}
+
+
+void ShiftUint32OpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register left = locs()->in(0).reg();
+  ASSERT(locs()->out().reg() == left);
+  const Immediate count(shift_count());
+  if (op_kind() == Token::kSHL) {
+    __ shll(left, count);
+  } else {
+    ASSERT(op_kind() == Token::kSHR);
+    __ shrl(left, count);
+  }
+}
+
+
+LocationSummary* BoxInt32Instr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 1;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs,
+                          kNumTemps,
+                          LocationSummary::kCallOnSlowPath);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_temp(0, Location::RequiresRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+void BoxInt32Instr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  BoxMintSlowPath* slow_path = new BoxMintSlowPath(this);
+  compiler->AddSlowPathCode(slow_path);
+
+  const Register value = locs()->in(0).reg();
+  const Register temp = locs()->temp(0).reg();
+  const Register out = locs()->out().reg();
+
+  Label done;
+  __ movl(out, value);
+  __ SmiTag(out);
+  __ j(NO_OVERFLOW, &done);
+  __ TryAllocate(
+      Class::ZoneHandle(Isolate::Current()->object_store()->mint_class()),
+      slow_path->entry_label(),
+      Assembler::kFarJump,
+      out);
+  __ Bind(slow_path->exit_label());
+  __ movl(FieldAddress(out, Mint::value_offset()), value);
+  __ movl(temp, value);
+  __ sarl(temp, Immediate(31));  // Sign extend into the upper half.
+  __ movl(FieldAddress(out, Mint::value_offset() + kWordSize), temp);
+  __ Bind(&done);
+}
+
+
+LocationSummary* UnboxInt32Instr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_out(Location::SameAsFirstInput());
+  return summary;
+}
+
+
+void UnboxInt32Instr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register value = locs()->in(0).reg();
+  ASSERT(locs()->out().reg() == value);
+  // Every Smi fits into 32 bits.
+  if (CanDeoptimize()) {
+    Label* deopt = compiler->AddDeoptStub(deopt_id_, kDeoptUnboxInteger);
+    __ testl(value, Immediate(kSmiTagMask));
+    __ j(NOT_ZERO, deopt);
+  }
+  __ SmiUntag(value);
+}
+
+
+LocationSummary* BinaryInt32OpInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 2;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_in(1, Location::RequiresRegister());
+  summary->set_out(Location::SameAsFirstInput());
+  return summary;
+}
+
+
+void BinaryInt32OpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register left = locs()->in(0).reg();
+  const Register right = locs()->in(1).reg();
+  ASSERT(locs()->out().reg() == left);
+  switch (op_kind()) {
+    case Token::kADD: __ addl(left, right); break;
+    case Token::kSUB: __ subl(left, right); break;
+    case Token::kBIT_AND: __ andl(left, right); break;
+    case Token::kBIT_OR: __ orl(left, right); break;
+    case Token::kBIT_XOR: __ xorl(left, right); break;
+    default: UNREACHABLE();
+  }
+}
+
+
 LocationSummary* ThrowInstr::MakeLocationSummary() const {
   return new LocationSummary(0, 0, LocationSummary::kCall);
 }
@@ -4916,7 +5245,8 @@ LocationSummary* AllocateObjectInstr::MakeLocationSummary() const {
 
 
 void AllocateObjectInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
-  const Code& stub = Code::Handle(StubCode::GetAllocationStubForClass(cls()));
+  const Code& stub = Code::Handle(
+      StubCode::GetAllocationStubForClass(cls(), space()));
   const ExternalLabel label(cls().ToCString(), stub.EntryPoint());
   compiler->GenerateCall(token_pos(),
                          &label,
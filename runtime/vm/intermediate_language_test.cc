@@ -3,10 +3,19 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "vm/intermediate_language.h"
+
+#include "vm/compiler.h"
+#include "vm/dart_api_impl.h"
+#include "vm/flow_graph.h"
+#include "vm/flow_graph_builder.h"
+#include "vm/parser.h"
+#include "vm/symbols.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
+DECLARE_FLAG(bool, use_jump_tables);
+
 TEST_CASE(InstructionTests) {
   TargetEntryInstr* target_instr =
       new TargetEntryInstr(1, CatchClauseNode::kInvalidTryIndex);
@@ -39,4 +48,313 @@ TEST_CASE(OptimizationTests) {
   EXPECT(!c3->Equals(c1));
 }
 
+
+// Masked hash computations are compiled to unboxed uint32 arithmetic. The
+// result has to match the untruncated semantics.
+TEST_CASE(Uint32ArithmeticTest) {
+  const char* script_chars =
+      "hash(list) {\n"
+      "  var h = 0;\n"
+      "  for (var i = 0; i < list.length; i++) {\n"
+      "    h = (h * 31 + list[i]) & 0xFFFFFFFF;\n"
+      "    h = h ^ (h >> 7);\n"
+      "  }\n"
+      "  return h;\n"
+      "}\n"
+      "\n"
+      "run() {\n"
+      "  var list = new List(100);\n"
+      "  for (var i = 0; i < list.length; i++) list[i] = i * 7919;\n"
+      "  var result;\n"
+      "  for (var k = 0; k < 200; k++) result = hash(list);\n"
+      "  return result;\n"
+      "}\n";
+  uint32_t expected = 0;
+  for (uint32_t i = 0; i < 100; i++) {
+    expected = expected * 31 + i * 7919;
+    expected = expected ^ (expected >> 7);
+  }
+  Dart_Handle lib = TestCase::LoadTestScript(script_chars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("run"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(static_cast<int64_t>(expected), value);
+}
+
+
+// Smi arithmetic that range analysis proves to stay within 32 bits is
+// compiled to unboxed int32 arithmetic. Deoptimizing inside the loop has to
+// materialize the unboxed values.
+TEST_CASE(Int32ArithmeticTest) {
+  const char* script_chars =
+      "class A { f(x) => x; }\n"
+      "class B { f(x) => 2 * x; }\n"
+      "\n"
+      "sum(list, objects) {\n"
+      "  var s = 0;\n"
+      "  for (var i = 0; i < list.length; i++) {\n"
+      "    var d = (list[i] & 0xFF) - 128;\n"
+      "    s += objects[i].f(d + (i & 0xF));\n"
+      "  }\n"
+      "  return s;\n"
+      "}\n"
+      "\n"
+      "newList(n) {\n"
+      "  var list = new List(n);\n"
+      "  for (var i = 0; i < list.length; i++) list[i] = i * 7919;\n"
+      "  return list;\n"
+      "}\n"
+      "\n"
+      "run() {\n"
+      "  var list = newList(100);\n"
+      "  var objects = new List.filled(100, new A());\n"
+      "  var result;\n"
+      "  for (var k = 0; k < 200; k++) result = sum(list, objects);\n"
+      "  return result;\n"
+      "}\n"
+      "\n"
+      "deopt() {\n"
+      "  var objects = new List.filled(3, new A());\n"
+      "  objects[2] = new B();\n"
+      "  return sum(newList(3), objects);\n"
+      "}\n";
+  int64_t expected = 0;
+  for (int64_t i = 0; i < 100; i++) {
+    expected += ((i * 7919) & 0xFF) - 128 + (i & 0xF);
+  }
+  Dart_Handle lib = TestCase::LoadTestScript(script_chars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("run"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(expected, value);
+
+  // The last call deoptimizes with its unboxed argument on the stack.
+  expected = 0;
+  for (int64_t i = 0; i < 3; i++) {
+    expected += ((i < 2) ? 1 : 2) * (((i * 7919) & 0xFF) - 128 + (i & 0xF));
+  }
+  result = Dart_Invoke(lib, NewString("deopt"), 0, NULL);
+  EXPECT_VALID(result);
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(expected, value);
+}
+
+
+// The bounds check in sum() is replaced with checks of start and end in the
+// loop pre-header. Out of range accesses must still throw after the function
+// is optimized, and empty loops at the end of the list must not.
+TEST_CASE(HoistedBoundsCheckTest) {
+  const char* script_chars =
+      "sum(list, start, end) {\n"
+      "  var s = 0;\n"
+      "  for (var i = start; i < end; i++) s += list[i];\n"
+      "  return s;\n"
+      "}\n"
+      "\n"
+      "run() {\n"
+      "  var list = new List(100);\n"
+      "  for (var i = 0; i < list.length; i++) list[i] = i;\n"
+      "  var result = 0;\n"
+      "  for (var k = 0; k < 200; k++) {\n"
+      "    result += sum(list, k % 10, 100 - k % 10);\n"
+      "    result += sum(list, 100, 100);\n"
+      "  }\n"
+      "  try {\n"
+      "    sum(list, 90, 101);\n"
+      "  } on RangeError catch (e) {\n"
+      "    result = -result;\n"
+      "  }\n"
+      "  return result;\n"
+      "}\n";
+  int64_t expected = 0;
+  for (intptr_t k = 0; k < 200; k++) {
+    for (intptr_t i = k % 10; i < 100 - k % 10; i++) expected += i;
+  }
+  Dart_Handle lib = TestCase::LoadTestScript(script_chars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("run"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(-expected, value);
+}
+
+
+TEST_CASE(NestedAllocationSinkingTest) {
+  // The closure is stored into a Holder that does not escape. Both
+  // allocations are sunk and materialized together when 'y + 1' deoptimizes.
+  const char* script_chars =
+      "class Holder {\n"
+      "  final f;\n"
+      "  Holder(this.f);\n"
+      "}\n"
+      "\n"
+      "apply(x, y) {\n"
+      "  var h = new Holder(() => x + 1);\n"
+      "  var r = y + 1;\n"
+      "  var g = h.f;\n"
+      "  return g() + r;\n"
+      "}\n"
+      "\n"
+      "run() {\n"
+      "  var result = 0;\n"
+      "  for (var i = 0; i < 20000; i++) result += apply(i, i);\n"
+      "  result += apply(1, 1.5).toInt();\n"
+      "  return result;\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(script_chars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("run"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(400020004, value);
+}
+
+
+TEST_CASE(SmiSwitchDispatchTest) {
+  const char* script_chars =
+      "classify(x) {\n"
+      "  switch (x) {\n"
+      "    case -5: return 1;\n"
+      "    case 0: return 2;\n"
+      "    case 3: return 3;\n"
+      "    case 7:\n"
+      "    case 8: return 4;\n"
+      "    case 100: return 5;\n"
+      "    case 1000: return 6;\n"
+      "    default: return 7;\n"
+      "  }\n"
+      "}\n"
+      "\n"
+      "count(x) {\n"
+      "  var n = 0;\n"
+      "  switch (x) {\n"
+      "    case 1: n = 10; break;\n"
+      "    case 2: n = 20; break;\n"
+      "    case 3: n = 30; break;\n"
+      "    case 4: n = 40; break;\n"
+      "    case 5: n = 50; break;\n"
+      "    case 6: n = 60; break;\n"
+      "  }\n"
+      "  return n;\n"
+      "}\n"
+      "\n"
+      "run() {\n"
+      "  var result = 0;\n"
+      "  for (var k = 0; k < 100; k++) {\n"
+      "    result += classify(-5) + classify(0) + classify(3) + classify(7);\n"
+      "    result += classify(8) + classify(100) + classify(1000);\n"
+      "    result += classify(-6) + classify(4) + classify(1001);\n"
+      "    result += classify('3') + classify(null);\n"
+      "    for (var i = 0; i < 8; i++) result += count(i);\n"
+      "  }\n"
+      "  return result;\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(script_chars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("run"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(100 * (1 + 2 + 3 + 4 + 4 + 5 + 6 + 7 + 7 + 7 + 7 + 7 + 210),
+            value);
+}
+
+static const Function& LookupFunction(Dart_Handle lib, const char* name) {
+  Library& library = Library::Handle();
+  library ^= Api::UnwrapHandle(lib);
+  const Function& function = Function::ZoneHandle(
+      library.LookupLocalFunction(String::Handle(Symbols::New(name))));
+  EXPECT(!function.IsNull());
+  return function;
+}
+
+
+// Counts the jump tables in the graph of the already executed function.
+static intptr_t CountJumpTables(const Function& function) {
+  ParsedFunction* parsed_function = new ParsedFunction(function);
+  Parser::ParseFunction(parsed_function);
+  parsed_function->AllocateVariables();
+  const Code& unoptimized_code = Code::Handle(function.unoptimized_code());
+  const Array& ic_data_array =
+      Array::Handle(unoptimized_code.ExtractTypeFeedbackArray());
+  Isolate::Current()->set_deopt_id(0);
+  FlowGraphBuilder builder(parsed_function,
+                           ic_data_array,
+                           NULL,  // NULL = not inlining.
+                           Isolate::kNoDeoptId);
+  FlowGraph* flow_graph = builder.BuildGraph();
+  intptr_t count = 0;
+  for (BlockIterator it = flow_graph->reverse_postorder_iterator();
+       !it.Done();
+       it.Advance()) {
+    if (it.Current()->last_instruction()->IsJumpTable()) count++;
+  }
+  return count;
+}
+
+
+TEST_CASE(SmiSwitchJumpTableTest) {
+  const char* script_chars =
+      "dense(x) {\n"
+      "  switch (x) {\n"
+      "    case 1: return 10;\n"
+      "    case 2: return 20;\n"
+      "    case 3: return 30;\n"
+      "    case 5:\n"
+      "    case 6: return 50;\n"
+      "    case 7: return 70;\n"
+      "    default: return 0;\n"
+      "  }\n"
+      "}\n"
+      "\n"
+      "sparse(x) {\n"
+      "  switch (x) {\n"
+      "    case 1: return 1;\n"
+      "    case 10: return 2;\n"
+      "    case 100: return 3;\n"
+      "    case 1000: return 4;\n"
+      "    case 10000: return 5;\n"
+      "    case 100000: return 6;\n"
+      "  }\n"
+      "  return 7;\n"
+      "}\n"
+      "\n"
+      "run() {\n"
+      "  var result = 0;\n"
+      "  for (var i = -2; i < 10; i++) result += dense(i);\n"
+      "  result += dense(1 << 40) + dense(-(1 << 40));\n"
+      "  result += dense('3') + dense(null);\n"
+      "  for (var x in [1, 10, 100, 1000, 10000, 100000, 2, -1]) {\n"
+      "    result += sparse(x);\n"
+      "  }\n"
+      "  return result;\n"
+      "}\n";
+  const int64_t kExpected = (10 + 20 + 30 + 50 + 50 + 70) +
+                            (1 + 2 + 3 + 4 + 5 + 6 + 7 + 7);
+  Dart_Handle lib = TestCase::LoadTestScript(script_chars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("run"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(kExpected, value);
+
+  // Only the dense switch is dispatched through a jump table.
+  const Function& dense = LookupFunction(lib, "dense");
+  const Function& sparse = LookupFunction(lib, "sparse");
+  EXPECT_EQ(1, CountJumpTables(dense));
+  EXPECT_EQ(0, CountJumpTables(sparse));
+  const bool saved_use_jump_tables = FLAG_use_jump_tables;
+  FLAG_use_jump_tables = false;
+  EXPECT_EQ(0, CountJumpTables(dense));
+  FLAG_use_jump_tables = saved_use_jump_tables;
+
+  EXPECT(Error::Handle(Compiler::CompileOptimizedFunction(dense)).IsNull());
+  EXPECT(Error::Handle(Compiler::CompileOptimizedFunction(sparse)).IsNull());
+  result = Dart_Invoke(lib, NewString("run"), 0, NULL);
+  EXPECT_VALID(result);
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(kExpected, value);
+}
+
 }  // namespace dart
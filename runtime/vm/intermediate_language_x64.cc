@@ -1484,8 +1484,136 @@ void GuardFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 }
 
 
+// Allocates a box for an unboxed field: the copy returned by LoadField or
+// the first box of an instance stored by StoreInstanceField.
+class BoxAllocationSlowPath : public SlowPathCode {
+ public:
+  BoxAllocationSlowPath(Instruction* instruction,
+                        const Class& cls,
+                        Register result)
+      : instruction_(instruction), cls_(cls), result_(result) { }
+
+  virtual void EmitNativeCode(FlowGraphCompiler* compiler) {
+    __ Comment("BoxAllocationSlowPath");
+    __ Bind(entry_label());
+    const Code& stub =
+        Code::Handle(StubCode::GetAllocationStubForClass(cls_));
+    const ExternalLabel label(cls_.ToCString(), stub.EntryPoint());
+
+    LocationSummary* locs = instruction_->locs();
+    locs->live_registers()->Remove(Location::RegisterLocation(result_));
+
+    compiler->SaveLiveRegisters(locs);
+    compiler->GenerateCall(Scanner::kDummyTokenIndex,  // No token position.
+                           &label,
+                           PcDescriptors::kOther,
+                           locs);
+    __ MoveRegister(result_, RAX);
+    compiler->RestoreLiveRegisters(locs);
+
+    __ jmp(exit_label());
+  }
+
+ private:
+  Instruction* instruction_;
+  const Class& cls_;
+  const Register result_;
+};
+
+
+// Inputs of field accesses are still needed after the box allocation slow
+// path. The non-optimizing compiler does not compute live registers and the
+// register allocator does not record copies made for writable inputs.
+static void PreserveInputsAcrossSlowPath(LocationSummary* locs) {
+  for (intptr_t i = 0; i < locs->input_count(); i++) {
+    locs->live_registers()->Add(locs->in(i));
+  }
+}
+
+
+// Branches to is_double or is_float32x4 if the field is currently unboxed,
+// falls through otherwise.
+static void BranchIfUnboxedField(FlowGraphCompiler* compiler,
+                                 const Field& field,
+                                 Register temp,
+                                 Label* is_double,
+                                 Label* is_float32x4) {
+  Label is_boxed;
+  __ LoadObject(temp, Field::ZoneHandle(field.raw()), PP);
+  __ CompareImmediate(FieldAddress(temp, Field::is_nullable_offset()),
+                      Immediate(kNullCid), PP);
+  __ j(EQUAL, &is_boxed, Assembler::kNearJump);
+  __ movq(temp, FieldAddress(temp, Field::guarded_cid_offset()));
+  __ CompareImmediate(temp, Immediate(kDoubleCid), PP);
+  __ j(EQUAL, is_double);
+  __ CompareImmediate(temp, Immediate(kFloat32x4Cid), PP);
+  __ j(EQUAL, is_float32x4);
+  __ Bind(&is_boxed);
+}
+
+
+static void CopyBoxPayload(FlowGraphCompiler* compiler,
+                           Register dst,
+                           Register src,
+                           intptr_t value_offset,
+                           intptr_t value_size) {
+  for (intptr_t i = 0; i < value_size; i += kWordSize) {
+    __ movq(TMP, FieldAddress(src, value_offset + i));
+    __ movq(FieldAddress(dst, value_offset + i), TMP);
+  }
+}
+
+
+// Loads the box of the unboxed field at the given offset into box_reg,
+// allocating and storing a new box if the instance does not have one yet.
+static void LoadOrAllocateBox(FlowGraphCompiler* compiler,
+                              StoreInstanceFieldInstr* instruction,
+                              const Class& cls,
+                              Register instance_reg,
+                              intptr_t offset,
+                              Register box_reg) {
+  Label done;
+  __ movq(box_reg, FieldAddress(instance_reg, offset));
+  __ CompareObject(box_reg, Object::null_object(), PP);
+  __ j(NOT_EQUAL, &done);
+
+  BoxAllocationSlowPath* slow_path =
+      new BoxAllocationSlowPath(instruction, cls, box_reg);
+  compiler->AddSlowPathCode(slow_path);
+  __ TryAllocate(cls,
+                 slow_path->entry_label(),
+                 Assembler::kFarJump,
+                 box_reg,
+                 PP);
+  __ Bind(slow_path->exit_label());
+  // The store barrier clobbers the value register, reload the box.
+  __ StoreIntoObject(instance_reg,
+                     FieldAddress(instance_reg, offset),
+                     box_reg,
+                     false);  // The box is never a smi.
+  __ movq(box_reg, FieldAddress(instance_reg, offset));
+  __ Bind(&done);
+}
+
+
 LocationSummary* StoreInstanceFieldInstr::MakeLocationSummary() const {
   const intptr_t kNumInputs = 2;
+  if (IsUnboxedStore() || IsPotentialUnboxedStore()) {
+    const intptr_t kNumTemps = 1;
+    LocationSummary* summary =
+        new LocationSummary(kNumInputs, kNumTemps,
+                            LocationSummary::kCallOnSlowPath);
+    summary->set_in(0, Location::RequiresRegister());
+    if (IsUnboxedStore()) {
+      summary->set_in(1, Location::RequiresFpuRegister());
+    } else {
+      summary->set_in(1, ShouldEmitStoreBarrier()
+                           ? Location::WritableRegister()
+                           : Location::RequiresRegister());
+    }
+    summary->set_temp(0, Location::RequiresRegister());
+    return summary;
+  }
   const intptr_t kNumTemps = 0;
   LocationSummary* summary =
       new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
@@ -1499,6 +1627,52 @@ LocationSummary* StoreInstanceFieldInstr::MakeLocationSummary() const {
 
 void StoreInstanceFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   Register instance_reg = locs()->in(0).reg();
+
+  if (IsUnboxedStore()) {
+    XmmRegister value = locs()->in(1).fpu_reg();
+    Register box_reg = locs()->temp(0).reg();
+    PreserveInputsAcrossSlowPath(locs());
+    if (RequiredInputRepresentation(kValuePos) == kUnboxedDouble) {
+      LoadOrAllocateBox(compiler, this, compiler->double_class(),
+                        instance_reg, field().Offset(), box_reg);
+      __ movsd(FieldAddress(box_reg, Double::value_offset()), value);
+    } else {
+      ASSERT(RequiredInputRepresentation(kValuePos) == kUnboxedFloat32x4);
+      LoadOrAllocateBox(compiler, this, compiler->float32x4_class(),
+                        instance_reg, field().Offset(), box_reg);
+      __ movups(FieldAddress(box_reg, Float32x4::value_offset()), value);
+    }
+    return;
+  }
+
+  Label done;
+  if (IsPotentialUnboxedStore()) {
+    Register value_reg = locs()->in(1).reg();
+    Register box_reg = locs()->temp(0).reg();
+    Label store_pointer, store_double, store_float32x4;
+    BranchIfUnboxedField(compiler, field(), box_reg,
+                         &store_double, &store_float32x4);
+    __ jmp(&store_pointer);
+
+    PreserveInputsAcrossSlowPath(locs());
+
+    __ Bind(&store_double);
+    LoadOrAllocateBox(compiler, this, compiler->double_class(),
+                      instance_reg, field().Offset(), box_reg);
+    CopyBoxPayload(compiler, box_reg, value_reg,
+                   Double::value_offset(), kDoubleSize);
+    __ jmp(&done);
+
+    __ Bind(&store_float32x4);
+    LoadOrAllocateBox(compiler, this, compiler->float32x4_class(),
+                      instance_reg, field().Offset(), box_reg);
+    CopyBoxPayload(compiler, box_reg, value_reg,
+                   Float32x4::value_offset(), kSimd128Size);
+    __ jmp(&done);
+
+    __ Bind(&store_pointer);
+  }
+
   if (ShouldEmitStoreBarrier()) {
     Register value_reg = locs()->in(1).reg();
     __ StoreIntoObject(instance_reg,
@@ -1515,6 +1689,7 @@ void StoreInstanceFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
           FieldAddress(instance_reg, field().Offset()), value_reg);
     }
   }
+  __ Bind(&done);
 }
 
 
@@ -1635,17 +1810,97 @@ void AllocateObjectWithBoundsCheckInstr::EmitNativeCode(
 
 
 LocationSummary* LoadFieldInstr::MakeLocationSummary() const {
-  return LocationSummary::Make(1,
+  const intptr_t kNumInputs = 1;
+  if (IsUnboxedLoad()) {
+    const intptr_t kNumTemps = 1;
+    LocationSummary* locs =
+        new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+    locs->set_in(0, Location::RequiresRegister());
+    locs->set_temp(0, Location::RequiresRegister());
+    locs->set_out(Location::RequiresFpuRegister());
+    return locs;
+  }
+  if (IsPotentialUnboxedLoad()) {
+    const intptr_t kNumTemps = 1;
+    LocationSummary* locs =
+        new LocationSummary(kNumInputs, kNumTemps,
+                            LocationSummary::kCallOnSlowPath);
+    locs->set_in(0, Location::RequiresRegister());
+    locs->set_temp(0, Location::RequiresRegister());
+    locs->set_out(Location::RequiresRegister());
+    return locs;
+  }
+  return LocationSummary::Make(kNumInputs,
                                Location::RequiresRegister(),
                                LocationSummary::kNoCall);
 }
 
 
+// Replaces the box in result_reg by a copy of it.
+static void CopyBox(FlowGraphCompiler* compiler,
+                    LoadFieldInstr* instruction,
+                    const Class& cls,
+                    intptr_t value_offset,
+                    intptr_t value_size,
+                    Register instance_reg,
+                    Register result_reg,
+                    Register box_reg) {
+  BoxAllocationSlowPath* slow_path =
+      new BoxAllocationSlowPath(instruction, cls, result_reg);
+  compiler->AddSlowPathCode(slow_path);
+  __ TryAllocate(cls,
+                 slow_path->entry_label(),
+                 Assembler::kFarJump,
+                 result_reg,
+                 PP);
+  __ Bind(slow_path->exit_label());
+  __ movq(box_reg, FieldAddress(instance_reg, instruction->offset_in_bytes()));
+  CopyBoxPayload(compiler, result_reg, box_reg, value_offset, value_size);
+}
+
+
 void LoadFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   Register instance_reg = locs()->in(0).reg();
-  Register result_reg = locs()->out().reg();
 
+  if (IsUnboxedLoad()) {
+    XmmRegister result = locs()->out().fpu_reg();
+    Register box_reg = locs()->temp(0).reg();
+    __ movq(box_reg, FieldAddress(instance_reg, offset_in_bytes()));
+    if (representation() == kUnboxedDouble) {
+      __ movsd(result, FieldAddress(box_reg, Double::value_offset()));
+    } else {
+      ASSERT(representation() == kUnboxedFloat32x4);
+      __ movups(result, FieldAddress(box_reg, Float32x4::value_offset()));
+    }
+    return;
+  }
+
+  Register result_reg = locs()->out().reg();
   __ movq(result_reg, FieldAddress(instance_reg, offset_in_bytes()));
+
+  if (IsPotentialUnboxedLoad()) {
+    Register box_reg = locs()->temp(0).reg();
+    Label done, load_double, load_float32x4;
+    __ CompareObject(result_reg, Object::null_object(), PP);
+    __ j(EQUAL, &done);
+    BranchIfUnboxedField(compiler, *field(), box_reg,
+                         &load_double, &load_float32x4);
+    __ jmp(&done);
+
+    PreserveInputsAcrossSlowPath(locs());
+
+    __ Bind(&load_double);
+    CopyBox(compiler, this, compiler->double_class(),
+            Double::value_offset(), kDoubleSize,
+            instance_reg, result_reg, box_reg);
+    __ jmp(&done);
+
+    __ Bind(&load_float32x4);
+    CopyBox(compiler, this, compiler->float32x4_class(),
+            Float32x4::value_offset(), kSimd128Size,
+            instance_reg, result_reg, box_reg);
+    __ Bind(&done);
+  }
 }
 
 
@@ -4196,6 +4451,40 @@ void BranchInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 }
 
 
+LocationSummary* JumpTableInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 1;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_temp(0, Location::RequiresRegister());
+  return summary;
+}
+
+
+void JumpTableInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  Register value = locs()->in(0).reg();
+  Register index = locs()->temp(0).reg();
+  // The Smi value minus the lower bound is a tagged index, which is too large
+  // as unsigned if the value is below the lower bound.
+  __ movq(index, value);
+  __ AddImmediate(index, Immediate(-Smi::RawValue(lower_bound())), PP);
+  __ cmpq(index, Immediate(Smi::RawValue(length())));
+  __ j(ABOVE_EQUAL, compiler->GetJumpLabel(default_target()));
+  __ SmiUntag(index);
+  ASSERT(Assembler::kJmpFixedSize == 5);
+  __ leaq(index, Address(index, index, TIMES_4, 0));
+  Label table;
+  __ leaq(TMP, &table);
+  __ addq(TMP, index);
+  __ jmp(TMP);
+  __ Bind(&table);
+  for (intptr_t i = 0; i < length(); i++) {
+    __ JmpFixedSize(compiler->GetJumpLabel(TargetAt(i)));
+  }
+}
+
+
 LocationSummary* CheckClassInstr::MakeLocationSummary() const {
   const intptr_t kNumInputs = 1;
   const intptr_t kNumTemps = 0;
@@ -4384,6 +4673,217 @@ void ShiftMintOpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 }
 
 
+LocationSummary* BoxUint32Instr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+void BoxUint32Instr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register value = locs()->in(0).reg();
+  const Register out = locs()->out().reg();
+  // Every uint32 value fits into a Smi.
+  __ movl(out, value);
+  __ SmiTag(out);
+}
+
+
+LocationSummary* UnboxUint32Instr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+void UnboxUint32Instr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const intptr_t value_cid = value()->Type()->ToCid();
+  const Register value = locs()->in(0).reg();
+  const Register out = locs()->out().reg();
+
+  if (value_cid == kSmiCid) {
+    __ movq(out, value);
+    __ SmiUntag(out);
+    __ movl(out, out);  // Zero extend the low 32 bits.
+  } else if (value_cid == kMintCid) {
+    __ movl(out, FieldAddress(value, Mint::value_offset()));
+  } else {
+    Label* deopt = compiler->AddDeoptStub(deopt_id_, kDeoptUnboxInteger);
+    Label is_smi, done;
+    __ testq(value, Immediate(kSmiTagMask));
+    __ j(ZERO, &is_smi, Assembler::kNearJump);
+    __ CompareClassId(value, kMintCid);
+    __ j(NOT_EQUAL, deopt);
+    __ movl(out, FieldAddress(value, Mint::value_offset()));
+    __ jmp(&done, Assembler::kNearJump);
+    __ Bind(&is_smi);
+    __ movq(out, value);
+    __ SmiUntag(out);
+    __ movl(out, out);  // Zero extend the low 32 bits.
+    __ Bind(&done);
+  }
+}
+
+
+LocationSummary* UnboxedIntConverterInstr::MakeLocationSummary() const {
+  // There are no unboxed mints on x64.
+  ASSERT((from() == kUnboxedInt32) && (to() == kUnboxedUint32));
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_out(Location::SameAsFirstInput());
+  return summary;
+}
+
+
+void UnboxedIntConverterInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  // The low 32 bits of the int32 value already are the uint32 bit pattern.
+  ASSERT(locs()->out().reg() == locs()->in(0).reg());
+}
+
+
+LocationSummary* BinaryUint32OpInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 2;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_in(1, Location::RequiresRegister());
+  summary->set_out(Location::SameAsFirstInput());
+  return summary;
+}
+
+
+void BinaryUint32OpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register left = locs()->in(0).reg();
+  const Register right = locs()->in(1).reg();
+  ASSERT(locs()->out().reg() == left);
+  // 32-bit operations zero extend their result into the upper half of the
+  // register.
+  switch (op_kind()) {
+    case Token::kADD: __ addl(left, right); break;
+    case Token::kSUB: __ subl(left, right); break;
+    case Token::kMUL: __ imull(left, right); break;
+    case Token::kBIT_AND: __ andl(left, right); break;
+    case Token::kBIT_OR: __ orl(left, right); break;
+    case Token::kBIT_XOR: __ xorl(left, right); break;
+    default: UNREACHABLE();
+  }
+}
+
+
+LocationSummary* ShiftUint32OpInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 2;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_in(1, Location::Constant(right()->BoundConstant()));
+  summary->set_out(Location::SameAsFirstInput());
+  return summary;
+}
+
+
+void ShiftUint32OpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register left = locs()->in(0).reg();
+  ASSERT(locs()->out().reg() == left);
+  const Immediate count(shift_count());
+  if (op_kind() == Token::kSHL) {
+    __ shll(left, count);
+  } else {
+    ASSERT(op_kind() == Token::kSHR);
+    __ shrl(left, count);
+  }
+}
+
+
+LocationSummary* BoxInt32Instr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+void BoxInt32Instr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register value = locs()->in(0).reg();
+  const Register out = locs()->out().reg();
+  // Every int32 value fits into a Smi.
+  __ movsxd(out, value);
+  __ SmiTag(out);
+}
+
+
+LocationSummary* UnboxInt32Instr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_out(Location::SameAsFirstInput());
+  return summary;
+}
+
+
+void UnboxInt32Instr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register value = locs()->in(0).reg();
+  ASSERT(locs()->out().reg() == value);
+  if (!CanDeoptimize()) {
+    __ SmiUntag(value);
+    return;
+  }
+  Label* deopt = compiler->AddDeoptStub(deopt_id_, kDeoptUnboxInteger);
+  __ testq(value, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, deopt);
+  __ SmiUntag(value);
+  // Deoptimize if the value does not fit into 32 bits.
+  __ movsxd(TMP, value);
+  __ cmpq(TMP, value);
+  __ j(NOT_EQUAL, deopt);
+}
+
+
+LocationSummary* BinaryInt32OpInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 2;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_in(1, Location::RequiresRegister());
+  summary->set_out(Location::SameAsFirstInput());
+  return summary;
+}
+
+
+void BinaryInt32OpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const Register left = locs()->in(0).reg();
+  const Register right = locs()->in(1).reg();
+  ASSERT(locs()->out().reg() == left);
+  // Only the low 32 bits of an unboxed int32 value are significant.
+  switch (op_kind()) {
+    case Token::kADD: __ addl(left, right); break;
+    case Token::kSUB: __ subl(left, right); break;
+    case Token::kBIT_AND: __ andl(left, right); break;
+    case Token::kBIT_OR: __ orl(left, right); break;
+    case Token::kBIT_XOR: __ xorl(left, right); break;
+    default: UNREACHABLE();
+  }
+}
+
+
 LocationSummary* ThrowInstr::MakeLocationSummary() const {
   return new LocationSummary(0, 0, LocationSummary::kCall);
 }
@@ -4643,7 +5143,8 @@ LocationSummary* AllocateObjectInstr::MakeLocationSummary() const {
 
 
 void AllocateObjectInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
-  const Code& stub = Code::Handle(StubCode::GetAllocationStubForClass(cls()));
+  const Code& stub = Code::Handle(
+      StubCode::GetAllocationStubForClass(cls(), space()));
   const ExternalLabel label(cls().ToCString(), stub.EntryPoint());
   compiler->GenerateCall(token_pos(),
                          &label,
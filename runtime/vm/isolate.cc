@@ -306,6 +306,7 @@ Isolate::Isolate()
       gc_epilogue_callbacks_(),
       defer_finalization_count_(0),
       deopt_context_(NULL),
+      deopt_reason_counts_(new intptr_t[kDeoptNumReasons]),
       stacktrace_(NULL),
       stack_frame_index_(-1),
       object_histogram_(NULL),
@@ -313,6 +314,9 @@ Isolate::Isolate()
       profiler_data_(NULL),
       REUSABLE_HANDLE_LIST(REUSABLE_HANDLE_INITIALIZERS)
       reusable_handles_() {
+  for (intptr_t i = 0; i < kDeoptNumReasons; i++) {
+    deopt_reason_counts_[i] = 0;
+  }
   if (FLAG_print_object_histogram && (Dart::vm_isolate() != NULL)) {
     object_histogram_ = new ObjectHistogram(this);
   }
@@ -335,6 +339,7 @@ Isolate::~Isolate() {
   delete message_handler_;
   message_handler_ = NULL;  // Fail fast if we send messages to a dead isolate.
   ASSERT(deopt_context_ == NULL);  // No deopt in progress when isolate deleted.
+  delete [] deopt_reason_counts_;
   delete object_histogram_;
 }
 
@@ -350,17 +355,27 @@ void Isolate::SetCurrent(Isolate* current) {
 }
 
 
+void Isolate::SetCurrentHelper(Isolate* isolate) {
+  Thread::SetThreadLocal(isolate_key, reinterpret_cast<uword>(isolate));
+  Thread::SetThreadLocal(helper_key, (isolate != NULL) ? 1 : 0);
+}
+
+
 // The single thread local key which stores all the thread local data
 // for a thread. Since an Isolate is the central repository for
 // storing all isolate specific information a single thread local key
 // is sufficient.
 ThreadLocalKey Isolate::isolate_key = Thread::kUnsetThreadLocalKey;
+ThreadLocalKey Isolate::helper_key = Thread::kUnsetThreadLocalKey;
 
 
 void Isolate::InitOnce() {
   ASSERT(isolate_key == Thread::kUnsetThreadLocalKey);
   isolate_key = Thread::CreateThreadLocal();
   ASSERT(isolate_key != Thread::kUnsetThreadLocalKey);
+  ASSERT(helper_key == Thread::kUnsetThreadLocalKey);
+  helper_key = Thread::CreateThreadLocal();
+  ASSERT(helper_key != Thread::kUnsetThreadLocalKey);
   create_callback_ = NULL;
 }
 
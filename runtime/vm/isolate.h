@@ -84,6 +84,17 @@ class Isolate : public BaseIsolate {
 
   static void SetCurrent(Isolate* isolate);
 
+  // Makes 'isolate' the current isolate of a helper thread that works on the
+  // isolate's heap on behalf of the mutator, e.g. a parallel scavenger task.
+  // Unlike SetCurrent this does not schedule the thread with the profiler.
+  static void SetCurrentHelper(Isolate* isolate);
+
+  // Returns true on a helper thread set up by SetCurrentHelper. Helpers share
+  // the isolate with the mutator, but not its stack resources.
+  static bool IsCurrentHelper() {
+    return Thread::GetThreadLocal(helper_key) != 0;
+  }
+
   static void InitOnce();
   static Isolate* Init(const char* name_prefix);
   void Shutdown();
@@ -217,12 +228,14 @@ class Isolate : public BaseIsolate {
     kMessageInterrupt = 0x2,  // An interrupt to process an out of band message.
     kStoreBufferInterrupt = 0x4,  // An interrupt to process the store buffer.
     kVmStatusInterrupt = 0x8,     // An interrupt to process a status request.
+    kPretenureInterrupt = 0x10,   // An interrupt to withdraw pretenuring.
 
     kInterruptsMask =
         kApiInterrupt |
         kMessageInterrupt |
         kStoreBufferInterrupt |
-        kVmStatusInterrupt,
+        kVmStatusInterrupt |
+        kPretenureInterrupt,
   };
 
   void ScheduleInterrupts(uword interrupt_bits);
@@ -371,6 +384,9 @@ class Isolate : public BaseIsolate {
     deopt_context_ = value;
   }
 
+  // Number of deoptimizations in this isolate, indexed by DeoptReasonId.
+  intptr_t* deopt_reason_counts() const { return deopt_reason_counts_; }
+
   static char* GetStatus(const char* request);
 
   intptr_t BlockClassFinalization() {
@@ -415,6 +431,7 @@ class Isolate : public BaseIsolate {
   template<class T> T* AllocateReusableHandle();
 
   static ThreadLocalKey isolate_key;
+  static ThreadLocalKey helper_key;
 
   StoreBuffer store_buffer_;
   ClassTable class_table_;
@@ -449,6 +466,7 @@ class Isolate : public BaseIsolate {
   GcEpilogueCallbacks gc_epilogue_callbacks_;
   intptr_t defer_finalization_count_;
   DeoptContext* deopt_context_;
+  intptr_t* deopt_reason_counts_;
 
   // Status support.
   char* stacktrace_;
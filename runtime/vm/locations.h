@@ -21,6 +21,8 @@ enum Representation {
   kUntagged,
   kUnboxedDouble,
   kUnboxedMint,
+  kUnboxedUint32,
+  kUnboxedInt32,
   kUnboxedFloat32x4,
   kUnboxedInt32x4,
   kNumRepresentations
@@ -338,15 +340,21 @@ class Location : public ValueObject {
 
 class RegisterSet : public ValueObject {
  public:
-  RegisterSet() : cpu_registers_(0), fpu_registers_(0) {
+  RegisterSet()
+      : cpu_registers_(0), untagged_cpu_registers_(0), fpu_registers_(0) {
     ASSERT(kNumberOfCpuRegisters <= (kWordSize * kBitsPerByte));
     ASSERT(kNumberOfFpuRegisters <= (kWordSize * kBitsPerByte));
   }
 
 
-  void Add(Location loc) {
+  // CPU registers holding values of a representation other than kTagged
+  // (e.g. unboxed uint32 values) are not reported to the GC as objects.
+  void Add(Location loc, Representation rep = kTagged) {
     if (loc.IsRegister()) {
       cpu_registers_ |= (1 << loc.reg());
+      if (rep != kTagged) {
+        untagged_cpu_registers_ |= (1 << loc.reg());
+      }
     } else if (loc.IsFpuRegister()) {
       fpu_registers_ |= (1 << loc.fpu_reg());
     }
@@ -355,6 +363,7 @@ class RegisterSet : public ValueObject {
   void Remove(Location loc) {
     if (loc.IsRegister()) {
       cpu_registers_ &= ~(1 << loc.reg());
+      untagged_cpu_registers_ &= ~(1 << loc.reg());
     } else if (loc.IsFpuRegister()) {
       fpu_registers_ &= ~(1 << loc.fpu_reg());
     }
@@ -364,6 +373,10 @@ class RegisterSet : public ValueObject {
     return (cpu_registers_ & (1 << reg)) != 0;
   }
 
+  bool IsTagged(Register reg) const {
+    return (untagged_cpu_registers_ & (1 << reg)) == 0;
+  }
+
   bool ContainsFpuRegister(FpuRegister fpu_reg) const {
     return (fpu_registers_ & (1 << fpu_reg)) != 0;
   }
@@ -378,6 +391,7 @@ class RegisterSet : public ValueObject {
 
  private:
   intptr_t cpu_registers_;
+  intptr_t untagged_cpu_registers_;
   intptr_t fpu_registers_;
 
   DISALLOW_COPY_AND_ASSIGN(RegisterSet);
@@ -5,7 +5,9 @@
 #include "vm/megamorphic_cache_table.h"
 
 #include <stdlib.h>
+#include "vm/dart_entry.h"
 #include "vm/object.h"
+#include "vm/resolver.h"
 #include "vm/stub_code.h"
 #include "vm/symbols.h"
 
@@ -16,21 +18,36 @@ MegamorphicCacheTable::MegamorphicCacheTable()
       miss_handler_code_(NULL),
       capacity_(0),
       length_(0),
-      table_(NULL) {
+      table_(NULL),
+      index_capacity_(0),
+      index_(NULL),
+      dispatch_table_(NULL) {
 }
 
 
 MegamorphicCacheTable::~MegamorphicCacheTable() {
   free(table_);
+  free(index_);
 }
 
 
 RawMegamorphicCache* MegamorphicCacheTable::Lookup(const String& name,
                                                    const Array& descriptor) {
-  for (intptr_t i = 0; i < length_; ++i) {
-    if ((table_[i].name == name.raw()) &&
-        (table_[i].descriptor == descriptor.raw())) {
-      return table_[i].cache;
+  // Megamorphic call sites are looked up on every cache miss and every time
+  // a megamorphic call is compiled, so find the entry by hashing the selector
+  // name instead of scanning the whole table.
+  const intptr_t hash = name.Hash();
+  intptr_t probe = 0;
+  if (index_capacity_ > 0) {
+    const intptr_t mask = index_capacity_ - 1;
+    probe = hash & mask;
+    while (index_[probe] != kEmptyIndex) {
+      const Entry& entry = table_[index_[probe]];
+      if ((entry.name == name.raw()) &&
+          (entry.descriptor == descriptor.raw())) {
+        return entry.cache;
+      }
+      probe = (probe + 1) & mask;
     }
   }
 
@@ -39,16 +56,187 @@ RawMegamorphicCache* MegamorphicCacheTable::Lookup(const String& name,
     table_ =
         reinterpret_cast<Entry*>(realloc(table_, capacity_ * sizeof(*table_)));
   }
+  if (2 * (length_ + 1) > index_capacity_) {
+    Rehash(Utils::RoundUpToPowerOfTwo(4 * (length_ + 1)));
+    probe = hash & (index_capacity_ - 1);
+    while (index_[probe] != kEmptyIndex) {
+      probe = (probe + 1) & (index_capacity_ - 1);
+    }
+  }
 
   ASSERT(length_ < capacity_);
   const MegamorphicCache& cache =
       MegamorphicCache::Handle(MegamorphicCache::New());
-  Entry entry = { name.raw(), descriptor.raw(), cache.raw() };
+  Entry entry = { name.raw(), descriptor.raw(), cache.raw(), hash };
+  index_[probe] = length_;
   table_[length_++] = entry;
   return cache.raw();
 }
 
 
+void MegamorphicCacheTable::Rehash(intptr_t index_capacity) {
+  ASSERT(Utils::IsPowerOfTwo(index_capacity));
+  index_capacity_ = index_capacity;
+  index_ = reinterpret_cast<intptr_t*>(
+      realloc(index_, index_capacity_ * sizeof(*index_)));
+  const intptr_t mask = index_capacity_ - 1;
+  for (intptr_t i = 0; i < index_capacity_; ++i) {
+    index_[i] = kEmptyIndex;
+  }
+  for (intptr_t i = 0; i < length_; ++i) {
+    intptr_t probe = table_[i].hash & mask;
+    while (index_[probe] != kEmptyIndex) {
+      probe = (probe + 1) & mask;
+    }
+    index_[probe] = i;
+  }
+}
+
+
+bool MegamorphicCacheTable::IsFreeDispatchEntry(intptr_t index) const {
+  if (index < 0) {
+    return false;
+  }
+  const Array& table = Array::Handle(dispatch_table_);
+  if (index >= (table.Length() / kDispatchEntryLength)) {
+    return true;
+  }
+  return table.At(index * kDispatchEntryLength + kCacheIndex) ==
+      Object::null();
+}
+
+
+bool MegamorphicCacheTable::RowFits(const Array& buckets,
+                                    intptr_t row_offset) const {
+  const intptr_t num_buckets =
+      buckets.Length() / MegamorphicCache::kEntryLength;
+  for (intptr_t i = 0; i < num_buckets; ++i) {
+    const intptr_t class_id = Smi::Value(
+        Smi::RawCast(MegamorphicCache::GetClassId(buckets, i)));
+    if ((class_id != kIllegalCid) &&
+        !IsFreeDispatchEntry(row_offset + class_id)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void MegamorphicCacheTable::SetDispatchEntry(intptr_t index,
+                                             const MegamorphicCache& cache,
+                                             const Function& target) {
+  ASSERT(index >= 0);
+  Array& table = Array::Handle(dispatch_table_);
+  const intptr_t length = table.Length() / kDispatchEntryLength;
+  if (index >= length) {
+    const intptr_t new_length =
+        Utils::RoundUpToPowerOfTwo(Utils::Maximum(2 * length, index + 1));
+    table = Array::Grow(table, new_length * kDispatchEntryLength, Heap::kOld);
+    dispatch_table_ = table.raw();
+    // Generated code loads the table from the cache of the call site.
+    MegamorphicCache& other = MegamorphicCache::Handle();
+    for (intptr_t i = 0; i < length_; ++i) {
+      other = table_[i].cache;
+      other.set_dispatch_table(table);
+    }
+  }
+  table.SetAt(index * kDispatchEntryLength + kCacheIndex, cache);
+  table.SetAt(index * kDispatchEntryLength + kTargetFunctionIndex, target);
+}
+
+
+void MegamorphicCacheTable::InsertDispatchTarget(const MegamorphicCache& cache,
+                                                 const Smi& class_id,
+                                                 const Function& target) {
+  intptr_t row_offset = cache.row_offset();
+  if (IsFreeDispatchEntry(row_offset + class_id.Value())) {
+    SetDispatchEntry(row_offset + class_id.Value(), cache, target);
+    return;
+  }
+
+  // The entry belongs to the row of another cache.  Clear the row of this
+  // cache and enter all of its targets again at the first row offset where
+  // they fit.
+  const Array& table = Array::Handle(dispatch_table_);
+  const intptr_t length = table.Length() / kDispatchEntryLength;
+  const Array& buckets = Array::Handle(cache.buckets());
+  const intptr_t num_buckets =
+      buckets.Length() / MegamorphicCache::kEntryLength;
+  intptr_t min_class_id = class_id.Value();
+  Smi& id = Smi::Handle();
+  for (intptr_t i = 0; i < num_buckets; ++i) {
+    id ^= MegamorphicCache::GetClassId(buckets, i);
+    if (id.Value() == kIllegalCid) {
+      continue;
+    }
+    min_class_id = Utils::Minimum(min_class_id, id.Value());
+    const intptr_t index = row_offset + id.Value();
+    if ((index >= 0) && (index < length) &&
+        (table.At(index * kDispatchEntryLength + kCacheIndex) == cache.raw())) {
+      table.SetAt(index * kDispatchEntryLength + kCacheIndex,
+                  Object::null_object());
+      table.SetAt(index * kDispatchEntryLength + kTargetFunctionIndex,
+                  Object::null_object());
+    }
+  }
+  ASSERT(!RowFits(buckets, row_offset));
+  row_offset = -min_class_id;
+  while (!RowFits(buckets, row_offset)) {
+    row_offset++;
+  }
+  cache.set_row_offset(row_offset);
+  Function& function = Function::Handle();
+  for (intptr_t i = 0; i < num_buckets; ++i) {
+    id ^= MegamorphicCache::GetClassId(buckets, i);
+    if (id.Value() != kIllegalCid) {
+      function ^= MegamorphicCache::GetTargetFunction(buckets, i);
+      SetDispatchEntry(row_offset + id.Value(), cache, function);
+    }
+  }
+}
+
+
+void MegamorphicCacheTable::InsertClassTargets(const Class& cls) {
+  ASSERT(cls.is_finalized());
+  if (length_ == 0) {
+    return;
+  }
+  const Smi& class_id = Smi::Handle(Smi::New(cls.id()));
+  String& name = String::Handle();
+  Array& descriptor = Array::Handle();
+  MegamorphicCache& cache = MegamorphicCache::Handle();
+  Function& target = Function::Handle();
+  for (intptr_t i = 0; i < length_; ++i) {
+    name = table_[i].name;
+    descriptor = table_[i].descriptor;
+    ArgumentsDescriptor args_desc(descriptor);
+    target = Resolver::ResolveDynamicForReceiverClass(cls, name, args_desc);
+    // Compiling the targets here would compile every method of the class
+    // that shares a name with a megamorphic selector.
+    if (target.IsNull() || !target.HasCode()) {
+      continue;
+    }
+    cache = table_[i].cache;
+    cache.EnsureCapacity();
+    cache.Insert(class_id, target);
+    InsertDispatchTarget(cache, class_id, target);
+  }
+}
+
+
+RawFunction* MegamorphicCacheTable::LookupDispatchTarget(
+    const MegamorphicCache& cache, intptr_t class_id) const {
+  const Array& table = Array::Handle(dispatch_table_);
+  const intptr_t index = cache.row_offset() + class_id;
+  if ((index < 0) || (index >= (table.Length() / kDispatchEntryLength)) ||
+      (table.At(index * kDispatchEntryLength + kCacheIndex) != cache.raw())) {
+    return Function::null();
+  }
+  return Function::RawCast(
+      table.At(index * kDispatchEntryLength + kTargetFunctionIndex));
+}
+
+
 void MegamorphicCacheTable::InitMissHandler() {
   // The miss handler for a class ID not found in the table is invoked as a
   // normal Dart function.
@@ -69,6 +257,8 @@ void MegamorphicCacheTable::InitMissHandler() {
   miss_handler_code_ = code.raw();
   miss_handler_function_ = function.raw();
   function.SetCode(code);
+  dispatch_table_ = Array::New(
+      kInitialDispatchTableLength * kDispatchEntryLength, Heap::kOld);
 }
 
 
@@ -76,6 +266,7 @@ void MegamorphicCacheTable::VisitObjectPointers(ObjectPointerVisitor* v) {
   ASSERT(v != NULL);
   v->VisitPointer(reinterpret_cast<RawObject**>(&miss_handler_code_));
   v->VisitPointer(reinterpret_cast<RawObject**>(&miss_handler_function_));
+  v->VisitPointer(reinterpret_cast<RawObject**>(&dispatch_table_));
   for (intptr_t i = 0; i < length_; ++i) {
     v->VisitPointer(reinterpret_cast<RawObject**>(&table_[i].name));
     v->VisitPointer(reinterpret_cast<RawObject**>(&table_[i].descriptor));
@@ -97,6 +288,9 @@ void MegamorphicCacheTable::PrintSizes() {
   }
   OS::Print("%" Pd " megamorphic caches using %" Pd "KB.\n",
             length_, size / 1024);
+  const Array& table = Array::Handle(dispatch_table_);
+  OS::Print("Megamorphic dispatch table using %" Pd "KB.\n",
+            Array::InstanceSize(table.Length()) / 1024);
 }
 
 }  // namespace dart
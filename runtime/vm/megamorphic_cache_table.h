@@ -10,13 +10,16 @@
 namespace dart {
 
 class Array;
+class Class;
 class Function;
+class MegamorphicCache;
 class ObjectPointerVisitor;
 class RawArray;
 class RawFunction;
 class RawCode;
 class RawMegamorphicCache;
 class RawString;
+class Smi;
 class String;
 
 class MegamorphicCacheTable {
@@ -29,6 +32,27 @@ class MegamorphicCacheTable {
 
   RawMegamorphicCache* Lookup(const String& name, const Array& descriptor);
 
+  // The dispatch table holds one row of (cache, target function) entries per
+  // megamorphic cache.  The entry for a receiver class ID is found at the
+  // row offset of the cache plus the class ID; rows are displaced so that
+  // they interleave.  Entries not keyed by the cache are misses.
+  RawArray* dispatch_table() const { return dispatch_table_; }
+
+  // Adds the target for class_id, which has already been inserted into
+  // cache, to the row of cache.  Moves the row if the entry is taken.
+  void InsertDispatchTarget(const MegamorphicCache& cache,
+                            const Smi& class_id,
+                            const Function& target);
+
+  // Enters the compiled targets of the newly finalized class cls into every
+  // megamorphic cache and its row, so that calls on instances of cls do not
+  // start with a miss.  Targets without code are still entered on a miss.
+  void InsertClassTargets(const Class& cls);
+
+  // Returns the target in the row of cache for class_id, or null.
+  RawFunction* LookupDispatchTarget(const MegamorphicCache& cache,
+                                    intptr_t class_id) const;
+
   void VisitObjectPointers(ObjectPointerVisitor* visitor);
 
   void PrintSizes();
@@ -38,15 +62,38 @@ class MegamorphicCacheTable {
     RawString* name;
     RawArray* descriptor;
     RawMegamorphicCache* cache;
+    intptr_t hash;
   };
 
   static const int kCapacityIncrement = 128;
+  static const intptr_t kEmptyIndex = -1;
+  static const intptr_t kInitialDispatchTableLength = 256;
+
+  enum {
+    kCacheIndex,
+    kTargetFunctionIndex,
+    kDispatchEntryLength,
+  };
+
+  // Rebuilds the hash index over the entries of the table.
+  void Rehash(intptr_t index_capacity);
+
+  bool IsFreeDispatchEntry(intptr_t index) const;
+  bool RowFits(const Array& buckets, intptr_t row_offset) const;
+  void SetDispatchEntry(intptr_t index,
+                        const MegamorphicCache& cache,
+                        const Function& target);
 
   RawFunction* miss_handler_function_;
   RawCode* miss_handler_code_;
   intptr_t capacity_;
   intptr_t length_;
   Entry* table_;
+  // Open addressing hash index from the hash of the selector name to the
+  // position of its entry in table_, or kEmptyIndex.  Kept at most half full.
+  intptr_t index_capacity_;
+  intptr_t* index_;
+  RawArray* dispatch_table_;
 
   DISALLOW_COPY_AND_ASSIGN(MegamorphicCacheTable);
 };
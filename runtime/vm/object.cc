@@ -54,6 +54,10 @@ DEFINE_FLAG(bool, overlap_type_arguments, true,
 DEFINE_FLAG(bool, show_internal_names, false,
     "Show names of internal classes (e.g. \"OneByteString\") in error messages "
     "instead of showing the corresponding interface names (e.g. \"String\")");
+#if defined(TARGET_ARCH_X64)
+DEFINE_FLAG(bool, unbox_double_fields, true,
+    "Keep double and Float32x4 instance fields in mutable boxes.");
+#endif
 DEFINE_FLAG(bool, trace_disabling_optimized_code, false,
     "Trace disabling optimized code.");
 DEFINE_FLAG(bool, throw_on_javascript_int_overflow, false,
@@ -780,6 +784,7 @@ void Object::CreateInternalMetaData() {
   fields = Array::New(1);
   name = Symbols::New("@parent_");
   fld = Field::New(name, false, false, false, cls, 0);
+  fld.set_is_unboxing_candidate(false);
   fields.SetAt(0, fld);
   cls.SetFields(fields);
 }
@@ -1500,6 +1505,10 @@ RawObject* Object::Clone(const Object& src, Heap::Space space) {
   RawObject* raw_obj = Object::Allocate(cls.id(), size, space);
   NoGCScope no_gc;
   memmove(raw_obj->ptr(), src.raw()->ptr(), size);
+  // The clone is not in the store buffer yet and does not have a card table
+  // of its own.
+  raw_obj->ClearRememberedBit();
+  raw_obj->ClearCardRememberedBit();
   if ((space == Heap::kOld) && !raw_obj->IsRemembered()) {
     StoreBufferUpdateVisitor visitor(Isolate::Current(), raw_obj);
     raw_obj->VisitPointers(&visitor);
@@ -2723,6 +2732,139 @@ void Class::set_allocation_stub(const Code& value) const {
 }
 
 
+void Class::set_pretenured_allocation_stub(const Code& value) const {
+  ASSERT(!value.IsNull());
+  ASSERT(raw_ptr()->pretenured_allocation_stub_ == Code::null());
+  StorePointer(&raw_ptr()->pretenured_allocation_stub_, value.raw());
+}
+
+
+// Adds 'code' to the weakly held list of dependent code objects, reusing a
+// cleared entry if possible. Returns the possibly grown list.
+static RawArray* AddDependentCode(const Array& dependent, const Code& code) {
+  if (!dependent.IsNull()) {
+    // Try to find and reuse cleared WeakProperty to avoid allocating new one.
+    WeakProperty& weak_property = WeakProperty::Handle();
+    for (intptr_t i = 0; i < dependent.Length(); i++) {
+      weak_property ^= dependent.At(i);
+      if (weak_property.key() == Code::null()) {
+        // Empty property found. Reuse it.
+        weak_property.set_key(code);
+        return dependent.raw();
+      }
+    }
+  }
+
+  const WeakProperty& weak_property = WeakProperty::Handle(
+      WeakProperty::New(Heap::kOld));
+  weak_property.set_key(code);
+
+  intptr_t length = dependent.IsNull() ? 0 : dependent.Length();
+  const Array& new_dependent = Array::Handle(
+      Array::Grow(dependent, length + 1, Heap::kOld));
+  new_dependent.SetAt(length, weak_property);
+  return new_dependent.raw();
+}
+
+
+static bool IsDependentCode(const Array& dependent_code, const Code& code) {
+  if (!code.is_optimized()) {
+    return false;
+  }
+
+  WeakProperty& weak_property = WeakProperty::Handle();
+  for (intptr_t i = 0; i < dependent_code.Length(); i++) {
+    weak_property ^= dependent_code.At(i);
+    if (code.raw() == weak_property.key()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+// Deoptimizes the frames running any of the given code objects and switches
+// the functions using them to unoptimized code. 'reason' is only used for
+// tracing.
+static void DeoptimizeCodeObjects(const Array& code_objects,
+                                  const char* reason) {
+  // Deoptimize all dependent code on the stack.
+  Code& code = Code::Handle();
+  {
+    DartFrameIterator iterator;
+    StackFrame* frame = iterator.NextFrame();
+    while (frame != NULL) {
+      code = frame->LookupDartCode();
+      if (IsDependentCode(code_objects, code)) {
+        if (FLAG_trace_deoptimization || FLAG_trace_deoptimization_verbose) {
+          Function& function = Function::Handle(code.function());
+          OS::PrintErr("Deoptimizing %s because %s.\n",
+              function.ToFullyQualifiedCString(),
+              reason);
+        }
+        DeoptimizeAt(code, frame->pc());
+      }
+      frame = iterator.NextFrame();
+    }
+  }
+
+  // Switch functions that use dependent code to unoptimized code.
+  WeakProperty& weak_property = WeakProperty::Handle();
+  Function& function = Function::Handle();
+  for (intptr_t i = 0; i < code_objects.Length(); i++) {
+    weak_property ^= code_objects.At(i);
+    code ^= weak_property.key();
+    if (code.IsNull()) {
+      // Code was garbage collected already.
+      continue;
+    }
+
+    function ^= code.function();
+    // If function uses dependent code switch it to unoptimized.
+    if (function.CurrentCode() == code.raw()) {
+      ASSERT(function.HasOptimizedCode());
+      if (FLAG_trace_deoptimization || FLAG_trace_deoptimization_verbose) {
+        OS::PrintErr("Switching %s to unoptimized code because %s.\n",
+                     function.ToFullyQualifiedCString(),
+                     reason);
+      }
+      function.SwitchToUnoptimizedCode();
+    }
+  }
+}
+
+
+RawArray* Class::dependent_code() const {
+  return raw_ptr()->dependent_code_;
+}
+
+
+void Class::set_dependent_code(const Array& array) const {
+  StorePointer(&raw_ptr()->dependent_code_, array.raw());
+}
+
+
+void Class::RegisterDependentCode(const Code& code) const {
+  const Array& dependent = Array::Handle(dependent_code());
+  set_dependent_code(Array::Handle(AddDependentCode(dependent, code)));
+}
+
+
+void Class::DeoptimizeDependentCode() const {
+  const Array& code_objects = Array::Handle(dependent_code());
+
+  if (code_objects.IsNull()) {
+    return;
+  }
+  set_dependent_code(Object::null_array());
+
+  const char* reason = Isolate::Current()->current_zone()->PrintToString(
+      "pretenuring of class %s was withdrawn", ToCString());
+  DeoptimizeCodeObjects(code_objects, reason);
+}
+
+
 bool Class::IsFunctionClass() const {
   return raw() == Type::Handle(Type::Function()).type_class();
 }
@@ -5627,6 +5769,28 @@ void Function::PrintToJSONStream(JSONStream* stream, bool ref) const {
   jsobj.AddProperty("code", Object::Handle(CurrentCode()));
   jsobj.AddProperty("deoptimizations",
                     static_cast<intptr_t>(deoptimization_counter()));
+  const Code& unoptimized = Code::Handle(unoptimized_code());
+  if (!unoptimized.IsNull()) {
+    // Deoptimization reasons recorded per deopt id of the unoptimized code.
+    const Array& ic_data_array =
+        Array::Handle(unoptimized.ExtractTypeFeedbackArray());
+    ICData& ic_data = ICData::Handle();
+    JSONArray jsarr(&jsobj, "deopt_reasons");
+    for (intptr_t deopt_id = 0; deopt_id < ic_data_array.Length(); deopt_id++) {
+      ic_data ^= ic_data_array.At(deopt_id);
+      if (ic_data.IsNull() || !ic_data.HasDeoptReasons()) {
+        continue;
+      }
+      JSONObject site(&jsarr);
+      site.AddProperty("deopt_id", deopt_id);
+      JSONArray reasons(&site, "reasons");
+      for (intptr_t reason = 0; reason < kDeoptNumReasons; reason++) {
+        if (ic_data.HasDeoptReason(reason)) {
+          reasons.AddValue(DeoptReasonToText(reason));
+        }
+      }
+    }
+  }
 }
 
 
@@ -5828,6 +5992,7 @@ RawField* Field::New(const String& name,
   result.set_owner(owner);
   result.set_token_pos(token_pos);
   result.set_has_initializer(false);
+  result.set_is_unboxing_candidate(!is_static && !is_final);
   result.set_guarded_cid(kIllegalCid);
   result.set_is_nullable(false);
   // Presently, we only attempt to remember the list length for final fields.
@@ -5950,46 +6115,7 @@ void Field::set_dependent_code(const Array& array) const {
 
 void Field::RegisterDependentCode(const Code& code) const {
   const Array& dependent = Array::Handle(dependent_code());
-
-  if (!dependent.IsNull()) {
-    // Try to find and reuse cleared WeakProperty to avoid allocating new one.
-    WeakProperty& weak_property = WeakProperty::Handle();
-    for (intptr_t i = 0; i < dependent.Length(); i++) {
-      weak_property ^= dependent.At(i);
-      if (weak_property.key() == Code::null()) {
-        // Empty property found. Reuse it.
-        weak_property.set_key(code);
-        return;
-      }
-    }
-  }
-
-  const WeakProperty& weak_property = WeakProperty::Handle(
-      WeakProperty::New(Heap::kOld));
-  weak_property.set_key(code);
-
-  intptr_t length = dependent.IsNull() ? 0 : dependent.Length();
-  const Array& new_dependent = Array::Handle(
-      Array::Grow(dependent, length + 1, Heap::kOld));
-  new_dependent.SetAt(length, weak_property);
-  set_dependent_code(new_dependent);
-}
-
-
-static bool IsDependentCode(const Array& dependent_code, const Code& code) {
-  if (!code.is_optimized()) {
-    return false;
-  }
-
-  WeakProperty& weak_property = WeakProperty::Handle();
-  for (intptr_t i = 0; i < dependent_code.Length(); i++) {
-    weak_property ^= dependent_code.At(i);
-    if (code.raw() == weak_property.key()) {
-      return true;
-    }
-  }
-
-  return false;
+  set_dependent_code(Array::Handle(AddDependentCode(dependent, code)));
 }
 
 
@@ -6001,50 +6127,36 @@ void Field::DeoptimizeDependentCode() const {
   }
   set_dependent_code(Object::null_array());
 
-  // Deoptimize all dependent code on the stack.
-  Code& code = Code::Handle();
-  {
-    DartFrameIterator iterator;
-    StackFrame* frame = iterator.NextFrame();
-    while (frame != NULL) {
-      code = frame->LookupDartCode();
-      if (IsDependentCode(code_objects, code)) {
-        if (FLAG_trace_deoptimization || FLAG_trace_deoptimization_verbose) {
-          Function& function = Function::Handle(code.function());
-          OS::PrintErr("Deoptimizing %s because guard on field %s failed.\n",
-              function.ToFullyQualifiedCString(),
-              ToCString());
-        }
-        DeoptimizeAt(code, frame->pc());
-      }
-      frame = iterator.NextFrame();
-    }
-  }
+  const char* reason = Isolate::Current()->current_zone()->PrintToString(
+      "guard on field %s failed", ToCString());
+  DeoptimizeCodeObjects(code_objects, reason);
+}
 
-  // Switch functions that use dependent code to unoptimized code.
-  WeakProperty& weak_property = WeakProperty::Handle();
-  Function& function = Function::Handle();
-  for (intptr_t i = 0; i < code_objects.Length(); i++) {
-    weak_property ^= code_objects.At(i);
-    code ^= weak_property.key();
-    if (code.IsNull()) {
-      // Code was garbage collected already.
-      continue;
-    }
 
-    function ^= code.function();
-    // If function uses dependent code switch it to unoptimized.
-    if (function.CurrentCode() == code.raw()) {
-      ASSERT(function.HasOptimizedCode());
-      if (FLAG_trace_deoptimization || FLAG_trace_deoptimization_verbose) {
-        OS::PrintErr("Switching %s to unoptimized code because guard"
-                     " on field %s was violated.\n",
-                     function.ToFullyQualifiedCString(),
-                     ToCString());
-      }
-      function.SwitchToUnoptimizedCode();
-    }
-  }
+bool Field::IsUnboxedField() const {
+#if defined(TARGET_ARCH_X64)
+  // Only the x64 code generator implements the unboxed field accesses.
+  return FLAG_unbox_double_fields &&
+      is_unboxing_candidate() &&
+      !is_nullable() &&
+      ((guarded_cid() == kDoubleCid) || (guarded_cid() == kFloat32x4Cid));
+#else
+  return false;
+#endif
+}
+
+
+bool Field::IsPotentialUnboxedField() const {
+#if defined(TARGET_ARCH_X64)
+  // The guard only moves away from unboxing: nullability is sticky and a
+  // field guarded to any other class id can only become dynamic.
+  return IsUnboxedField() ||
+      (FLAG_unbox_double_fields &&
+       is_unboxing_candidate() &&
+       (guarded_cid() == kIllegalCid));
+#else
+  return false;
+#endif
 }
 
 
@@ -9366,6 +9478,11 @@ void Code::set_is_alive(bool value) const {
 }
 
 
+void Code::set_is_baseline(bool value) const {
+  set_state_bits(BaselineBit::update(value, raw_ptr()->state_bits_));
+}
+
+
 void Code::set_stackmaps(const Array& maps) const {
   ASSERT(maps.IsOld());
   StorePointer(&raw_ptr()->stackmaps_, maps.raw());
@@ -10005,10 +10122,25 @@ void ICData::set_ic_data(const Array& value) const {
 }
 
 
-void ICData::set_deopt_reason(intptr_t deopt_reason) const {
-  raw_ptr()->deopt_reason_ = deopt_reason;
+void ICData::set_deopt_reasons(uint32_t reasons) const {
+  raw_ptr()->deopt_reasons_ = reasons;
 }
 
+
+bool ICData::HasDeoptReason(intptr_t reason) const {
+  ASSERT((reason >= 0) && (reason < kDeoptNumReasons));
+  return (deopt_reasons() & (1 << reason)) != 0;
+}
+
+
+void ICData::AddDeoptReason(intptr_t reason) const {
+  COMPILE_ASSERT(kDeoptNumReasons <= (kBitsPerByte * sizeof(uint32_t)),
+                 deopt_reasons_fit_in_bitmask);
+  ASSERT((reason >= 0) && (reason < kDeoptNumReasons));
+  set_deopt_reasons(deopt_reasons() | (1 << reason));
+}
+
+
 void ICData::set_is_closure_call(bool value) const {
   raw_ptr()->is_closure_call_ = value ? 1 : 0;
 }
@@ -10322,8 +10454,8 @@ RawICData* ICData::AsUnaryClassChecksForArgNr(intptr_t arg_nr) const {
                               count);
     }
   }
-  // Copy deoptimization reason.
-  result.set_deopt_reason(deopt_reason());
+  // Copy deoptimization reasons.
+  result.set_deopt_reasons(deopt_reasons());
 
   return result.raw();
 }
@@ -10413,7 +10545,7 @@ RawICData* ICData::New(const Function& function,
   result.set_arguments_descriptor(arguments_descriptor);
   result.set_deopt_id(deopt_id);
   result.set_num_args_tested(num_args_tested);
-  result.set_deopt_reason(kDeoptUnknown);
+  result.set_deopt_reasons(0);
   result.set_is_closure_call(false);
   // Number of array elements in one test entry.
   intptr_t len = result.TestEntryLength();
@@ -10463,6 +10595,28 @@ void MegamorphicCache::set_filled_entry_count(intptr_t count) const {
 }
 
 
+RawArray* MegamorphicCache::dispatch_table() const {
+  return raw_ptr()->dispatch_table_;
+}
+
+
+void MegamorphicCache::set_dispatch_table(const Array& table) const {
+  StorePointer(&raw_ptr()->dispatch_table_, table.raw());
+}
+
+
+// The row offset is smi-tagged as well, so that generated code can add the
+// smi-tagged class ID to it.
+intptr_t MegamorphicCache::row_offset() const {
+  return Smi::Value(raw_ptr()->row_offset_);
+}
+
+
+void MegamorphicCache::set_row_offset(intptr_t offset) const {
+  raw_ptr()->row_offset_ = Smi::New(offset);
+}
+
+
 RawMegamorphicCache* MegamorphicCache::New() {
   MegamorphicCache& result = MegamorphicCache::Handle();
   { RawObject* raw = Object::Allocate(MegamorphicCache::kClassId,
@@ -10473,14 +10627,16 @@ RawMegamorphicCache* MegamorphicCache::New() {
   }
   const intptr_t capacity = kInitialCapacity;
   const Array& buckets = Array::Handle(Array::New(kEntryLength * capacity));
-  const Function& handler = Function::Handle(
-      Isolate::Current()->megamorphic_cache_table()->miss_handler());
+  MegamorphicCacheTable* table = Isolate::Current()->megamorphic_cache_table();
+  const Function& handler = Function::Handle(table->miss_handler());
   for (intptr_t i = 0; i < capacity; ++i) {
     SetEntry(buckets, i, smi_illegal_cid(), handler);
   }
   result.set_buckets(buckets);
   result.set_mask(capacity - 1);
   result.set_filled_entry_count(0);
+  result.set_dispatch_table(Array::Handle(table->dispatch_table()));
+  result.set_row_offset(0);
   return result.raw();
 }
 
@@ -11252,6 +11408,37 @@ bool Instance::IsIdenticalTo(const Instance& other) const {
 }
 
 
+RawObject* Instance::GetField(const Field& field) const {
+  const Object& value = Object::Handle(*FieldAddr(field));
+  if (!field.IsUnboxedField() || value.IsNull()) {
+    return value.raw();
+  }
+  // The box is owned by this instance and mutated by stores.
+  if (value.IsDouble()) {
+    return Double::New(Double::Cast(value).value());
+  }
+  return Float32x4::New(Float32x4::Cast(value).value());
+}
+
+
+void Instance::SetField(const Field& field, const Object& value) const {
+  field.UpdateGuardedCidAndLength(value);
+  if (field.IsUnboxedField()) {
+    // Store a fresh box, the value may be referenced from elsewhere.
+    ASSERT(value.GetClassId() == field.guarded_cid());
+    Object& box = Object::Handle();
+    if (value.IsDouble()) {
+      box = Double::New(Double::Cast(value).value());
+    } else {
+      box = Float32x4::New(Float32x4::Cast(value).value());
+    }
+    StorePointer(FieldAddr(field), box.raw());
+    return;
+  }
+  StorePointer(FieldAddr(field), value.raw());
+}
+
+
 void Instance::SetNativeField(int index, intptr_t value) const {
   ASSERT(IsValidNativeIndex(index));
   Object& native_fields = Object::Handle(*NativeFieldsAddr());
@@ -14970,12 +15157,19 @@ RawArray* Array::New(intptr_t class_id, intptr_t len, Heap::Space space) {
   }
   Array& result = Array::Handle();
   {
-    RawObject* raw = Object::Allocate(class_id,
-                                      Array::InstanceSize(len),
-                                      space);
+    intptr_t size = Array::InstanceSize(len);
+    RawObject* raw = Object::Allocate(class_id, size, space);
     NoGCScope no_gc;
     result ^= raw;
     result.SetLength(len);
+    if (FLAG_card_marking &&
+        raw->IsOldObject() &&
+        PageSpace::IsLargeObjectSize(size)) {
+      // Stores into large arrays only dirty the card of the stored slot, so
+      // that the scavenger does not need to visit the whole array.
+      raw->SetCardRememberedBit();
+      HeapPage::OfCardRemembered(raw)->AllocateCardTable();
+    }
   }
   return result.raw();
 }
@@ -521,10 +521,14 @@ class Object {
     *addr = value;
     // Filter stores based on source and target.
     if (!value->IsHeapObject()) return;
-    if (value->IsNewObject() && raw()->IsOldObject() &&
-        !raw()->IsRemembered()) {
-      raw()->SetRememberedBit();
-      Isolate::Current()->store_buffer()->AddObject(raw());
+    if (value->IsNewObject() && raw()->IsOldObject()) {
+      if (raw()->IsCardRemembered()) {
+        HeapPage::OfCardRemembered(raw())->RememberCard(
+            reinterpret_cast<uword>(addr));
+      } else if (!raw()->IsRemembered()) {
+        raw()->SetRememberedBit();
+        Isolate::Current()->store_buffer()->AddObject(raw());
+      }
     }
   }
 
@@ -982,6 +986,24 @@ class Class : public Object {
   }
   void set_allocation_stub(const Code& value) const;
 
+  RawCode* pretenured_allocation_stub() const {
+    return raw_ptr()->pretenured_allocation_stub_;
+  }
+  void set_pretenured_allocation_stub(const Code& value) const;
+
+  // Return the list of optimized code objects that allocate instances of this
+  // class in old space. These code objects must be deoptimized when the
+  // instances are no longer pretenured.
+  // Code objects are held weakly via an indirection through WeakProperty.
+  RawArray* dependent_code() const;
+  void set_dependent_code(const Array& array) const;
+
+  // Add the given code object to the list of dependent ones.
+  void RegisterDependentCode(const Code& code) const;
+
+  // Deoptimize all dependent code objects.
+  void DeoptimizeDependentCode() const;
+
   RawArray* constants() const;
 
   RawFunction* GetInvocationDispatcher(const String& target_name,
@@ -2168,6 +2190,27 @@ class Field : public Object {
   // deoptimization of dependent optimized code.
   bool UpdateGuardedCidAndLength(const Object& value) const;
 
+  // Returns false for fields whose values must never be kept in a mutable
+  // box, e.g. the fake fields used by the compiler to describe closures.
+  bool is_unboxing_candidate() const {
+    return UnboxingCandidateBit::decode(raw_ptr()->kind_bits_);
+  }
+  void set_is_unboxing_candidate(bool b) const {
+    set_kind_bits(UnboxingCandidateBit::update(b, raw_ptr()->kind_bits_));
+  }
+
+  // Returns true if instances store the value of this field in a mutable box
+  // that they own: a non-nullable instance field that was only ever assigned
+  // doubles or Float32x4 values. Stores overwrite the payload of the box and
+  // loads return a copy of it. A field stops being unboxed as soon as its
+  // guard is invalidated; the existing boxes then become ordinary values.
+  bool IsUnboxedField() const;
+
+  // Returns true if the field is unboxed or might become unboxed later,
+  // i.e. nothing has been stored into it yet. Code accessing such a field
+  // without depending on its guard has to check its state at run time.
+  bool IsPotentialUnboxedField() const;
+
   // Return the list of optimized code objects that were optimized under
   // assumptions about guarded class id and nullability of this field.
   // These code objects must be deoptimized when field's properties change.
@@ -2199,11 +2242,14 @@ class Field : public Object {
     kStaticBit,
     kFinalBit,
     kHasInitializerBit,
+    kUnboxingCandidateBit,
   };
   class ConstBit : public BitField<bool, kConstBit, 1> {};
   class StaticBit : public BitField<bool, kStaticBit, 1> {};
   class FinalBit : public BitField<bool, kFinalBit, 1> {};
   class HasInitializerBit : public BitField<bool, kHasInitializerBit, 1> {};
+  class UnboxingCandidateBit :
+      public BitField<bool, kUnboxingCandidateBit, 1> {};
 
   // Update guarded class id and nullability of the field to reflect assignment
   // of the value with the given class id to this field. Returns true, if
@@ -3125,6 +3171,12 @@ class Code : public Object {
     return AliveBit::decode(raw_ptr()->state_bits_);
   }
   void set_is_alive(bool value) const;
+  // Baseline code is optimized code compiled without the expensive passes.
+  // It keeps counting invocations and is replaced by fully optimized code.
+  bool is_baseline() const {
+    return BaselineBit::decode(raw_ptr()->state_bits_);
+  }
+  void set_is_baseline(bool value) const;
 
   uword EntryPoint() const {
     const Instructions& instr = Instructions::Handle(instructions());
@@ -3304,10 +3356,12 @@ class Code : public Object {
   enum {
     kOptimizedBit = 0,
     kAliveBit = 1,
+    kBaselineBit = 2,
   };
 
   class OptimizedBit : public BitField<bool, kOptimizedBit, 1> {};
   class AliveBit : public BitField<bool, kAliveBit, 1> {};
+  class BaselineBit : public BitField<bool, kBaselineBit, 1> {};
 
   // An object finder visitor interface.
   class FindRawCodeVisitor : public FindObjectVisitor {
@@ -3520,11 +3574,15 @@ class ICData : public Object {
     return raw_ptr()->deopt_id_;
   }
 
-  intptr_t deopt_reason() const {
-    return raw_ptr()->deopt_reason_;
+  // Reasons of the deoptimizations that occurred at this call site, one bit
+  // per DeoptReasonId.
+  uint32_t deopt_reasons() const {
+    return raw_ptr()->deopt_reasons_;
   }
-
-  void set_deopt_reason(intptr_t reason) const;
+  void set_deopt_reasons(uint32_t reasons) const;
+  bool HasDeoptReasons() const { return deopt_reasons() != 0; }
+  bool HasDeoptReason(intptr_t reason) const;
+  void AddDeoptReason(intptr_t reason) const;
 
   bool is_closure_call() const {
     return raw_ptr()->is_closure_call_ == 1;
@@ -3667,12 +3725,26 @@ class MegamorphicCache : public Object {
   intptr_t filled_entry_count() const;
   void set_filled_entry_count(intptr_t num) const;
 
+  // The dispatch table of the isolate, which holds the targets of this cache
+  // as one row starting at row_offset.
+  RawArray* dispatch_table() const;
+  void set_dispatch_table(const Array& table) const;
+
+  intptr_t row_offset() const;
+  void set_row_offset(intptr_t offset) const;
+
   static intptr_t buckets_offset() {
     return OFFSET_OF(RawMegamorphicCache, buckets_);
   }
   static intptr_t mask_offset() {
     return OFFSET_OF(RawMegamorphicCache, mask_);
   }
+  static intptr_t dispatch_table_offset() {
+    return OFFSET_OF(RawMegamorphicCache, dispatch_table_);
+  }
+  static intptr_t row_offset_offset() {
+    return OFFSET_OF(RawMegamorphicCache, row_offset_);
+  }
 
   static RawMegamorphicCache* New();
 
@@ -3686,6 +3758,7 @@ class MegamorphicCache : public Object {
 
  private:
   friend class Class;
+  friend class MegamorphicCacheTable;
 
   enum {
     kClassIdIndex,
@@ -3916,14 +3989,10 @@ class Instance : public Object {
   // Returns true if all fields are OK for canonicalization.
   virtual bool CheckAndCanonicalizeFields(const char** error_str) const;
 
-  RawObject* GetField(const Field& field) const {
-    return *FieldAddr(field);
-  }
+  // Returns a copy of the box if the field is unboxed.
+  RawObject* GetField(const Field& field) const;
 
-  void SetField(const Field& field, const Object& value) const {
-    field.UpdateGuardedCidAndLength(value);
-    StorePointer(FieldAddr(field), value.raw());
-  }
+  void SetField(const Field& field, const Object& value) const;
 
   RawType* GetType() const;
 
@@ -5651,10 +5720,14 @@ class GrowableObjectArray : public Instance {
     *addr = value;
     // Filter stores based on source and target.
     if (!value->IsHeapObject()) return;
-    if (value->IsNewObject() && data()->IsOldObject() &&
-        !data()->IsRemembered()) {
-      data()->SetRememberedBit();
-      Isolate::Current()->store_buffer()->AddObject(data());
+    if (value->IsNewObject() && data()->IsOldObject()) {
+      if (data()->IsCardRemembered()) {
+        HeapPage::OfCardRemembered(data())->RememberCard(
+            reinterpret_cast<uword>(addr));
+      } else if (!data()->IsRemembered()) {
+        data()->SetRememberedBit();
+        Isolate::Current()->store_buffer()->AddObject(data());
+      }
     }
   }
 
@@ -62,6 +62,7 @@ ObjectStore::ObjectStore()
     libraries_(GrowableObjectArray::null()),
     pending_classes_(GrowableObjectArray::null()),
     pending_functions_(GrowableObjectArray::null()),
+    optimization_queue_(GrowableObjectArray::null()),
     sticky_error_(Error::null()),
     unhandled_exception_handler_(String::null()),
     empty_context_(Context::null()),
@@ -105,6 +106,8 @@ bool ObjectStore::PreallocateObjects() {
 
   ASSERT(this->pending_functions() == GrowableObjectArray::null());
   this->pending_functions_ = GrowableObjectArray::New();
+  ASSERT(this->optimization_queue() == GrowableObjectArray::null());
+  this->optimization_queue_ = GrowableObjectArray::New();
 
   Object& result = Object::Handle();
   const Library& library = Library::Handle(Library::CoreLibrary());
@@ -343,6 +343,10 @@ class ObjectStore {
     return pending_functions_;
   }
 
+  RawGrowableObjectArray* optimization_queue() const {
+    return optimization_queue_;
+  }
+
   RawError* sticky_error() const { return sticky_error_; }
   void set_sticky_error(const Error& value) {
     ASSERT(!value.IsNull());
@@ -472,6 +476,7 @@ class ObjectStore {
   RawGrowableObjectArray* libraries_;
   RawGrowableObjectArray* pending_classes_;
   RawGrowableObjectArray* pending_functions_;
+  RawGrowableObjectArray* optimization_queue_;
   RawError* sticky_error_;
   RawString* unhandled_exception_handler_;
   RawContext* empty_context_;
@@ -5,10 +5,14 @@
 #include "vm/assembler.h"
 #include "vm/bigint_operations.h"
 #include "vm/class_finalizer.h"
+#include "vm/code_generator.h"
+#include "vm/compiler.h"
 #include "vm/dart_api_impl.h"
 #include "vm/dart_entry.h"
 #include "vm/debugger.h"
+#include "vm/flow_graph_compiler.h"
 #include "vm/isolate.h"
+#include "vm/megamorphic_cache_table.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
 #include "vm/simulator.h"
@@ -2680,6 +2684,16 @@ TEST_CASE(ICData) {
   EXPECT_EQ(target2.raw(), test_target.raw());
   EXPECT_EQ(kDoubleCid, o1.GetCidAt(1));
 
+  // Deoptimization reasons accumulate and are kept by unary class checks.
+  EXPECT(!o1.HasDeoptReasons());
+  o1.AddDeoptReason(kDeoptCheckSmi);
+  o1.AddDeoptReason(kDeoptBinarySmiOp);
+  EXPECT(o1.HasDeoptReason(kDeoptCheckSmi));
+  EXPECT(o1.HasDeoptReason(kDeoptBinarySmiOp));
+  EXPECT(!o1.HasDeoptReason(kDeoptCheckClass));
+  const ICData& unary = ICData::Handle(o1.AsUnaryClassChecks());
+  EXPECT_EQ(o1.deopt_reasons(), unary.deopt_reasons());
+
   ICData& o2 = ICData::Handle();
   o2 = ICData::New(function, target_name, args_descriptor, 57, 2);
   EXPECT_EQ(2, o2.num_args_tested());
@@ -2706,6 +2720,201 @@ TEST_CASE(ICData) {
 }
 
 
+TEST_CASE(MegamorphicCacheTable) {
+  MegamorphicCacheTable* table = Isolate::Current()->megamorphic_cache_table();
+  const Array& one_arg =
+      Array::Handle(ArgumentsDescriptor::New(1, Object::null_array()));
+  const Array& two_args =
+      Array::Handle(ArgumentsDescriptor::New(2, Object::null_array()));
+  const intptr_t kNumSelectors = 300;
+  const Array& caches = Array::Handle(Array::New(2 * kNumSelectors));
+  String& name = String::Handle();
+  MegamorphicCache& cache = MegamorphicCache::Handle();
+  char buffer[32];
+  for (intptr_t i = 0; i < kNumSelectors; i++) {
+    OS::SNPrint(buffer, sizeof(buffer), "selector%" Pd "", i);
+    name = Symbols::New(buffer);
+    cache = table->Lookup(name, one_arg);
+    caches.SetAt(2 * i, cache);
+    cache = table->Lookup(name, two_args);
+    EXPECT(cache.raw() != caches.At(2 * i));
+    caches.SetAt(2 * i + 1, cache);
+  }
+  // Looking up a selector again returns its cache, also after the table grew.
+  for (intptr_t i = 0; i < kNumSelectors; i++) {
+    OS::SNPrint(buffer, sizeof(buffer), "selector%" Pd "", i);
+    name = Symbols::New(buffer);
+    cache = table->Lookup(name, one_arg);
+    EXPECT_EQ(caches.At(2 * i), cache.raw());
+    cache = table->Lookup(name, two_args);
+    EXPECT_EQ(caches.At(2 * i + 1), cache.raw());
+  }
+}
+
+
+static void InsertMegamorphicTarget(const MegamorphicCache& cache,
+                                    intptr_t cid,
+                                    const Function& target) {
+  const Smi& class_id = Smi::Handle(Smi::New(cid));
+  cache.EnsureCapacity();
+  cache.Insert(class_id, target);
+  Isolate::Current()->megamorphic_cache_table()->InsertDispatchTarget(
+      cache, class_id, target);
+}
+
+
+TEST_CASE(MegamorphicDispatchTable) {
+  const char* kScriptChars =
+      "f() => 1;\n"
+      "g() => 2;\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Library& library = Library::Handle();
+  library ^= Api::UnwrapHandle(lib);
+  const Function& f = Function::Handle(
+      library.LookupLocalFunction(String::Handle(Symbols::New("f"))));
+  const Function& g = Function::Handle(
+      library.LookupLocalFunction(String::Handle(Symbols::New("g"))));
+  EXPECT(!f.IsNull() && !g.IsNull());
+
+  MegamorphicCacheTable* table = Isolate::Current()->megamorphic_cache_table();
+  const Array& descriptor = Array::Handle(ArgumentsDescriptor::New(1));
+  const MegamorphicCache& a = MegamorphicCache::Handle(
+      table->Lookup(String::Handle(Symbols::New("a")), descriptor));
+  const MegamorphicCache& b = MegamorphicCache::Handle(
+      table->Lookup(String::Handle(Symbols::New("b")), descriptor));
+  EXPECT_EQ(a.row_offset(), b.row_offset());
+
+  InsertMegamorphicTarget(a, 100, f);
+  InsertMegamorphicTarget(a, 101, f);
+  EXPECT_EQ(f.raw(), table->LookupDispatchTarget(a, 100));
+  EXPECT_EQ(f.raw(), table->LookupDispatchTarget(a, 101));
+  EXPECT(table->LookupDispatchTarget(a, 102) == Function::null());
+  EXPECT(table->LookupDispatchTarget(b, 100) == Function::null());
+
+  // The entry for class 100 is taken by the row of 'a', so the row of 'b'
+  // moves.
+  InsertMegamorphicTarget(b, 100, g);
+  EXPECT(a.row_offset() != b.row_offset());
+  EXPECT_EQ(f.raw(), table->LookupDispatchTarget(a, 100));
+  EXPECT_EQ(g.raw(), table->LookupDispatchTarget(b, 100));
+  InsertMegamorphicTarget(b, 102, g);
+  EXPECT_EQ(g.raw(), table->LookupDispatchTarget(b, 102));
+  EXPECT(table->LookupDispatchTarget(a, 102) == Function::null());
+
+  // Growing the table updates the table of every cache.
+  const Array& old_table = Array::Handle(table->dispatch_table());
+  InsertMegamorphicTarget(a, old_table.Length(), f);
+  EXPECT(table->dispatch_table() != old_table.raw());
+  EXPECT_EQ(table->dispatch_table(), a.dispatch_table());
+  EXPECT_EQ(table->dispatch_table(), b.dispatch_table());
+  EXPECT_EQ(f.raw(), table->LookupDispatchTarget(a, old_table.Length()));
+  EXPECT_EQ(f.raw(), table->LookupDispatchTarget(a, 101));
+  EXPECT_EQ(g.raw(), table->LookupDispatchTarget(b, 100));
+}
+
+
+TEST_CASE(MegamorphicDispatchTableCall) {
+  if (!FlowGraphCompiler::SupportsMegamorphicDispatchTable()) {
+    return;
+  }
+  const char* kScriptChars =
+      "class A0 { get id => 0; }\n"
+      "class A1 { get id => 1; }\n"
+      "class A2 { get id => 2; }\n"
+      "class A3 { get id => 3; }\n"
+      "class A4 { get id => 4; }\n"
+      "class A5 { get id => 5; }\n"
+      "sum(list) {\n"
+      "  var s = 0;\n"
+      "  for (var i = 0; i < list.length; i++) s += list[i].id;\n"
+      "  return s;\n"
+      "}\n"
+      "main() {\n"
+      "  var list = [new A0(), new A1(), new A2(),\n"
+      "              new A3(), new A4(), new A5()];\n"
+      "  var r;\n"
+      "  for (var i = 0; i < 10; i++) r = sum(list);\n"
+      "  return r;\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("main"), 0, NULL));
+  Library& library = Library::Handle();
+  library ^= Api::UnwrapHandle(lib);
+  const Function& sum = Function::Handle(
+      library.LookupLocalFunction(String::Handle(Symbols::New("sum"))));
+  EXPECT(!sum.IsNull());
+  // The call of 'id' has seen more receiver classes than polymorphic
+  // inlining handles, so optimized code calls it through the dispatch table.
+  EXPECT(Error::Handle(Compiler::CompileOptimizedFunction(sum)).IsNull());
+  EXPECT(sum.HasOptimizedCode());
+
+  // The first optimized calls miss and fill the row of the selector.
+  for (intptr_t i = 0; i < 2; i++) {
+    Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+    EXPECT_VALID(result);
+    int64_t value = 0;
+    EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+    EXPECT_EQ(15, value);
+  }
+  MegamorphicCacheTable* table = Isolate::Current()->megamorphic_cache_table();
+  const MegamorphicCache& cache = MegamorphicCache::Handle(
+      table->Lookup(String::Handle(Symbols::New("get:id")),
+                    Array::Handle(ArgumentsDescriptor::New(1))));
+  Class& cls = Class::Handle();
+  Function& target = Function::Handle();
+  char buffer[8];
+  for (intptr_t i = 0; i < 6; i++) {
+    OS::SNPrint(buffer, sizeof(buffer), "A%" Pd "", i);
+    cls = library.LookupClass(String::Handle(Symbols::New(buffer)));
+    EXPECT(!cls.IsNull());
+    target = table->LookupDispatchTarget(cache, cls.id());
+    EXPECT(!target.IsNull());
+    EXPECT_EQ(cls.raw(), target.Owner());
+  }
+}
+
+
+// Finalizing a class enters the compiled targets it inherits into the
+// existing megamorphic caches and their rows.
+TEST_CASE(MegamorphicDispatchTableClassFinalization) {
+  if (!FlowGraphCompiler::SupportsMegamorphicDispatchTable()) {
+    return;
+  }
+  const char* kScriptChars =
+      "class A { get id => 0; }\n"
+      "class B extends A { }\n"
+      "class C extends A { get id => 2; }\n"
+      "main() => new A().id;\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("main"), 0, NULL));
+  Isolate* isolate = Isolate::Current();
+  Library& library = Library::Handle();
+  library ^= Api::UnwrapHandle(lib);
+  const Class& a = Class::Handle(
+      library.LookupClass(String::Handle(Symbols::New("A"))));
+  const Class& b = Class::Handle(
+      library.LookupClass(String::Handle(Symbols::New("B"))));
+  const Class& c = Class::Handle(
+      library.LookupClass(String::Handle(Symbols::New("C"))));
+  EXPECT(!a.IsNull() && !b.IsNull() && !c.IsNull());
+  EXPECT(!b.is_finalized());
+  EXPECT(!c.is_finalized());
+
+  MegamorphicCacheTable* table = isolate->megamorphic_cache_table();
+  const MegamorphicCache& cache = MegamorphicCache::Handle(
+      table->Lookup(String::Handle(Symbols::New("get:id")),
+                    Array::Handle(ArgumentsDescriptor::New(1))));
+  EXPECT(Error::Handle(b.EnsureIsFinalized(isolate)).IsNull());
+  Function& target = Function::Handle(
+      table->LookupDispatchTarget(cache, b.id()));
+  EXPECT(!target.IsNull());
+  EXPECT_EQ(a.raw(), target.Owner());
+  // The getter of 'C' has not been compiled yet, the first call misses.
+  EXPECT(Error::Handle(c.EnsureIsFinalized(isolate)).IsNull());
+  EXPECT(table->LookupDispatchTarget(cache, c.id()) == Function::null());
+}
+
+
 TEST_CASE(SubtypeTestCache) {
   String& class_name = String::Handle(Symbols::New("EmptyClass"));
   Script& script = Script::Handle();
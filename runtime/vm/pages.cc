@@ -6,8 +6,10 @@
 
 #include "platform/assert.h"
 #include "vm/compiler_stats.h"
+#include "vm/gc_compactor.h"
 #include "vm/gc_marker.h"
 #include "vm/gc_sweeper.h"
+#include "vm/growable_array.h"
 #include "vm/object.h"
 #include "vm/virtual_memory.h"
 
@@ -31,6 +33,20 @@ DEFINE_FLAG(bool, log_code_drop, false,
             "Emit a log message when pointers to unused code are dropped.");
 DEFINE_FLAG(bool, always_drop_code, false,
             "Always try to drop code if the function's usage counter is >= 0");
+DEFINE_FLAG(bool, lazy_sweep, false,
+            "Sweep old space pages on demand when allocating, instead of "
+            "during the mark-sweep pause.");
+DEFINE_FLAG(int, sweeper_tasks, 1,
+            "Number of tasks used to sweep old space. Values larger than 1 "
+            "sweep pages in parallel using the VM thread pool.");
+DEFINE_FLAG(bool, compact_old_space, false,
+            "Evacuate sparsely used old space pages when old space is "
+            "fragmented.");
+DEFINE_FLAG(int, compaction_free_ratio, 50,
+            "The percentage of free space in old space pages after GC above "
+            "which the next GC compacts old space");
+DEFINE_FLAG(bool, card_marking, true,
+            "Remember stores into large arrays with a card table.");
 
 HeapPage* HeapPage::Initialize(VirtualMemory* memory, PageType type) {
   ASSERT(memory->size() > VirtualMemory::PageSize());
@@ -41,6 +57,7 @@ HeapPage* HeapPage::Initialize(VirtualMemory* memory, PageType type) {
   result->memory_ = memory;
   result->next_ = NULL;
   result->executable_ = is_executable;
+  result->card_table_ = NULL;
   return result;
 }
 
@@ -53,11 +70,53 @@ HeapPage* HeapPage::Allocate(intptr_t size_in_words, PageType type) {
 
 
 void HeapPage::Deallocate() {
+  free(card_table_);
   // The memory for this object will become unavailable after the delete below.
   delete memory_;
 }
 
 
+void HeapPage::AllocateCardTable() {
+  ASSERT(card_table_ == NULL);
+  card_table_ = reinterpret_cast<uint8_t*>(calloc(NumCards(), sizeof(uint8_t)));
+  if (card_table_ == NULL) {
+    FATAL("Out of memory.\n");
+  }
+}
+
+
+void HeapPage::ClearCards() {
+  ASSERT(card_table_ != NULL);
+  memset(card_table_, 0, NumCards());
+}
+
+
+void HeapPage::VisitRememberedCards(ObjectPointerVisitor* visitor) {
+  ASSERT(card_table_ != NULL);
+  RawArray* raw_array =
+      reinterpret_cast<RawArray*>(RawObject::FromAddr(object_start()));
+  ASSERT(raw_array->IsCardRemembered());
+  uword first = reinterpret_cast<uword>(raw_array->from());
+  uword last = reinterpret_cast<uword>(
+      raw_array->to(Smi::Value(raw_array->ptr()->length_)));
+  intptr_t num_cards = NumCards();
+  for (intptr_t i = 0; i < num_cards; i++) {
+    if (card_table_[i] == 0) {
+      continue;
+    }
+    card_table_[i] = 0;
+    uword card_start = object_start() + (i << kCardSizeLog2);
+    uword card_last = card_start + kCardSize - kWordSize;
+    uword from = Utils::Maximum(first, card_start);
+    uword to = Utils::Minimum(last, card_last);
+    if (from <= to) {
+      visitor->VisitPointers(reinterpret_cast<RawObject**>(from),
+                             reinterpret_cast<RawObject**>(to));
+    }
+  }
+}
+
+
 void HeapPage::VisitObjects(ObjectVisitor* visitor) const {
   uword obj_addr = object_start();
   uword end_addr = object_end();
@@ -124,10 +183,18 @@ PageSpace::PageSpace(Heap* heap, intptr_t max_capacity_in_words)
       max_capacity_in_words_(max_capacity_in_words),
       capacity_in_words_(0),
       used_in_words_(0),
+      bump_top_(0),
+      bump_end_(0),
       sweeping_(false),
+      sweep_previous_(NULL),
+      unswept_pages_(0),
+      marked_in_words_(0),
+      helper_marked_in_words_(0),
+      helper_swept_pages_(0),
       page_space_controller_(FLAG_heap_growth_space_ratio,
                              FLAG_heap_growth_rate,
-                             FLAG_heap_growth_time_ratio) {
+                             FLAG_heap_growth_time_ratio,
+                             FLAG_compaction_free_ratio) {
 }
 
 
@@ -208,6 +275,45 @@ void PageSpace::FreePages(HeapPage* pages) {
 }
 
 
+void PageSpace::SetBumpArea(uword start, uword end) {
+  ASSERT(start <= end);
+  AbandonBumpArea();
+  bump_top_ = start;
+  bump_end_ = end;
+  used_in_words_ += ((end - start) >> kWordSizeLog2);
+}
+
+
+void PageSpace::AbandonBumpArea() {
+  intptr_t remaining = bump_end_ - bump_top_;
+  if (remaining > 0) {
+    freelist_[HeapPage::kData].Free(bump_top_, remaining);
+    used_in_words_ -= (remaining >> kWordSizeLog2);
+  }
+  bump_top_ = 0;
+  bump_end_ = 0;
+}
+
+
+uword PageSpace::TryAllocateFromFreeList(intptr_t size,
+                                         HeapPage::PageType type) {
+  if ((type == HeapPage::kData) && (size <= (kBumpAreaSize / 4))) {
+    // Refill the bump allocation area instead of splitting a free list
+    // element for every small object.
+    uword area = freelist_[type].TryAllocate(kBumpAreaSize);
+    if (area != 0) {
+      SetBumpArea(area, area + kBumpAreaSize);
+      uword result = TryBumpAllocate(size);
+      ASSERT(result != 0);
+      // The object is already accounted for as part of the area.
+      used_in_words_ -= (size >> kWordSizeLog2);
+      return result;
+    }
+  }
+  return freelist_[type].TryAllocate(size);
+}
+
+
 uword PageSpace::TryAllocate(intptr_t size,
                              HeapPage::PageType type,
                              GrowthPolicy growth_policy) {
@@ -215,7 +321,18 @@ uword PageSpace::TryAllocate(intptr_t size,
   ASSERT(Utils::IsAligned(size, kObjectAlignment));
   uword result = 0;
   if (size < kAllocatablePageSize) {
-    result = freelist_[type].TryAllocate(size);
+    if (type == HeapPage::kData) {
+      result = TryBumpAllocate(size);
+      if (result != 0) {
+        // The bump allocation area is already accounted for as used.
+        ASSERT((result & kObjectAlignmentMask) == kOldObjectAlignmentOffset);
+        return result;
+      }
+    }
+    result = TryAllocateFromFreeList(size, type);
+    while ((result == 0) && SweepNextPage()) {
+      result = TryAllocateFromFreeList(size, type);
+    }
     if ((result == 0) &&
         (page_space_controller_.CanGrowPageSpace(size) ||
          growth_policy == kForceGrowth) &&
@@ -224,11 +341,16 @@ uword PageSpace::TryAllocate(intptr_t size,
       ASSERT(page != NULL);
       // Start of the newly allocated page is the allocated object.
       result = page->object_start();
-      // Enqueue the remainder in the free list.
       uword free_start = result + size;
-      intptr_t free_size = page->object_end() - free_start;
-      if (free_size > 0) {
-        freelist_[type].Free(free_start, free_size);
+      if (type == HeapPage::kData) {
+        // Bump allocate from the remainder of the page.
+        SetBumpArea(free_start, page->object_end());
+      } else {
+        // Enqueue the remainder in the free list.
+        intptr_t free_size = page->object_end() - free_start;
+        if (free_size > 0) {
+          freelist_[type].Free(free_start, free_size);
+        }
       }
     }
   } else {
@@ -315,7 +437,9 @@ void PageSpace::StartEndAddress(uword* start, uword* end) const {
 }
 
 
-void PageSpace::VisitObjects(ObjectVisitor* visitor) const {
+void PageSpace::VisitObjects(ObjectVisitor* visitor) {
+  CompleteSweep();
+  AbandonBumpArea();
   HeapPage* page = pages_;
   while (page != NULL) {
     page->VisitObjects(visitor);
@@ -330,7 +454,9 @@ void PageSpace::VisitObjects(ObjectVisitor* visitor) const {
 }
 
 
-void PageSpace::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
+void PageSpace::VisitObjectPointers(ObjectPointerVisitor* visitor) {
+  CompleteSweep();
+  AbandonBumpArea();
   HeapPage* page = pages_;
   while (page != NULL) {
     page->VisitObjectPointers(visitor);
@@ -374,6 +500,8 @@ RawObject* PageSpace::FindObject(FindObjectVisitor* visitor,
 
 
 void PageSpace::WriteProtect(bool read_only) {
+  CompleteSweep();
+  AbandonBumpArea();
   HeapPage* page = pages_;
   while (page != NULL) {
     page->WriteProtect(read_only);
@@ -387,6 +515,31 @@ void PageSpace::WriteProtect(bool read_only) {
 }
 
 
+void PageSpace::VisitCardRememberedObjects(ObjectVisitor* visitor) const {
+  HeapPage* page = large_pages_;
+  while (page != NULL) {
+    if (page->card_table_ != NULL) {
+      RawObject* raw_obj = RawObject::FromAddr(page->object_start());
+      if (!raw_obj->IsRemembered()) {
+        visitor->VisitObject(raw_obj);
+      }
+    }
+    page = page->next();
+  }
+}
+
+
+void PageSpace::ClearCards() {
+  HeapPage* page = large_pages_;
+  while (page != NULL) {
+    if (page->card_table_ != NULL) {
+      page->ClearCards();
+    }
+    page = page->next();
+  }
+}
+
+
 bool PageSpace::ShouldCollectCode() {
   // Try to collect code if enough time has passed since the last attempt.
   const int64_t start = OS::GetCurrentTimeMicros();
@@ -413,6 +566,11 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
 
   NoHandleScope no_handles(isolate);
 
+  // Clear the mark bits left on the pages which have not been swept yet.
+  CompleteSweep();
+  // The sweeper needs to walk over the unused part of the bump area.
+  AbandonBumpArea();
+
   if (FLAG_print_free_list_before_gc) {
     OS::Print("Data Freelist (before GC):\n");
     freelist_[HeapPage::kData].Print();
@@ -432,6 +590,8 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
   bool collect_code = FLAG_collect_code && ShouldCollectCode();
   GCMarker marker(heap_);
   marker.MarkObjects(isolate, this, invoke_api_callbacks, collect_code);
+  marked_in_words_ = marker.marked_words();
+  helper_marked_in_words_ += marker.helper_marked_words();
 
   int64_t mid1 = OS::GetCurrentTimeMicros();
 
@@ -442,22 +602,68 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
 
   int64_t mid2 = OS::GetCurrentTimeMicros();
 
+  // Take the sparsely used pages out of the page list before sweeping, their
+  // live objects are evacuated into the swept pages below.
+  GrowableArray<HeapPage*> evacuation_candidates;
+  if (FLAG_compact_old_space &&
+      !FLAG_lazy_sweep &&
+      page_space_controller_.should_compact()) {
+    SelectEvacuationCandidates(&evacuation_candidates);
+  }
+
   GCSweeper sweeper(heap_);
   intptr_t used_in_words = 0;
+  intptr_t sweeper_tasks = FLAG_sweeper_tasks;
 
   HeapPage* prev_page = NULL;
   HeapPage* page = pages_;
-  while (page != NULL) {
-    HeapPage* next_page = page->next();
-    intptr_t page_in_use = sweeper.SweepPage(page, &freelist_[page->type()]);
-    if (page_in_use == 0) {
-      FreePage(page, prev_page);
-    } else {
-      used_in_words += (page_in_use >> kWordSizeLog2);
-      prev_page = page;
+  if (FLAG_lazy_sweep) {
+    // Leave the pages to TryAllocate. The live size is known from marking.
+    sweep_previous_ = NULL;
+    unswept_pages_ = 0;
+    for (page = pages_; page != NULL; page = page->next()) {
+      unswept_pages_++;
+    }
+  } else if (sweeper_tasks > 1) {
+    used_in_words += SweepPagesInParallel(&sweeper, sweeper_tasks);
+  } else {
+    while (page != NULL) {
+      HeapPage* next_page = page->next();
+      intptr_t page_in_use = sweeper.SweepPage(page, &freelist_[page->type()]);
+      if (page_in_use == 0) {
+        FreePage(page, prev_page);
+      } else {
+        used_in_words += (page_in_use >> kWordSizeLog2);
+        prev_page = page;
+      }
+      // Advance to the next page.
+      page = next_page;
+    }
+  }
+
+  // The time spent compacting is recorded as part of sweeping the pages.
+  if (evacuation_candidates.length() > 0) {
+    GCCompactor compactor(heap_, this);
+    intptr_t evacuated =
+        compactor.EvacuatePages(isolate, evacuation_candidates);
+    used_in_words += (evacuated >> kWordSizeLog2);
+    // Leave the pages the survivors were copied to iterable.
+    AbandonBumpArea();
+    for (intptr_t i = 0; i < evacuation_candidates.length(); i++) {
+      page = evacuation_candidates[i];
+      capacity_in_words_ -= (page->memory_->size() >> kWordSizeLog2);
+      page->Deallocate();
     }
-    // Advance to the next page.
-    page = next_page;
+  }
+
+  // Record the fragmentation of the regular pages.
+  if (!FLAG_lazy_sweep) {
+    intptr_t regular_capacity_in_words = 0;
+    for (page = pages_; page != NULL; page = page->next()) {
+      regular_capacity_in_words += (page->memory_->size() >> kWordSizeLog2);
+    }
+    page_space_controller_.EvaluateFragmentation(used_in_words,
+                                                 regular_capacity_in_words);
   }
 
   int64_t mid3 = OS::GetCurrentTimeMicros();
@@ -476,6 +682,10 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
     // Advance to the next page.
     page = next_page;
   }
+  if (FLAG_lazy_sweep) {
+    // The marked size includes the objects on large pages.
+    used_in_words = marker.marked_words();
+  }
 
   // Record data and print if requested.
   intptr_t used_before_in_words = used_in_words_;
@@ -512,15 +722,133 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
 }
 
 
+intptr_t PageSpace::SweepPagesInParallel(GCSweeper* sweeper,
+                                         intptr_t num_tasks) {
+  intptr_t num_pages = 0;
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    num_pages++;
+  }
+  HeapPage** pages = new HeapPage*[num_pages];
+  intptr_t* in_use = new intptr_t[num_pages];
+  intptr_t i = 0;
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    pages[i++] = page;
+  }
+  helper_swept_pages_ += sweeper->SweepPages(
+      Isolate::Current(), pages, in_use, num_pages, freelist_, num_tasks);
+
+  // Free the empty pages.
+  intptr_t used_in_words = 0;
+  HeapPage* prev_page = NULL;
+  for (i = 0; i < num_pages; i++) {
+    if (in_use[i] == 0) {
+      FreePage(pages[i], prev_page);
+    } else {
+      used_in_words += (in_use[i] >> kWordSizeLog2);
+      prev_page = pages[i];
+    }
+  }
+  delete[] pages;
+  delete[] in_use;
+  return used_in_words;
+}
+
+
+void PageSpace::SelectEvacuationCandidates(
+    GrowableArray<HeapPage*>* candidates) {
+  intptr_t marked_in_words = 0;
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    if (page->type() != HeapPage::kData) {
+      continue;
+    }
+    intptr_t page_size = page->object_end() - page->object_start();
+    intptr_t marked = GCCompactor::MarkedSize(page);
+    if ((marked * 100) < (page_size * kEvacuationOccupancyRatio)) {
+      candidates->Add(page);
+      marked_in_words += (marked >> kWordSizeLog2);
+    }
+  }
+  // Moving the objects of a single page does not release any memory. The
+  // evacuation may need new pages before the candidates are released.
+  if ((candidates->length() < 2) ||
+      !CanIncreaseCapacityInWords(
+          Utils::RoundUp(marked_in_words, kPageSizeInWords))) {
+    candidates->Clear();
+    return;
+  }
+  // Unlink the candidates, which appear in page list order.
+  intptr_t next_candidate = 0;
+  HeapPage* prev_page = NULL;
+  HeapPage* page = pages_;
+  while (page != NULL) {
+    HeapPage* next_page = page->next();
+    if ((next_candidate < candidates->length()) &&
+        (page == (*candidates)[next_candidate])) {
+      if (prev_page != NULL) {
+        prev_page->set_next(next_page);
+      } else {
+        pages_ = next_page;
+      }
+      if (page == pages_tail_) {
+        pages_tail_ = prev_page;
+      }
+      page->set_next(NULL);
+      next_candidate++;
+    } else {
+      prev_page = page;
+    }
+    page = next_page;
+  }
+  ASSERT(next_candidate == candidates->length());
+}
+
+
+bool PageSpace::SweepNextPage() {
+  if (unswept_pages_ == 0) {
+    return false;
+  }
+  HeapPage* page = (sweep_previous_ == NULL) ? pages_ : sweep_previous_->next();
+  ASSERT(page != NULL);
+  GCSweeper sweeper(heap_);
+  intptr_t page_in_use = sweeper.SweepPage(page, &freelist_[page->type()]);
+  if (page_in_use == 0) {
+    FreePage(page, sweep_previous_);
+  } else {
+    sweep_previous_ = page;
+  }
+  unswept_pages_--;
+  return true;
+}
+
+
+void PageSpace::CompleteSweep() {
+  while (SweepNextPage()) {
+  }
+}
+
+
+bool PageSpace::SweepUntil(int64_t deadline) {
+  while (OS::GetCurrentTimeMicros() < deadline) {
+    if (!SweepNextPage()) {
+      return true;
+    }
+  }
+  return unswept_pages_ == 0;
+}
+
+
 PageSpaceController::PageSpaceController(int heap_growth_ratio,
                                          int heap_growth_rate,
-                                         int garbage_collection_time_ratio)
+                                         int garbage_collection_time_ratio,
+                                         int compaction_free_ratio)
     : is_enabled_(false),
       grow_heap_(heap_growth_rate),
       heap_growth_ratio_(heap_growth_ratio),
       desired_utilization_((100.0 - heap_growth_ratio) / 100.0),
       heap_growth_rate_(heap_growth_rate),
       garbage_collection_time_ratio_(garbage_collection_time_ratio),
+      compaction_free_ratio_(compaction_free_ratio),
+      should_compact_(false),
       last_code_collection_in_us_(OS::GetCurrentTimeMicros()) {
 }
 
@@ -585,6 +913,20 @@ void PageSpaceController::EvaluateGarbageCollection(
 }
 
 
+void PageSpaceController::EvaluateFragmentation(intptr_t used_in_words,
+                                                intptr_t capacity_in_words) {
+  ASSERT(used_in_words <= capacity_in_words);
+  if (capacity_in_words == 0) {
+    should_compact_ = false;
+    return;
+  }
+  int free_ratio = static_cast<int>(
+      (static_cast<double>(capacity_in_words - used_in_words) /
+       static_cast<double>(capacity_in_words)) * 100.0);
+  should_compact_ = (free_ratio > compaction_free_ratio_);
+}
+
+
 PageSpaceGarbageCollectionHistory::PageSpaceGarbageCollectionHistory()
     : index_(0) {
   for (intptr_t i = 0; i < kHistoryLength; i++) {
@@ -14,8 +14,15 @@ namespace dart {
 DECLARE_FLAG(bool, collect_code);
 DECLARE_FLAG(bool, log_code_drop);
 DECLARE_FLAG(bool, always_drop_code);
+DECLARE_FLAG(int, marker_tasks);
+DECLARE_FLAG(bool, lazy_sweep);
+DECLARE_FLAG(int, sweeper_tasks);
+DECLARE_FLAG(bool, compact_old_space);
+DECLARE_FLAG(bool, card_marking);
 
 // Forward declarations.
+class GCSweeper;
+template <typename T> class GrowableArray;
 class Heap;
 class ObjectPointerVisitor;
 
@@ -57,6 +64,44 @@ class HeapPage {
     return Utils::RoundUp(sizeof(HeapPage), OS::kMaxPreferredCodeAlignment);
   }
 
+  // Large arrays are remembered with a card table instead of the store
+  // buffer. Every card covers kCardSize bytes of the array and is dirty if
+  // its slots may refer to new space.
+  static const intptr_t kCardSizeLog2 = 9;
+  static const intptr_t kCardSize = 1 << kCardSizeLog2;
+
+  // A card remembered array is the only object on its large page.
+  static HeapPage* OfCardRemembered(RawObject* raw_obj) {
+    ASSERT(raw_obj->IsCardRemembered());
+    return reinterpret_cast<HeapPage*>(
+        RawObject::ToAddr(raw_obj) - ObjectStartOffset());
+  }
+
+  void AllocateCardTable();
+  void RememberCard(uword slot) {
+    ASSERT(card_table_ != NULL);
+    ASSERT((slot >= object_start()) && (slot < object_end()));
+    card_table_[(slot - object_start()) >> kCardSizeLog2] = 1;
+  }
+  void ClearCards();
+  intptr_t NumCards() const {
+    return (object_end() - object_start() + kCardSize - 1) >> kCardSizeLog2;
+  }
+  bool IsCardDirty(intptr_t index) const {
+    ASSERT((index >= 0) && (index < NumCards()));
+    return card_table_[index] != 0;
+  }
+
+  // Visits the pointers covered by the dirty cards of the card remembered
+  // array on this page. The cards are cleaned before their pointers are
+  // visited, so visitors dirty them again for the slots which still refer
+  // to new space.
+  void VisitRememberedCards(ObjectPointerVisitor* visitor);
+
+  static intptr_t card_table_offset() {
+    return OFFSET_OF(HeapPage, card_table_);
+  }
+
  private:
   void set_object_end(uword val) {
     ASSERT((val & kObjectAlignmentMask) == kOldObjectAlignmentOffset);
@@ -74,6 +119,7 @@ class HeapPage {
   HeapPage* next_;
   uword object_end_;
   bool executable_;
+  uint8_t* card_table_;
 
   friend class PageSpace;
 
@@ -112,11 +158,18 @@ class PageSpaceController {
  public:
   PageSpaceController(int heap_growth_ratio,
                       int heap_growth_rate,
-                      int garbage_collection_time_ratio);
+                      int garbage_collection_time_ratio,
+                      int compaction_free_ratio);
   ~PageSpaceController();
 
   bool CanGrowPageSpace(intptr_t size_in_bytes);
 
+  // True if the page space can not grow any more before the next garbage
+  // collection.
+  bool NeedsGarbageCollection() const {
+    return is_enabled_ && (heap_growth_ratio_ != 100) && (grow_heap_ <= 0);
+  }
+
   // A garbage collection is considered as successful if more than
   // heap_growth_ratio % of memory got deallocated by the garbage collector.
   // In this case garbage collection will be performed next time. Otherwise
@@ -125,6 +178,13 @@ class PageSpaceController {
                                  intptr_t used_after_in_words,
                                  int64_t start, int64_t end);
 
+  // The regular pages are considered fragmented if more than
+  // compaction_free_ratio % of their capacity is free after a garbage
+  // collection. In this case the next garbage collection compacts them.
+  void EvaluateFragmentation(intptr_t used_in_words,
+                             intptr_t capacity_in_words);
+  bool should_compact() const { return should_compact_; }
+
   int64_t last_code_collection_in_us() { return last_code_collection_in_us_; }
   void set_last_code_collection_in_us(int64_t t) {
     last_code_collection_in_us_ = t;
@@ -158,6 +218,10 @@ class PageSpaceController {
   // garbage collection can be performed.
   int garbage_collection_time_ratio_;
 
+  // Percentage of free space in the regular pages triggering a compaction.
+  int compaction_free_ratio_;
+  bool should_compact_;
+
   // The time in microseconds of the last time we tried to collect unused
   // code.
   int64_t last_code_collection_in_us_;
@@ -185,7 +249,10 @@ class PageSpace {
                     HeapPage::PageType type = HeapPage::kData,
                     GrowthPolicy growth_policy = kControlGrowth);
 
-  intptr_t UsedInWords() const { return used_in_words_; }
+  // The unused part of the current bump allocation area is not in use.
+  intptr_t UsedInWords() const {
+    return used_in_words_ - ((bump_end_ - bump_top_) >> kWordSizeLog2);
+  }
   intptr_t CapacityInWords() const { return capacity_in_words_; }
 
   bool Contains(uword addr) const;
@@ -194,8 +261,10 @@ class PageSpace {
     return Contains(addr);
   }
 
-  void VisitObjects(ObjectVisitor* visitor) const;
-  void VisitObjectPointers(ObjectPointerVisitor* visitor) const;
+  // Visiting the objects completes any pending lazy sweeping first, so that
+  // visitors do not see unreachable objects.
+  void VisitObjects(ObjectVisitor* visitor);
+  void VisitObjectPointers(ObjectPointerVisitor* visitor);
 
   RawObject* FindObject(FindObjectVisitor* visitor,
                         HeapPage::PageType type) const;
@@ -207,6 +276,26 @@ class PageSpace {
   // Collect the garbage in the page space using mark-sweep.
   void MarkSweep(bool invoke_api_callbacks);
 
+  // Sweep all pages left unswept by the last MarkSweep when sweeping lazily.
+  void CompleteSweep();
+  // Sweep the pages left unswept by the last MarkSweep until 'deadline' (as
+  // returned by OS::GetCurrentTimeMicros) has passed. Returns true if all
+  // pages have been swept.
+  bool SweepUntil(int64_t deadline);
+  // Pages left unswept by the last MarkSweep when sweeping lazily.
+  intptr_t unswept_pages() const { return unswept_pages_; }
+
+  // Words marked by the last MarkSweep.
+  intptr_t marked_in_words() const { return marked_in_words_; }
+  // Work done by the helper tasks of parallel marking and sweeping in all
+  // collections so far.
+  intptr_t helper_marked_in_words() const { return helper_marked_in_words_; }
+  intptr_t helper_swept_pages() const { return helper_swept_pages_; }
+
+  bool NeedsGarbageCollection() const {
+    return page_space_controller_.NeedsGarbageCollection();
+  }
+
   void StartEndAddress(uword* start, uword* end) const;
 
   void SetGrowthControlState(bool state) {
@@ -219,6 +308,27 @@ class PageSpace {
 
   void WriteProtect(bool read_only);
 
+  // Objects of at least this size are allocated on their own large page.
+  static bool IsLargeObjectSize(intptr_t size) {
+    return size >= kAllocatablePageSize;
+  }
+
+  // Visits the card remembered arrays which are not in the store buffer.
+  // Remembered arrays are visited as a whole, which covers all of their
+  // cards.
+  void VisitCardRememberedObjects(ObjectVisitor* visitor) const;
+  void ClearCards();
+
+  // Return the unused part of the bump allocation area to the free list, so
+  // that the data pages can be iterated.
+  void AbandonBumpArea();
+
+  // Accessors to generate code for inlined allocation of data objects.
+  uword* TopAddress() { return &bump_top_; }
+  uword* EndAddress() { return &bump_end_; }
+  static intptr_t top_offset() { return OFFSET_OF(PageSpace, bump_top_); }
+  static intptr_t end_offset() { return OFFSET_OF(PageSpace, bump_end_); }
+
  private:
   // Ids for time and data records in Heap::GCStats.
   enum {
@@ -236,12 +346,43 @@ class PageSpace {
 
   static const intptr_t kAllocatablePageSize = 64 * KB;
 
+  // Size of the blocks taken from the data free list for bump allocation.
+  // Only objects of at most a quarter of it are bump allocated, so that large
+  // allocations do not drain the area.
+  static const intptr_t kBumpAreaSize = 16 * KB;
+
+  // Data pages with less than this percentage in use are evacuated when
+  // compacting.
+  static const intptr_t kEvacuationOccupancyRatio = 50;
+
   HeapPage* AllocatePage(HeapPage::PageType type);
   void FreePage(HeapPage* page, HeapPage* previous_page);
   HeapPage* AllocateLargePage(intptr_t size, HeapPage::PageType type);
   void FreeLargePage(HeapPage* page, HeapPage* previous_page);
   void FreePages(HeapPage* pages);
 
+  // Removes the sparsely used data pages from the page list and adds them to
+  // 'candidates', if compacting them is worthwhile.
+  void SelectEvacuationCandidates(GrowableArray<HeapPage*>* candidates);
+
+  // Sweep the next page left unswept by the last MarkSweep. Returns false if
+  // there is no such page.
+  bool SweepNextPage();
+  intptr_t SweepPagesInParallel(GCSweeper* sweeper, intptr_t num_tasks);
+
+  uword TryAllocateFromFreeList(intptr_t size, HeapPage::PageType type);
+  uword TryBumpAllocate(intptr_t size) {
+    uword result = bump_top_;
+    if ((bump_end_ - result) < static_cast<uword>(size)) {
+      return 0;
+    }
+    bump_top_ = result + size;
+    return result;
+  }
+  // Abandons the current bump allocation area and starts allocating from
+  // [start, end), which is accounted as used until abandoned.
+  void SetBumpArea(uword start, uword end);
+
   static intptr_t LargePageSizeInWordsFor(intptr_t size);
 
   bool CanIncreaseCapacityInWords(intptr_t increase_in_words) {
@@ -262,9 +403,24 @@ class PageSpace {
   intptr_t capacity_in_words_;
   intptr_t used_in_words_;
 
+  // Bump allocation area for data objects carved out of the free list. The
+  // whole area is counted in used_in_words_.
+  uword bump_top_;
+  uword bump_end_;
+
   // Keep track whether a MarkSweep is currently running.
   bool sweeping_;
 
+  // Pages still to be swept lazily. They follow sweep_previous_, or start the
+  // page list if sweep_previous_ is NULL. Pages allocated after the last
+  // MarkSweep are appended to the list and never need sweeping.
+  HeapPage* sweep_previous_;
+  intptr_t unswept_pages_;
+
+  intptr_t marked_in_words_;
+  intptr_t helper_marked_in_words_;
+  intptr_t helper_swept_pages_;
+
   PageSpaceController page_space_controller_;
 
   friend class PageSpaceController;
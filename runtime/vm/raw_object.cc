@@ -47,16 +47,24 @@ void RawObject::Validate(Isolate* isolate) const {
 
 
 intptr_t RawObject::SizeFromClass() const {
+  intptr_t instance_size = SizeFromClass(GetClassId());
+  uword tags = ptr()->tags_;
+  ASSERT((instance_size == SizeTag::decode(tags)) ||
+         (SizeTag::decode(tags) == 0));
+  return instance_size;
+}
+
+
+intptr_t RawObject::SizeFromClass(intptr_t class_id) const {
   Isolate* isolate = Isolate::Current();
   NoHandleScope no_handles(isolate);
 
   // Only reasonable to be called on heap objects.
   ASSERT(IsHeapObject());
 
-  RawClass* raw_class = isolate->class_table()->At(GetClassId());
+  RawClass* raw_class = isolate->class_table()->At(class_id);
   intptr_t instance_size =
       raw_class->ptr()->instance_size_in_words_ << kWordSizeLog2;
-  intptr_t class_id = raw_class->ptr()->id_;
 
   if (instance_size == 0) {
     switch (class_id) {
@@ -120,9 +128,9 @@ intptr_t RawObject::SizeFromClass() const {
       CLASS_LIST_TYPED_DATA(SIZE_FROM_CLASS) {
         const RawTypedData* raw_obj =
             reinterpret_cast<const RawTypedData*>(this);
-        intptr_t cid = raw_obj->GetClassId();
         intptr_t array_len = Smi::Value(raw_obj->ptr()->length_);
-        intptr_t lengthInBytes = array_len * TypedData::ElementSizeInBytes(cid);
+        intptr_t lengthInBytes =
+            array_len * TypedData::ElementSizeInBytes(class_id);
         instance_size = TypedData::InstanceSize(lengthInBytes);
         break;
       }
@@ -187,9 +195,6 @@ intptr_t RawObject::SizeFromClass() const {
     }
   }
   ASSERT(instance_size != 0);
-  uword tags = ptr()->tags_;
-  ASSERT((instance_size == SizeTag::decode(tags)) ||
-         (SizeTag::decode(tags) == 0));
   return instance_size;
 }
 
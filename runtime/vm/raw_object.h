@@ -228,8 +228,9 @@ class RawObject {
     kCanonicalBit = 2,
     kFromSnapshotBit = 3,
     kRememberedBit = 4,
-    kReservedTagBit = 5,  // kReservedBit{10K,100K,1M,10M}
-    kReservedTagSize = 3,
+    kCardRememberedBit = 5,
+    kReservedTagBit = 6,  // kReservedBit{10K,100K}
+    kReservedTagSize = 2,
     kSizeTagBit = 8,
     kSizeTagSize = 8,
     kClassIdTagBit = kSizeTagBit + kSizeTagSize,
@@ -348,6 +349,21 @@ class RawObject {
     ptr()->tags_ = RememberedBit::update(false, tags);
   }
 
+  // Support for card marking. Old objects with this bit set are remembered
+  // by dirtying the cards of their large page holding the stored slots.
+  bool IsCardRemembered() const {
+    return CardRememberedBit::decode(ptr()->tags_);
+  }
+  void SetCardRememberedBit() {
+    ASSERT(!IsCardRemembered());
+    uword tags = ptr()->tags_;
+    ptr()->tags_ = CardRememberedBit::update(true, tags);
+  }
+  void ClearCardRememberedBit() {
+    uword tags = ptr()->tags_;
+    ptr()->tags_ = CardRememberedBit::update(false, tags);
+  }
+
   bool IsDartInstance() {
     return (!IsHeapObject() || (GetClassId() >= kInstanceCid));
   }
@@ -367,6 +383,17 @@ class RawObject {
     return result;
   }
 
+  // Returns the size of this object as described by 'tags', a header value
+  // read earlier. Used by parallel GC tasks which may observe the header being
+  // replaced by a forwarding address while they are looking at the object.
+  intptr_t SizeFromTags(uword tags) const {
+    intptr_t result = SizeTag::decode(tags);
+    if (result != 0) {
+      return result;
+    }
+    return SizeFromClass(ClassIdTag::decode(tags));
+  }
+
   void Validate(Isolate* isolate) const;
   intptr_t VisitPointers(ObjectPointerVisitor* visitor);
   bool FindObject(FindObjectVisitor* visitor);
@@ -414,6 +441,8 @@ class RawObject {
 
   class RememberedBit : public BitField<bool, kRememberedBit, 1> {};
 
+  class CardRememberedBit : public BitField<bool, kCardRememberedBit, 1> {};
+
   class CanonicalObjectTag : public BitField<bool, kCanonicalBit, 1> {};
 
   class CreatedFromSnapshotTag : public BitField<bool, kFromSnapshotBit, 1> {};
@@ -429,6 +458,7 @@ class RawObject {
   }
 
   intptr_t SizeFromClass() const;
+  intptr_t SizeFromClass(intptr_t class_id) const;
 
   intptr_t GetClassId() const {
     uword tags = ptr()->tags_;
@@ -446,6 +476,7 @@ class RawObject {
   friend class MarkingVisitor;
   friend class Object;
   friend class ObjectHistogram;
+  friend class ParallelScavengerVisitor;
   friend class RawExternalTypedData;
   friend class RawInstructions;
   friend class RawInstance;
@@ -491,9 +522,11 @@ class RawClass : public RawObject {
   RawArray* constants_;  // Canonicalized values of this class.
   RawArray* canonical_types_;  // Canonicalized types of this class.
   RawArray* invocation_dispatcher_cache_;   // Cache for dispatcher functions.
+  RawArray* dependent_code_;  // Code allocating pretenured instances.
   RawCode* allocation_stub_;  // Stub code for allocation of instances.
+  RawCode* pretenured_allocation_stub_;  // Allocates instances in old space.
   RawObject** to() {
-    return reinterpret_cast<RawObject**>(&ptr()->allocation_stub_);
+    return reinterpret_cast<RawObject**>(&ptr()->pretenured_allocation_stub_);
   }
 
   cpp_vtable handle_vtable_;
@@ -700,7 +733,8 @@ class RawField : public RawObject {
   intptr_t guarded_cid_;
   intptr_t is_nullable_;  // kNullCid if field can contain null value and
                           // any other value otherwise.
-  uint8_t kind_bits_;  // static, final, const, has initializer.
+  uint8_t kind_bits_;  // static, final, const, has initializer,
+                       // unboxing candidate.
 };
 
 
@@ -1049,7 +1083,7 @@ class RawICData : public RawObject {
   }
   intptr_t deopt_id_;          // Deoptimization id corresponding to this IC.
   intptr_t num_args_tested_;   // Number of arguments tested in IC.
-  uint8_t deopt_reason_;       // Last deoptimization reason.
+  uint32_t deopt_reasons_;     // Bitmask of deoptimization reasons.
   uint8_t is_closure_call_;    // 0 or 1.
 };
 
@@ -1062,8 +1096,10 @@ class RawMegamorphicCache : public RawObject {
   }
   RawArray* buckets_;
   RawSmi* mask_;
+  RawArray* dispatch_table_;
+  RawSmi* row_offset_;
   RawObject** to() {
-    return reinterpret_cast<RawObject**>(&ptr()->mask_);
+    return reinterpret_cast<RawObject**>(&ptr()->row_offset_);
   }
 
   intptr_t filled_entry_count_;
@@ -1381,6 +1417,7 @@ class RawArray : public RawInstance {
   friend class RawImmutableArray;
   friend class SnapshotReader;
   friend class GrowableObjectArray;
+  friend class HeapPage;
   friend class Object;
 };
 
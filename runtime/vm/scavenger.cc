@@ -8,12 +8,15 @@
 #include <map>
 #include <utility>
 
+#include "vm/atomic.h"
 #include "vm/dart.h"
 #include "vm/dart_api_state.h"
+#include "vm/freelist.h"
 #include "vm/isolate.h"
 #include "vm/object.h"
 #include "vm/stack_frame.h"
 #include "vm/store_buffer.h"
+#include "vm/thread_pool.h"
 #include "vm/verifier.h"
 #include "vm/visitor.h"
 #include "vm/weak_table.h"
@@ -21,6 +24,15 @@
 
 namespace dart {
 
+DEFINE_FLAG(int, scavenger_tasks, 1,
+            "Number of tasks used to scavenge new space. Values larger than 1 "
+            "copy objects in parallel using the VM thread pool.");
+DEFINE_FLAG(int, new_gen_target_pause_micros, 0,
+            "Target scavenge pause in microseconds. When positive, the "
+            "semispaces grow and shrink to meet it, up to the size given by "
+            "new_gen_heap_size.");
+DECLARE_FLAG(bool, pretenure);
+
 // Scavenger uses RawObject::kMarkBit to distinguish forwaded and non-forwarded
 // objects. The kMarkBit does not intersect with the target address because of
 // object alignment.
@@ -51,6 +63,13 @@ static inline void ForwardTo(uword orignal, uword target) {
 }
 
 
+// During a parallel scavenge the task copying an object first claims it by
+// installing this header value, a forwarding pointer without a target. Other
+// tasks reaching the object wait until the actual forwarding address has been
+// installed.
+static const uword kClaimedForwarding = kForwarded;
+
+
 class BoolScope : public ValueObject {
  public:
   BoolScope(bool* addr, bool value) : _addr(addr), _value(*addr) {
@@ -79,7 +98,13 @@ class ScavengerVisitor : public ObjectPointerVisitor {
         growth_policy_(PageSpace::kControlGrowth),
         bytes_promoted_(0),
         visiting_old_object_(NULL),
-        in_scavenge_pointer_(false) { }
+        in_scavenge_pointer_(false) {
+    // A parallel scavenge which preceded this visitor may already have run
+    // into a promotion failure.
+    if (scavenger->had_promotion_failure_) {
+      growth_policy_ = PageSpace::kForceGrowth;
+    }
+  }
 
   void VisitPointers(RawObject** first, RawObject** last) {
     for (RawObject** current = first; current <= last; current++) {
@@ -127,7 +152,14 @@ class ScavengerVisitor : public ObjectPointerVisitor {
     ASSERT(!heap_->CodeContains(ptr));
     ASSERT(heap_->Contains(ptr));
     // If the newly written object is not a new object, drop it immediately.
-    if (!obj->IsNewObject() || visiting_old_object_->IsRemembered()) {
+    if (!obj->IsNewObject()) {
+      return;
+    }
+    if (visiting_old_object_->IsCardRemembered()) {
+      HeapPage::OfCardRemembered(visiting_old_object_)->RememberCard(ptr);
+      return;
+    }
+    if (visiting_old_object_->IsRemembered()) {
       return;
     }
     visiting_old_object_->SetRememberedBit();
@@ -259,6 +291,586 @@ class ScavengerVisitor : public ObjectPointerVisitor {
 };
 
 
+class ParallelScavengerVisitor;
+
+
+// A unit of work shared between the tasks of a parallel scavenge. It is
+// either a range of to-space holding copied objects which have not been
+// scanned yet, or a block of objects whose pointers still need to be visited.
+class ParallelScavengeWork {
+ public:
+  ParallelScavengeWork(uword start, uword end)
+      : start_(start),
+        end_(end),
+        objects_(NULL),
+        from_store_buffer_(false),
+        next_(NULL) { }
+  ParallelScavengeWork(StoreBufferBlock* objects, bool from_store_buffer)
+      : start_(0),
+        end_(0),
+        objects_(objects),
+        from_store_buffer_(from_store_buffer),
+        next_(NULL) { }
+
+  uword start() const { return start_; }
+  uword end() const { return end_; }
+  StoreBufferBlock* objects() const { return objects_; }
+  bool from_store_buffer() const { return from_store_buffer_; }
+
+  ParallelScavengeWork* next() const { return next_; }
+  void set_next(ParallelScavengeWork* next) { next_ = next; }
+
+ private:
+  uword start_;
+  uword end_;
+  StoreBufferBlock* objects_;
+  bool from_store_buffer_;
+  ParallelScavengeWork* next_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelScavengeWork);
+};
+
+
+// Shared state of a parallel scavenge: the work list, termination detection
+// and the results handed back by the tasks. The mutator thread participates
+// as one of the tasks.
+// Helper tasks run with the isolate set as their current isolate, so locking
+// uses the platform scopes which, unlike MonitorLocker, do not register as
+// stack resources of the isolate.
+class ParallelScavenge : public ValueObject {
+ public:
+  ParallelScavenge(Isolate* isolate, Scavenger* scavenger)
+      : isolate_(isolate),
+        scavenger_(scavenger),
+        work_(NULL),
+        running_tasks_(1),
+        idle_tasks_(0),
+        pending_tasks_(0),
+        done_(false),
+        growth_policy_(PageSpace::kControlGrowth),
+        remembered_(NULL),
+        weak_properties_(NULL),
+        store_buffer_visited_(0),
+        store_buffer_handled_(0),
+        bytes_promoted_(0) { }
+
+  ~ParallelScavenge() {
+    ASSERT(work_ == NULL);
+    ASSERT(pending_tasks_ == 0);
+  }
+
+  Isolate* isolate() const { return isolate_; }
+  Scavenger* scavenger() const { return scavenger_; }
+
+  // Called by a helper task before it starts working. Returns false if the
+  // scavenge has already completed without it.
+  bool EnterTask() {
+    ScopedMonitor ml(&monitor_);
+    if (done_) {
+      return false;
+    }
+    running_tasks_++;
+    return true;
+  }
+
+  // Called by every task, including the mutator, once it has run out of work.
+  void ExitTask(ParallelScavengerVisitor* visitor, bool is_helper);
+
+  void StartHelpers(intptr_t num_helpers) {
+    {
+      ScopedMonitor ml(&monitor_);
+      pending_tasks_ += num_helpers;
+    }
+    for (intptr_t i = 0; i < num_helpers; i++) {
+      Dart::thread_pool()->Run(new ParallelScavengeTask(this));
+    }
+  }
+
+  // Waits until all helper tasks have handed back their results.
+  void WaitForHelpers() {
+    ScopedMonitor ml(&monitor_);
+    while (pending_tasks_ > 0) {
+      ml.Wait();
+    }
+  }
+
+  void AddWork(ParallelScavengeWork* work) {
+    ScopedMonitor ml(&monitor_);
+    work->set_next(work_);
+    work_ = work;
+    if (idle_tasks_ > 0) {
+      ml.Notify();
+    }
+  }
+
+  // Returns the next unit of work, waiting for other tasks to produce some
+  // if necessary. Returns NULL once all tasks are idle and no work is left.
+  ParallelScavengeWork* TakeWork() {
+    ScopedMonitor ml(&monitor_);
+    while (true) {
+      if (work_ != NULL) {
+        ParallelScavengeWork* result = work_;
+        work_ = result->next();
+        result->set_next(NULL);
+        return result;
+      }
+      if (done_) {
+        return NULL;
+      }
+      idle_tasks_++;
+      if (idle_tasks_ == running_tasks_) {
+        done_ = true;
+        ml.NotifyAll();
+        return NULL;
+      }
+      ml.Wait();
+      idle_tasks_--;
+    }
+  }
+
+  // Racy by design: only used as a hint whether sharing local work pays off.
+  bool HasIdleTasks() const { return idle_tasks_ > 0; }
+
+  // Allocates space for a promoted object in old space. The page space is
+  // not thread safe, so promotion is serialized.
+  uword TryPromote(intptr_t size) {
+    ScopedMutex ml(&promotion_mutex_);
+    Heap* heap = scavenger_->heap_;
+    uword addr = heap->TryAllocate(size, Heap::kOld, growth_policy_);
+    if ((addr == 0) && (growth_policy_ != PageSpace::kForceGrowth)) {
+      // Signal a promotion failure and force growth for this, and all
+      // subsequent promotion allocations.
+      scavenger_->had_promotion_failure_ = true;
+      growth_policy_ = PageSpace::kForceGrowth;
+      addr = heap->TryAllocate(size, Heap::kOld, growth_policy_);
+    }
+    return addr;
+  }
+
+  StoreBufferBlock* remembered() const { return remembered_; }
+  StoreBufferBlock* weak_properties() const { return weak_properties_; }
+  intptr_t store_buffer_visited() const { return store_buffer_visited_; }
+  intptr_t store_buffer_handled() const { return store_buffer_handled_; }
+  intptr_t bytes_promoted() const { return bytes_promoted_; }
+
+ private:
+  class ParallelScavengeTask : public ThreadPool::Task {
+   public:
+    explicit ParallelScavengeTask(ParallelScavenge* scavenge)
+        : scavenge_(scavenge) { }
+
+    virtual void Run();
+
+   private:
+    ParallelScavenge* scavenge_;
+
+    DISALLOW_COPY_AND_ASSIGN(ParallelScavengeTask);
+  };
+
+  static void AppendBlocks(StoreBufferBlock** list, StoreBufferBlock* blocks);
+
+  Isolate* isolate_;
+  Scavenger* scavenger_;
+
+  Monitor monitor_;
+  ParallelScavengeWork* work_;
+  intptr_t running_tasks_;
+  volatile intptr_t idle_tasks_;
+  intptr_t pending_tasks_;
+  bool done_;
+
+  Mutex promotion_mutex_;
+  PageSpace::GrowthPolicy growth_policy_;
+
+  // Results merged from the tasks.
+  StoreBufferBlock* remembered_;
+  StoreBufferBlock* weak_properties_;
+  intptr_t store_buffer_visited_;
+  intptr_t store_buffer_handled_;
+  intptr_t bytes_promoted_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelScavenge);
+};
+
+
+// Visitor used by each task of a parallel scavenge. Objects are copied into a
+// private allocation buffer carved out of to-space and forwarded by atomically
+// updating the header of the original. Surplus work is shared with idle tasks
+// through the ParallelScavenge work list.
+class ParallelScavengerVisitor : public ObjectPointerVisitor {
+ public:
+  explicit ParallelScavengerVisitor(ParallelScavenge* scavenge)
+      : ObjectPointerVisitor(scavenge->isolate()),
+        scavenge_(scavenge),
+        scavenger_(scavenge->scavenger()),
+        buffer_top_(0),
+        buffer_end_(0),
+        buffer_scan_(0),
+        pending_(NULL),
+        remembered_(NULL),
+        weak_properties_(NULL),
+        visiting_old_object_(NULL),
+        visited_count_(0),
+        handled_count_(0),
+        copied_count_(0),
+        store_buffer_visited_(0),
+        store_buffer_handled_(0),
+        bytes_promoted_(0) { }
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      ScavengePointer(current);
+    }
+  }
+
+  // Drains the local work and the shared work list until the scavenge
+  // terminates.
+  void ProcessWork() {
+    while (true) {
+      if (buffer_scan_ < buffer_top_) {
+        RawObject* raw_obj = RawObject::FromAddr(buffer_scan_);
+        // Advance before visiting: copying may retire the current buffer and
+        // hand its unscanned part to other tasks.
+        buffer_scan_ += raw_obj->Size();
+        ScanObject(raw_obj);
+        ShareLocalWork();
+        continue;
+      }
+      if (pending_ != NULL) {
+        StoreBufferBlock* pending = pending_;
+        pending_ = NULL;
+        VisitObjects(pending, false);
+        delete pending;
+        continue;
+      }
+      ParallelScavengeWork* work = scavenge_->TakeWork();
+      if (work == NULL) {
+        break;
+      }
+      if (work->objects() != NULL) {
+        VisitObjects(work->objects(), work->from_store_buffer());
+        delete work->objects();
+      } else {
+        uword current = work->start();
+        while (current < work->end()) {
+          RawObject* raw_obj = RawObject::FromAddr(current);
+          current += raw_obj->Size();
+          ScanObject(raw_obj);
+        }
+      }
+      delete work;
+    }
+  }
+
+  // Gives up the allocation buffer. Its unused tail is formatted as a free
+  // list element so that to-space stays iterable.
+  void RetireBuffer() {
+    if (buffer_scan_ < buffer_top_) {
+      scavenge_->AddWork(new ParallelScavengeWork(buffer_scan_, buffer_top_));
+    }
+    if (buffer_top_ < buffer_end_) {
+      FreeListElement::AsElement(buffer_top_, buffer_end_ - buffer_top_);
+    }
+    buffer_top_ = 0;
+    buffer_end_ = 0;
+    buffer_scan_ = 0;
+  }
+
+  StoreBufferBlock* remembered() const { return remembered_; }
+  StoreBufferBlock* weak_properties() const { return weak_properties_; }
+  intptr_t store_buffer_visited() const { return store_buffer_visited_; }
+  intptr_t store_buffer_handled() const { return store_buffer_handled_; }
+  intptr_t bytes_promoted() const { return bytes_promoted_; }
+  intptr_t copied_count() const { return copied_count_; }
+
+ private:
+  // Size of the private to-space allocation buffers. Objects larger than a
+  // quarter of it are allocated individually to limit the waste at the end
+  // of a buffer.
+  static const intptr_t kBufferSize = 32 * KB;
+  static const intptr_t kMaxBufferedObjectSize = kBufferSize / 4;
+  // Minimum amount of unscanned local objects handed to idle tasks.
+  static const intptr_t kMinSharedRange = 4 * KB;
+
+  static void AddToBlocks(StoreBufferBlock** blocks, RawObject* raw_obj) {
+    if ((*blocks == NULL) || (*blocks)->IsFull()) {
+      *blocks = new StoreBufferBlock(*blocks);
+    }
+    (*blocks)->Add(raw_obj);
+  }
+
+  void ScanObject(RawObject* raw_obj) {
+    if (raw_obj->GetClassId() == kWeakPropertyCid) {
+      // The fate of weak properties is decided in the serial phase, after
+      // all strongly reachable objects have been copied.
+      AddToBlocks(&weak_properties_, raw_obj);
+    } else {
+      raw_obj->VisitPointers(this);
+    }
+  }
+
+  void VisitObjects(StoreBufferBlock* block, bool from_store_buffer) {
+    intptr_t visited_count_before = visited_count_;
+    intptr_t handled_count_before = handled_count_;
+    intptr_t count = block->Count();
+    for (intptr_t i = 0; i < count; i++) {
+      RawObject* raw_obj = block->At(i);
+      if (raw_obj->IsNewObject()) {
+        // A large object copied outside of an allocation buffer.
+        ScanObject(raw_obj);
+        continue;
+      }
+      if (from_store_buffer && !raw_obj->IsRemembered()) {
+        // An array remembered by its cards rather than the store buffer.
+        visiting_old_object_ = raw_obj;
+        HeapPage::OfCardRemembered(raw_obj)->VisitRememberedCards(this);
+        visiting_old_object_ = NULL;
+        continue;
+      }
+      if (from_store_buffer) {
+        raw_obj->ClearRememberedBit();
+      } else {
+        ASSERT(!raw_obj->IsRemembered());
+      }
+      visiting_old_object_ = raw_obj;
+      raw_obj->VisitPointers(this);
+      visiting_old_object_ = NULL;
+    }
+    if (from_store_buffer) {
+      store_buffer_visited_ += visited_count_ - visited_count_before;
+      store_buffer_handled_ += handled_count_ - handled_count_before;
+    }
+  }
+
+  // Hands surplus local work to idle tasks.
+  void ShareLocalWork() {
+    if (!scavenge_->HasIdleTasks()) {
+      return;
+    }
+    if ((buffer_top_ - buffer_scan_) >= static_cast<uword>(kMinSharedRange)) {
+      scavenge_->AddWork(new ParallelScavengeWork(buffer_scan_, buffer_top_));
+      buffer_scan_ = buffer_top_;
+    }
+    if ((pending_ != NULL) && (pending_->Count() > 1)) {
+      scavenge_->AddWork(new ParallelScavengeWork(pending_, false));
+      pending_ = NULL;
+    }
+  }
+
+  void AddPending(uword addr) {
+    if ((pending_ != NULL) && pending_->IsFull()) {
+      scavenge_->AddWork(new ParallelScavengeWork(pending_, false));
+      pending_ = NULL;
+    }
+    if (pending_ == NULL) {
+      pending_ = new StoreBufferBlock(NULL);
+    }
+    pending_->Add(RawObject::FromAddr(addr));
+  }
+
+  // Allocates to-space for a copy. Sets 'is_pending' if the copy lies outside
+  // of the allocation buffer and thus needs to be queued for scanning.
+  uword TryAllocateInToSpace(intptr_t size, bool* is_pending) {
+    if (size > kMaxBufferedObjectSize) {
+      *is_pending = true;
+      return scavenger_->TryAllocateAtomic(size);
+    }
+    if ((buffer_end_ - buffer_top_) < static_cast<uword>(size)) {
+      RetireBuffer();
+      uword buffer = scavenger_->TryAllocateAtomic(kBufferSize);
+      if (buffer == 0) {
+        // To-space is nearly exhausted, allocate the object on its own.
+        *is_pending = true;
+        return scavenger_->TryAllocateAtomic(size);
+      }
+      buffer_top_ = buffer;
+      buffer_scan_ = buffer;
+      buffer_end_ = buffer + kBufferSize;
+    }
+    uword result = buffer_top_;
+    buffer_top_ += size;
+    return result;
+  }
+
+  uword Copy(RawObject* raw_obj, intptr_t size, bool* is_pending) {
+    uword raw_addr = RawObject::ToAddr(raw_obj);
+    uword new_addr = 0;
+    if (scavenger_->survivor_end_ <= raw_addr) {
+      // Not a survivor of a previous scavenge. Just copy the object into the
+      // to space.
+      new_addr = TryAllocateInToSpace(size, is_pending);
+      if (new_addr != 0) {
+        return new_addr;
+      }
+    }
+    new_addr = scavenge_->TryPromote(size);
+    if (new_addr != 0) {
+      *is_pending = true;
+      bytes_promoted_ += size;
+      return new_addr;
+    }
+    // Promotion did not succeed. Copy into the to space instead.
+    new_addr = TryAllocateInToSpace(size, is_pending);
+    if (new_addr == 0) {
+      FATAL("Out of memory during parallel scavenge.\n");
+    }
+    return new_addr;
+  }
+
+  void UpdateStoreBuffer(RawObject** p, RawObject* obj) {
+    ASSERT(obj->IsHeapObject());
+    // If the newly written object is not a new object, drop it immediately.
+    if (!obj->IsNewObject()) {
+      return;
+    }
+    // Each old object is visited by one task only, so its remembered bit and
+    // cards can be updated without synchronization.
+    if (visiting_old_object_->IsCardRemembered()) {
+      HeapPage::OfCardRemembered(visiting_old_object_)->RememberCard(
+          reinterpret_cast<uword>(p));
+      return;
+    }
+    if (visiting_old_object_->IsRemembered()) {
+      return;
+    }
+    visiting_old_object_->SetRememberedBit();
+    AddToBlocks(&remembered_, visiting_old_object_);
+  }
+
+  void ScavengePointer(RawObject** p) {
+    visited_count_++;
+    RawObject* raw_obj = *p;
+
+    // Fast exit if the raw object is a Smi or an old object.
+    if (!raw_obj->IsHeapObject() || raw_obj->IsOldObject()) {
+      return;
+    }
+
+    uword raw_addr = RawObject::ToAddr(raw_obj);
+    // The scavenger is only interested in objects located in the from space.
+    if (!scavenger_->from_->Contains(raw_addr)) {
+      return;
+    }
+
+    handled_count_++;
+    uword* header_addr = reinterpret_cast<uword*>(raw_addr);
+    uword header = *header_addr;
+    if (!IsForwarding(header) &&
+        (AtomicOperations::CompareAndSwapWord(
+            header_addr, header, kClaimedForwarding) == header)) {
+      // This task copies the object. Objects are never watched before the
+      // serial phase processes weak properties.
+      ASSERT(!raw_obj->IsWatched());
+      intptr_t size = raw_obj->SizeFromTags(header);
+      bool is_pending = false;
+      uword new_addr = Copy(raw_obj, size, &is_pending);
+      copied_count_++;
+      memmove(reinterpret_cast<void*>(new_addr),
+              reinterpret_cast<void*>(raw_addr),
+              size);
+      // The copy picked up the claim marker; restore the original header.
+      *reinterpret_cast<uword*>(new_addr) = header;
+      // Publish the forwarding address, waking up any waiting tasks.
+      uword claim = AtomicOperations::CompareAndSwapWord(
+          header_addr, kClaimedForwarding, new_addr | kForwarded);
+      ASSERT(claim == kClaimedForwarding);
+      if (is_pending) {
+        AddPending(new_addr);
+      }
+      header = new_addr | kForwarded;
+    } else {
+      // Another task copied or is copying the object.
+      header = *reinterpret_cast<volatile uword*>(header_addr);
+      while (header == kClaimedForwarding) {
+        header = *reinterpret_cast<volatile uword*>(header_addr);
+      }
+    }
+    // Update the reference.
+    RawObject* new_obj = RawObject::FromAddr(ForwardedAddr(header));
+    *p = new_obj;
+    // Update the store buffer as needed.
+    if (visiting_old_object_ != NULL) {
+      UpdateStoreBuffer(p, new_obj);
+    }
+  }
+
+  ParallelScavenge* scavenge_;
+  Scavenger* scavenger_;
+
+  // Private to-space allocation buffer. Objects in [buffer_scan_,
+  // buffer_top_) have been copied but not scanned yet.
+  uword buffer_top_;
+  uword buffer_end_;
+  uword buffer_scan_;
+
+  // Copied objects outside of the allocation buffer which still need to be
+  // scanned: promoted objects and large to-space objects.
+  StoreBufferBlock* pending_;
+  // Old objects which need to be added to the store buffer.
+  StoreBufferBlock* remembered_;
+  // Weak properties in to-space, processed by the serial phase.
+  StoreBufferBlock* weak_properties_;
+
+  RawObject* visiting_old_object_;
+  intptr_t visited_count_;
+  intptr_t handled_count_;
+  // Objects claimed and copied or promoted by this task.
+  intptr_t copied_count_;
+  intptr_t store_buffer_visited_;
+  intptr_t store_buffer_handled_;
+  intptr_t bytes_promoted_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelScavengerVisitor);
+};
+
+
+void ParallelScavenge::ParallelScavengeTask::Run() {
+  Isolate::SetCurrentHelper(scavenge_->isolate());
+  ParallelScavengerVisitor visitor(scavenge_);
+  if (scavenge_->EnterTask()) {
+    visitor.ProcessWork();
+  }
+  scavenge_->ExitTask(&visitor, true);
+  // The scavenge may be gone at this point, do not touch it anymore.
+  Isolate::SetCurrentHelper(NULL);
+}
+
+
+void ParallelScavenge::AppendBlocks(StoreBufferBlock** list,
+                                    StoreBufferBlock* blocks) {
+  while (blocks != NULL) {
+    StoreBufferBlock* next = blocks->next();
+    intptr_t count = blocks->Count();
+    for (intptr_t i = 0; i < count; i++) {
+      if ((*list == NULL) || (*list)->IsFull()) {
+        *list = new StoreBufferBlock(*list);
+      }
+      (*list)->Add(blocks->At(i));
+    }
+    delete blocks;
+    blocks = next;
+  }
+}
+
+
+void ParallelScavenge::ExitTask(ParallelScavengerVisitor* visitor,
+                                bool is_helper) {
+  visitor->RetireBuffer();
+  ScopedMonitor ml(&monitor_);
+  AppendBlocks(&remembered_, visitor->remembered());
+  AppendBlocks(&weak_properties_, visitor->weak_properties());
+  store_buffer_visited_ += visitor->store_buffer_visited();
+  store_buffer_handled_ += visitor->store_buffer_handled();
+  bytes_promoted_ += visitor->bytes_promoted();
+  scavenger_->parallel_copied_count_ += visitor->copied_count();
+  if (is_helper) {
+    scavenger_->parallel_helper_copied_count_ += visitor->copied_count();
+    pending_tasks_--;
+    ml.NotifyAll();
+  }
+}
+
+
 class ScavengerWeakVisitor : public HandleVisitor {
  public:
   explicit ScavengerWeakVisitor(Scavenger* scavenger) : scavenger_(scavenger) {
@@ -280,6 +892,44 @@ class ScavengerWeakVisitor : public HandleVisitor {
 };
 
 
+// Visits the dirty cards of the card remembered arrays.
+class ScavengerCardVisitor : public ObjectVisitor {
+ public:
+  ScavengerCardVisitor(Isolate* isolate, ScavengerVisitor* visitor)
+      : ObjectVisitor(isolate), visitor_(visitor) { }
+
+  void VisitObject(RawObject* raw_obj) {
+    visitor_->VisitingOldObject(raw_obj);
+    HeapPage::OfCardRemembered(raw_obj)->VisitRememberedCards(visitor_);
+  }
+
+ private:
+  ScavengerVisitor* visitor_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScavengerCardVisitor);
+};
+
+
+// Hands the card remembered arrays out as work of a parallel scavenge, one
+// array per unit.
+class ParallelScavengeCardVisitor : public ObjectVisitor {
+ public:
+  ParallelScavengeCardVisitor(Isolate* isolate, ParallelScavenge* scavenge)
+      : ObjectVisitor(isolate), scavenge_(scavenge) { }
+
+  void VisitObject(RawObject* raw_obj) {
+    StoreBufferBlock* block = new StoreBufferBlock(NULL);
+    block->Add(raw_obj);
+    scavenge_->AddWork(new ParallelScavengeWork(block, true));
+  }
+
+ private:
+  ParallelScavenge* scavenge_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelScavengeCardVisitor);
+};
+
+
 // Visitor used to verify that all old->new references have been added to the
 // StoreBuffers.
 class VerifyStoreBufferPointerVisitor : public ObjectPointerVisitor {
@@ -308,7 +958,9 @@ Scavenger::Scavenger(Heap* heap,
                      uword object_alignment)
     : heap_(heap),
       object_alignment_(object_alignment),
-      scavenging_(false) {
+      scavenging_(false),
+      parallel_copied_count_(0),
+      parallel_helper_copied_count_(0) {
   // Verify assumptions about the first word in objects which the scavenger is
   // going to use for forwarding pointers.
   ASSERT(Object::tags_offset() == 0);
@@ -319,15 +971,21 @@ Scavenger::Scavenger(Heap* heap,
     FATAL("Out of memory.\n");
   }
 
-  // Allocate the entire space at the beginning.
-  space_->Commit(false);
-
-  // Setup the semi spaces.
-  uword semi_space_size = space_->size() / 2;
-  ASSERT((semi_space_size & (VirtualMemory::PageSize() - 1)) == 0);
-  to_ = new MemoryRegion(space_->address(), semi_space_size);
-  uword middle = space_->start() + semi_space_size;
-  from_ = new MemoryRegion(reinterpret_cast<void*>(middle), semi_space_size);
+  // Setup the semi spaces. When adapting to the pause target they start
+  // small, otherwise they use all of the reserved memory.
+  max_semi_space_size_ = space_->size() / 2;
+  ASSERT((max_semi_space_size_ & (VirtualMemory::PageSize() - 1)) == 0);
+  semi_space_size_ = max_semi_space_size_;
+  if (FLAG_new_gen_target_pause_micros > 0) {
+    semi_space_size_ = Utils::Minimum(kMinSemiSpaceSize, max_semi_space_size_);
+  }
+  uword middle = space_->start() + max_semi_space_size_;
+  if (!space_->Commit(space_->start(), semi_space_size_, false) ||
+      !space_->Commit(middle, semi_space_size_, false)) {
+    FATAL("Out of memory.\n");
+  }
+  to_ = new MemoryRegion(space_->address(), semi_space_size_);
+  from_ = new MemoryRegion(reinterpret_cast<void*>(middle), semi_space_size_);
 
   // Make sure that the two semi-spaces are aligned properly.
   ASSERT(Utils::IsAligned(to_->start(), kObjectAlignment));
@@ -396,6 +1054,10 @@ void Scavenger::IterateStoreBuffers(Isolate* isolate,
   StoreBufferBlock* pending = isolate->store_buffer()->Blocks();
   intptr_t visited_count_before = visitor->visited_count();
   intptr_t handled_count_before = visitor->handled_count();
+  // Visit the dirty cards before the store buffer clears the remembered bits
+  // which exclude arrays from the card visit.
+  ScavengerCardVisitor card_visitor(isolate, visitor);
+  heap_->IterateCardRememberedObjects(&card_visitor);
   while (pending != NULL) {
     StoreBufferBlock* next = pending->next();
     intptr_t count = pending->Count();
@@ -447,6 +1109,103 @@ void Scavenger::IterateRoots(Isolate* isolate,
 }
 
 
+uword Scavenger::TryAllocateAtomic(intptr_t size) {
+  ASSERT(Utils::IsAligned(size, kObjectAlignment));
+  while (true) {
+    uword result = *reinterpret_cast<volatile uword*>(&top_);
+    intptr_t remaining = end_ - result;
+    if (remaining < size) {
+      return 0;
+    }
+    if (AtomicOperations::CompareAndSwapWord(&top_, result, result + size) ==
+        result) {
+      ASSERT(to_->Contains(result));
+      return result;
+    }
+  }
+}
+
+
+void Scavenger::ParallelIterateRoots(
+    Isolate* isolate,
+    bool visit_prologue_weak_persistent_handles,
+    StoreBufferBlock** weak_properties) {
+  StoreBuffer* buffer = isolate->store_buffer();
+  heap_->RecordData(kStoreBufferEntries, buffer->Count());
+
+  ParallelScavenge scavenge(isolate, this);
+  // Hand out the store buffer blocks to the tasks before they are started.
+  StoreBufferBlock* pending = buffer->Blocks();
+  while (pending != NULL) {
+    StoreBufferBlock* next = pending->next();
+    scavenge.AddWork(new ParallelScavengeWork(pending, true));
+    pending = next;
+  }
+  ParallelScavengeCardVisitor card_visitor(isolate, &scavenge);
+  heap_->IterateCardRememberedObjects(&card_visitor);
+  intptr_t num_helpers = FLAG_scavenger_tasks - 1;
+  scavenge.StartHelpers(num_helpers);
+
+  // The mutator visits the isolate roots while the helpers start on the
+  // store buffers.
+  int64_t start = OS::GetCurrentTimeMicros();
+  ParallelScavengerVisitor visitor(&scavenge);
+  isolate->VisitObjectPointers(&visitor,
+                               visit_prologue_weak_persistent_handles,
+                               StackFrameIterator::kDontValidateFrames);
+  ObjectIdRing* ring = isolate->object_id_ring();
+  if (ring != NULL) {
+    ring->VisitPointers(&visitor);
+  } else {
+    // --gc_at_alloc can get us here before the ring has been initialized.
+    ASSERT(FLAG_gc_at_alloc);
+  }
+  int64_t middle = OS::GetCurrentTimeMicros();
+  visitor.ProcessWork();
+  scavenge.ExitTask(&visitor, false);
+  scavenge.WaitForHelpers();
+  int64_t end = OS::GetCurrentTimeMicros();
+
+  // All copied objects have been scanned by the tasks.
+  resolved_top_ = top_;
+  // Add the old objects which still refer to new space to the store buffer.
+  StoreBufferBlock* remembered = scavenge.remembered();
+  while (remembered != NULL) {
+    StoreBufferBlock* next = remembered->next();
+    intptr_t count = remembered->Count();
+    for (intptr_t i = 0; i < count; i++) {
+      buffer->AddObjectGC(remembered->At(i));
+    }
+    delete remembered;
+    remembered = next;
+  }
+  *weak_properties = scavenge.weak_properties();
+
+  heap_->RecordData(kStoreBufferVisited, scavenge.store_buffer_visited());
+  heap_->RecordData(kStoreBufferPointers, scavenge.store_buffer_handled());
+  heap_->RecordData(kToKBAfterStoreBuffer, RoundWordsToKB(UsedInWords()));
+  heap_->RecordTime(kVisitIsolateRoots, middle - start);
+  // The store buffers are processed together with the transitive closure.
+  heap_->RecordTime(kIterateStoreBuffers, end - middle);
+}
+
+
+void Scavenger::ProcessDelayedWeakProperties(StoreBufferBlock* weak_properties,
+                                             ScavengerVisitor* visitor) {
+  while (weak_properties != NULL) {
+    StoreBufferBlock* next = weak_properties->next();
+    intptr_t count = weak_properties->Count();
+    for (intptr_t i = 0; i < count; i++) {
+      RawWeakProperty* raw_weak =
+          reinterpret_cast<RawWeakProperty*>(weak_properties->At(i));
+      ProcessWeakProperty(raw_weak, visitor);
+    }
+    delete weak_properties;
+    weak_properties = next;
+  }
+}
+
+
 bool Scavenger::IsUnreachable(RawObject** p) {
   RawObject* raw_obj = *p;
   if (!raw_obj->IsHeapObject()) {
@@ -585,6 +1344,30 @@ uword Scavenger::ProcessWeakProperty(RawWeakProperty* raw_weak,
 }
 
 
+void Scavenger::RecordSurvival(Isolate* isolate, uword start, uword end) {
+  ClassTable* class_table = isolate->class_table();
+  uword current = start;
+  while (current < end) {
+    uword header = *reinterpret_cast<uword*>(current);
+    // Surviving objects have been forwarded, the others are still intact.
+    const bool survived = IsForwarding(header);
+    RawObject* raw_obj = survived
+        ? RawObject::FromAddr(ForwardedAddr(header))
+        : RawObject::FromAddr(current);
+    const intptr_t size = raw_obj->Size();
+    const intptr_t cid = raw_obj->GetClassId();
+    if (cid != kFreeListElement) {
+      class_table->RecordAllocation(cid, size, survived);
+    }
+    current += size;
+  }
+  if (class_table->UpdatePretenuring()) {
+    // Code allocating in old space is deoptimized outside of the GC.
+    isolate->ScheduleInterrupts(Isolate::kPretenureInterrupt);
+  }
+}
+
+
 void Scavenger::ProcessWeakTables() {
   for (int sel = 0;
        sel < Heap::kNumWeakSelectors;
@@ -658,10 +1441,26 @@ void Scavenger::Scavenge(bool invoke_api_callbacks) {
     OS::PrintErr(" done.\n");
   }
 
-  // Setup the visitor and run a scavenge.
-  ScavengerVisitor visitor(isolate, this);
+  // The objects allocated since the previous scavenge.
+  const uword allocation_start = survivor_end_;
+  const uword allocation_end = top_;
+  const int64_t scavenge_start = OS::GetCurrentTimeMicros();
+  const intptr_t used_before_in_words = UsedInWords();
+  const intptr_t old_used_before_in_words = heap_->UsedInWords(Heap::kOld);
   Prologue(isolate, invoke_api_callbacks);
-  IterateRoots(isolate, &visitor, !invoke_api_callbacks);
+  StoreBufferBlock* weak_properties = NULL;
+  const bool parallel = (FLAG_scavenger_tasks > 1);
+  if (parallel) {
+    ParallelIterateRoots(isolate, !invoke_api_callbacks, &weak_properties);
+  }
+  // Setup the visitor and run a scavenge. After a parallel scavenge it only
+  // takes care of the weak properties and everything they keep alive.
+  ScavengerVisitor visitor(isolate, this);
+  if (parallel) {
+    ProcessDelayedWeakProperties(weak_properties, &visitor);
+  } else {
+    IterateRoots(isolate, &visitor, !invoke_api_callbacks);
+  }
   int64_t start = OS::GetCurrentTimeMicros();
   ProcessToSpace(&visitor);
   int64_t middle = OS::GetCurrentTimeMicros();
@@ -670,11 +1469,22 @@ void Scavenger::Scavenge(bool invoke_api_callbacks) {
   IterateWeakRoots(isolate, &weak_visitor, invoke_api_callbacks);
   visitor.Finalize();
   ProcessWeakTables();
+  if (FLAG_pretenure) {
+    RecordSurvival(isolate, allocation_start, allocation_end);
+  }
   int64_t end = OS::GetCurrentTimeMicros();
   heap_->RecordTime(kProcessToSpace, middle - start);
   heap_->RecordTime(kIterateWeaks, end - middle);
   Epilogue(isolate, invoke_api_callbacks);
 
+  // Objects survive by being copied within new space or by being promoted.
+  const intptr_t survived_in_words = UsedInWords() +
+      (heap_->UsedInWords(Heap::kOld) - old_used_before_in_words);
+  const intptr_t survival_ratio = (used_before_in_words > 0)
+      ? ((survived_in_words * 100) / used_before_in_words)
+      : 0;
+  heap_->RecordData(kSurvivalRatio, survival_ratio);
+
   if (FLAG_verify_after_gc) {
     OS::PrintErr("Verifying after Scavenge...");
     heap_->Verify();
@@ -684,6 +1494,88 @@ void Scavenger::Scavenge(bool invoke_api_callbacks) {
   // Done scavenging. Reset the marker.
   ASSERT(scavenging_);
   scavenging_ = false;
+
+  // Resizing moves the end of the to space, so it waits until the scavenge
+  // is over.
+  AdaptSemiSpaceSize(OS::GetCurrentTimeMicros() - scavenge_start,
+                     survival_ratio);
+}
+
+
+// The smallest semispace size which leaves room for allocating at least as
+// much as is in use in new space.
+static intptr_t MinimumSemiSpaceSize(intptr_t used_in_bytes,
+                                     intptr_t min_size,
+                                     intptr_t max_size) {
+  intptr_t size = Utils::RoundUp(2 * used_in_bytes, VirtualMemory::PageSize());
+  return Utils::Minimum(Utils::Maximum(size, min_size), max_size);
+}
+
+
+void Scavenger::AdaptSemiSpaceSize(int64_t pause_micros,
+                                   intptr_t survival_ratio) {
+  const intptr_t target = FLAG_new_gen_target_pause_micros;
+  if (target <= 0) {
+    // Undo a Shrink.
+    SetSemiSpaceSize(max_semi_space_size_);
+    return;
+  }
+  intptr_t size = semi_space_size_;
+  if (pause_micros > target) {
+    // The pause is dominated by copying the survivors. Fewer of them
+    // accumulate between the scavenges of a smaller new space.
+    size = semi_space_size_ / 2;
+  } else if (((2 * pause_micros) < target) &&
+             (survival_ratio < kMaxSurvivalRatioForGrowth)) {
+    // Most objects die young, so doubling new space gives them more time to
+    // die without copying many more survivors.
+    size = semi_space_size_ * 2;
+  }
+  const intptr_t min_size = MinimumSemiSpaceSize(
+      top_ - FirstObjectStart(),
+      Utils::Minimum(kMinSemiSpaceSize, max_semi_space_size_),
+      max_semi_space_size_);
+  SetSemiSpaceSize(Utils::Minimum(Utils::Maximum(size, min_size),
+                                  max_semi_space_size_));
+}
+
+
+void Scavenger::SetSemiSpaceSize(intptr_t size) {
+  ASSERT(!scavenging_);
+  ASSERT(Utils::IsAligned(size, VirtualMemory::PageSize()));
+  ASSERT(size <= max_semi_space_size_);
+  ASSERT(top_ <= (to_->start() + size));
+  if (size == semi_space_size_) {
+    return;
+  }
+  const uword to_start = to_->start();
+  const uword from_start = from_->start();
+  if (size > semi_space_size_) {
+    const intptr_t delta = size - semi_space_size_;
+    if (!space_->Commit(to_start + semi_space_size_, delta, false) ||
+        !space_->Commit(from_start + semi_space_size_, delta, false)) {
+      // Keep the current size if the memory is not available.
+      return;
+    }
+  } else {
+    const intptr_t delta = semi_space_size_ - size;
+    space_->Decommit(to_start + size, delta);
+    space_->Decommit(from_start + size, delta);
+  }
+  delete to_;
+  delete from_;
+  to_ = new MemoryRegion(reinterpret_cast<void*>(to_start), size);
+  from_ = new MemoryRegion(reinterpret_cast<void*>(from_start), size);
+  end_ = to_->end();
+  semi_space_size_ = size;
+}
+
+
+void Scavenger::Shrink() {
+  SetSemiSpaceSize(MinimumSemiSpaceSize(
+      top_ - FirstObjectStart(),
+      Utils::Minimum(kMinSemiSpaceSize, max_semi_space_size_),
+      max_semi_space_size_));
 }
 
 
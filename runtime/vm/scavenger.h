@@ -18,9 +18,13 @@ namespace dart {
 // Forward declarations.
 class Heap;
 class Isolate;
+class ParallelScavenge;
 class ScavengerVisitor;
+class StoreBufferBlock;
 
 DECLARE_FLAG(bool, gc_at_alloc);
+DECLARE_FLAG(int, scavenger_tasks);
+DECLARE_FLAG(int, new_gen_target_pause_micros);
 
 class Scavenger {
  public:
@@ -59,6 +63,11 @@ class Scavenger {
     return result;
   }
 
+  // Allocates 'size' bytes of to-space with an atomic update of the
+  // allocation top. Used by the tasks of a parallel scavenge to carve out
+  // their private allocation buffers.
+  uword TryAllocateAtomic(intptr_t size);
+
   // Collect the garbage in this scavenger.
   void Scavenge();
   void Scavenge(bool invoke_api_callbacks);
@@ -72,7 +81,9 @@ class Scavenger {
   intptr_t UsedInWords() const {
     return (top_ - FirstObjectStart()) >> kWordSizeLog2;
   }
-  intptr_t CapacityInWords() const { return space_->size() >> kWordSizeLog2; }
+  intptr_t CapacityInWords() const {
+    return (2 * semi_space_size_) >> kWordSizeLog2;
+  }
 
   void VisitObjects(ObjectVisitor* visitor) const;
   void VisitObjectPointers(ObjectPointerVisitor* visitor) const;
@@ -87,8 +98,20 @@ class Scavenger {
     return had_promotion_failure_;
   }
 
+  // Objects copied by the tasks of all parallel scavenges so far, and the
+  // part of them copied by the helper tasks rather than the mutator.
+  intptr_t parallel_copied_count() const { return parallel_copied_count_; }
+  intptr_t parallel_helper_copied_count() const {
+    return parallel_helper_copied_count_;
+  }
+
   void WriteProtect(bool read_only);
 
+  // Shrinks the semispaces to the smallest size holding the objects currently
+  // in new space and returns the rest of their memory to the OS, e.g. when
+  // the isolate is idle. They grow again if the pause target allows it.
+  void Shrink();
+
  private:
   // Ids for time and data records in Heap::GCStats.
   enum {
@@ -101,9 +124,15 @@ class Scavenger {
     kStoreBufferEntries = 0,
     kStoreBufferVisited = 1,
     kStoreBufferPointers = 2,
-    kToKBAfterStoreBuffer = 3
+    kToKBAfterStoreBuffer = 3,
+    kSurvivalRatio = 4
   };
 
+  // Bounds of the semispace size when it is adapted to the pause target.
+  static const intptr_t kMinSemiSpaceSize = 1 * MB;
+  // New space only grows while less than this percentage survives.
+  static const intptr_t kMaxSurvivalRatioForGrowth = 20;
+
   uword FirstObjectStart() const { return to_->start() | object_alignment_; }
   void Prologue(Isolate* isolate, bool invoke_api_callbacks);
   void IterateStoreBuffers(Isolate* isolate, ScavengerVisitor* visitor);
@@ -111,6 +140,14 @@ class Scavenger {
   void IterateRoots(Isolate* isolate,
                     ScavengerVisitor* visitor,
                     bool visit_prologue_weak_persistent_handles);
+  // Copies all objects reachable from the roots and the store buffers using
+  // FLAG_scavenger_tasks tasks. Weak properties found in to-space are left
+  // for the serial phase and returned in 'weak_properties'.
+  void ParallelIterateRoots(Isolate* isolate,
+                            bool visit_prologue_weak_persistent_handles,
+                            StoreBufferBlock** weak_properties);
+  void ProcessDelayedWeakProperties(StoreBufferBlock* weak_properties,
+                                    ScavengerVisitor* visitor);
   void IterateWeakProperties(Isolate* isolate, ScavengerVisitor* visitor);
   void IterateWeakReferences(Isolate* isolate, ScavengerVisitor* visitor);
   void IterateWeakRoots(Isolate* isolate,
@@ -144,9 +181,22 @@ class Scavenger {
 
   void ProcessWeakTables();
 
+  // Records the survival of the objects allocated in [start, end) of the
+  // from-space since the previous scavenge as pretenuring feedback.
+  void RecordSurvival(Isolate* isolate, uword start, uword end);
+
+  // Grows or shrinks the semispaces after a scavenge, based on its pause
+  // time and the percentage of the objects in new space which survived it.
+  void AdaptSemiSpaceSize(int64_t pause_micros, intptr_t survival_ratio);
+  void SetSemiSpaceSize(intptr_t size);
+
+  // The reserved memory holds the two semispaces at fixed offsets. Only the
+  // first semi_space_size_ bytes of each of them are committed and in use.
   VirtualMemory* space_;
   MemoryRegion* to_;
   MemoryRegion* from_;
+  intptr_t semi_space_size_;
+  intptr_t max_semi_space_size_;
 
   Heap* heap_;
 
@@ -170,6 +220,12 @@ class Scavenger {
   // Keep track whether the scavenge had a promotion failure.
   bool had_promotion_failure_;
 
+  // See parallel_copied_count().
+  intptr_t parallel_copied_count_;
+  intptr_t parallel_helper_copied_count_;
+
+  friend class ParallelScavenge;
+  friend class ParallelScavengerVisitor;
   friend class ScavengerVisitor;
   friend class ScavengerWeakVisitor;
 
@@ -2,6 +2,7 @@
 // for details. All rights reserved. Use of this source code is governed by a
 // BSD-style license that can be found in the LICENSE file.
 
+#include "vm/code_generator.h"
 #include "vm/debugger.h"
 #include "vm/heap_histogram.h"
 #include "vm/isolate.h"
@@ -199,6 +200,21 @@ static void HandleObjectHistogram(Isolate* isolate, JSONStream* js) {
 }
 
 
+static void HandleDeoptimizations(Isolate* isolate, JSONStream* js) {
+  const intptr_t* counts = isolate->deopt_reason_counts();
+  JSONObject jsobj(js);
+  jsobj.AddProperty("type", "DeoptimizationHistogram");
+  JSONArray jsarr(&jsobj, "members");
+  for (intptr_t i = 0; i < kDeoptNumReasons; i++) {
+    if (counts[i] > 0) {
+      JSONObject entry(&jsarr);
+      entry.AddProperty("reason", DeoptReasonToText(i));
+      entry.AddProperty("count", counts[i]);
+    }
+  }
+}
+
+
 static void HandleEcho(Isolate* isolate, JSONStream* js) {
   JSONObject jsobj(js);
   jsobj.AddProperty("type", "message");
@@ -258,6 +274,7 @@ static ServiceMessageHandlerEntry __message_handlers[] = {
   { "name", HandleName },
   { "stacktrace", HandleStackTrace },
   { "objecthistogram", HandleObjectHistogram},
+  { "deoptimizations", HandleDeoptimizations },
   { "library", HandleLibrary },
   { "classes", HandleClasses },
   { "objects", HandleObjects },
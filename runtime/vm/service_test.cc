@@ -0,0 +1,101 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/assert.h"
+#include "vm/compiler.h"
+#include "vm/dart_api_impl.h"
+#include "vm/message_handler.h"
+#include "vm/port.h"
+#include "vm/service.h"
+#include "vm/snapshot.h"
+#include "vm/symbols.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+// Keeps the last reply posted to its port.
+class ServiceTestMessageHandler : public MessageHandler {
+ public:
+  ServiceTestMessageHandler() : msg_(NULL) {}
+
+  ~ServiceTestMessageHandler() {
+    free(msg_);
+  }
+
+  bool HandleMessage(Message* message) {
+    SnapshotReader reader(message->data(), message->len(),
+                          Snapshot::kMessage, Isolate::Current());
+    String& reply = String::Handle();
+    reply ^= reader.ReadObject();
+    free(msg_);
+    msg_ = strdup(reply.ToCString());
+    delete message;
+    return true;
+  }
+
+  const char* msg() const { return msg_; }
+
+ private:
+  char* msg_;
+};
+
+
+// Builds a service request for 'path' without options.
+static RawGrowableObjectArray* NewServiceRequest(const char* path) {
+  const GrowableObjectArray& request =
+      GrowableObjectArray::Handle(GrowableObjectArray::New());
+  const GrowableObjectArray& segments =
+      GrowableObjectArray::Handle(GrowableObjectArray::New());
+  segments.Add(String::Handle(String::New(path)));
+  request.Add(segments);
+  request.Add(GrowableObjectArray::Handle(GrowableObjectArray::New()));
+  request.Add(GrowableObjectArray::Handle(GrowableObjectArray::New()));
+  return request.raw();
+}
+
+
+TEST_CASE(Service_Deoptimizations) {
+  const char* kScriptChars =
+      "class A { f() => 1; }\n"
+      "class B { f() => 2; }\n"
+      "call(o) => o.f();\n"
+      "warmup() {\n"
+      "  for (var i = 0; i < 10; i++) call(new A());\n"
+      "}\n"
+      "deopt() => call(new B());\n";
+
+  Isolate* isolate = Isolate::Current();
+  ServiceTestMessageHandler handler;
+  Dart_Port port = PortMap::CreatePort(&handler);
+
+  // No deoptimizations yet.
+  Service::HandleServiceMessage(isolate, port, GrowableObjectArray::Handle(
+      NewServiceRequest("deoptimizations")));
+  EXPECT(handler.HandleNextMessage());
+  EXPECT_STREQ("{\"type\":\"DeoptimizationHistogram\",\"members\":[]}",
+               handler.msg());
+
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("warmup"), 0, NULL));
+  Library& library = Library::Handle();
+  library ^= Api::UnwrapHandle(lib);
+  const Function& call = Function::Handle(
+      library.LookupLocalFunction(String::Handle(Symbols::New("call"))));
+  EXPECT(!call.IsNull());
+  EXPECT(Error::Handle(Compiler::CompileOptimizedFunction(call)).IsNull());
+  EXPECT_VALID(Dart_Invoke(lib, NewString("deopt"), 0, NULL));
+  EXPECT(!call.HasOptimizedCode());
+
+  // The receiver class check of 'o.f()' failed once.
+  Service::HandleServiceMessage(isolate, port, GrowableObjectArray::Handle(
+      NewServiceRequest("deoptimizations")));
+  EXPECT(handler.HandleNextMessage());
+  EXPECT_STREQ("{\"type\":\"DeoptimizationHistogram\",\"members\":"
+               "[{\"reason\":\"CheckClass\",\"count\":1}]}",
+               handler.msg());
+
+  PortMap::ClosePort(port);
+}
+
+}  // namespace dart
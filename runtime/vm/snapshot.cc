@@ -8,16 +8,25 @@
 #include "vm/bigint_operations.h"
 #include "vm/bootstrap.h"
 #include "vm/class_finalizer.h"
+#include "vm/compiler.h"
+#include "vm/dart_entry.h"
 #include "vm/exceptions.h"
+#include "vm/flags.h"
 #include "vm/heap.h"
 #include "vm/longjump.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
+#include "vm/resolver.h"
 #include "vm/snapshot_ids.h"
 #include "vm/symbols.h"
 
 namespace dart {
 
+DEFINE_FLAG(int, type_feedback_warmup, 10,
+    "Number of invocations after which a function recorded as hot in "
+    "loaded type feedback is optimized.");
+DECLARE_FLAG(int, optimization_counter_threshold);
+
 static const int kNumInitialReferencesInFullSnapshot = 160 * KB;
 static const int kNumInitialReferences = 64;
 
@@ -1522,4 +1531,487 @@ void MessageWriter::WriteMessage(const Object& obj) {
 }
 
 
+// Version of the type feedback format, bumped whenever the layout below or
+// the way the compiler assigns deopt ids changes.
+static const int32_t kTypeFeedbackVersion = 1;
+
+// Record tags of the type feedback format.
+enum {
+  kEndTag = 0,
+  kFunctionTag,
+  kFieldTag,
+};
+
+// Class ids up to kNumPredefinedCids are the same in every run and are
+// written as is. Other classes are written as kClassIdByName followed by the
+// url of their library and their name.
+static const intptr_t kClassIdByName = -1;
+static const intptr_t kUnresolvedClassId = -2;
+
+
+static intptr_t LookupFeedbackClassId(const String& library_url,
+                                      const String& class_name) {
+  const Library& library =
+      Library::Handle(Library::LookupLibrary(library_url));
+  if (library.IsNull()) {
+    return kUnresolvedClassId;
+  }
+  const Class& cls =
+      Class::Handle(library.LookupClassAllowPrivate(class_name));
+  if (cls.IsNull()) {
+    return kUnresolvedClassId;
+  }
+  return cls.id();
+}
+
+
+// Top level functions are looked up in the library, as every script of a
+// library has its own top level class.
+static RawFunction* LookupFeedbackFunction(const String& library_url,
+                                           const String& class_name,
+                                           const String& function_name) {
+  const Library& library =
+      Library::Handle(Library::LookupLibrary(library_url));
+  if (library.IsNull()) {
+    return Function::null();
+  }
+  if (class_name.Equals(Symbols::TopLevel())) {
+    return library.LookupLocalFunction(function_name);
+  }
+  const Class& cls =
+      Class::Handle(library.LookupClassAllowPrivate(class_name));
+  if (cls.IsNull()) {
+    return Function::null();
+  }
+  return cls.LookupFunctionAllowPrivate(function_name);
+}
+
+
+static RawField* LookupFeedbackField(const String& library_url,
+                                     const String& class_name,
+                                     const String& field_name) {
+  const intptr_t class_id = LookupFeedbackClassId(library_url, class_name);
+  if (class_id == kUnresolvedClassId) {
+    return Field::null();
+  }
+  const Class& cls =
+      Class::Handle(Isolate::Current()->class_table()->At(class_id));
+  return cls.LookupInstanceField(field_name);
+}
+
+
+static bool ShouldWriteFeedbackFor(const Function& function) {
+  switch (function.kind()) {
+    case RawFunction::kRegularFunction:
+    case RawFunction::kGetterFunction:
+    case RawFunction::kSetterFunction:
+    case RawFunction::kConstructor:
+      break;
+    default:
+      return false;
+  }
+  if (!function.HasCode()) {
+    return false;
+  }
+  // Only write functions a later run is able to find again.
+  const Class& owner = Class::Handle(function.Owner());
+  const Library& library = Library::Handle(owner.library());
+  if (library.IsNull()) {
+    return false;
+  }
+  const Function& lookup = Function::Handle(
+      LookupFeedbackFunction(String::Handle(library.url()),
+                             String::Handle(owner.Name()),
+                             String::Handle(function.name())));
+  return lookup.raw() == function.raw();
+}
+
+
+void TypeFeedbackWriter::WriteString(const String& str) {
+  const char* cstr = str.ToCString();
+  const intptr_t len = strlen(cstr);
+  WriteIntptrValue(len);
+  WriteBytes(reinterpret_cast<const uint8_t*>(cstr), len);
+}
+
+
+bool TypeFeedbackWriter::CanWriteClassId(intptr_t class_id) const {
+  if (class_id < kNumPredefinedCids) {
+    return true;
+  }
+  const Class& cls = Class::Handle(class_table_->At(class_id));
+  const Library& library = Library::Handle(cls.library());
+  if (library.IsNull()) {
+    return false;
+  }
+  return LookupFeedbackClassId(String::Handle(library.url()),
+                               String::Handle(cls.Name())) == class_id;
+}
+
+
+void TypeFeedbackWriter::WriteClassId(intptr_t class_id) {
+  ASSERT(CanWriteClassId(class_id));
+  if (class_id < kNumPredefinedCids) {
+    WriteIntptrValue(class_id);
+    return;
+  }
+  const Class& cls = Class::Handle(class_table_->At(class_id));
+  WriteIntptrValue(kClassIdByName);
+  WriteString(String::Handle(Library::Handle(cls.library()).url()));
+  WriteString(String::Handle(cls.Name()));
+}
+
+
+intptr_t TypeFeedbackWriter::NumberOfWritableChecks(
+    const ICData& ic_data) const {
+  if (ic_data.IsNull() ||
+      (ic_data.num_args_tested() == 0) ||
+      ic_data.is_closure_call()) {
+    return 0;
+  }
+  intptr_t count = 0;
+  for (intptr_t i = 0; i < ic_data.NumberOfChecks(); i++) {
+    bool writable = true;
+    for (intptr_t k = 0; k < ic_data.num_args_tested(); k++) {
+      writable = writable && CanWriteClassId(ic_data.GetClassIdAt(i, k));
+    }
+    if (writable) {
+      count++;
+    }
+  }
+  return count;
+}
+
+
+void TypeFeedbackWriter::WriteFunction(const Function& function) {
+  const Class& owner = Class::Handle(function.Owner());
+  Write<int8_t>(kFunctionTag);
+  WriteString(String::Handle(Library::Handle(owner.library()).url()));
+  WriteString(String::Handle(owner.Name()));
+  WriteString(String::Handle(function.name()));
+  Write<int32_t>(function.SourceFingerprint());
+  // Functions that deoptimized too often have a negative usage counter.
+  WriteIntptrValue(Utils::Maximum(static_cast<intptr_t>(0),
+                                  function.usage_counter()));
+  Write<int8_t>(function.HasOptimizedCode() ? 1 : 0);
+
+  const Code& code = Code::Handle(function.unoptimized_code());
+  const Array& ic_data_array = Array::Handle(code.ExtractTypeFeedbackArray());
+  ICData& ic_data = ICData::Handle();
+  intptr_t num_ic_data = 0;
+  for (intptr_t i = 0; i < ic_data_array.Length(); i++) {
+    ic_data ^= ic_data_array.At(i);
+    if (NumberOfWritableChecks(ic_data) > 0) {
+      num_ic_data++;
+    }
+  }
+  WriteIntptrValue(num_ic_data);
+  GrowableArray<intptr_t> class_ids;
+  for (intptr_t i = 0; i < ic_data_array.Length(); i++) {
+    ic_data ^= ic_data_array.At(i);
+    const intptr_t num_checks = NumberOfWritableChecks(ic_data);
+    if (num_checks == 0) {
+      continue;
+    }
+    const intptr_t num_args = ic_data.num_args_tested();
+    WriteIntptrValue(ic_data.deopt_id());
+    WriteIntptrValue(num_args);
+    WriteIntptrValue(num_checks);
+    for (intptr_t j = 0; j < ic_data.NumberOfChecks(); j++) {
+      class_ids.Clear();
+      bool writable = true;
+      for (intptr_t k = 0; k < num_args; k++) {
+        class_ids.Add(ic_data.GetClassIdAt(j, k));
+        writable = writable && CanWriteClassId(class_ids[k]);
+      }
+      if (!writable) {
+        continue;
+      }
+      WriteIntptrValue(ic_data.GetCountAt(j));
+      for (intptr_t k = 0; k < num_args; k++) {
+        WriteClassId(class_ids[k]);
+      }
+    }
+  }
+}
+
+
+void TypeFeedbackWriter::WriteField(const Field& field) {
+  const Class& owner = Class::Handle(field.owner());
+  Write<int8_t>(kFieldTag);
+  WriteString(String::Handle(Library::Handle(owner.library()).url()));
+  WriteString(String::Handle(owner.Name()));
+  WriteString(String::Handle(field.name()));
+  WriteClassId(field.guarded_cid());
+  Write<int8_t>(field.is_nullable() ? 1 : 0);
+  WriteIntptrValue(field.guarded_list_length());
+}
+
+
+void TypeFeedbackWriter::WriteTypeFeedback() {
+  // Reserve space in the output buffer for a snapshot header.
+  ReserveHeader();
+  Write<int32_t>(kTypeFeedbackVersion);
+
+  Class& cls = Class::Handle();
+  Array& members = Array::Handle();
+  Function& function = Function::Handle();
+  Field& field = Field::Handle();
+  for (intptr_t cid = 1; cid < class_table_->NumCids(); cid++) {
+    if (!class_table_->HasValidClassAt(cid)) {
+      continue;
+    }
+    cls = class_table_->At(cid);
+    // The classes of VM internal objects have no members.
+    if (!cls.is_finalized() || (cls.functions() == Array::null())) {
+      continue;
+    }
+    members = cls.functions();
+    for (intptr_t i = 0; i < members.Length(); i++) {
+      function ^= members.At(i);
+      if (ShouldWriteFeedbackFor(function)) {
+        WriteFunction(function);
+      }
+    }
+    if (!CanWriteClassId(cid)) {
+      continue;
+    }
+    members = cls.fields();
+    if (members.IsNull()) {
+      continue;
+    }
+    for (intptr_t i = 0; i < members.Length(); i++) {
+      field ^= members.At(i);
+      if (!field.is_static() &&
+          (field.guarded_cid() != kIllegalCid) &&
+          CanWriteClassId(field.guarded_cid())) {
+        WriteField(field);
+      }
+    }
+  }
+  Write<int8_t>(kEndTag);
+
+  // Fill in the header.
+  FillHeader(Snapshot::kTypeFeedback);
+}
+
+
+TypeFeedbackReader::TypeFeedbackReader(const uint8_t* buffer,
+                                       intptr_t size,
+                                       bool apply)
+    : BaseReader(buffer, size),
+      isolate_(Isolate::Current()),
+      apply_(apply),
+      error_(String::Handle(isolate_)) {
+}
+
+
+bool TypeFeedbackReader::Mismatch(const char* format, ...) {
+  char buffer[1024];
+  va_list args;
+  va_start(args, format);
+  OS::VSNPrint(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  error_ = String::New(buffer);
+  return false;
+}
+
+
+RawString* TypeFeedbackReader::ReadString() {
+  const intptr_t len = ReadIntptrValue();
+  const uint8_t* utf8 = CurrentBufferAddress();
+  Advance(len);
+  return Symbols::FromUTF8(utf8, len);
+}
+
+
+intptr_t TypeFeedbackReader::ReadClassId() {
+  const intptr_t class_id = ReadIntptrValue();
+  if (class_id != kClassIdByName) {
+    return class_id;
+  }
+  const String& library_url = String::Handle(isolate_, ReadString());
+  const String& class_name = String::Handle(isolate_, ReadString());
+  return LookupFeedbackClassId(library_url, class_name);
+}
+
+
+// Adds a check recorded by an earlier run to an empty inline cache, the way
+// an inline cache miss would have.
+void TypeFeedbackReader::SeedCheck(const ICData& ic_data,
+                                   const GrowableArray<intptr_t>& class_ids,
+                                   intptr_t count) {
+  const Class& receiver_class =
+      Class::Handle(isolate_, isolate_->class_table()->At(class_ids[0]));
+  const ArgumentsDescriptor args_desc(
+      Array::Handle(isolate_, ic_data.arguments_descriptor()));
+  const Function& target = Function::Handle(isolate_,
+      Resolver::ResolveDynamicForReceiverClass(
+          receiver_class,
+          String::Handle(isolate_, ic_data.target_name()),
+          args_desc));
+  if (target.IsNull()) {
+    // Leave noSuchMethod and closure calls to the megamorphic stub.
+    return;
+  }
+  if (!target.HasCode()) {
+    const Error& error =
+        Error::Handle(isolate_, Compiler::CompileFunction(target));
+    if (!error.IsNull()) {
+      return;
+    }
+  }
+  if (class_ids.length() == 1) {
+    ic_data.AddReceiverCheck(class_ids[0], target, count);
+  } else {
+    ic_data.AddCheck(class_ids, target);
+    ic_data.SetCountAt(ic_data.NumberOfChecks() - 1, count);
+  }
+}
+
+
+bool TypeFeedbackReader::ReadFunction() {
+  const String& library_url = String::Handle(isolate_, ReadString());
+  const String& class_name = String::Handle(isolate_, ReadString());
+  const String& function_name = String::Handle(isolate_, ReadString());
+  const int32_t fingerprint = Read<int32_t>();
+  const intptr_t usage_counter = ReadIntptrValue();
+  const bool was_optimized = (Read<int8_t>() != 0);
+  const intptr_t num_ic_data = ReadIntptrValue();
+
+  const Function& function = Function::Handle(isolate_,
+      LookupFeedbackFunction(library_url, class_name, function_name));
+  if (function.IsNull()) {
+    return Mismatch("function '%s' of '%s' no longer exists",
+                    function_name.ToCString(), library_url.ToCString());
+  }
+  if (function.SourceFingerprint() != fingerprint) {
+    return Mismatch("source of '%s' has changed",
+                    function.ToFullyQualifiedCString());
+  }
+
+  Array& ic_data_array = Array::Handle(isolate_);
+  if (apply_) {
+    if (!function.HasCode() && (num_ic_data > 0)) {
+      const Error& error =
+          Error::Handle(isolate_, Compiler::CompileFunction(function));
+      if (!error.IsNull()) {
+        return Mismatch("%s", error.ToErrorCString());
+      }
+    }
+    if (function.HasCode()) {
+      const Code& code = Code::Handle(isolate_, function.unoptimized_code());
+      ic_data_array = code.ExtractTypeFeedbackArray();
+    }
+    // Functions that were hot in the recorded run are optimized after a
+    // few invocations, by which time their inline caches are seeded below.
+    intptr_t counter = usage_counter;
+    if (was_optimized ||
+        (counter >= FLAG_optimization_counter_threshold)) {
+      counter = Utils::Maximum(
+          static_cast<intptr_t>(0),
+          static_cast<intptr_t>(FLAG_optimization_counter_threshold -
+                                FLAG_type_feedback_warmup));
+    }
+    if (counter > function.usage_counter()) {
+      function.set_usage_counter(counter);
+    }
+  }
+
+  ICData& ic_data = ICData::Handle(isolate_);
+  GrowableArray<intptr_t> class_ids;
+  for (intptr_t i = 0; i < num_ic_data; i++) {
+    const intptr_t deopt_id = ReadIntptrValue();
+    const intptr_t num_args = ReadIntptrValue();
+    const intptr_t num_checks = ReadIntptrValue();
+    ic_data = ICData::null();
+    if (!ic_data_array.IsNull() &&
+        (deopt_id >= 0) && (deopt_id < ic_data_array.Length())) {
+      ic_data ^= ic_data_array.At(deopt_id);
+    }
+    // Only seed inline caches that this run has not filled yet.
+    const bool seed = !ic_data.IsNull() &&
+                      (ic_data.num_args_tested() == num_args) &&
+                      !ic_data.is_closure_call() &&
+                      (ic_data.NumberOfChecks() == 0);
+    for (intptr_t j = 0; j < num_checks; j++) {
+      const intptr_t count = ReadIntptrValue();
+      class_ids.Clear();
+      for (intptr_t k = 0; k < num_args; k++) {
+        const intptr_t class_id = ReadClassId();
+        if (class_id == kUnresolvedClassId) {
+          return Mismatch("a receiver class seen in '%s' no longer exists",
+                          function.ToFullyQualifiedCString());
+        }
+        class_ids.Add(class_id);
+      }
+      if (seed) {
+        SeedCheck(ic_data, class_ids, count);
+      }
+    }
+  }
+  return true;
+}
+
+
+bool TypeFeedbackReader::ReadField() {
+  const String& library_url = String::Handle(isolate_, ReadString());
+  const String& class_name = String::Handle(isolate_, ReadString());
+  const String& field_name = String::Handle(isolate_, ReadString());
+  const intptr_t guarded_cid = ReadClassId();
+  const bool is_nullable = (Read<int8_t>() != 0);
+  const intptr_t guarded_list_length = ReadIntptrValue();
+
+  const Field& field = Field::Handle(isolate_,
+      LookupFeedbackField(library_url, class_name, field_name));
+  if (field.IsNull()) {
+    return Mismatch("field '%s' of '%s' no longer exists",
+                    field_name.ToCString(), class_name.ToCString());
+  }
+  if (guarded_cid == kUnresolvedClassId) {
+    return Mismatch("the class stored into field '%s' no longer exists",
+                    field_name.ToCString());
+  }
+  // A field nothing has been stored into yet may take on any guard: the
+  // first store that does not match generalizes it and deoptimizes code
+  // depending on it, just as for a guard learned in this run.
+  if (apply_ && (field.guarded_cid() == kIllegalCid)) {
+    field.set_guarded_cid(guarded_cid);
+    field.set_is_nullable(is_nullable);
+    if (field.is_final()) {
+      field.set_guarded_list_length(guarded_list_length);
+    }
+  }
+  return true;
+}
+
+
+RawApiError* TypeFeedbackReader::ReadTypeFeedback() {
+  if (Read<int32_t>() != kTypeFeedbackVersion) {
+    Mismatch("type feedback was written by a different version of the VM");
+    return ApiError::New(error_);
+  }
+  while (true) {
+    bool success = false;
+    switch (Read<int8_t>()) {
+      case kEndTag:
+        return ApiError::null();
+      case kFunctionTag:
+        success = ReadFunction();
+        break;
+      case kFieldTag:
+        success = ReadField();
+        break;
+      default:
+        Mismatch("type feedback is corrupt");
+        break;
+    }
+    if (!success) {
+      return ApiError::New(error_);
+    }
+  }
+  UNREACHABLE();
+  return ApiError::null();
+}
+
 }  // namespace dart
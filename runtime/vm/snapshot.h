@@ -24,8 +24,11 @@ class Array;
 class Class;
 class ClassTable;
 class ExternalTypedData;
+class Field;
+class Function;
 class GrowableObjectArray;
 class Heap;
+class ICData;
 class LanguageError;
 class Library;
 class Object;
@@ -126,6 +129,7 @@ class Snapshot {
     kFull = 0,  // Full snapshot of the current dart heap.
     kScript,    // A partial snapshot of only the application script.
     kMessage,   // A partial snapshot used only for isolate messaging.
+    kTypeFeedback,  // Type feedback gathered by a run of the application.
   };
 
   static const int kHeaderSize = 2 * sizeof(int32_t);
@@ -142,6 +146,7 @@ class Snapshot {
   bool IsMessageSnapshot() const { return kind_ == kMessage; }
   bool IsScriptSnapshot() const { return kind_ == kScript; }
   bool IsFullSnapshot() const { return kind_ == kFull; }
+  bool IsTypeFeedbackSnapshot() const { return kind_ == kTypeFeedback; }
   uint8_t* Addr() { return reinterpret_cast<uint8_t*>(this); }
 
   static intptr_t length_offset() { return OFFSET_OF(Snapshot, length_); }
@@ -595,6 +600,69 @@ class MessageWriter : public SnapshotWriter {
 };
 
 
+// Writes the type feedback gathered by the current isolate: usage counters
+// and inline cache receiver classes of compiled functions, and the guarded
+// class ids of instance fields. Functions, fields and classes are identified
+// by library url and name so that a later run of the same sources can pick
+// the feedback up (see TypeFeedbackReader).
+class TypeFeedbackWriter : public BaseWriter {
+ public:
+  static const intptr_t kInitialSize = 16 * KB;
+  TypeFeedbackWriter(uint8_t** buffer, ReAlloc alloc)
+      : BaseWriter(buffer, alloc, kInitialSize),
+        class_table_(Isolate::Current()->class_table()) {
+    ASSERT(buffer != NULL);
+    ASSERT(alloc != NULL);
+  }
+  ~TypeFeedbackWriter() { }
+
+  void WriteTypeFeedback();
+
+ private:
+  void WriteString(const String& str);
+  bool CanWriteClassId(intptr_t class_id) const;
+  void WriteClassId(intptr_t class_id);
+  intptr_t NumberOfWritableChecks(const ICData& ic_data) const;
+  void WriteFunction(const Function& function);
+  void WriteField(const Field& field);
+
+  ClassTable* class_table_;
+
+  DISALLOW_COPY_AND_ASSIGN(TypeFeedbackWriter);
+};
+
+
+// Reads type feedback written by TypeFeedbackWriter. The feedback is only
+// applied if 'apply' is true; reading it with 'apply' false first checks
+// that it was recorded against the sources currently loaded, using the
+// source fingerprints of the recorded functions.
+class TypeFeedbackReader : public BaseReader {
+ public:
+  TypeFeedbackReader(const uint8_t* buffer, intptr_t size, bool apply);
+  ~TypeFeedbackReader() { }
+
+  // Returns ApiError::null() on success or an error naming the first
+  // function or class that no longer matches the recorded feedback.
+  RawApiError* ReadTypeFeedback();
+
+ private:
+  RawString* ReadString();
+  intptr_t ReadClassId();
+  bool ReadFunction();
+  bool ReadField();
+  void SeedCheck(const ICData& ic_data,
+                 const GrowableArray<intptr_t>& class_ids,
+                 intptr_t count);
+  bool Mismatch(const char* format, ...) PRINTF_ATTRIBUTE(2, 3);
+
+  Isolate* isolate_;
+  bool apply_;
+  String& error_;  // Describes the first mismatch found.
+
+  DISALLOW_COPY_AND_ASSIGN(TypeFeedbackReader);
+};
+
+
 // An object pointer visitor implementation which writes out
 // objects to a snap shot.
 class SnapshotWriterVisitor : public ObjectPointerVisitor {
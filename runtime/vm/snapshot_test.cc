@@ -2693,4 +2693,97 @@ UNIT_TEST_CASE(PostCObject) {
   Dart_ExitScope();
 }
 
+// Returns the number of checks in the inline cache of the first instance
+// call in function 'name' of the test script.
+static intptr_t NumberOfChecksInFirstCall(Dart_Handle lib, const char* name) {
+  Isolate* isolate = Isolate::Current();
+  StackZone zone(isolate);
+  HANDLESCOPE(isolate);
+  Library& library = Library::Handle();
+  library ^= Api::UnwrapHandle(lib);
+  const Function& function = Function::Handle(
+      library.LookupLocalFunction(String::Handle(Symbols::New(name))));
+  if (function.IsNull() || !function.HasCode()) {
+    return -1;
+  }
+  const Code& code = Code::Handle(function.unoptimized_code());
+  const Array& ic_data_array = Array::Handle(code.ExtractTypeFeedbackArray());
+  ICData& ic_data = ICData::Handle();
+  for (intptr_t i = 0; i < ic_data_array.Length(); i++) {
+    ic_data ^= ic_data_array.At(i);
+    if (!ic_data.IsNull() && (ic_data.num_args_tested() == 1)) {
+      return ic_data.NumberOfChecks();
+    }
+  }
+  return -1;
+}
+
+
+UNIT_TEST_CASE(TypeFeedback) {
+  const char* kScriptChars =
+      "class A { foo() => 1; }\n"
+      "class B { foo() => 2; }\n"
+      "call(x) => x.foo();\n"
+      "main() {\n"
+      "  var sum = 0;\n"
+      "  for (var i = 0; i < 10; i++) {\n"
+      "    sum += call(new A()) + call(new B());\n"
+      "  }\n"
+      "  return sum;\n"
+      "}\n";
+  const char* kChangedScriptChars =
+      "class A { foo() => 1; }\n"
+      "class B { foo() => 2; }\n"
+      "call(x) => x.foo() + 0;\n"
+      "main() => call(new A());\n";
+
+  Dart_Handle result;
+  uint8_t* buffer;
+  intptr_t size;
+  uint8_t* feedback = NULL;
+
+  {
+    // Run the script and record its type feedback.
+    TestIsolateScope __test_isolate__;
+    Dart_EnterScope();  // Start a Dart API scope for invoking API functions.
+    Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+    result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+    EXPECT_VALID(result);
+    EXPECT_EQ(2, NumberOfChecksInFirstCall(lib, "call"));
+    result = Dart_CreateTypeFeedback(&buffer, &size);
+    EXPECT_VALID(result);
+    feedback = reinterpret_cast<uint8_t*>(malloc(size));
+    memmove(feedback, buffer, size);
+    Dart_ExitScope();
+  }
+
+  {
+    // A fresh run of the same script starts with the recorded inline caches.
+    TestIsolateScope __test_isolate__;
+    Dart_EnterScope();  // Start a Dart API scope for invoking API functions.
+    Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+    EXPECT_VALID(Dart_LoadTypeFeedback(feedback, size));
+    EXPECT_EQ(2, NumberOfChecksInFirstCall(lib, "call"));
+    result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+    EXPECT_VALID(result);
+    int64_t value = 0;
+    EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+    EXPECT_EQ(30, value);
+    Dart_ExitScope();
+  }
+
+  {
+    // Feedback recorded against different sources is rejected as a whole.
+    TestIsolateScope __test_isolate__;
+    Dart_EnterScope();  // Start a Dart API scope for invoking API functions.
+    Dart_Handle lib = TestCase::LoadTestScript(kChangedScriptChars, NULL);
+    result = Dart_LoadTypeFeedback(feedback, size);
+    EXPECT(Dart_IsError(result));
+    EXPECT_SUBSTRING("has changed", Dart_GetError(result));
+    EXPECT_EQ(-1, NumberOfChecksInFirstCall(lib, "call"));
+    Dart_ExitScope();
+  }
+  free(feedback);
+}
+
 }  // namespace dart
@@ -5,10 +5,15 @@
 #include "vm/store_buffer.h"
 
 #include "platform/assert.h"
+#include "vm/flags.h"
 #include "vm/runtime_entry.h"
 
 namespace dart {
 
+DEFINE_FLAG(int, store_buffer_max_blocks, 100,
+            "Number of full store buffer blocks above which the mutator "
+            "schedules a scavenge.");
+
 DEFINE_LEAF_RUNTIME_ENTRY(void, StoreBufferBlockProcess, 1, Isolate* isolate) {
   StoreBuffer* buffer = isolate->store_buffer();
   buffer->Expand(true);
@@ -67,9 +72,10 @@ void StoreBuffer::Expand(bool check) {
 
 void StoreBuffer::CheckThreshold() {
   // Schedule an interrupt if we have run over the max number of
-  // StoreBufferBlocks.
-  // TODO(iposva): Fix magic number.
-  if (full_count_ > 100) {
+  // StoreBufferBlocks. Every object is recorded at most once between
+  // scavenges, so the bound limits the work of the next scavenge rather than
+  // the number of stores.
+  if (full_count_ > FLAG_store_buffer_max_blocks) {
     Isolate::Current()->ScheduleInterrupts(Isolate::kStoreBufferInterrupt);
   }
 }
@@ -27,6 +27,15 @@ class StoreBufferBlock {
 
   intptr_t Count() const { return top_; }
 
+  bool IsFull() const { return top_ == kSize; }
+
+  // Add an object to a block which is not owned by a StoreBuffer, e.g. one
+  // used by a GC task to collect objects privately.
+  void Add(RawObject* obj) {
+    ASSERT(!IsFull());
+    pointers_[top_++] = obj;
+  }
+
   RawObject* At(intptr_t i) const {
     ASSERT(i >= 0);
     ASSERT(i < top_);
@@ -95,17 +95,24 @@ bool StubCode::InInvocationStub(uword pc) {
 }
 
 
-RawCode* StubCode::GetAllocationStubForClass(const Class& cls) {
+RawCode* StubCode::GetAllocationStubForClass(const Class& cls,
+                                             Heap::Space space) {
   Isolate* isolate = Isolate::Current();
   const Error& error = Error::Handle(isolate, cls.EnsureIsFinalized(isolate));
   ASSERT(error.IsNull());
-  Code& stub = Code::Handle(isolate, cls.allocation_stub());
+  Code& stub = Code::Handle(isolate, (space == Heap::kNew)
+      ? cls.allocation_stub()
+      : cls.pretenured_allocation_stub());
   if (stub.IsNull()) {
     Assembler assembler;
     const char* name = cls.ToCString();
-    StubCode::GenerateAllocationStubForClass(&assembler, cls);
+    StubCode::GenerateAllocationStubForClass(&assembler, cls, space);
     stub ^= Code::FinalizeCode(name, &assembler);
-    cls.set_allocation_stub(stub);
+    if (space == Heap::kNew) {
+      cls.set_allocation_stub(stub);
+    } else {
+      cls.set_pretenured_allocation_stub(stub);
+    }
     if (FLAG_disassemble_stubs) {
       OS::Print("Code for allocation stub '%s': {\n", name);
       Disassembler::Disassemble(stub.EntryPoint(),
@@ -157,7 +157,10 @@ class StubCode {
   STUB_CODE_LIST(STUB_CODE_ACCESSOR);
 #undef STUB_CODE_ACCESSOR
 
-  static RawCode* GetAllocationStubForClass(const Class& cls);
+  // Instances of classes without type arguments can also be allocated in old
+  // space.
+  static RawCode* GetAllocationStubForClass(const Class& cls,
+                                            Heap::Space space = Heap::kNew);
   static RawCode* GetAllocationStubForClosure(const Function& func);
 
   static const intptr_t kNoInstantiator = 0;
@@ -193,7 +196,8 @@ class StubCode {
 
   static void GenerateMegamorphicMissStub(Assembler* assembler);
   static void GenerateAllocationStubForClass(Assembler* assembler,
-                                             const Class& cls);
+                                             const Class& cls,
+                                             Heap::Space space);
   static void GenerateAllocationStubForClosure(Assembler* assembler,
                                                const Function& func);
   static void GenerateNArgsCheckInlineCacheStub(
@@ -1084,11 +1084,15 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
 //   SP + 4 : type arguments object (only if class is parameterized).
 //   SP + 0 : type arguments of instantiator (only if class is parameterized).
 void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
-                                              const Class& cls) {
+                                              const Class& cls,
+                                              Heap::Space space) {
   // The generated code is different if the class is parameterized.
   const bool is_cls_parameterized = cls.NumTypeArguments() > 0;
   ASSERT(!is_cls_parameterized ||
          (cls.type_arguments_field_offset() != Class::kNoTypeArguments));
+  // Pretenured instances are initialized without a write barrier, so only
+  // classes without type arguments are allocated in old space.
+  ASSERT((space == Heap::kNew) || !is_cls_parameterized);
   // kInlineInstanceSize is a constant used as a threshold for determining
   // when the object initialization should be done as a loop or as
   // straight line code.
@@ -1100,7 +1104,11 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
       Heap::IsAllocatableInNewSpace(instance_size + type_args_size)) {
     Label slow_case;
     Heap* heap = Isolate::Current()->heap();
-    __ LoadImmediate(R5, heap->TopAddress());
+    const uword top_address = (space == Heap::kNew)
+        ? heap->TopAddress() : heap->OldTopAddress();
+    const uword end_address = (space == Heap::kNew)
+        ? heap->EndAddress() : heap->OldEndAddress();
+    __ LoadImmediate(R5, top_address);
     __ ldr(R2, Address(R5, 0));
     __ AddImmediate(R3, R2, instance_size);
     if (is_cls_parameterized) {
@@ -1116,7 +1124,7 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
     // Check if the allocation fits into the remaining space.
     // R2: potential new object start.
     // R3: potential next object start.
-    __ LoadImmediate(IP, heap->EndAddress());
+    __ LoadImmediate(IP, end_address);
     __ ldr(IP, Address(IP, 0));
     __ cmp(R3, ShifterOperand(IP));
     if (FLAG_use_slow_path) {
@@ -1236,7 +1244,9 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
     __ LoadImmediate(R1, Smi::RawValue(StubCode::kNoInstantiator));
     __ PushList((1 << R1) | (1 << R2));
   }
-  __ CallRuntime(kAllocateObjectRuntimeEntry, 3);  // Allocate object.
+  // Allocate object.
+  __ CallRuntime((space == Heap::kNew) ? kAllocateObjectRuntimeEntry
+                                       : kAllocateObjectOldRuntimeEntry, 3);
   __ Drop(3);  // Pop arguments.
   __ Pop(R0);  // Pop result (newly allocated object).
   // R0: new object
@@ -1018,23 +1018,42 @@ DECLARE_LEAF_RUNTIME_ENTRY(void, StoreBufferBlockProcess, Isolate* isolate);
 // Helper stub to implement Assembler::StoreIntoObject.
 // Input parameters:
 //   EAX: Address being stored
+//   TOS + 1: Address of the slot being stored into
 void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
   // Save values being destroyed.
   __ pushl(EDX);
   __ pushl(ECX);
 
-  Label add_to_buffer;
+  Label add_to_buffer, remember_card;
   // Check whether this object has already been remembered. Skip adding to the
   // store buffer if the object is in the store buffer already.
   // Spilled: EDX, ECX
   // EAX: Address being stored
   __ movl(ECX, FieldAddress(EAX, Object::tags_offset()));
+  __ testl(ECX, Immediate(1 << RawObject::kCardRememberedBit));
+  __ j(NOT_ZERO, &remember_card, Assembler::kNearJump);
   __ testl(ECX, Immediate(1 << RawObject::kRememberedBit));
   __ j(EQUAL, &add_to_buffer, Assembler::kNearJump);
   __ popl(ECX);
   __ popl(EDX);
   __ ret();
 
+  // Dirty the card of the slot in the card table of the large page holding
+  // the array.
+  // Spilled: EDX, ECX
+  // EAX: Address being stored
+  __ Bind(&remember_card);
+  __ leal(EDX, FieldAddress(EAX, 0));
+  __ movl(ECX, Address(ESP, 3 * kWordSize));
+  __ subl(ECX, EDX);
+  __ shrl(ECX, Immediate(HeapPage::kCardSizeLog2));
+  __ movl(EDX, Address(EDX, HeapPage::card_table_offset() -
+                            HeapPage::ObjectStartOffset()));
+  __ movb(Address(EDX, ECX, TIMES_1, 0), Immediate(1));
+  __ popl(ECX);
+  __ popl(EDX);
+  __ ret();
+
   __ Bind(&add_to_buffer);
   __ orl(ECX, Immediate(1 << RawObject::kRememberedBit));
   __ movl(FieldAddress(EAX, Object::tags_offset()), ECX);
@@ -1089,7 +1108,8 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
 //   ESP : points to return address.
 // Uses EAX, EBX, ECX, EDX, EDI as temporary registers.
 void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
-                                              const Class& cls) {
+                                              const Class& cls,
+                                              Heap::Space space) {
   const intptr_t kObjectTypeArgumentsOffset = 2 * kWordSize;
   const intptr_t kInstantiatorTypeArgumentsOffset = 1 * kWordSize;
   const Immediate& raw_null =
@@ -1098,6 +1118,9 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
   const bool is_cls_parameterized = cls.NumTypeArguments() > 0;
   ASSERT(!is_cls_parameterized ||
          (cls.type_arguments_field_offset() != Class::kNoTypeArguments));
+  // Pretenured instances are initialized without a write barrier, so only
+  // classes without type arguments are allocated in old space.
+  ASSERT((space == Heap::kNew) || !is_cls_parameterized);
   // kInlineInstanceSize is a constant used as a threshold for determining
   // when the object initialization should be done as a loop or as
   // straight line code.
@@ -1109,7 +1132,11 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
       Heap::IsAllocatableInNewSpace(instance_size + type_args_size)) {
     Label slow_case;
     Heap* heap = Isolate::Current()->heap();
-    __ movl(EAX, Address::Absolute(heap->TopAddress()));
+    const uword top_address = (space == Heap::kNew)
+        ? heap->TopAddress() : heap->OldTopAddress();
+    const uword end_address = (space == Heap::kNew)
+        ? heap->EndAddress() : heap->OldEndAddress();
+    __ movl(EAX, Address::Absolute(top_address));
     __ leal(EBX, Address(EAX, instance_size));
     if (is_cls_parameterized) {
       __ movl(ECX, EBX);
@@ -1127,7 +1154,7 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
     // Check if the allocation fits into the remaining space.
     // EAX: potential new object start.
     // EBX: potential next object start.
-    __ cmpl(EBX, Address::Absolute(heap->EndAddress()));
+    __ cmpl(EBX, Address::Absolute(end_address));
     if (FLAG_use_slow_path) {
       __ jmp(&slow_case);
     } else {
@@ -1136,7 +1163,7 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
 
     // Successfully allocated the object(s), now update top to point to
     // next object start and initialize the object.
-    __ movl(Address::Absolute(heap->TopAddress()), EBX);
+    __ movl(Address::Absolute(top_address), EBX);
 
     if (is_cls_parameterized) {
       // Initialize the type arguments field in the object.
@@ -1245,7 +1272,9 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
     __ pushl(raw_null);  // Push null type arguments.
     __ pushl(Immediate(Smi::RawValue(StubCode::kNoInstantiator)));
   }
-  __ CallRuntime(kAllocateObjectRuntimeEntry, 3);  // Allocate object.
+  // Allocate object.
+  __ CallRuntime((space == Heap::kNew) ? kAllocateObjectRuntimeEntry
+                                       : kAllocateObjectOldRuntimeEntry, 3);
   __ popl(EAX);  // Pop argument (instantiator).
   __ popl(EAX);  // Pop argument (type arguments of object).
   __ popl(EAX);  // Pop argument (class of object).
@@ -1257,12 +1257,16 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
 //   SP + 4 : type arguments object (only if class is parameterized).
 //   SP + 0 : type arguments of instantiator (only if class is parameterized).
 void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
-                                              const Class& cls) {
+                                              const Class& cls,
+                                              Heap::Space space) {
   __ TraceSimMsg("AllocationStubForClass");
   // The generated code is different if the class is parameterized.
   const bool is_cls_parameterized = cls.NumTypeArguments() > 0;
   ASSERT(!is_cls_parameterized ||
          (cls.type_arguments_field_offset() != Class::kNoTypeArguments));
+  // Pretenured instances are initialized without a write barrier, so only
+  // classes without type arguments are allocated in old space.
+  ASSERT((space == Heap::kNew) || !is_cls_parameterized);
   // kInlineInstanceSize is a constant used as a threshold for determining
   // when the object initialization should be done as a loop or as
   // straight line code.
@@ -1274,7 +1278,11 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
       Heap::IsAllocatableInNewSpace(instance_size + type_args_size)) {
     Label slow_case;
     Heap* heap = Isolate::Current()->heap();
-    __ LoadImmediate(T5, heap->TopAddress());
+    const uword top_address = (space == Heap::kNew)
+        ? heap->TopAddress() : heap->OldTopAddress();
+    const uword end_address = (space == Heap::kNew)
+        ? heap->EndAddress() : heap->OldEndAddress();
+    __ LoadImmediate(T5, top_address);
     __ lw(T2, Address(T5));
     __ LoadImmediate(T4, instance_size);
     __ addu(T3, T2, T4);
@@ -1295,7 +1303,7 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
     // Check if the allocation fits into the remaining space.
     // T2: potential new object start.
     // T3: potential next object start.
-    __ LoadImmediate(TMP, heap->EndAddress());
+    __ LoadImmediate(TMP, end_address);
     __ lw(CMPRES1, Address(TMP));
     if (FLAG_use_slow_path) {
       __ b(&slow_case);
@@ -1416,7 +1424,9 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
     __ sw(T7, Address(SP, 1 * kWordSize));
     __ sw(T1, Address(SP, 0 * kWordSize));
   }
-  __ CallRuntime(kAllocateObjectRuntimeEntry, 3);  // Allocate object.
+  // Allocate object.
+  __ CallRuntime((space == Heap::kNew) ? kAllocateObjectRuntimeEntry
+                                       : kAllocateObjectOldRuntimeEntry, 3);
   __ TraceSimMsg("AllocationStubForClass return");
   // Pop result (newly allocated object).
   __ lw(V0, Address(SP, 3 * kWordSize));
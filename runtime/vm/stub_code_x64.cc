@@ -1021,23 +1021,42 @@ DECLARE_LEAF_RUNTIME_ENTRY(void, StoreBufferBlockProcess, Isolate* isolate);
 // Helper stub to implement Assembler::StoreIntoObject.
 // Input parameters:
 //   RAX: Address being stored
+//   TOS + 1: Address of the slot being stored into
 void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
   // Save registers being destroyed.
   __ pushq(RDX);
   __ pushq(RCX);
 
-  Label add_to_buffer;
+  Label add_to_buffer, remember_card;
   // Check whether this object has already been remembered. Skip adding to the
   // store buffer if the object is in the store buffer already.
   // Spilled: RDX, RCX
   // RAX: Address being stored
   __ movq(RCX, FieldAddress(RAX, Object::tags_offset()));
+  __ testq(RCX, Immediate(1 << RawObject::kCardRememberedBit));
+  __ j(NOT_ZERO, &remember_card, Assembler::kNearJump);
   __ testq(RCX, Immediate(1 << RawObject::kRememberedBit));
   __ j(EQUAL, &add_to_buffer, Assembler::kNearJump);
   __ popq(RCX);
   __ popq(RDX);
   __ ret();
 
+  // Dirty the card of the slot in the card table of the large page holding
+  // the array.
+  // Spilled: RDX, RCX
+  // RAX: Address being stored
+  __ Bind(&remember_card);
+  __ leaq(RDX, FieldAddress(RAX, 0));
+  __ movq(RCX, Address(RSP, 3 * kWordSize));
+  __ subq(RCX, RDX);
+  __ shrq(RCX, Immediate(HeapPage::kCardSizeLog2));
+  __ movq(RDX, Address(RDX, HeapPage::card_table_offset() -
+                            HeapPage::ObjectStartOffset()));
+  __ movb(Address(RDX, RCX, TIMES_1, 0), Immediate(1));
+  __ popq(RCX);
+  __ popq(RDX);
+  __ ret();
+
   __ Bind(&add_to_buffer);
   __ orq(RCX, Immediate(1 << RawObject::kRememberedBit));
   __ movq(FieldAddress(RAX, Object::tags_offset()), RCX);
@@ -1084,13 +1103,17 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
 //   RSP + 8 : type arguments of instantiator (only if class is parameterized).
 //   RSP : points to return address.
 void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
-                                              const Class& cls) {
+                                              const Class& cls,
+                                              Heap::Space space) {
   const intptr_t kObjectTypeArgumentsOffset = 2 * kWordSize;
   const intptr_t kInstantiatorTypeArgumentsOffset = 1 * kWordSize;
   // The generated code is different if the class is parameterized.
   const bool is_cls_parameterized = cls.NumTypeArguments() > 0;
   ASSERT(!is_cls_parameterized ||
          (cls.type_arguments_field_offset() != Class::kNoTypeArguments));
+  // Pretenured instances are initialized without a write barrier, so only
+  // classes without type arguments are allocated in old space.
+  ASSERT((space == Heap::kNew) || !is_cls_parameterized);
   // kInlineInstanceSize is a constant used as a threshold for determining
   // when the object initialization should be done as a loop or as
   // straight line code.
@@ -1103,7 +1126,11 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
       Heap::IsAllocatableInNewSpace(instance_size + type_args_size)) {
     Label slow_case;
     Heap* heap = Isolate::Current()->heap();
-    __ movq(RAX, Immediate(heap->TopAddress()));
+    const uword top_address = (space == Heap::kNew)
+        ? heap->TopAddress() : heap->OldTopAddress();
+    const uword end_address = (space == Heap::kNew)
+        ? heap->EndAddress() : heap->OldEndAddress();
+    __ movq(RAX, Immediate(top_address));
     __ movq(RAX, Address(RAX, 0));
     __ leaq(RBX, Address(RAX, instance_size));
     if (is_cls_parameterized) {
@@ -1122,7 +1149,7 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
     // Check if the allocation fits into the remaining space.
     // RAX: potential new object start.
     // RBX: potential next object start.
-    __ movq(RDI, Immediate(heap->EndAddress()));
+    __ movq(RDI, Immediate(end_address));
     __ cmpq(RBX, Address(RDI, 0));
     if (FLAG_use_slow_path) {
       __ jmp(&slow_case);
@@ -1132,7 +1159,7 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
 
     // Successfully allocated the object(s), now update top to point to
     // next object start and initialize the object.
-    __ movq(RDI, Immediate(heap->TopAddress()));
+    __ movq(RDI, Immediate(top_address));
     __ movq(Address(RDI, 0), RBX);
 
     if (is_cls_parameterized) {
@@ -1238,7 +1265,9 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
     __ pushq(R12);  // Push null type arguments.
     __ pushq(Immediate(Smi::RawValue(StubCode::kNoInstantiator)));
   }
-  __ CallRuntime(kAllocateObjectRuntimeEntry, 3);  // Allocate object.
+  // Allocate object.
+  __ CallRuntime((space == Heap::kNew) ? kAllocateObjectRuntimeEntry
+                                       : kAllocateObjectOldRuntimeEntry, 3);
   __ popq(RAX);  // Pop argument (instantiator).
   __ popq(RAX);  // Pop argument (type arguments of object).
   __ popq(RAX);  // Pop argument (class of object).
@@ -40,6 +40,13 @@ class VirtualMemory {
     return Commit(start(), size(), is_executable);
   }
 
+  // Commit a reserved memory area, so that the memory can be accessed.
+  bool Commit(uword addr, intptr_t size, bool is_executable);
+
+  // Return the memory of a committed area to the OS. The area stays reserved
+  // and has to be committed again before it can be accessed.
+  bool Decommit(uword addr, intptr_t size);
+
   // Changes the protection of the virtual memory area.
   bool Protect(Protection mode);
 
@@ -71,9 +78,6 @@ class VirtualMemory {
       region_(region.pointer(), region.size()),
       reserved_pointer_(reserved_pointer) { }
 
-  // Commit a reserved memory area, so that the memory can be accessed.
-  bool Commit(uword addr, intptr_t size, bool is_executable);
-
   MemoryRegion region_;
 
   // The original pointer returned by the OS for this virtual memory
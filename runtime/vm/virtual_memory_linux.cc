@@ -76,6 +76,20 @@ bool VirtualMemory::Commit(uword addr, intptr_t size, bool executable) {
 }
 
 
+bool VirtualMemory::Decommit(uword addr, intptr_t size) {
+  ASSERT(Contains(addr));
+  ASSERT(Contains(addr + size) || (addr + size == end()));
+  // Mapping fresh inaccessible pages over the area drops its contents.
+  void* address = mmap(reinterpret_cast<void*>(addr), size, PROT_NONE,
+                       MAP_PRIVATE | MAP_ANON | MAP_NORESERVE | MAP_FIXED,
+                       -1, 0);
+  if (address == MAP_FAILED) {
+    return false;
+  }
+  return true;
+}
+
+
 bool VirtualMemory::Protect(Protection mode) {
   int prot = 0;
   switch (mode) {
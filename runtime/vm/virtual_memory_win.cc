@@ -56,13 +56,21 @@ bool VirtualMemory::Commit(uword addr, intptr_t size, bool executable) {
   ASSERT(Contains(addr));
   ASSERT(Contains(addr + size) || (addr + size == end()));
   int prot = executable ? PAGE_EXECUTE_READWRITE : PAGE_READWRITE;
-  if (VirtualAlloc(address(), size, MEM_COMMIT, prot) == NULL) {
+  if (VirtualAlloc(reinterpret_cast<void*>(addr), size, MEM_COMMIT, prot) ==
+      NULL) {
     return false;
   }
   return true;
 }
 
 
+bool VirtualMemory::Decommit(uword addr, intptr_t size) {
+  ASSERT(Contains(addr));
+  ASSERT(Contains(addr + size) || (addr + size == end()));
+  return VirtualFree(reinterpret_cast<void*>(addr), size, MEM_DECOMMIT) != 0;
+}
+
+
 bool VirtualMemory::Protect(Protection mode) {
   DWORD prot = 0;
   switch (mode) {